@@ -0,0 +1,509 @@
+/*Native flight path generator
+ * Generates the same flight plan mesh as Tools/MATLAB/FlightPathGeneration.m without MATLAB
+ * Paths are integrated backwards from the target apogee with the coast dynamics used by Controller::updateRule
+ * Trajectory integration (the expensive part) is split across all available cores
+ * The output file uses the format read by FlightPlan::loadFromFile
+ *
+ * Build: g++ -std=c++17 -O2 -pthread FlightPathGeneration.cpp -o FlightPathGeneration
+ * Usage: FlightPathGeneration [--option value]... (run with --help for the list of options)
+*/
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+//natural constants (match FlightPathGeneration.m)
+#define TEMPERATURE_LAPSE_RATE 0.0065
+#define GRAVITATIONAL_CONSTANT 9.80665
+#define IDEAL_GAS_CONSTANT 8.31446
+#define MOLAR_MASS_OF_DRY_AIR 0.0289652
+#define DYNAMICS_GRAVITY 9.8
+
+//integration constants (match FlightPathGeneration.m & ode45)
+#define OUTPUT_PERIOD_s 0.125
+#define MAXIMUM_PATH_TIME_s 100.0
+#define PATH_BATCH_SIZE 256
+
+namespace FlightPathGeneration{
+
+    using state_t = std::array<double, 4>; //x, y, vx, vy
+
+    /*Generation properties
+     * defaults are the values used to generate Tools/MATLAB/flightPath.csv
+    */
+    struct Properties{
+        double targetApogee = 800;                  //m
+        double minimumDragArea = 0.0025;            //m^2
+        double maximumDragArea = 0.01;              //m^2
+        double deploymentAngleLimit = 90;           //degrees
+        double dryMass = 3;                         //kg
+        double launchSiteTemperature = 288.15;      //K
+        double launchSitePressure = 101325;         //Pa
+        double maxVelocity = 150;                   //m/s
+        unsigned velocitySamples = 64;
+        unsigned angleSamples = 64;
+        double minimumAngle = 0.1;                  //degrees
+        double horizontalVelocityIncrement = 1;     //m/s
+        double relativeTolerance = 1e-3;            //ode45 default
+        double absoluteTolerance = 1e-6;            //ode45 default
+        unsigned threads = 0;                       //0 -> all cores
+        std::string outputFile = "flightPath.csv";
+        std::string compareFile;
+    };
+
+    /*Single path resampled over the velocity samples
+    */
+    struct ResampledPath{
+        std::vector<double> angles;
+        std::vector<double> altitudes;
+        double maximumAngle = 0;
+        unsigned steps = 0;
+    };
+
+    /*Resampled surface (rows are angles pi/2 -> 0, columns are velocities max -> 0)
+    */
+    struct Surface{
+        std::vector<double> altitudes;
+        unsigned paths = 0;
+        unsigned long steps = 0;
+    };
+
+    double densityFromAltitude(double altitude, const Properties& properties){
+        const double exponent = GRAVITATIONAL_CONSTANT*MOLAR_MASS_OF_DRY_AIR/(IDEAL_GAS_CONSTANT*TEMPERATURE_LAPSE_RATE) - 1;
+        const double groundDensity = properties.launchSitePressure*MOLAR_MASS_OF_DRY_AIR/(IDEAL_GAS_CONSTANT*properties.launchSiteTemperature);
+        return groundDensity * std::pow(1 - TEMPERATURE_LAPSE_RATE*altitude/properties.launchSiteTemperature, exponent);
+    }
+
+    //time reversed coast dynamics
+    state_t reverseDynamics(const state_t& x, double dragArea, const Properties& properties){
+        const double drag = 0.5 * densityFromAltitude(x[1], properties) * dragArea * std::sqrt(x[2]*x[2] + x[3]*x[3]);
+        return {-x[2], -x[3], drag*x[2]/properties.dryMass, drag*x[3]/properties.dryMass + DYNAMICS_GRAVITY};
+    }
+
+    /*Dormand-Prince 5(4) integrator
+     * follows ode45: same tableau, error norm, step size control, initial step & continuous extension
+    */
+    class PathIntegrator{
+    private:
+        static constexpr std::array<double, 6> c_c = {1.0/5, 3.0/10, 4.0/5, 8.0/9, 1, 1};
+        static constexpr std::array<std::array<double, 6>, 6> c_a = {{
+            {1.0/5, 0, 0, 0, 0, 0},
+            {3.0/40, 9.0/40, 0, 0, 0, 0},
+            {44.0/45, -56.0/15, 32.0/9, 0, 0, 0},
+            {19372.0/6561, -25360.0/2187, 64448.0/6561, -212.0/729, 0, 0},
+            {9017.0/3168, -355.0/33, 46732.0/5247, 49.0/176, -5103.0/18656, 0},
+            {35.0/384, 0, 500.0/1113, 125.0/192, -2187.0/6784, 11.0/84}
+        }};
+        static constexpr std::array<double, 7> c_e = {71.0/57600, 0, -71.0/16695, 71.0/1920, -17253.0/339200, 22.0/525, -1.0/40};
+        static constexpr std::array<std::array<double, 4>, 7> c_bi = {{
+            {1, -183.0/64, 37.0/12, -145.0/128},
+            {0, 0, 0, 0},
+            {0, 1500.0/371, -1000.0/159, 1000.0/371},
+            {0, -125.0/32, 125.0/12, -375.0/64},
+            {0, 9477.0/3392, -729.0/106, 25515.0/6784},
+            {0, -11.0/7, 11.0/3, -55.0/28},
+            {0, 3.0/2, -4, 5.0/2}
+        }};
+
+        const Properties& m_properties;
+        double m_dragArea;
+        std::array<state_t, 7> m_k;
+
+    public:
+        PathIntegrator(const Properties& properties, double dragArea) : m_properties(properties), m_dragArea(dragArea){}
+
+        //integrates until the vertical velocity reaches the max velocity, outputs every OUTPUT_PERIOD_s & at the event
+        unsigned integrate(double horizontalVelocity, std::vector<state_t>& output){
+            output.clear();
+            const double threshold = m_properties.absoluteTolerance / m_properties.relativeTolerance;
+            const double maxStep = 0.1 * MAXIMUM_PATH_TIME_s;
+            const double minStep = 16 * std::nextafter(0.0, 1.0);
+            const double pow = 1.0/5;
+            double t = 0;
+            state_t y = {0, m_properties.targetApogee, horizontalVelocity, 0};
+            output.push_back(y);
+            double nextOutput = OUTPUT_PERIOD_s;
+            m_k[0] = derivative(y);
+            //initial step (ode45)
+            double rh = 0;
+            for(unsigned i=0; i<4; i++) rh = std::max(rh, std::abs(m_k[0][i]) / std::max(std::abs(y[i]), threshold));
+            rh /= 0.8 * std::pow(m_properties.relativeTolerance, pow);
+            double h = std::min(maxStep, MAXIMUM_PATH_TIME_s);
+            if(h * rh > 1) h = 1 / rh;
+            h = std::max(h, minStep);
+            unsigned steps = 0;
+            double lastEvent = eventValue(y);
+            bool noFailures = true;
+            while(t < MAXIMUM_PATH_TIME_s){
+                h = std::min(h, MAXIMUM_PATH_TIME_s - t);
+                //attempt step
+                state_t yNew;
+                double error;
+                for(;;){
+                    for(unsigned stage=0; stage<6; stage++){
+                        state_t yStage = y;
+                        for(unsigned j=0; j<=stage; j++)
+                            for(unsigned i=0; i<4; i++) yStage[i] += h * c_a[stage][j] * m_k[j][i];
+                        m_k[stage+1] = derivative(yStage);
+                        if(stage == 5) yNew = yStage;
+                    }
+                    error = 0;
+                    for(unsigned i=0; i<4; i++){
+                        double e = 0;
+                        for(unsigned j=0; j<7; j++) e += c_e[j] * m_k[j][i];
+                        error = std::max(error, std::abs(e) / std::max(std::max(std::abs(y[i]), std::abs(yNew[i])), threshold));
+                    }
+                    error *= h;
+                    steps++;
+                    if(error <= m_properties.relativeTolerance) break;
+                    //failed step
+                    if(h <= minStep) return steps;
+                    if(noFailures){
+                        noFailures = false;
+                        h = std::max(minStep, h * std::max(0.1, 0.8 * std::pow(m_properties.relativeTolerance/error, pow)));
+                    }
+                    else h = std::max(minStep, 0.5 * h);
+                }
+                const double tNew = t + h;
+                //event location
+                const double event = eventValue(yNew);
+                bool terminate = false;
+                double tEvent = tNew;
+                if((lastEvent < 0 && event >= 0) || (lastEvent > 0 && event <= 0)){
+                    terminate = true;
+                    tEvent = locateEvent(t, y, h, lastEvent);
+                }
+                //outputs inside this step
+                const double tLimit = terminate ? tEvent : tNew;
+                while(nextOutput <= tLimit && nextOutput <= MAXIMUM_PATH_TIME_s){
+                    output.push_back(nextOutput == tNew ? yNew : interpolate(t, y, h, nextOutput));
+                    nextOutput += OUTPUT_PERIOD_s;
+                }
+                if(terminate){
+                    output.push_back(interpolate(t, y, h, tEvent));
+                    return steps;
+                }
+                //advance
+                t = tNew;
+                y = yNew;
+                m_k[0] = m_k[6];
+                lastEvent = event;
+                double growth = 1.25 * std::pow(error/m_properties.relativeTolerance, pow);
+                if(noFailures) h = growth > 0.2 ? h / growth : 5 * h;
+                noFailures = true;
+            }
+            return steps;
+        }
+
+    private:
+        state_t derivative(const state_t& y) const{
+            return reverseDynamics(y, m_dragArea, m_properties);
+        }
+
+        double eventValue(const state_t& y) const{
+            return y[3] - m_properties.maxVelocity;
+        }
+
+        state_t interpolate(double t, const state_t& y, double h, double tInterp) const{
+            const double s = (tInterp - t) / h;
+            const std::array<double, 4> powers = {s, s*s, s*s*s, s*s*s*s};
+            state_t result = y;
+            for(unsigned j=0; j<7; j++){
+                double weight = 0;
+                for(unsigned p=0; p<4; p++) weight += c_bi[j][p] * powers[p];
+                for(unsigned i=0; i<4; i++) result[i] += h * weight * m_k[j][i];
+            }
+            return result;
+        }
+
+        //regula falsi (Illinois) on the continuous extension
+        double locateEvent(double t, const state_t& y, double h, double startValue) const{
+            double left = t, right = t + h;
+            double leftValue = startValue, rightValue = eventValue(interpolate(t, y, h, right));
+            int side = 0;
+            for(unsigned i=0; i<64 && (right - left) > 4 * std::numeric_limits<double>::epsilon() * std::abs(right); i++){
+                const double mid = right - rightValue * (right - left) / (rightValue - leftValue);
+                const double midValue = eventValue(interpolate(t, y, h, mid));
+                if(midValue == 0) return mid;
+                if((midValue < 0) == (rightValue < 0)){
+                    right = mid;
+                    rightValue = midValue;
+                    if(side == -1) leftValue /= 2;
+                    side = -1;
+                }
+                else{
+                    left = mid;
+                    leftValue = midValue;
+                    if(side == 1) rightValue /= 2;
+                    side = 1;
+                }
+            }
+            return right;
+        }
+    };
+
+    double linInterp(double x1, double y1, double x2, double y2, double x){
+        if(x2 - x1 == 0) return y1;
+        return (y2-y1)/(x2-x1)*(x-x1)+y1;
+    }
+
+    double linspace(double start, double end, unsigned count, unsigned index){
+        if(count < 2) return end;
+        return start + (end - start) * index / (count - 1);
+    }
+
+    //integrates one path & resamples it over the velocity samples (resampleVelocities in FlightPathGeneration.m)
+    ResampledPath generatePath(PathIntegrator& integrator, std::vector<state_t>& buffer, double horizontalVelocity, const Properties& properties){
+        ResampledPath path;
+        path.steps = integrator.integrate(horizontalVelocity, buffer);
+        std::reverse(buffer.begin(), buffer.end());
+        std::vector<double> angles(buffer.size());
+        path.maximumAngle = 0;
+        for(std::size_t i=0; i<buffer.size(); i++){
+            const double angle = std::atan(buffer[i][3] / buffer[i][2]);
+            angles[i] = std::isnan(angle) ? M_PI/2 : angle;
+            if(!std::isnan(angle)) path.maximumAngle = std::max(path.maximumAngle, angle);
+        }
+        path.angles.resize(properties.velocitySamples);
+        path.altitudes.resize(properties.velocitySamples);
+        for(unsigned j=0; j<properties.velocitySamples; j++){
+            const double velocity = linspace(properties.maxVelocity, 0, properties.velocitySamples, j);
+            std::size_t index = 0;
+            while(index < buffer.size() && velocity < buffer[index][3]) index++;
+            if(index == 0){
+                path.angles[j] = angles.front();
+                path.altitudes[j] = buffer.front()[1];
+            }
+            else if(index == buffer.size()){
+                path.angles[j] = angles.back();
+                path.altitudes[j] = buffer.back()[1];
+            }
+            else{
+                path.angles[j] = linInterp(buffer[index-1][3], angles[index-1], buffer[index][3], angles[index], velocity);
+                path.altitudes[j] = linInterp(buffer[index-1][3], buffer[index-1][1], buffer[index][3], buffer[index][1], velocity);
+            }
+        }
+        return path;
+    }
+
+    /*Incremental angle resampler (resampleAngles in FlightPathGeneration.m)
+     * paths arrive in order of increasing horizontal velocity, so each angle sample is resolved by the first path at or below it
+    */
+    class AngleResampler{
+    private:
+        const Properties& m_properties;
+        std::vector<double> m_altitudes;
+        std::vector<unsigned> m_nextAngle;
+        ResampledPath m_previous;
+        bool m_hasPrevious;
+
+    public:
+        AngleResampler(const Properties& properties) : m_properties(properties), m_altitudes(properties.angleSamples * properties.velocitySamples, properties.targetApogee), m_nextAngle(properties.velocitySamples, 0), m_hasPrevious(false){}
+
+        void addPath(const ResampledPath& path){
+            for(unsigned j=0; j<m_properties.velocitySamples; j++){
+                unsigned& i = m_nextAngle[j];
+                while(i < m_properties.angleSamples){
+                    const double angle = linspace(M_PI/2, 0, m_properties.angleSamples, i);
+                    if(angle < path.angles[j]) break;
+                    double& altitude = m_altitudes[i * m_properties.velocitySamples + j];
+                    if(!m_hasPrevious) altitude = path.altitudes[j];
+                    else altitude = linInterp(m_previous.angles[j], m_previous.altitudes[j], path.angles[j], path.altitudes[j], angle);
+                    i++;
+                }
+            }
+            m_previous = path;
+            m_hasPrevious = true;
+        }
+
+        //limit of infinite horizontal velocity (addSingularPath in FlightPathGeneration.m)
+        void addSingularPath(){
+            ResampledPath path;
+            path.angles.assign(m_properties.velocitySamples, 0);
+            path.altitudes.assign(m_properties.velocitySamples, m_properties.targetApogee);
+            addPath(path);
+        }
+
+        const std::vector<double>& getAltitudes() const{
+            return m_altitudes;
+        }
+    };
+
+    //generates all paths for one drag area, batches of paths are integrated in parallel & merged in order
+    Surface generateSurface(double dragArea, const Properties& properties, unsigned threads){
+        Surface surface;
+        AngleResampler resampler(properties);
+        const double finishAngle = properties.minimumAngle * M_PI / 180;
+        const unsigned batchSize = PATH_BATCH_SIZE * threads;
+        std::vector<ResampledPath> batch(batchSize);
+        unsigned long firstPath = 0;
+        bool finished = false;
+        while(!finished){
+            std::atomic<unsigned> nextPath(0);
+            auto worker = [&](){
+                PathIntegrator integrator(properties, dragArea);
+                std::vector<state_t> buffer;
+                for(unsigned i = nextPath++; i < batchSize; i = nextPath++)
+                    batch[i] = generatePath(integrator, buffer, (firstPath + i) * properties.horizontalVelocityIncrement, properties);
+            };
+            std::vector<std::thread> pool;
+            for(unsigned i=1; i<threads; i++) pool.emplace_back(worker);
+            worker();
+            for(std::thread& thread : pool) thread.join();
+            //merge in order, the last path is the first one that starts at or below the finish angle
+            for(const ResampledPath& path : batch){
+                resampler.addPath(path);
+                surface.paths++;
+                surface.steps += path.steps;
+                if(path.maximumAngle <= finishAngle){
+                    finished = true;
+                    break;
+                }
+            }
+            firstPath += batchSize;
+        }
+        resampler.addSingularPath();
+        surface.altitudes = resampler.getAltitudes();
+        return surface;
+    }
+
+    void printUsage(){
+        std::printf(
+            "usage: FlightPathGeneration [--option value]...\n"
+            "  --apogee <m>               target apogee (800)\n"
+            "  --min-drag <m^2>           minimum drag area (0.0025)\n"
+            "  --max-drag <m^2>           maximum drag area (0.01)\n"
+            "  --angle-limit <deg>        actuator deployment angle limit (90)\n"
+            "  --mass <kg>                dry mass (3)\n"
+            "  --temperature <K>          launch site temperature (288.15)\n"
+            "  --pressure <Pa>            launch site pressure (101325)\n"
+            "  --max-velocity <m/s>       maximum vertical velocity of the mesh (150)\n"
+            "  --velocity-samples <n>     velocity samples (64)\n"
+            "  --angle-samples <n>        angle samples (64)\n"
+            "  --min-angle <deg>          angle where path generation stops (0.1)\n"
+            "  --increment <m/s>          horizontal velocity increment between paths (1)\n"
+            "  --reltol <x>               integrator relative tolerance (1e-3)\n"
+            "  --abstol <x>               integrator absolute tolerance (1e-6)\n"
+            "  --threads <n>              worker threads, 0 uses all cores (0)\n"
+            "  --output <file>            output file (flightPath.csv)\n"
+            "  --compare <file>           compare the generated mesh against an existing flight plan\n");
+    }
+
+    bool parseArguments(int argc, char** argv, Properties& properties){
+        for(int i=1; i<argc; i++){
+            const std::string option = argv[i];
+            if(option == "--help" || option == "-h") return false;
+            if(i + 1 >= argc){
+                std::fprintf(stderr, "missing value for '%s'\n", option.c_str());
+                return false;
+            }
+            const char* value = argv[++i];
+            if(option == "--apogee") properties.targetApogee = std::atof(value);
+            else if(option == "--min-drag") properties.minimumDragArea = std::atof(value);
+            else if(option == "--max-drag") properties.maximumDragArea = std::atof(value);
+            else if(option == "--angle-limit") properties.deploymentAngleLimit = std::atof(value);
+            else if(option == "--mass") properties.dryMass = std::atof(value);
+            else if(option == "--temperature") properties.launchSiteTemperature = std::atof(value);
+            else if(option == "--pressure") properties.launchSitePressure = std::atof(value);
+            else if(option == "--max-velocity") properties.maxVelocity = std::atof(value);
+            else if(option == "--velocity-samples") properties.velocitySamples = std::atoi(value);
+            else if(option == "--angle-samples") properties.angleSamples = std::atoi(value);
+            else if(option == "--min-angle") properties.minimumAngle = std::atof(value);
+            else if(option == "--increment") properties.horizontalVelocityIncrement = std::atof(value);
+            else if(option == "--reltol") properties.relativeTolerance = std::atof(value);
+            else if(option == "--abstol") properties.absoluteTolerance = std::atof(value);
+            else if(option == "--threads") properties.threads = std::atoi(value);
+            else if(option == "--output") properties.outputFile = value;
+            else if(option == "--compare") properties.compareFile = value;
+            else{
+                std::fprintf(stderr, "unknown option '%s'\n", option.c_str());
+                return false;
+            }
+        }
+        if(properties.velocitySamples < 2 || properties.angleSamples < 2 || properties.horizontalVelocityIncrement <= 0 || properties.minimumAngle <= 0){
+            std::fprintf(stderr, "invalid mesh properties\n");
+            return false;
+        }
+        return true;
+    }
+
+    bool saveFlightPath(const Properties& properties, const std::vector<double>& altitudes){
+        std::FILE* file = std::fopen(properties.outputFile.c_str(), "w");
+        if(!file) return false;
+        std::fprintf(file, "%.15g,%.15g,%.15g,%.15g,%.15g,%.15g,%.15g,%.15g,%u,%u\n", properties.targetApogee, properties.minimumDragArea, properties.maximumDragArea, properties.deploymentAngleLimit, properties.dryMass, properties.launchSiteTemperature, properties.launchSitePressure, properties.maxVelocity, properties.velocitySamples, properties.angleSamples);
+        for(unsigned i=0; i<properties.angleSamples; i++){
+            for(unsigned j=0; j<properties.velocitySamples; j++)
+                std::fprintf(file, j+1 < properties.velocitySamples ? "%.15g," : "%.15g\n", altitudes[i * properties.velocitySamples + j]);
+        }
+        return std::fclose(file) == 0;
+    }
+
+    //compares the mesh against an existing flight plan with the same dimensions
+    bool compareFlightPath(const Properties& properties, const std::vector<double>& altitudes){
+        std::ifstream file(properties.compareFile);
+        if(!file){
+            std::fprintf(stderr, "failed to open '%s'\n", properties.compareFile.c_str());
+            return false;
+        }
+        std::string line;
+        std::getline(file, line); //header
+        std::vector<double> reference;
+        while(std::getline(file, line)){
+            std::stringstream row(line);
+            std::string cell;
+            while(std::getline(row, cell, ',')) reference.push_back(std::atof(cell.c_str()));
+        }
+        if(reference.size() != altitudes.size()){
+            std::fprintf(stderr, "'%s' has %zu mesh points, expected %zu\n", properties.compareFile.c_str(), reference.size(), altitudes.size());
+            return false;
+        }
+        double maxError = 0, sumSquares = 0;
+        std::size_t worst = 0;
+        for(std::size_t i=0; i<altitudes.size(); i++){
+            const double error = std::abs(altitudes[i] - reference[i]);
+            sumSquares += error * error;
+            if(error > maxError){
+                maxError = error;
+                worst = i;
+            }
+        }
+        std::printf("compare: max |error| %.4f m (angle row %zu, velocity column %zu), rms %.4f m\n", maxError, worst / properties.velocitySamples, worst % properties.velocitySamples, std::sqrt(sumSquares / altitudes.size()));
+        return true;
+    }
+}
+
+int main(int argc, char** argv){
+    using namespace FlightPathGeneration;
+    Properties properties;
+    if(!parseArguments(argc, argv, properties)){
+        printUsage();
+        return 1;
+    }
+    const unsigned threads = properties.threads ? properties.threads : std::max(1u, std::thread::hardware_concurrency());
+    const auto start = std::chrono::steady_clock::now();
+    const Surface lower = generateSurface(properties.minimumDragArea, properties, threads);
+    const Surface upper = generateSurface(properties.maximumDragArea, properties, threads);
+    std::vector<double> center(lower.altitudes.size());
+    for(std::size_t i=0; i<center.size(); i++) center[i] = (lower.altitudes[i] + upper.altitudes[i]) / 2;
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    const unsigned long paths = lower.paths + upper.paths;
+    const unsigned long steps = lower.steps + upper.steps;
+    std::printf("generated %ux%u mesh from %lu paths on %u threads in %.3f s\n", properties.angleSamples, properties.velocitySamples, paths, threads, seconds);
+    std::printf("throughput: %.0f paths/s, %.3g integrator steps/s, %.0f mesh points/s\n", paths / seconds, steps / seconds, center.size() / seconds);
+    if(!saveFlightPath(properties, center)){
+        std::fprintf(stderr, "failed to write '%s'\n", properties.outputFile.c_str());
+        return 1;
+    }
+    std::printf("saved to '%s'\n", properties.outputFile.c_str());
+    if(!properties.compareFile.empty() && !compareFlightPath(properties, center)) return 1;
+    return 0;
+}
@@ -16,6 +16,7 @@
 #define RocketOS_CFG_HasSimulation
 #define RocketOS_CFG_HasProcessing
 #define RocketOS_CFG_HasUtilities
+#define RocketOS_CFG_HasScheduler
 
 /*Architecure Type
  * 
@@ -25,9 +26,15 @@
 /*Serial Parameters
  * These macros parameterize the serial IO of the shell. Look in the Shell README for more info about how these work.
  * RocketOS_CFG_SerialRxBufferSize - Determines the size of the shell's input buffer and thus the maximum size of interpretable commands.
+ * RocketOS_CFG_SerialRxLineQueueDepth - Number of complete lines that can be queued before they are read (each takes RocketOS_CFG_SerialRxBufferSize bytes).
+ * RocketOS_CFG_SerialTxConsoleBufferSize - Bytes of shell and log text buffered while waiting for the USB port (power of two).
+ * RocketOS_CFG_SerialTxHILBufferSize - Bytes of HIL frames buffered while waiting for the USB port (power of two).
  * 
 */
 #define RocketOS_CFG_SerialRxBufferSize 256
+#define RocketOS_CFG_SerialRxLineQueueDepth 4
+#define RocketOS_CFG_SerialTxConsoleBufferSize 4096
+#define RocketOS_CFG_SerialTxHILBufferSize 1024
 
 /*Teensy Timer Tool compatability
  * this define uses teensy timer tool's inplace function implementation to avoid conflicts. This only needs to be enabled if you are using teensy timer tool.
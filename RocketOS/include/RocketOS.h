@@ -20,4 +20,7 @@
 #endif
 #ifdef RocketOS_CFG_HasUtilities
 #include "utilities\RocketOS_Utilities.h"
+#endif
+#ifdef RocketOS_CFG_HasScheduler
+#include "scheduler\RocketOS_Scheduler.h"
 #endif
\ No newline at end of file
@@ -55,6 +55,27 @@ static_assert(false, "Only 8, 16, 32 & 64 bit architectures are supported");
     static_assert(RocketOS_CFG_SerialRxBufferSize > 0, "RocketOS_CFG_SerialRxBufferSize must be positive");
 #endif
 
+//RocketOS_CFG_SerialRxLineQueueDepth check
+#ifndef RocketOS_CFG_SerialRxLineQueueDepth
+    static_assert(false, "RocketOS_CFG_SerialRxLineQueueDepth must be defined in the file RocketOS.cfg.h");
+#else
+    static_assert(RocketOS_CFG_SerialRxLineQueueDepth > 0, "RocketOS_CFG_SerialRxLineQueueDepth must be positive");
+#endif
+
+//RocketOS_CFG_SerialTxConsoleBufferSize check
+#ifndef RocketOS_CFG_SerialTxConsoleBufferSize
+    static_assert(false, "RocketOS_CFG_SerialTxConsoleBufferSize must be defined in the file RocketOS.cfg.h");
+#else
+    static_assert(RocketOS_CFG_SerialTxConsoleBufferSize > 0 && (RocketOS_CFG_SerialTxConsoleBufferSize & (RocketOS_CFG_SerialTxConsoleBufferSize - 1)) == 0, "RocketOS_CFG_SerialTxConsoleBufferSize must be a power of two");
+#endif
+
+//RocketOS_CFG_SerialTxHILBufferSize check
+#ifndef RocketOS_CFG_SerialTxHILBufferSize
+    static_assert(false, "RocketOS_CFG_SerialTxHILBufferSize must be defined in the file RocketOS.cfg.h");
+#else
+    static_assert(RocketOS_CFG_SerialTxHILBufferSize > 0 && (RocketOS_CFG_SerialTxHILBufferSize & (RocketOS_CFG_SerialTxHILBufferSize - 1)) == 0, "RocketOS_CFG_SerialTxHILBufferSize must be a power of two");
+#endif
+
 /*error handling
  *
  *
@@ -1,18 +1,32 @@
 #pragma once
 #include "RocketOSGeneral.h"
+#include <array>
+#include <Arduino.h> //for Print and Serial
 
 /*SerialInput class
  * This class is used to handle serial inputs for the shell. 
  * It buffers inputs from Serial so they can be interpreted in their entirety by the command interpreter 
  *
- * 
+ * update() never waits for the rest of a line. It takes only the bytes Serial has already received and adds them to the
+ * line being assembled, so a command or HIL line can arrive over any number of calls. A line ends at '\r' or '\n' (empty lines
+ * are skipped, so "\r\n" is one terminator) and completed lines are queued in order, up to RocketOS_CFG_SerialRxLineQueueDepth.
+ * Once the queue is full update() stops reading and leaves the remaining bytes in Serial's receive buffer.
+ * Lines longer than the buffer are dropped up to their terminator and counted as overflows.
+ *
+ * The indexing functions and copy() read the oldest completed line, which is null terminated. clear() releases it.
 */
 
 namespace RocketOS{
     class SerialInput{
         static constexpr int_t c_size = RocketOS_CFG_SerialRxBufferSize;
-        char m_rxBuffer[c_size];
-        bool m_hasData;
+        static constexpr uint_t c_depth = RocketOS_CFG_SerialRxLineQueueDepth;
+        //completed lines start at m_front, the line being assembled is in the slot after the last completed one
+        std::array<std::array<char, c_size>, c_depth> m_lines;
+        uint_t m_front;
+        uint_t m_count;
+        int_t m_length;
+        bool m_discarding;
+        uint_t m_overflows;
         uint_t m_baud;
     public:
         SerialInput(uint_t);
@@ -28,5 +42,94 @@ namespace RocketOS{
 		error_t update();
 		bool hasData() const;
 		void clear();
+
+		uint_t linesQueued() const;
+		uint_t getOverflows() const;
+    private:
+		void finishLine();
+    };
+
+    /*OutputLane class
+     * Print target that buffers text in a byte ring instead of writing to Serial, so printing never waits on the USB port.
+     * Use it like Serial (print, println, printf). A SerialOutput moves the buffered bytes to Serial from the main loop.
+     *
+     * Only complete lines are handed to the SerialOutput, so lines from different lanes are never mixed on the wire.
+     * writeFrame() adds a whole line or nothing, for HIL frames that must not be cut short.
+     * When the ring is full the line being written is dropped and counted. A line longer than the ring is sent in the part that fit.
+     * Lanes are not interrupt safe, write to them from the main loop only.
+     * The size must be a power of two.
+    */
+    class OutputLane : public Print{
+        const char* const m_name;
+        char* const m_buffer;
+        const uint32_t m_size;
+        //free running indices: sent up to m_head, complete lines up to m_committed, written up to m_tail
+        uint32_t m_head;
+        uint32_t m_committed;
+        uint32_t m_tail;
+        bool m_lineOpen;
+        bool m_discarding;
+        //statistics
+        uint32_t m_written;
+        uint32_t m_dropped;
+        uint32_t m_peak;
+    public:
+        OutputLane(const char*, char*, uint_t);
+
+        using Print::write;
+        size_t write(uint8_t) override;
+        size_t write(const uint8_t*, size_t) override;
+        int availableForWrite() override;
+        error_t writeFrame(const char*, uint_t);
+
+        //interface for SerialOutput
+        uint_t ready() const;
+        uint_t send(uint_t);
+        bool lineOpen() const;
+
+        const char* getName() const;
+        uint_t getSize() const;
+        uint_t getBuffered() const;
+        uint32_t getWritten() const;
+        uint32_t getDropped() const;
+        uint32_t getPeak() const;
+        void resetStatistics();
+    };
+
+    //shell and log text
+    extern OutputLane Console;
+    //HIL frames
+    extern OutputLane HILOutput;
+
+    /*SerialOutput class
+     * Moves buffered lines from a set of output lanes to Serial without blocking. Call update() every main loop pass.
+     * Lanes are listed in priority order. Each update sends as much as Serial can take right now (availableForWrite),
+     * always from the highest priority lane with a complete line, except that a line that has started going out is finished
+     * before another lane gets the port.
+    */
+    template<std::size_t t_numLanes>
+    class SerialOutput{
+    private:
+        const std::array<OutputLane*, t_numLanes> m_lanes;
+        OutputLane* m_sending;
+    public:
+        SerialOutput(const std::array<OutputLane*, t_numLanes>& lanes) : m_lanes(lanes), m_sending(nullptr) {}
+
+        void update(){
+            for(int_t space = Serial.availableForWrite(); space > 0; space = Serial.availableForWrite()){
+                //a lane only stops mid line if it overflowed with one line, let the others through then
+                if(m_sending != nullptr && m_sending->ready() == 0) m_sending = nullptr;
+                OutputLane* lane = m_sending;
+                for(uint_t i=0; lane == nullptr && i<t_numLanes; i++)
+                    if(m_lanes[i]->ready() > 0) lane = m_lanes[i];
+                if(lane == nullptr) return;
+                lane->send(space);
+                m_sending = lane->lineOpen() ? lane : nullptr;
+            }
+        }
+
+        const std::array<OutputLane*, t_numLanes>& getLanes() const{
+            return m_lanes;
+        }
     };
-}
\ No newline at end of file
+}
@@ -12,6 +12,11 @@
 #define Airbrakes_CFG_TelemetryRefreshPeriod_ms 100
 
 
+/*Persistent Configuration
+*/
+#define Airbrakes_CFG_PersistentCallbackCaptureSize 4 //the restore callback captures the application
+
+
 /*File Configuration
 */
 #define Airbrakes_CFG_CommandLocalStringBufferSize 64
@@ -28,12 +33,34 @@
 */
 #define Airbrakes_CFG_FlightPlanMemorySize 0x4000 // 2^14 entries or 64Kb
 #define Airbrakes_CFG_DefaultFlightPlanFileName "flightPath.csv"
+#define Airbrakes_CFG_DeploymentTableSize 128
 
 
 /*Controller Configuration
 */
 #define Airbrakes_CFG_ControllerPeriod_us 100000
 #define Airbrakes_CFG_DecayRate -2.5
+#define Airbrakes_CFG_ApogeePredictorSteps 32
+#define Airbrakes_CFG_ControllerBudget_us 2000
+#define Airbrakes_CFG_ControllerFastMath 1    //1: RocketOS::Processing::FastMath kernels, 0: libm
+#define Airbrakes_CFG_ControllerTopicDepth 4
+#define Airbrakes_CFG_SafePointQueueSize 8    //power of two
+
+
+/*Scheduler Configuration
+*/
+#define Airbrakes_CFG_SchedulerMaxTasks 8
+#define Airbrakes_CFG_DeferredWorkQueueSize 16  //power of two
+
+
+/*SPI Configuration
+*/
+#ifdef RocketOS_HostBuild
+#define Airbrakes_CFG_SPIBackend RocketOS::Utilities::MockSPIBackend<>   //host tests (test/) run the sensor drivers on the mock
+#else
+#define Airbrakes_CFG_SPIBackend RocketOS::Utilities::TeensySPIBackend
+#endif
+#define Airbrakes_CFG_SPIQueueSize 8   //power of two
 
 
 /*Simulation Configuration
@@ -46,13 +73,21 @@
 #define Airbrakes_CFG_AltimeterSPIFrequency 4000000
 #define Airbrakes_CFG_AltimeterNominalGroundPressure 101325
 #define Airbrakes_CFG_AltimeterNominalGroundTemperature 288.15
+#define Airbrakes_CFG_AltimeterPressureOSR 4096      //256, 512, 1024, 2048 or 4096
+#define Airbrakes_CFG_AltimeterTemperatureOSR 1024   //256, 512, 1024, 2048 or 4096
+#define Airbrakes_CFG_AltimeterTemperatureRatio 8    //pressure conversions per temperature conversion
+#define Airbrakes_CFG_AltimeterHistorySize 32        //samples kept per stream, one less can be read
+#define Airbrakes_CFG_AltimeterCalibrationSamples 64 //readings a ground calibration averages at most
 
 
 /*IMU Configuration
 */
 #define Airbrakes_CFG_IMU_SPIFrequency 1000000
 #define Airbrakes_CFG_IMU_SamplePeriod_us 10000
-#define Airbrakes_CFG_IMUBufferSize 64
+#define Airbrakes_CFG_IMU_BatchInterval_us 20000     //longest the hub holds reports, 0 interrupts for every report
+#define Airbrakes_CFG_IMUBufferSize 256              //largest packet received whole, holds a full batch
+#define Airbrakes_CFG_IMUHistorySize 64              //reports kept per sensor, one less can be read
+#define Airbrakes_CFG_IMU_StalePeriods 4             //sample periods past the batch interval before a running stream counts as stale
 #define Airbrekes_CFG_IMUTxQueueSize 16
 #define Airbrakes_CFG_IMUTxCallbackCaptureSize 12
 
@@ -71,6 +106,10 @@
 #define Airbrakes_CFG_ObserverAltimeterSamplePeriod_us 25000
 #define Airbrakes_CFG_ObserverIMUSamplePeriod_us 10000
 #define Airbrakes_CFG_ObserverFilterDelay_us 400000
+#define Airbrakes_CFG_ObserverFastMath 1      //1: RocketOS::Processing::FastMath kernels, 0: libm
+#define Airbrakes_CFG_ObserverWorldFrame 1    //1: vertical acceleration rotated into the world frame by the IMU orientation, 0: body z axis
+#define Airbrakes_CFG_ObserverMaxIMUAge_us 100000 //IMU samples older than this at a tick are left out of the filters
+#define Airbrakes_CFG_ObserverTopicDepth 4
 
 
 /*Detection Configuration
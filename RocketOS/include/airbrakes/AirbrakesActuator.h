@@ -81,6 +81,7 @@ namespace Airbrakes{
             using Command = RocketOS::Shell::Command;
             using CommandList = RocketOS::Shell::CommandList;
             using arg_t = RocketOS::Shell::arg_t;
+            using CommandModes = RocketOS::Shell::CommandModes;
 
             // === ROOT COMMAND LIST ===
                 //children command lists
@@ -88,23 +89,23 @@ namespace Airbrakes{
                     //commands
                     const std::array<Command, 5> c_modeCommands{
                         Command{"", "", [this](arg_t){
-                            if(m_mode == SteppingModes::MicroStep) Serial.println("micro");
-                            if(m_mode == SteppingModes::QuarterStep) Serial.println("quarter");
-                            if(m_mode == SteppingModes::HalfStep) Serial.println("half");
-                            if(m_mode == SteppingModes::FullStep) Serial.println("full");
+                            if(m_mode == SteppingModes::MicroStep) RocketOS::Console.println("micro");
+                            if(m_mode == SteppingModes::QuarterStep) RocketOS::Console.println("quarter");
+                            if(m_mode == SteppingModes::HalfStep) RocketOS::Console.println("half");
+                            if(m_mode == SteppingModes::FullStep) RocketOS::Console.println("full");
                         }},
                         Command{"full", "", [this](arg_t){
                             setSteppingMode(SteppingModes::FullStep);
-                        }},
+                        }, CommandModes::Atomic},
                         Command{"half", "", [this](arg_t){
                             setSteppingMode(SteppingModes::HalfStep);
-                        }},
+                        }, CommandModes::Atomic},
                         Command{"quarter", "", [this](arg_t){
                             setSteppingMode(SteppingModes::QuarterStep);
-                        }},
+                        }, CommandModes::Atomic},
                         Command{"micro", "", [this](arg_t){
                             setSteppingMode(SteppingModes::MicroStep);
-                        }}
+                        }, CommandModes::Atomic}
                     };
                 // =========================
 
@@ -112,11 +113,11 @@ namespace Airbrakes{
                     //commands
                     const std::array<Command, 2> c_targetCommands{
                         Command{"", "", [this](arg_t){
-                            Serial.println(getTarget());
+                            RocketOS::Console.println(getTarget());
                         }},
                         Command{"set", "f", [this](arg_t args){
-                            if(setTargetDeployment(args[0].getFloatData()) != error_t::GOOD) Serial.println("Invalid target position");
-                        }}
+                            if(setTargetDeployment(args[0].getFloatData()) != error_t::GOOD) RocketOS::Console.println("Invalid target position");
+                        }, CommandModes::Atomic}
                     };
                 // ===========================
 
@@ -124,11 +125,11 @@ namespace Airbrakes{
                     //commands
                     const std::array<Command, 2> c_limitCommands{
                         Command{"", "", [this](arg_t){
-                            Serial.println(m_ActuatorLimit);
+                            RocketOS::Console.println(m_ActuatorLimit);
                         }},
                         Command{"set", "f", [this](arg_t args){
-                            if( setActuatorLimit(args[0].getFloatData()) != error_t::GOOD) Serial.println("Invalid actuator limit");
-                        }}
+                            if( setActuatorLimit(args[0].getFloatData()) != error_t::GOOD) RocketOS::Console.println("Invalid actuator limit");
+                        }, CommandModes::Atomic}
                     };
                 // ==========================
                 //command list
@@ -141,23 +142,23 @@ namespace Airbrakes{
                 //commands
                 const std::array<Command, 6> c_rootCommands{
                     Command{"position", "", [this](arg_t){
-                        Serial.println(getCurrentDeployment());
+                        RocketOS::Console.println(getCurrentDeployment());
                     }},
                     Command{"start", "", [this](arg_t){
                         wake();
-                    }},
+                    }, CommandModes::Atomic},
                     Command{"stop", "", [this](arg_t){
                         sleep();
-                    }},
+                    }, CommandModes::Atomic},
                     Command{"zero", "", [this](arg_t){
                        beginZero();
-                    }},
+                    }, CommandModes::Atomic},
                     Command{"tare", "", [this](arg_t){
                         beginTare();
-                    }},
+                    }, CommandModes::Atomic},
                     Command{"speed", "f", [this](arg_t args){
                         setSteppingSpeed(args[0].getFloatData());
-                    }}
+                    }, CommandModes::Atomic}
                 };
             // =========================
         };
@@ -10,6 +10,10 @@
 #include "AirbrakesSensors_IMU.h"
 #include "AirbrakesActuator.h"
 #include "AirbrakesDetectionParameters.h"
+#include "AirbrakesScheduler.h"
+#include "AirbrakesDeferredWork.h"
+#include "AirbrakesSPIBus.h"
+#include "AirbrakesSerialOutput.h"
 #include <Arduino.h> //serial printing, elapsedmillis
 
 // ===simulation control macros ===
@@ -31,6 +35,25 @@ namespace Airbrakes{
         enum class ProgramStates{
             Standby, Armed, ReArmed, Boost, Coast, Recovery
         };
+
+        /*State consumer
+         * One consumer's own subscriptions to the observer and controller topics and the copies it reads.
+         * Telemetry and TxHIL bind to the copies, so each consumer refreshes them right before it uses them, at its own rate.
+        */
+        struct StateConsumer{
+            ObserverSubscriber_t observerSubscriber;
+            Controls::ControllerSubscriber_t controllerSubscriber;
+            ObserverState observer;
+            Controls::ControllerOutput controller;
+
+            StateConsumer(const ObserverTopic_t& observerTopic, const Controls::ControllerTopic_t& controllerTopic) : observerSubscriber(observerTopic), controllerSubscriber(controllerTopic), observer{}, controller{} {}
+
+            //copies the newest messages, the previous copy of a topic is kept if it has none
+            void update(){
+                observerSubscriber.copyLatest(observer);
+                controllerSubscriber.copyLatest(controller);
+            }
+        };
     private:
         // --- program logic systems ---
         ProgramStates m_state;
@@ -40,15 +63,27 @@ namespace Airbrakes{
         uint_t m_stateTransitionSamplePeriod_ms;
         bool m_armFlag;
         EventDetection m_launchDetectionParameters, m_burnoutDetectionParameters, m_apogeeDetectionParameters;
+        // --- shared models ---
+        RocketOS::Processing::StandardAtmosphere<> m_atmosphere;
+        DeferredWorkWithCommands<Airbrakes_CFG_DeferredWorkQueueSize> m_deferredWork;
         // --- peripheral hardware systems ---
+        SPIBackend_t m_spi0Backend, m_spi1Backend;
+        SPIBusWithCommands m_spi0, m_spi1;
         Sensors::MS5607_SPI m_altimeter;
+        //last ground calibration state that was logged
+        Sensors::MS5607_SPI::CalibrationStates m_altimeterCalibrationState;
         Sensors::BNO085_SPI m_imu;
         Motor::Actuator m_actuator;
         bool m_actuateInFlight;
         // --- control system ---
+        //the observer comes first, the controller subscribes to its topic when it is constructed
+        Observer m_observer;
         Controls::Controller m_controller;
         Controls::FlightPlan m_flightPlan;
-        Observer m_observer;
+        //event detection only needs the observer state
+        ObserverSubscriber_t m_detectionSubscriber;
+        ObserverState m_observerState;
+        StateConsumer m_telemetryState, m_HILState, m_shellState;
         const ObserverModes m_simulationType;
         // --- sd card systems ---
         SdFat m_sdCard;
@@ -75,6 +110,12 @@ namespace Airbrakes{
             float_t,        //measured orientation j
             float_t,        //measured orientation k
             float_t,        //measured angle to horizontal
+            uint_t,         //altitude sample time
+            uint_t,         //acceleration sample time
+            uint_t,         //acceleration sample age
+            uint_t,         //gravity sample age
+            uint_t,         //orientation sample age
+            uint_t,         //imu missed reports
             float_t,        //controller error
             float_t,        //controller flight path
             float_t,        //controller flight path velocity partial
@@ -83,6 +124,7 @@ namespace Airbrakes{
             float_t,        //controller adjusted drag
             float_t,        //controller requested drag
             float_t,        //current drag area from motor position
+            float_t,        //controller predicted apogee
             bool,           //controller update rule clamp flag
             bool,           //controller saturation flag
             bool            //controller fault flag
@@ -106,14 +148,19 @@ namespace Airbrakes{
             uint_t,                             //simulation refresh period
             float_t,                            //controller decay rate
             float_t,                            //controller coast velocity
+            Controls::ControlModes,             //controller mode
             uint_t,                             //altimeter SPI speed
             float_t,                            //altimeter ground pressure
             float_t,                            //altimeter ground temperature
+            uint_t,                             //altimeter pressure OSR
+            uint_t,                             //altimeter temperature OSR
+            uint_t,                             //altimeter temperature ratio
             uint_t,                             //imu SPI speed
             uint32_t,                           //imu acceleration sample period
             uint32_t,                           //imu angular velocity sample period
             uint32_t,                           //imu orientation sample period
             uint32_t,                           //imu gravity sample period
+            uint32_t,                           //imu batch interval
             float_t,                            //motor range limit
             uint_t,                             //motor encoder steps
             uint_t,                             //motor steps
@@ -127,7 +174,12 @@ namespace Airbrakes{
 
         // --- serial port systems ---
         RocketOS::SerialInput m_inputBuffer;
-        elapsedMillis m_serialRefresh;
+        //HIL frames go out ahead of shell text
+        SerialOutputWithCommands<2> m_output;
+
+        // --- task scheduling ---
+        SchedulerWithCommands<Airbrakes_CFG_SchedulerMaxTasks> m_scheduler;
+        uint_t m_serialTask;
 
         // --- HIL systems ---
 #ifndef NO_TX_HIL
@@ -166,6 +218,10 @@ namespace Airbrakes{
         void updateBackground(); 
 
     private:
+        error_t registerTasks();
+        void serialTasks();
+        void altimeterTasks();
+        void stateTasks();
         void standbyTasks();
         void armedTasks();
         void boostTasks();
@@ -181,6 +237,8 @@ namespace Airbrakes{
         void initRecovery();
 
         void logPrint(const char*);
+        void printTopics() const;
+        void printSnapshot();
 
     private:
         // ######### command structure #########
@@ -193,11 +251,12 @@ namespace Airbrakes{
                     //list of local commands
                     const std::array<Command, 2> c_simRefreshCommands{
                         Command{"", "", [this](arg_t){
-                            Serial.print(m_HILRefreshPeriod);
-                            Serial.println("ms");
+                            RocketOS::Console.print(m_HILRefreshPeriod);
+                            RocketOS::Console.println("ms");
                         }},
                         Command{"set", "u", [this](arg_t args){
                             m_HILRefreshPeriod = args[0].getUnsignedData();
+                            m_scheduler.setPeriod(m_serialTask, m_HILRefreshPeriod * 1000);
                         }}
                     };
                 // ==========================
@@ -209,20 +268,20 @@ namespace Airbrakes{
                 const std::array<Command, 3> c_simCommands{
                     Command{"start", "", [this](arg_t){
                         if(m_observer.setMode(m_simulationType) == error_t::ERROR){
-                            Serial.println("Failed to start simulation");
+                            RocketOS::Console.println("Failed to start simulation");
                             return;
                         }
                         m_HILEnabled = true;
                     }},
                     Command{"stop", "", [this](arg_t){
                         if(m_observer.setMode(ObserverModes::Sensor) == error_t::ERROR){
-                            Serial.println("Error stopping simulation");
+                            RocketOS::Console.println("Error stopping simulation");
                         }
                         m_HILEnabled = false;
                     }},
                     Command{"", "", [this](arg_t){
-                        if(m_HILEnabled) Serial.println("Simulation is active");
-                        else Serial.println("Simulation is inactive");
+                        if(m_HILEnabled) RocketOS::Console.println("Simulation is active");
+                        else RocketOS::Console.println("Simulation is inactive");
                     }}
                 };
             // =============================
@@ -233,8 +292,8 @@ namespace Airbrakes{
                     //list of commands
                     const std::array<Command, 2> c_flightSampleCommands{
                         Command{"", "", [this](arg_t){
-                            Serial.print(m_stateTransitionSamplePeriod_ms);
-                            Serial.println("ms");
+                            RocketOS::Console.print(m_stateTransitionSamplePeriod_ms);
+                            RocketOS::Console.println("ms");
                         }},
                         Command{"set", "u", [this](arg_t args){
                             m_stateTransitionSamplePeriod_ms = args[0].getUnsignedData();
@@ -246,8 +305,8 @@ namespace Airbrakes{
                 //list of commands
                 const std::array<Command, 3> c_flightBufferCommands{
                     Command{"", "", [this](arg_t){
-                        if(m_bufferFlightTelemetry) Serial.println("Buffer mode is enabled");
-                        else Serial.println("Buffer mode is is disabled");
+                        if(m_bufferFlightTelemetry) RocketOS::Console.println("Buffer mode is enabled");
+                        else RocketOS::Console.println("Buffer mode is is disabled");
                     }},
                     Command{"set", "", [this](arg_t){
                         m_bufferFlightTelemetry = true;
@@ -261,8 +320,8 @@ namespace Airbrakes{
                 // === ACTUATE SUBCOMMAND ===
                 const std::array<Command, 3> c_flightActuateCommands{
                     Command{"", "", [this](arg_t){
-                        if(m_actuateInFlight) Serial.println("Actuators are enabled for flight");
-                        else Serial.println("Actuators are disabled for flight");
+                        if(m_actuateInFlight) RocketOS::Console.println("Actuators are enabled for flight");
+                        else RocketOS::Console.println("Actuators are disabled for flight");
                     }},
                     Command{"set", "", [this](arg_t){
                         m_actuateInFlight = true;
@@ -289,20 +348,25 @@ namespace Airbrakes{
             
 
             //list of subcommands
-            const std::array<CommandList, 9> c_rootChildren{
+            const std::array<CommandList, 15> c_rootChildren{
                 CommandList{"flight", nullptr, 0, c_flightSubCommands.data(), c_flightSubCommands.size()},
                 m_controller.getCommands(),
+                m_observer.getCommands(),
                 m_log.getCommands(),
                 m_telemetry.getCommands(),
                 m_persistent.getCommands(),
                 CommandList{"sim", c_simCommands.data(), c_simCommands.size(), c_simChildren.data(), c_simChildren.size()},
                 m_altimeter.getCommands(),
                 m_imu.getCommands(),
-                m_actuator.getCommands()
-                
+                m_actuator.getCommands(),
+                m_scheduler.getCommands(),
+                m_deferredWork.getCommands(),
+                m_spi0.getCommands(),
+                m_spi1.getCommands(),
+                m_output.getCommands()
             };
             //list of local commands
-            const std::array<Command, 5> c_rootCommands{
+            const std::array<Command, 7> c_rootCommands{
                 Command{"arm", "", [this](arg_t){
                     m_armFlag = true;
                 }},
@@ -313,20 +377,20 @@ namespace Airbrakes{
                     switch(m_state){
                         case ProgramStates::Standby:
                         default:
-                            Serial.println(APP_STANDBY_STATE_NAME);
+                            RocketOS::Console.println(APP_STANDBY_STATE_NAME);
                         break;
                         case ProgramStates::Armed:
                         case ProgramStates::ReArmed:
-                            Serial.println(APP_ARMED_STATE_NAME);
+                            RocketOS::Console.println(APP_ARMED_STATE_NAME);
                         break;
                         case ProgramStates::Boost:
-                            Serial.println(APP_BOOST_STATE_NAME);
+                            RocketOS::Console.println(APP_BOOST_STATE_NAME);
                         break;
                         case ProgramStates::Coast:
-                            Serial.println(APP_COAST_STATE_NAME);
+                            RocketOS::Console.println(APP_COAST_STATE_NAME);
                         break;
                         case ProgramStates::Recovery:
-                            Serial.println(APP_RECOVERY_STATE_NAME);
+                            RocketOS::Console.println(APP_RECOVERY_STATE_NAME);
                         break;
                     }
                 }},
@@ -334,7 +398,13 @@ namespace Airbrakes{
                     makeShutdownSafe();
                 }},
                 Command{"restartSD", "", [this](arg_t){
-                    if(!m_sdCard.begin(SdioConfig(FIFO_SDIO))) Serial.println("Error re-initializing the SD card");
+                    if(!m_sdCard.begin(SdioConfig(FIFO_SDIO))) RocketOS::Console.println("Error re-initializing the SD card");
+                }},
+                Command{"bus", "", [this](arg_t){
+                    printTopics();
+                }},
+                Command{"snapshot", "", [this](arg_t){
+                    printSnapshot();
                 }}
             };
             //command list object
@@ -8,12 +8,39 @@
 
 namespace Airbrakes{
     namespace Controls{
+        enum class ControlModes{
+            FlightPath, ApogeePrediction
+        };
+
+        /*Controller output
+         * Control signals from one controller tick, published on the controller topic for telemetry and HIL.
+        */
+        struct ControllerOutput{
+            float_t error;
+            float_t flightPath;
+            float_t flightPathVelocityPartial;
+            float_t flightPathAnglePartial;
+            float_t updateRuleDragArea;
+            float_t adjustedDragArea;
+            float_t requestedDragArea;
+            float_t currentDragArea;
+            float_t predictedApogee;
+            bool updateRuleClamped;
+            bool isSaturated;
+            bool fault;
+        };
+
+        using ControllerTopic_t = RocketOS::Utilities::Topic<ControllerOutput, Airbrakes_CFG_ControllerTopicDepth>;
+        using ControllerSubscriber_t = RocketOS::Utilities::Subscriber<ControllerOutput, Airbrakes_CFG_ControllerTopicDepth>;
+
         class Controller{
         private:
             const char* const m_name;
-            const FlightPlan& m_flightPlan;
-            const Observer& m_observer;
+            FlightPlan& m_flightPlan;
+            ObserverSubscriber_t m_observerSubscriber;
             Motor::Actuator& m_motor;
+            const RocketOS::Processing::StandardAtmosphere<>& m_atmosphere;
+            ObserverState m_observerState;
 
             //control signals
             float_t m_error, m_flightPath, m_flightPathVelocityPartial, m_flightPathAnglePartial, m_updateRuleDragArea, m_adjustedDragArea, m_requestedDragArea, m_currentDragArea;
@@ -21,6 +48,10 @@ namespace Airbrakes{
             //state flags
             bool m_updateRuleClamped, m_isSaturated, m_fault;
 
+            //apogee prediction, the apogee mode predicts both actuator extremes and reuses them for the current deployment
+            ControlModes m_mode;
+            float_t m_predictedApogee, m_highestApogee, m_lowestApogee;
+
             //parameters
             float_t m_decayRate, m_updateRuleShutdownVelocity;
             
@@ -28,9 +59,18 @@ namespace Airbrakes{
             uint_t m_clockPeriod;
             IntervalTimer m_clock;
             bool m_isActive;
+            RocketOS::Utilities::CycleTimer m_clockTimer;
+            RocketOS::Utilities::JitterMonitor m_clockJitter;
+            uint_t m_budgetOverruns;
+
+            //shell changes applied between ticks
+            RocketOS::Utilities::SafePoint<Airbrakes_CFG_SafePointQueueSize> m_safePoint;
+
+            //outputs
+            ControllerTopic_t m_output;
             
         public:
-            Controller(const char* name, uint_t clockPeriod, const FlightPlan& plan, const Observer& observer, Motor::Actuator& motor, float_t decayDate);
+            Controller(const char* name, uint_t clockPeriod, FlightPlan& plan, const Observer& observer, Motor::Actuator& motor, const RocketOS::Processing::StandardAtmosphere<>& atmosphere, float_t decayDate);
 
             RocketOS::Shell::CommandList getCommands() const;
 
@@ -42,48 +82,40 @@ namespace Airbrakes{
             void clock();
 
 
-            //acessors to references for peristent storage, telemetry and HIL systems
+            //control signals for telemetry and HIL
+            const ControllerTopic_t& getOutputTopic() const;
+
+            //acessors to references for peristent storage
             uint_t& getClockPeriodRef();
             bool& getActiveFlagRef();
 
-            const float_t& getErrorRef() const;
-            const float_t& getFlightPathRef() const;
-            const float_t& getVPartialRef() const;
-            const float_t& getAnglePartialRef() const;
-            const float_t& getUpdateRuleDragRef() const;
-            const float_t& getAdjustedDragRef() const;
-            const float_t& getRequestedDragRef() const;
-            const float_t& getCurrentDragRef() const;
-
-            const bool& getClampFlagRef() const;
-            const bool& getSaturationFlagRef() const;
-            const bool& getFaultFlagRef() const;
-
             float_t& getDecayRateRef();
             float_t& getCoastVelocityRef();
+            ControlModes& getModeRef();
 
         private:
             float_t airDensity(float_t altitude) const;
             float_t updateRule(float_t error, float_t verticalVelocity, float_t angle, float_t altitude, float_t velocityPartial, float_t anglePartial) const;
+            float_t predictApogee(float_t altitude, float_t verticalVelocity, float_t angle, float_t dragArea) const;
+            float_t interpolateApogee(float_t dragArea) const;
+            float_t apogeeRule() const;
             float_t getBestPossibleDragArea(float_t dragArea, float_t error) const;
-            result_t<float_t> convertDragAreaToMotorPosition(float_t) const;
-            result_t<float_t> convertMotorPositionToDragArea(float_t) const;
             error_t newFlight();
-
-            static float_t sinSquared(float_t);
+            void publishOutput();
         private:
             // ######### command structure #########
             using Command = RocketOS::Shell::Command;
             using CommandList = RocketOS::Shell::CommandList;
             using arg_t = RocketOS::Shell::arg_t;
+            using CommandModes = RocketOS::Shell::CommandModes;
             // === ROOT COMAND LIST ===
             // children command lists ---------
                 // === PERIOD COMMAND LIST ===
                     //command list
                     const std::array<Command, 2> c_periodCommands{
                         Command{"", "", [this](arg_t){
-                            Serial.print(m_clockPeriod);
-                            Serial.println(" us");
+                            RocketOS::Console.print(m_clockPeriod);
+                            RocketOS::Console.println(" us");
                         }},
                         Command{"set", "u", [this](arg_t args){
                             m_clockPeriod = args[0].getUnsignedData();
@@ -96,12 +128,12 @@ namespace Airbrakes{
                     //command list
                     const std::array<Command, 2> c_decayCommands{
                         Command{"", "", [this](arg_t){
-                            Serial.println(m_decayRate);
+                            RocketOS::Console.println(m_decayRate);
                         }},
                         Command{"set", "f", [this](arg_t args){
                             float_t newDecayRate = args[0].getFloatData();
-                            if(newDecayRate >=0) Serial.println("Warning: Decay rate should probably be negative");
-                            m_decayRate = newDecayRate;
+                            if(newDecayRate >=0) RocketOS::Console.println("Warning: Decay rate should probably be negative");
+                            if(m_safePoint.post([this, newDecayRate](){m_decayRate = newDecayRate;}) != error_t::GOOD) RocketOS::Console.println("Controller is busy, try again");
                         }}
                     };
                 // ===============================
@@ -110,31 +142,71 @@ namespace Airbrakes{
                     //command list
                     const std::array<Command, 2> c_coastCommands{
                         Command{"", "", [this](arg_t){
-                            Serial.print(m_updateRuleShutdownVelocity);
-                            Serial.println("m/s");
+                            RocketOS::Console.print(m_updateRuleShutdownVelocity);
+                            RocketOS::Console.println("m/s");
                         }},
                         Command{"set", "f", [this](arg_t args){
                             float_t newVelocity = args[0].getFloatData();
-                            if(newVelocity < 0) Serial.println("Value should be positive");
-                            else m_updateRuleShutdownVelocity = newVelocity;
+                            if(newVelocity < 0) RocketOS::Console.println("Value should be positive");
+                            else if(m_safePoint.post([this, newVelocity](){m_updateRuleShutdownVelocity = newVelocity;}) != error_t::GOOD) RocketOS::Console.println("Controller is busy, try again");
                         }}
                     };
                 // ===================================
 
+                // === MODE COMMAND LIST ===
+                    //command list
+                    const std::array<Command, 3> c_modeCommands{
+                        Command{"", "", [this](arg_t){
+                            if(m_mode == ControlModes::ApogeePrediction) RocketOS::Console.println("apogee");
+                            else RocketOS::Console.println("path");
+                        }},
+                        Command{"path", "", [this](arg_t){
+                            if(m_safePoint.post([this](){m_mode = ControlModes::FlightPath;}) != error_t::GOOD) RocketOS::Console.println("Controller is busy, try again");
+                        }},
+                        Command{"apogee", "", [this](arg_t){
+                            if(m_safePoint.post([this](){m_mode = ControlModes::ApogeePrediction;}) != error_t::GOOD) RocketOS::Console.println("Controller is busy, try again");
+                        }}
+                    };
+                // =========================
+
+                // === TIMING COMMAND LIST ===
+                    //command list
+                    const std::array<Command, 2> c_timingCommands{
+                        Command{"", "", [this](arg_t){
+                            RocketOS::Console.printf("Last tick: %.1fus (%u cycles)\n", m_clockTimer.getLast_us(), m_clockTimer.getLastCycles());
+                            RocketOS::Console.printf("Worst tick: %.1fus (%u cycles) over %u ticks\n", m_clockTimer.getMax_us(), m_clockTimer.getMaxCycles(), m_clockTimer.getCount());
+                            RocketOS::Console.printf("Budget: %dus, %.2f%% of the clock period used in the worst case\n", Airbrakes_CFG_ControllerBudget_us, 100 * m_clockTimer.getMax_us() / m_clockPeriod);
+                            RocketOS::Console.printf("Budget overruns: %u\n", m_budgetOverruns);
+                            RocketOS::Console.printf("Tick jitter: %.1fus late, %.1fus early (worst case)\n", m_clockJitter.getMaxLate_us(), m_clockJitter.getMaxEarly_us());
+                        }},
+                        Command{"reset", "", [this](arg_t){
+                            m_clockTimer.reset();
+                            m_clockJitter.reset();
+                            m_budgetOverruns = 0;
+                        }, CommandModes::Atomic}
+                    };
+                // ===========================
+
             // --------------------------------
             // subcommand list
-            const std::array<CommandList, 3> c_rootChildren{
+            const std::array<CommandList, 5> c_rootChildren{
                 CommandList{"period", c_periodCommands.data(), c_periodCommands.size(), nullptr, 0},
                 CommandList{"decay", c_decayCommands.data(), c_decayCommands.size(), nullptr, 0},
-                CommandList{"coast", c_coastCommands.data(), c_coastCommands.size(), nullptr, 0}
+                CommandList{"coast", c_coastCommands.data(), c_coastCommands.size(), nullptr, 0},
+                CommandList{"mode", c_modeCommands.data(), c_modeCommands.size(), nullptr, 0},
+                CommandList{"timing", c_timingCommands.data(), c_timingCommands.size(), nullptr, 0}
             };
             // command list
-            const std::array<Command, 2> c_rootCommands{
+            const std::array<Command, 3> c_rootCommands{
                 Command{"start", "", [this](arg_t){
-                    if(start() != error_t::GOOD) Serial.println("Error starting the controller");//log message
+                    if(start() != error_t::GOOD) RocketOS::Console.println("Error starting the controller");//log message
                 }},
                 Command{"stop", "", [this](arg_t){
                     stop();
+                }},
+                Command{"apogee", "", [this](arg_t){
+                    RocketOS::Console.print(m_predictedApogee);
+                    RocketOS::Console.println("m");
                 }}
             };
             // =========================
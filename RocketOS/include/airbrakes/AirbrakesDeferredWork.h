@@ -0,0 +1,45 @@
+#pragma once
+#include "RocketOS.h"
+#include "AirbrakesGeneral.h"
+#include <Arduino.h> //serial printing
+
+namespace Airbrakes{
+    template<std::size_t t_size>
+    class DeferredWorkWithCommands : public RocketOS::Utilities::DeferredWork<t_size>{
+    private:
+        const char* const m_name;
+
+    public:
+        DeferredWorkWithCommands(const char* name) : m_name(name) {}
+
+        RocketOS::Shell::CommandList getCommands() const{
+            return {m_name, c_rootCommands.data(), c_rootCommands.size(), nullptr, 0};
+        }
+
+    private:
+        void printStatistics() const{
+            RocketOS::Console.printf("items: %u, overflows: %u, pending: %u\n", this->getCount(), this->getOverflows(), this->pending());
+            using RocketOS::Utilities::CycleTimer;
+            RocketOS::Console.printf("latency: %.2fus last, %.2fus max\n", CycleTimer::toMicroseconds(this->getLastLatencyCycles()), CycleTimer::toMicroseconds(this->getMaxLatencyCycles()));
+            RocketOS::Console.printf("execution: %.2fus max\n", CycleTimer::toMicroseconds(this->getMaxExecutionCycles()));
+        }
+
+        // ##### COMMAND LIST #####
+        using Command = RocketOS::Shell::Command;
+        using CommandList = RocketOS::Shell::CommandList;
+        using arg_t = RocketOS::Shell::arg_t;
+        using CommandModes = RocketOS::Shell::CommandModes;
+
+        // === ROOT COMMAND LIST ===
+            //list of commands
+            const std::array<Command, 2> c_rootCommands{
+                Command{"", "", [this](arg_t){
+                    printStatistics();
+                }},
+                Command{"reset", "", [this](arg_t){
+                    this->resetStatistics();
+                }, CommandModes::Atomic}
+            };
+        // =========================
+    };
+}
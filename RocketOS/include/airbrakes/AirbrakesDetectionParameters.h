@@ -40,12 +40,12 @@ namespace Airbrakes{
                 //commands
                 const std::array<Command, 2> c_altitudeCommands{
                     Command{"", "", [this](arg_t){
-                        Serial.print(m_data.altitudeThreshold);
-                        Serial.println("m");
+                        RocketOS::Console.print(m_data.altitudeThreshold);
+                        RocketOS::Console.println("m");
                     }},
                     Command{"set", "f", [this](arg_t args){
                         m_data.altitudeThreshold = args[0].getFloatData();
-                        if(m_data.altitudeThreshold < 0) Serial.println("Warning: Negative altitude value");
+                        if(m_data.altitudeThreshold < 0) RocketOS::Console.println("Warning: Negative altitude value");
                     }}
                 };
             // =================================
@@ -54,12 +54,12 @@ namespace Airbrakes{
                 //commands
                 const std::array<Command, 2> c_velocityCommands{
                     Command{"", "", [this](arg_t){
-                        Serial.print(m_data.verticalVelocityThreshold);
-                        Serial.println("m/s");
+                        RocketOS::Console.print(m_data.verticalVelocityThreshold);
+                        RocketOS::Console.println("m/s");
                     }},
                     Command{"set", "f", [this](arg_t args){
                         float_t newValue = args[0].getFloatData();
-                        if((newValue < 0 && m_data.verticalVelocityThreshold > 0) || (newValue >0 && m_data.verticalVelocityThreshold < 0)) Serial.println("Warning: Signs differ between old and new values");
+                        if((newValue < 0 && m_data.verticalVelocityThreshold > 0) || (newValue >0 && m_data.verticalVelocityThreshold < 0)) RocketOS::Console.println("Warning: Signs differ between old and new values");
                         m_data.verticalVelocityThreshold = newValue;
                     }}
                 };
@@ -69,12 +69,12 @@ namespace Airbrakes{
                 //commands
                 const std::array<Command, 2> c_accelerationCommands{
                     Command{"", "", [this](arg_t){
-                        Serial.print(m_data.verticalAccelerationThreshold);
-                        Serial.println("m/s^2");
+                        RocketOS::Console.print(m_data.verticalAccelerationThreshold);
+                        RocketOS::Console.println("m/s^2");
                     }},
                     Command{"set", "f", [this](arg_t args){
                         float_t newValue = args[0].getFloatData();
-                        if((newValue < 0 && m_data.verticalAccelerationThreshold > 0) || (newValue >0 && m_data.verticalAccelerationThreshold < 0)) Serial.println("Warning: Signs differ between old and new values");
+                        if((newValue < 0 && m_data.verticalAccelerationThreshold > 0) || (newValue >0 && m_data.verticalAccelerationThreshold < 0)) RocketOS::Console.println("Warning: Signs differ between old and new values");
                         m_data.verticalAccelerationThreshold = newValue;
                     }}
                 };
@@ -84,8 +84,8 @@ namespace Airbrakes{
                 //commands
                 const std::array<Command, 2> c_samplesCommands{
                     Command{"", "", [this](arg_t){
-                        Serial.print(m_data.requiredConsecutiveSamples);
-                        Serial.println(" samples");
+                        RocketOS::Console.print(m_data.requiredConsecutiveSamples);
+                        RocketOS::Console.println(" samples");
                     }},
                     Command{"set", "u", [this](arg_t args){
                         m_data.requiredConsecutiveSamples = args[0].getUnsignedData();
@@ -98,8 +98,8 @@ namespace Airbrakes{
                 //commands
                 const std::array<Command, 2> c_timeCommands{
                     Command{"", "", [this](arg_t){
-                        Serial.print(m_data.minimumTime_ms);
-                        Serial.println("ms");
+                        RocketOS::Console.print(m_data.minimumTime_ms);
+                        RocketOS::Console.println("ms");
                     }},
                     Command{"set", "u", [this](arg_t args){
                         m_data.minimumTime_ms = args[0].getUnsignedData();
@@ -118,11 +118,11 @@ namespace Airbrakes{
             //commands
             const std::array<Command, 1> c_rootCommands{
                 Command{"properties", "", [this](arg_t){
-                    Serial.printf("%s event detection parameters:\n", m_name);
-                    Serial.printf("Vertical velocity threshold: %.2fm/s\n", m_data.verticalVelocityThreshold);
-                    Serial.printf("Vertical acceleration threshold: %.2fm/s^2\n", m_data.verticalAccelerationThreshold);
-                    Serial.printf("Minimum consecutive samples: %d samples\n", m_data.requiredConsecutiveSamples);
-                    Serial.printf("Minimum state time: %dms\n", m_data.minimumTime_ms);
+                    RocketOS::Console.printf("%s event detection parameters:\n", m_name);
+                    RocketOS::Console.printf("Vertical velocity threshold: %.2fm/s\n", m_data.verticalVelocityThreshold);
+                    RocketOS::Console.printf("Vertical acceleration threshold: %.2fm/s^2\n", m_data.verticalAccelerationThreshold);
+                    RocketOS::Console.printf("Minimum consecutive samples: %d samples\n", m_data.requiredConsecutiveSamples);
+                    RocketOS::Console.printf("Minimum state time: %dms\n", m_data.minimumTime_ms);
                 }}
             };
         // =========================
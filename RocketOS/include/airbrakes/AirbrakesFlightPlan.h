@@ -14,6 +14,7 @@ namespace Airbrakes{
             static constexpr error_t ERROR_Memory = error_t(3);
             static constexpr error_t ERROR_File = error_t(4);
             static constexpr error_t ERROR_NotLoaded = error_t(5);
+            static constexpr error_t ERROR_InUse = error_t(8);
         
         private:
             //data
@@ -37,6 +38,11 @@ namespace Airbrakes{
             float_t m_groundLevelPressure;
             FileName_t m_fileName;
             bool m_isLoaded;
+            //set by the controller while its interrupt reads the plan, loading is refused until it stops
+            bool m_inUse;
+
+            //deployment mapping, sin(deployment * angleLimit) / sin(angleLimit) sampled over deployment in [0, 1]
+            RocketOS::Processing::LookupTable<Airbrakes_CFG_DeploymentTableSize> m_deploymentTable;
         public:
             //interface
             FlightPlan(const char*, SdFat&, float_t*, uint_t, const char*);
@@ -48,6 +54,8 @@ namespace Airbrakes{
 
             error_t loadFromFile();
             bool isLoaded() const;
+            void setInUse(bool);
+            bool isInUse() const;
 
             result_t<float_t> getAltitude(float_t, float_t) const;
             result_t<float_t> getVelocityPartial(float_t, float_t) const;
@@ -59,6 +67,8 @@ namespace Airbrakes{
             result_t<float_t> getDryMass() const;
             result_t<float_t> getGroundTemperature() const;
             result_t<float_t> getGroundPressure() const;
+            result_t<float_t> getDragArea(float_t) const;
+            result_t<float_t> getDeployment(float_t) const;
             
         private:
             //helpers
@@ -83,54 +93,59 @@ namespace Airbrakes{
             using Command = RocketOS::Shell::Command;
             using CommandList = RocketOS::Shell::CommandList;
             using arg_t = RocketOS::Shell::arg_t;
+            using CommandModes = RocketOS::Shell::CommandModes;
 
             // === ROOT COMMAND LIST ===
                 //list of local commands
                 const std::array<Command, 4> c_rootCommands = {
                     Command{"properties", "", [this](arg_t){
                         if(isLoaded()){
-                             Serial.printf("Flight plan '%s':\n", m_fileName.data());
-                             Serial.printf("Target apogee: %.2fm\n", m_targetApogee);
-                             Serial.printf("Deployment range: 0 degrees - %.2f degrees\n", m_deploymentAngleLimit * 180 / PI);
-                             Serial.printf("Effective drag area range: %.4fm^2 - %.4fm^2\n", m_minimumDragArea, m_maximumDragArea);
-                             Serial.printf("Dry mass: %.2fkg\n", m_dryMass);
-                             Serial.printf("Launch site conditions: %.2fC at %.2fpa\n", m_groundLevelTemperature - 273.15, m_groundLevelPressure);
-                             Serial.printf("Vertical velocity range: 0m/s - %.2fm/s with %d samples\n", m_maxVelocity, m_numVelocitySamples);
-                             Serial.printf("Angle with horizontal range: 0 degrees - %.2f degrees with %d samples\n", c_maxAngle * 180 / PI, m_numAngleSamples);
-                             Serial.printf("Using %d kB of available %d kB storage\n", m_numAngleSamples * m_numVelocitySamples * 4 / 1024, m_memorySize * 4 / 1024);
+                             RocketOS::Console.printf("Flight plan '%s':\n", m_fileName.data());
+                             RocketOS::Console.printf("Target apogee: %.2fm\n", m_targetApogee);
+                             RocketOS::Console.printf("Deployment range: 0 degrees - %.2f degrees\n", m_deploymentAngleLimit * 180 / PI);
+                             RocketOS::Console.printf("Effective drag area range: %.4fm^2 - %.4fm^2\n", m_minimumDragArea, m_maximumDragArea);
+                             RocketOS::Console.printf("Dry mass: %.2fkg\n", m_dryMass);
+                             RocketOS::Console.printf("Launch site conditions: %.2fC at %.2fpa\n", m_groundLevelTemperature - 273.15, m_groundLevelPressure);
+                             RocketOS::Console.printf("Vertical velocity range: 0m/s - %.2fm/s with %d samples\n", m_maxVelocity, m_numVelocitySamples);
+                             RocketOS::Console.printf("Angle with horizontal range: 0 degrees - %.2f degrees with %d samples\n", c_maxAngle * 180 / PI, m_numAngleSamples);
+                             RocketOS::Console.printf("Using %d kB of available %d kB storage\n", m_numAngleSamples * m_numVelocitySamples * 4 / 1024, m_memorySize * 4 / 1024);
                         }
                         else {
-                            Serial.println("No flight plan is loaded");
-                            Serial.printf("%d kB available for storage\n", m_memorySize * 4 / 1024);
+                            RocketOS::Console.println("No flight plan is loaded");
+                            RocketOS::Console.printf("%d kB available for storage\n", m_memorySize * 4 / 1024);
                         }
                     }},
                     Command{"load", "s", [this](arg_t args){
+                        if(isInUse()){
+                            RocketOS::Console.println("The controller is using the flight plan, stop it before loading another");
+                            return;
+                        }
                         args[0].copyStringData(m_fileName.data(), m_fileName.size());
                         error_t error = loadFromFile();
-                        if(error == error_t::GOOD) Serial.printf("Sucesfully loaded flight plan from '%s'\n", getFileName());
-                        else if(error == error_t(2)) Serial.printf("Formatting error encountered when loading flight plan from '%s'\n", getFileName());
-                        else if(error == error_t(3)) Serial.printf("Failed to load flight plan from '%s' due to lack of allocated memory\n", getFileName());
-                        else if(error == error_t(4)) Serial.printf("Failed to open flight plan with file name '%s'\n", getFileName());
-                        else Serial.println("Failed to load the flight plan");
+                        if(error == error_t::GOOD) RocketOS::Console.printf("Sucesfully loaded flight plan from '%s'\n", getFileName());
+                        else if(error == error_t(2)) RocketOS::Console.printf("Formatting error encountered when loading flight plan from '%s'\n", getFileName());
+                        else if(error == error_t(3)) RocketOS::Console.printf("Failed to load flight plan from '%s' due to lack of allocated memory\n", getFileName());
+                        else if(error == error_t(4)) RocketOS::Console.printf("Failed to open flight plan with file name '%s'\n", getFileName());
+                        else RocketOS::Console.println("Failed to load the flight plan");
                     }},
                     Command{"altitude", "ff", [this](arg_t args){
                         float_t velocity = args[0].getFloatData();
                         float_t angle_deg = args[1].getFloatData();
-                        if(!isLoaded()) Serial.println("No flight plan is loaded");
+                        if(!isLoaded()) RocketOS::Console.println("No flight plan is loaded");
                         else{
                             result_t<float_t> result = getAltitude(velocity, angle_deg * PI /180);
-                            if(result.error != error_t::GOOD) Serial.println("Value is out of range");
-                            else Serial.printf("%.2fm\n", result.data);
+                            if(result.error != error_t::GOOD) RocketOS::Console.println("Value is out of range");
+                            else RocketOS::Console.printf("%.2fm\n", result.data);
                         }
                     }},
                     Command{"gradient", "ff", [this](arg_t args){
                         float_t velocity = args[0].getFloatData();
                         float_t angle_deg = args[1].getFloatData();
-                        if(!isLoaded()) Serial.println("No flight plan is loaded");
+                        if(!isLoaded()) RocketOS::Console.println("No flight plan is loaded");
                         else{
                             float_t velocityPartial = getVelocityPartial(velocity, angle_deg * PI /180);
                             float_t anglePartial = getAnglePartial(velocity, angle_deg * PI /180);
-                            Serial.printf("<%.2f, %.2f>\n", velocityPartial, anglePartial);
+                            RocketOS::Console.printf("<%.2f, %.2f>\n", velocityPartial, anglePartial);
                         }
                     }}
                 };
@@ -16,6 +16,9 @@ namespace Airbrakes{
     using result_t = RocketOS::result_t<T>;
 
     using FileName_t = std::array<char, Airbrakes_CFG_FileNameBufferSize>;
+    using DeferredWork_t = RocketOS::Utilities::DeferredWork<Airbrakes_CFG_DeferredWorkQueueSize>;
+    using SPIBackend_t = Airbrakes_CFG_SPIBackend;
+    using SPIBus_t = RocketOS::Utilities::SPIBus<SPIBackend_t, Airbrakes_CFG_SPIQueueSize>;
 }
 
 /*configuration validity checks
@@ -38,3 +41,168 @@ namespace Airbrakes{
     static_assert(Airbrakes_CFG_LogBufferSize > 0, "Airbrakes_CFG_LogBufferSize must be positive");
 #endif
 
+//Airbrakes_CFG_DeploymentTableSize check
+#ifndef Airbrakes_CFG_DeploymentTableSize
+    static_assert(false, "Airbrakes_CFG_DeploymentTableSize must be defined in the file Airbrakes.cfg.h");
+#else
+    static_assert(Airbrakes_CFG_DeploymentTableSize > 1, "Airbrakes_CFG_DeploymentTableSize must be greater than 1");
+#endif
+
+//Airbrakes_CFG_ApogeePredictorSteps check
+#ifndef Airbrakes_CFG_ApogeePredictorSteps
+    static_assert(false, "Airbrakes_CFG_ApogeePredictorSteps must be defined in the file Airbrakes.cfg.h");
+#else
+    static_assert(Airbrakes_CFG_ApogeePredictorSteps > 0, "Airbrakes_CFG_ApogeePredictorSteps must be positive");
+#endif
+
+//Airbrakes_CFG_ControllerBudget_us check
+#ifndef Airbrakes_CFG_ControllerBudget_us
+    static_assert(false, "Airbrakes_CFG_ControllerBudget_us must be defined in the file Airbrakes.cfg.h");
+#else
+    static_assert(Airbrakes_CFG_ControllerBudget_us * 10 <= Airbrakes_CFG_ControllerPeriod_us, "Airbrakes_CFG_ControllerBudget_us must leave at least 90% of the controller period free");
+#endif
+
+//Airbrakes_CFG_SchedulerMaxTasks check
+#ifndef Airbrakes_CFG_SchedulerMaxTasks
+    static_assert(false, "Airbrakes_CFG_SchedulerMaxTasks must be defined in the file Airbrakes.cfg.h");
+#else
+    static_assert(Airbrakes_CFG_SchedulerMaxTasks >= 3, "Airbrakes_CFG_SchedulerMaxTasks must leave room for the serial, imu and state tasks");
+#endif
+
+//Airbrakes_CFG_IMU_BatchInterval_us check
+#ifndef Airbrakes_CFG_IMU_BatchInterval_us
+    static_assert(false, "Airbrakes_CFG_IMU_BatchInterval_us must be defined in the file Airbrakes.cfg.h");
+#else
+    static_assert(Airbrakes_CFG_IMU_BatchInterval_us < Airbrakes_CFG_ObserverAltimeterSamplePeriod_us || Airbrakes_CFG_IMU_BatchInterval_us < Airbrakes_CFG_ObserverIMUSamplePeriod_us, "Airbrakes_CFG_IMU_BatchInterval_us must be shorter than the observer period so every tick gets new reports");
+#endif
+
+//Airbrakes_CFG_IMUBufferSize check
+#ifndef Airbrakes_CFG_IMUBufferSize
+    static_assert(false, "Airbrakes_CFG_IMUBufferSize must be defined in the file Airbrakes.cfg.h");
+#else
+    static_assert(Airbrakes_CFG_IMUBufferSize >= 64, "Airbrakes_CFG_IMUBufferSize must hold at least one report of every sensor");
+#endif
+
+//Airbrakes_CFG_IMUHistorySize check
+#ifndef Airbrakes_CFG_IMUHistorySize
+    static_assert(false, "Airbrakes_CFG_IMUHistorySize must be defined in the file Airbrakes.cfg.h");
+#else
+    static_assert(Airbrakes_CFG_IMUHistorySize > 1 && (Airbrakes_CFG_IMUHistorySize & (Airbrakes_CFG_IMUHistorySize - 1)) == 0, "Airbrakes_CFG_IMUHistorySize must be a power of two");
+#endif
+
+//Airbrakes_CFG_IMU_StalePeriods check
+#ifndef Airbrakes_CFG_IMU_StalePeriods
+    static_assert(false, "Airbrakes_CFG_IMU_StalePeriods must be defined in the file Airbrakes.cfg.h");
+#else
+    static_assert(Airbrakes_CFG_IMU_StalePeriods > 0, "Airbrakes_CFG_IMU_StalePeriods must be positive");
+#endif
+
+//Airbrekes_CFG_IMUTxQueueSize check
+#ifndef Airbrekes_CFG_IMUTxQueueSize
+    static_assert(false, "Airbrekes_CFG_IMUTxQueueSize must be defined in the file Airbrakes.cfg.h");
+#else
+    static_assert(Airbrekes_CFG_IMUTxQueueSize >= 8 && (Airbrekes_CFG_IMUTxQueueSize & (Airbrekes_CFG_IMUTxQueueSize - 1)) == 0, "Airbrekes_CFG_IMUTxQueueSize must be a power of two with room for the 8 configuration commands");
+#endif
+
+//Airbrakes_CFG_DeferredWorkQueueSize check
+#ifndef Airbrakes_CFG_DeferredWorkQueueSize
+    static_assert(false, "Airbrakes_CFG_DeferredWorkQueueSize must be defined in the file Airbrakes.cfg.h");
+#else
+    static_assert(Airbrakes_CFG_DeferredWorkQueueSize >= 4 && (Airbrakes_CFG_DeferredWorkQueueSize & (Airbrakes_CFG_DeferredWorkQueueSize - 1)) == 0, "Airbrakes_CFG_DeferredWorkQueueSize must be a power of two and at least 4");
+#endif
+
+//Airbrakes_CFG_ControllerTopicDepth check
+#ifndef Airbrakes_CFG_ControllerTopicDepth
+    static_assert(false, "Airbrakes_CFG_ControllerTopicDepth must be defined in the file Airbrakes.cfg.h");
+#else
+    static_assert(Airbrakes_CFG_ControllerTopicDepth > 1, "Airbrakes_CFG_ControllerTopicDepth must be greater than 1");
+#endif
+
+//Airbrakes_CFG_ObserverTopicDepth check
+#ifndef Airbrakes_CFG_ObserverTopicDepth
+    static_assert(false, "Airbrakes_CFG_ObserverTopicDepth must be defined in the file Airbrakes.cfg.h");
+#else
+    static_assert(Airbrakes_CFG_ObserverTopicDepth > 1, "Airbrakes_CFG_ObserverTopicDepth must be greater than 1");
+#endif
+
+//Airbrakes_CFG_SafePointQueueSize check
+#ifndef Airbrakes_CFG_SafePointQueueSize
+    static_assert(false, "Airbrakes_CFG_SafePointQueueSize must be defined in the file Airbrakes.cfg.h");
+#else
+    static_assert(Airbrakes_CFG_SafePointQueueSize > 1 && (Airbrakes_CFG_SafePointQueueSize & (Airbrakes_CFG_SafePointQueueSize - 1)) == 0, "Airbrakes_CFG_SafePointQueueSize must be a power of two");
+#endif
+
+//Airbrakes_CFG_ControllerFastMath check
+#ifndef Airbrakes_CFG_ControllerFastMath
+    static_assert(false, "Airbrakes_CFG_ControllerFastMath must be defined in the file Airbrakes.cfg.h");
+#else
+    static_assert(Airbrakes_CFG_ControllerFastMath == 0 || Airbrakes_CFG_ControllerFastMath == 1, "Airbrakes_CFG_ControllerFastMath must be 0 or 1");
+#endif
+
+//Airbrakes_CFG_ObserverFastMath check
+#ifndef Airbrakes_CFG_ObserverFastMath
+    static_assert(false, "Airbrakes_CFG_ObserverFastMath must be defined in the file Airbrakes.cfg.h");
+#else
+    static_assert(Airbrakes_CFG_ObserverFastMath == 0 || Airbrakes_CFG_ObserverFastMath == 1, "Airbrakes_CFG_ObserverFastMath must be 0 or 1");
+#endif
+
+//Airbrakes_CFG_ObserverWorldFrame check
+#ifndef Airbrakes_CFG_ObserverWorldFrame
+    static_assert(false, "Airbrakes_CFG_ObserverWorldFrame must be defined in the file Airbrakes.cfg.h");
+#else
+    static_assert(Airbrakes_CFG_ObserverWorldFrame == 0 || Airbrakes_CFG_ObserverWorldFrame == 1, "Airbrakes_CFG_ObserverWorldFrame must be 0 or 1");
+#endif
+
+//Airbrakes_CFG_ObserverMaxIMUAge_us check
+#ifndef Airbrakes_CFG_ObserverMaxIMUAge_us
+    static_assert(false, "Airbrakes_CFG_ObserverMaxIMUAge_us must be defined in the file Airbrakes.cfg.h");
+#else
+    static_assert(Airbrakes_CFG_ObserverMaxIMUAge_us > Airbrakes_CFG_IMU_BatchInterval_us + Airbrakes_CFG_ObserverAltimeterSamplePeriod_us && Airbrakes_CFG_ObserverMaxIMUAge_us > Airbrakes_CFG_IMU_BatchInterval_us + Airbrakes_CFG_ObserverIMUSamplePeriod_us, "Airbrakes_CFG_ObserverMaxIMUAge_us must be longer than a batch interval and an observer period, or on time samples are rejected");
+#endif
+
+//Airbrakes_CFG_SPIQueueSize check
+#ifndef Airbrakes_CFG_SPIQueueSize
+    static_assert(false, "Airbrakes_CFG_SPIQueueSize must be defined in the file Airbrakes.cfg.h");
+#else
+    static_assert(Airbrakes_CFG_SPIQueueSize > 1 && (Airbrakes_CFG_SPIQueueSize & (Airbrakes_CFG_SPIQueueSize - 1)) == 0, "Airbrakes_CFG_SPIQueueSize must be a power of two");
+#endif
+
+//Airbrakes_CFG_SPIBackend check
+#ifndef Airbrakes_CFG_SPIBackend
+    static_assert(false, "Airbrakes_CFG_SPIBackend must be defined in the file Airbrakes.cfg.h");
+#endif
+
+//Airbrakes_CFG_AltimeterPressureOSR check
+#ifndef Airbrakes_CFG_AltimeterPressureOSR
+    static_assert(false, "Airbrakes_CFG_AltimeterPressureOSR must be defined in the file Airbrakes.cfg.h");
+#else
+    static_assert(Airbrakes_CFG_AltimeterPressureOSR == 256 || Airbrakes_CFG_AltimeterPressureOSR == 512 || Airbrakes_CFG_AltimeterPressureOSR == 1024 || Airbrakes_CFG_AltimeterPressureOSR == 2048 || Airbrakes_CFG_AltimeterPressureOSR == 4096, "Airbrakes_CFG_AltimeterPressureOSR must be 256, 512, 1024, 2048 or 4096");
+#endif
+
+//Airbrakes_CFG_AltimeterTemperatureOSR check
+#ifndef Airbrakes_CFG_AltimeterTemperatureOSR
+    static_assert(false, "Airbrakes_CFG_AltimeterTemperatureOSR must be defined in the file Airbrakes.cfg.h");
+#else
+    static_assert(Airbrakes_CFG_AltimeterTemperatureOSR == 256 || Airbrakes_CFG_AltimeterTemperatureOSR == 512 || Airbrakes_CFG_AltimeterTemperatureOSR == 1024 || Airbrakes_CFG_AltimeterTemperatureOSR == 2048 || Airbrakes_CFG_AltimeterTemperatureOSR == 4096, "Airbrakes_CFG_AltimeterTemperatureOSR must be 256, 512, 1024, 2048 or 4096");
+#endif
+
+//Airbrakes_CFG_AltimeterTemperatureRatio check
+#ifndef Airbrakes_CFG_AltimeterTemperatureRatio
+    static_assert(false, "Airbrakes_CFG_AltimeterTemperatureRatio must be defined in the file Airbrakes.cfg.h");
+#else
+    static_assert(Airbrakes_CFG_AltimeterTemperatureRatio > 0, "Airbrakes_CFG_AltimeterTemperatureRatio must be positive");
+#endif
+
+//Airbrakes_CFG_AltimeterHistorySize check
+#ifndef Airbrakes_CFG_AltimeterHistorySize
+    static_assert(false, "Airbrakes_CFG_AltimeterHistorySize must be defined in the file Airbrakes.cfg.h");
+#else
+    static_assert(Airbrakes_CFG_AltimeterHistorySize > 1 && (Airbrakes_CFG_AltimeterHistorySize & (Airbrakes_CFG_AltimeterHistorySize - 1)) == 0, "Airbrakes_CFG_AltimeterHistorySize must be a power of two");
+#endif
+
+//Airbrakes_CFG_AltimeterCalibrationSamples check
+#ifndef Airbrakes_CFG_AltimeterCalibrationSamples
+    static_assert(false, "Airbrakes_CFG_AltimeterCalibrationSamples must be defined in the file Airbrakes.cfg.h");
+#else
+    static_assert(Airbrakes_CFG_AltimeterCalibrationSamples > 0, "Airbrakes_CFG_AltimeterCalibrationSamples must be positive");
+#endif
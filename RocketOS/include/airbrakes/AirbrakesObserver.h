@@ -11,6 +11,39 @@ namespace Airbrakes{
         Sensor, FilteredSimulation, FullSimulation
     };
 
+    /*Observer state
+     * Complete set of observer outputs from one filter update. 
+     * The observer publishes it on the observer topic. The controller, event detection, telemetry, HIL and the shell each read it through
+     * their own subscriber, so none of them sees a mix of two updates or depends on the observer's members.
+    */
+    struct ObserverState{
+        //values used by the controller
+        float_t altitude;
+        float_t verticalVelocity;
+        float_t verticalAcceleration;
+        float_t angleToHorizontal;
+        //raw readings
+        float_t measuredAltitude;
+        float_t measuredPressure;
+        float_t measuredTemperature;
+        float_t measuredVerticalAcceleration;
+        float_t measuredAngleToHorizontal;
+        Sensors::Vector3 measuredLinearAcceleration;
+        Sensors::Vector3 measuredRotation;
+        Sensors::Vector3 measuredGravity;
+        Sensors::Quaternion measuredOrientation;
+        //acquisition times of the readings
+        uint_t altitudeTime_us;
+        uint_t accelerationTime_us;
+        //age of the newest IMU samples at the update
+        uint_t accelerationAge_us;
+        uint_t gravityAge_us;
+        uint_t orientationAge_us;
+    };
+
+    using ObserverTopic_t = RocketOS::Utilities::Topic<ObserverState, Airbrakes_CFG_ObserverTopicDepth>;
+    using ObserverSubscriber_t = RocketOS::Utilities::Subscriber<ObserverState, Airbrakes_CFG_ObserverTopicDepth>;
+
     class Observer{
     public:
         //error codes
@@ -19,9 +52,12 @@ namespace Airbrakes{
     private:
         static constexpr uint_t c_SamplePeriod_us = (Airbrakes_CFG_ObserverAltimeterSamplePeriod_us > Airbrakes_CFG_ObserverIMUSamplePeriod_us)? Airbrakes_CFG_ObserverAltimeterSamplePeriod_us : Airbrakes_CFG_ObserverIMUSamplePeriod_us;
         static constexpr uint_t c_FilterOrder = 2 * Airbrakes_CFG_ObserverFilterDelay_us / c_SamplePeriod_us;
+        //most IMU samples of one stream used per tick, the newest are taken if more arrived
+        static constexpr uint_t c_IMUSamplesPerTick = 16;
         //state
         ObserverModes m_mode;
         IntervalTimer m_timer;
+        RocketOS::Utilities::JitterMonitor m_tickJitter;
 
         //sensors
         Sensors::BNO085_SPI& m_imu;
@@ -29,6 +65,10 @@ namespace Airbrakes{
 
         //processing
         RocketOS::Processing::Differentiator<c_FilterOrder> m_verticalVelocityFilter;
+        RocketOS::Processing::Differentiator<c_FilterOrder> m_elapsedTimeFilter;
+        std::array<uint32_t, c_FilterOrder> m_altitudeTimes_us;
+        uint_t m_altitudeTimeIndex;
+        uint_t m_altitudeTimeCount;
         RocketOS::Processing::LowPass<c_FilterOrder> m_altitudeFilter;
         RocketOS::Processing::LowPass<c_FilterOrder> m_accelerationFilter;
         RocketOS::Processing::LowPass<c_FilterOrder> m_angleFilter;
@@ -50,15 +90,34 @@ namespace Airbrakes{
         Sensors::Quaternion m_measuredOrientation;
         float_t m_measuredAngleToHorizontal;
 
+        //IMU samples read from the histories each tick
+        std::array<Sensors::Sample<Sensors::Vector3>, c_IMUSamplesPerTick> m_vectorSamples;
+        std::array<Sensors::Sample<Sensors::Quaternion>, c_IMUSamplesPerTick> m_orientationSamples;
+
+        //sample freshness, the filters only take readings the sensors have not delivered before
+        bool m_newAltitude, m_newAcceleration, m_newGravity;
+        uint32_t m_altitudeSequence, m_accelerationSequence, m_gravitySequence, m_rotationSequence, m_orientationSequence;
+        //IMU samples that were overwritten or did not fit in a tick before they were used
+        uint32_t m_missedIMUSamples;
+        //IMU samples older than Airbrakes_CFG_ObserverMaxIMUAge_us when they were read, and readings rotated without an orientation close to them
+        uint32_t m_staleIMUSamples;
+        uint32_t m_staleOrientations;
+        uint32_t m_altitudeTime_us, m_accelerationTime_us;
+        //time of the newest IMU sample of each stream, and its age at the last tick
+        uint32_t m_newestAccelerationTime_us, m_newestGravityTime_us, m_newestOrientationTime_us;
+        uint32_t m_accelerationAge_us, m_gravityAge_us, m_orientationAge_us;
+
+        //published state
+        ObserverTopic_t m_output;
+
     public:
         Observer(Sensors::BNO085_SPI&, Sensors::MS5607_SPI&);
         error_t setMode(ObserverModes);
+        RocketOS::Shell::CommandList getCommands() const;
 
-        //controller interface
-        float_t getAltitude() const;
-        float_t getVeritcalVelocity() const;
-        float_t getVerticalAcceleration() const;
-        float_t getAngleToHorizontal() const;
+        //state for the controller, event detection, telemetry, HIL and the shell, published from one context at a time
+        const ObserverTopic_t& getOutputTopic() const;
+        void publishState();
 
         //references for HIL overides
         float_t& getPredictedAltitudeRef();
@@ -69,36 +128,44 @@ namespace Airbrakes{
         float_t& getPredictedAngleRef();
         float_t& getMeasuredAngleRef();
 
-        //read only references for telemetry
-        const float_t& getPredictedAltitudeRef() const;
-        const float_t& getMeasuredAltitudeRef() const;
-        const float_t& getMeasuredTemperatureRef() const;
-        const float_t& getMeasuredPressureRef() const;
-        const float_t& getPredictedVerticalVelocityRef() const;
-        const float_t& getPredictedVerticalAccelerationRef() const;
-        const float_t& getMeasuredVerticalAccelerationRef() const;
-        const Sensors::Vector3& getMeasuredLinearAccelerationRef() const;
-        const float_t& getPredictedAngleRef() const;
-        const float_t& getMeasuredAngleRef() const;
-        const Sensors::Vector3& getMeasuredGravityRef() const;
-        const Sensors::Vector3& getMeasuredRotationRef() const;
-        const Sensors::Quaternion& getMeasuredOrientationRef() const;
-
     private:
         void sensorModeTimerISR();
         void filterSimModeTimerISR();
         error_t setupSensors();
         void updateFilters();
         void readSensors();
+        uint_t readIMU(Sensors::IMUData, uint32_t&, Sensors::Sample<Sensors::Vector3>&, uint32_t&, uint32_t);
+        float_t verticalAcceleration(uint_t);
+        float_t elapsedAltitudeTime_s();
 
     private:
         // ######### command structure #########
         using Command = RocketOS::Shell::Command;
         using CommandList = RocketOS::Shell::CommandList;
         using arg_t = RocketOS::Shell::arg_t;
+        using CommandModes = RocketOS::Shell::CommandModes;
 
-        // === ROOT COMMAND LIST ===
+        // === TIMING COMMAND LIST ===
+        const std::array<Command, 2> c_timingCommands{
+            Command{"", "", [this](arg_t){
+                RocketOS::Console.printf("Tick jitter: %.1fus late, %.1fus early (worst case) over %u ticks\n", m_tickJitter.getMaxLate_us(), m_tickJitter.getMaxEarly_us(), m_tickJitter.getCount());
+                RocketOS::Console.printf("IMU samples missed: %u\n", m_missedIMUSamples);
+                RocketOS::Console.printf("IMU samples rejected as stale: %u, readings without a current orientation: %u\n", m_staleIMUSamples, m_staleOrientations);
+                RocketOS::Console.printf("IMU sample age: acceleration %uus, gravity %uus, orientation %uus\n", m_accelerationAge_us, m_gravityAge_us, m_orientationAge_us);
+            }},
+            Command{"reset", "", [this](arg_t){
+                m_tickJitter.reset();
+                m_missedIMUSamples = 0;
+                m_staleIMUSamples = 0;
+                m_staleOrientations = 0;
+            }, CommandModes::Atomic}
+        };
+        // ===========================
 
+        // === ROOT COMMAND LIST ===
+        const std::array<CommandList, 1> c_rootChildren{
+            CommandList{"timing", c_timingCommands.data(), c_timingCommands.size(), nullptr, 0}
+        };
         // =========================
     };
 }
\ No newline at end of file
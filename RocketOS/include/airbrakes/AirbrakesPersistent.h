@@ -1,15 +1,21 @@
 #pragma once
 #include "RocketOS.h"
+#include "AirbrakesGeneral.h"
 
 namespace Airbrakes{
+    using restoreCallback_t = RocketOS::inplaceFunction_t<void(void), Airbrakes_CFG_PersistentCallbackCaptureSize>;
+
     template<class... T>
     class EEPROMWithCommands : public RocketOS::Persistent::EEPROMBackup<T...>{
     private:
         const char* const m_name;
+        //reapplies settings that were copied into other state when they were first loaded
+        restoreCallback_t m_restored;
 
         using Command = RocketOS::Shell::Command;
         using CommandList = RocketOS::Shell::CommandList;
         using arg_t = RocketOS::Shell::arg_t;
+        using CommandModes = RocketOS::Shell::CommandModes;
         
         // === ROOT COMMAND LIST ===
             //=== RESTORE SUBCOMMAND ===
@@ -17,10 +23,12 @@ namespace Airbrakes{
             const std::array<Command, 2> c_persistentResotreCommands{
                 Command{"", "", [this](arg_t){
                     this->restore();
-                }},
+                    if(m_restored) m_restored();
+                }, CommandModes::Atomic},
                 Command{"defaults", "", [this](arg_t){
                     this->restoreDefaults();
-                }},
+                    if(m_restored) m_restored();
+                }, CommandModes::Atomic},
             };
             //==========================
         //list of subcommands
@@ -40,5 +48,10 @@ namespace Airbrakes{
         RocketOS::Shell::CommandList getCommands() const{
             return {m_name, c_persistentCommands.data(), c_persistentCommands.size(), c_persistentChildren.data(), c_persistentChildren.size()};
         } 
+
+        //called after the restore commands
+        void onRestore(restoreCallback_t callback){
+            m_restored = callback;
+        }
     };
 }
@@ -0,0 +1,42 @@
+#pragma once
+#include "RocketOS.h"
+#include "AirbrakesGeneral.h"
+#include <Arduino.h> //serial printing
+
+namespace Airbrakes{
+    class SPIBusWithCommands : public SPIBus_t{
+    private:
+        const char* const m_name;
+
+    public:
+        SPIBusWithCommands(const char* name, SPIBackend_t& backend) : SPIBus_t(backend), m_name(name) {}
+
+        RocketOS::Shell::CommandList getCommands() const{
+            return {m_name, c_rootCommands.data(), c_rootCommands.size(), nullptr, 0};
+        }
+
+    private:
+        void printStatistics() const{
+            RocketOS::Console.printf("transactions: %u, bytes: %u, async: %u\n", this->getCount(), this->getBytes(), this->getDeferred());
+            RocketOS::Console.printf("overflows: %u, timeouts: %u, pending: %u\n", this->getOverflows(), this->getTimeouts(), this->pending());
+        }
+
+        // ##### COMMAND LIST #####
+        using Command = RocketOS::Shell::Command;
+        using CommandList = RocketOS::Shell::CommandList;
+        using arg_t = RocketOS::Shell::arg_t;
+        using CommandModes = RocketOS::Shell::CommandModes;
+
+        // === ROOT COMMAND LIST ===
+            //list of commands
+            const std::array<Command, 2> c_rootCommands{
+                Command{"", "", [this](arg_t){
+                    printStatistics();
+                }},
+                Command{"reset", "", [this](arg_t){
+                    this->resetStatistics();
+                }, CommandModes::Atomic}
+            };
+        // =========================
+    };
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include "RocketOS.h"
+#include "AirbrakesGeneral.h"
+#include <Arduino.h> //serial printing
+
+namespace Airbrakes{
+    template<std::size_t t_maxTasks>
+    class SchedulerWithCommands : public RocketOS::Scheduler::Dispatcher<t_maxTasks>{
+    private:
+        const char* const m_name;
+
+    public:
+        SchedulerWithCommands(const char* name) : m_name(name) {}
+
+        RocketOS::Shell::CommandList getCommands() const{
+            return {m_name, c_rootCommands.data(), c_rootCommands.size(), nullptr, 0};
+        }
+
+    private:
+        void printTasks() const{
+            RocketOS::Console.println("task        period(us) deadline(us) priority     runs overruns  skipped  last(us)   max(us) late(us)");
+            for(uint_t i=0; i<this->size(); i++){
+                const RocketOS::Scheduler::Task& task = this->getTask(i);
+                const RocketOS::Scheduler::TaskStatistics& statistics = task.statistics;
+                RocketOS::Console.printf("%-11s %10u %12u %8u %8u %8u %8u %9u %9u %8u%s\n", task.name, 
+                    task.timing.period_us, task.timing.deadline_us, task.timing.priority, 
+                    statistics.runs, statistics.overruns, statistics.skipped, 
+                    statistics.lastExecution_us, statistics.maxExecution_us, statistics.maxLateness_us,
+                    task.enabled ? "" : " (stopped)");
+            }
+        }
+
+        // ##### COMMAND LIST #####
+        using Command = RocketOS::Shell::Command;
+        using CommandList = RocketOS::Shell::CommandList;
+        using arg_t = RocketOS::Shell::arg_t;
+
+        // === ROOT COMMAND LIST ===
+            //list of commands
+            const std::array<Command, 2> c_rootCommands{
+                Command{"", "", [this](arg_t){
+                    printTasks();
+                }},
+                Command{"reset", "", [this](arg_t){
+                    this->resetStatistics();
+                }}
+            };
+        // =========================
+    };
+}
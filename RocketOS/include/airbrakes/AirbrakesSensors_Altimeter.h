@@ -1,6 +1,8 @@
 #pragma once
 #include "RocketOS.h"
 #include "AirbrakesGeneral.h"
+#include "AirbrakesSensors_Sample.h"
+#include "AirbrakesSensors_SampleHistory.h"
 #include <TeensyTimerTool.h>
 
 namespace Airbrakes{
@@ -11,41 +13,111 @@ namespace Airbrakes{
                 Standby, Blocking, Async
             };
         public:
+            enum class CalibrationStates{
+                Idle, Running, Complete, Failed
+            };
+
             static constexpr error_t ERROR_NotInitialized = error_t(2);
             static constexpr error_t ERROR_NotResponsive = error_t(3);
-        private:
+            static constexpr error_t ERROR_Calibrating = error_t(4);
+            static constexpr error_t ERROR_Busy = error_t(5);
             static constexpr uint_t c_numCalibrationCoefficients = 8;
+            static constexpr uint_t c_maxCalibrationSamples = Airbrakes_CFG_AltimeterCalibrationSamples;
+
+            //compensated reading, temperature in hundredths of a degree celsius
+            struct Compensated{
+                int32_t temperature_cC;
+                int32_t pressure_pa;
+            };
+
+            //progress and result of the last ground calibration, spread is the robust standard deviation of the pressure readings
+            struct Calibration{
+                CalibrationStates state;
+                uint_t collected;
+                uint_t target;
+                uint_t rejected;
+                float_t spread_pa;
+            };
+
+            using History_t = SampleHistory<float_t, Airbrakes_CFG_AltimeterHistorySize>;
+        private:
+            static constexpr uint_t c_ADCReadLength = 4;
             const char* const m_name;
+            const RocketOS::Processing::StandardAtmosphere<>& m_atmosphere;
+            SPIBus_t& m_bus;
             std::array<uint16_t, c_numCalibrationCoefficients> m_calibrationCoeffieicents;
+            std::array<uint8_t, c_ADCReadLength> m_rxBuffer;
             uint32_t m_temperatureADC;
             uint32_t m_pressureADC;
             uint_t m_SPIFrequency;
+            uint_t m_pressureOSR;
+            uint_t m_temperatureOSR;
+            //pressure conversions per temperature conversion
+            uint_t m_temperatureRatio;
+            uint_t m_temperatureCountdown;
+            volatile bool m_continuous;
             TeensyTimerTool::OneShotTimer m_timer;
             AltimeterStates m_state;
-            bool m_newData;
+            //which conversion the asynchronous update is waiting on
+            bool m_convertingPressure;
+            //start of the running pressure conversion and the time each reading is stamped with
+            uint32_t m_conversionStart_us;
+            uint32_t m_pressureTime_us;
+            volatile uint32_t m_sampleTime_us;
+            volatile uint32_t m_sequence;
+            //results of the last published sample, computed once when it is published
             float_t m_pressure_pa;
             float_t m_temperature_k;
             float_t m_altitude_m;
+            //every published sample, for consumers that need more than the newest
+            History_t m_pressureHistory;
+            History_t m_altitudeHistory;
+            RocketOS::Utilities::CycleTimer m_compensationTimer;
             float_t m_groundLevelTemperature_k;
             float_t m_groundLevelPressure_pa;
+            //ground calibration, readings are collected by publishSample and reduced from the main loop
+            std::array<Compensated, c_maxCalibrationSamples> m_calibrationReadings;
+            volatile CalibrationStates m_calibrationState;
+            volatile uint_t m_calibrationCount;
+            uint_t m_calibrationTarget;
+            uint_t m_calibrationRejected;
+            float_t m_calibrationSpread_pa;
+            uint32_t m_calibrationStart_us;
+            uint32_t m_calibrationTimeout_us;
         public:
             //interface
-            MS5607_SPI(const char*, float_t, float_t, uint_t, TeensyTimerTool::TimerGenerator*);
+            MS5607_SPI(const char*, const RocketOS::Processing::StandardAtmosphere<>&, SPIBus_t&, float_t, float_t, uint_t, uint_t, uint_t, uint_t, TeensyTimerTool::TimerGenerator*);
             error_t initialize();
             bool initialized() const;
             error_t updateBlocking();
             void updateAsync();
+            void setContinuous(bool);
+            error_t setPressureOSR(uint_t);
+            error_t setTemperatureOSR(uint_t);
+            error_t setTemperatureRatio(uint_t);
             result_t<float_t> getNewPressure();
             result_t<float_t> getNewTemperature();
             result_t<float_t> getNewAltitude();
-            float_t getLastPressure();
-            float_t getLastTemperature();
-            float_t getLastAltitude();
+            float_t getLastPressure() const;
+            float_t getLastTemperature() const;
+            float_t getLastAltitude() const;
+            Sample<float_t> getAltitudeSample() const;
+            Sample<float_t> getPressureSample() const;
+            const History_t& getPressureHistory() const;
+            const History_t& getAltitudeHistory() const;
             error_t zero();
+            error_t startCalibration(uint_t);
+            void cancelCalibration();
+            void updateCalibration();
+            Calibration getCalibration() const;
             RocketOS::Shell::CommandList getCommands();
+            static Compensated compensate(const std::array<uint16_t, c_numCalibrationCoefficients>&, uint32_t, uint32_t);
 
             //references for persistent
             uint_t& getSPIFrequencyRef();
+            uint_t& getPressureOSRRef();
+            uint_t& getTemperatureOSRRef();
+            uint_t& getTemperatureRatioRef();
             float_t& getGroundPressureRef();
             float_t& getGroundTemperatureRef();
         private:
@@ -53,14 +125,21 @@ namespace Airbrakes{
             result_t<uint16_t> getCalibrationCoefficient(uint_t n);
             void markAsUninitialized();
 
-            void beginPressureConversion();
-            void beginTemperatureConversion();
-            error_t readPressureVal();
-            error_t readTemperatureVal();
-            void asyncStep1();
-            void asyncStep2();
-
-            void updateOutputValues();
+            RocketOS::Utilities::SPITransaction makeTransaction(const uint8_t*, uint8_t*, uint16_t) const;
+            error_t command(const uint8_t*);
+            error_t readADC();
+            result_t<uint32_t> parseADC() const;
+            error_t storePressureVal();
+            error_t storeTemperatureVal();
+            void startCycle();
+            error_t submitConversion();
+            uint32_t conversionTime_us() const;
+            void asyncConversionStarted();
+            void asyncConversionDone();
+            void asyncReadDone();
+            void publishSample();
+            void finishCalibration();
+            void printCalibration() const;
 
 
         private:
@@ -68,6 +147,7 @@ namespace Airbrakes{
             using Command = RocketOS::Shell::Command;
             using CommandList = RocketOS::Shell::CommandList;
             using arg_t = RocketOS::Shell::arg_t;
+            using CommandModes = RocketOS::Shell::CommandModes;
 
             // === ROOT COMMAND LIST ===
                 //child command lists
@@ -75,12 +155,14 @@ namespace Airbrakes{
                     //commands
                     const std::array<Command, 2> c_initCommands{
                         Command{"get", "", [this](arg_t){
-                            if(initialized()) Serial.println("Initialized");
-                            else Serial.println("Uninitialized");
+                            if(initialized()) RocketOS::Console.println("Initialized");
+                            else RocketOS::Console.println("Uninitialized");
                         }},
                         Command{"", "", [this](arg_t){
-                            if(initialize() != error_t::GOOD) Serial.println("Failed to initialize");
-                            else Serial.println("Sucesfully initialized");
+                            error_t result = initialize();
+                            if(result == ERROR_Busy) RocketOS::Console.println("Altimeter busy, stop the observer and try again");
+                            else if(result != error_t::GOOD) RocketOS::Console.println("Failed to initialize");
+                            else RocketOS::Console.println("Sucesfully initialized");
                         }}
                     };
                 // =========================
@@ -89,8 +171,8 @@ namespace Airbrakes{
                     //commands
                     const std::array<Command, 2> c_speedCommands{
                         Command{"", "", [this](arg_t){
-                            Serial.print(m_SPIFrequency);
-                            Serial.println("Hz");
+                            RocketOS::Console.print(m_SPIFrequency);
+                            RocketOS::Console.println("Hz");
                         }},
                         Command{"set", "u", [this](arg_t args){
                             uint_t newFrequency = args[0].getUnsignedData();
@@ -98,46 +180,102 @@ namespace Airbrakes{
                         }}
                     };
                 // ==========================
+
+                // === OSR COMMAND LIST ===
+                    //commands
+                    const std::array<Command, 3> c_OSRCommands{
+                        Command{"", "", [this](arg_t){
+                            RocketOS::Console.printf("pressure: %u, temperature: %u\n", m_pressureOSR, m_temperatureOSR);
+                        }},
+                        Command{"pressure", "u", [this](arg_t args){
+                            if(setPressureOSR(args[0].getUnsignedData()) != error_t::GOOD) RocketOS::Console.println("OSR must be 256, 512, 1024, 2048 or 4096");
+                        }},
+                        Command{"temperature", "u", [this](arg_t args){
+                            if(setTemperatureOSR(args[0].getUnsignedData()) != error_t::GOOD) RocketOS::Console.println("OSR must be 256, 512, 1024, 2048 or 4096");
+                        }}
+                    };
+                // ========================
+
+                // === RATIO COMMAND LIST ===
+                    //commands
+                    const std::array<Command, 2> c_ratioCommands{
+                        Command{"", "", [this](arg_t){
+                            RocketOS::Console.printf("1 temperature per %u pressure conversions\n", m_temperatureRatio);
+                        }},
+                        Command{"set", "u", [this](arg_t args){
+                            if(setTemperatureRatio(args[0].getUnsignedData()) != error_t::GOOD) RocketOS::Console.println("Ratio must be positive");
+                        }}
+                    };
+                // ==========================
+
+                // === CALIBRATION COMMAND LIST ===
+                    //commands
+                    const std::array<Command, 3> c_calibrationCommands{
+                        Command{"", "", [this](arg_t){
+                            printCalibration();
+                        }},
+                        Command{"start", "u", [this](arg_t args){
+                            uint_t samples = args[0].getUnsignedData();
+                            error_t error = startCalibration(samples);
+                            if(error == error_t::GOOD) RocketOS::Console.printf("Calibrating over %u readings\n", samples);
+                            else if(error == ERROR_NotInitialized) RocketOS::Console.println("Altimeter is not initialized");
+                            else if(error == ERROR_Calibrating) RocketOS::Console.println("A calibration is already running");
+                            else RocketOS::Console.printf("Readings must be between 1 and %u\n", c_maxCalibrationSamples);
+                        }},
+                        Command{"cancel", "", [this](arg_t){
+                            cancelCalibration();
+                        }}
+                    };
+                // ================================
                 //command list
-                const std::array<CommandList, 2> c_rootCommandList{
+                const std::array<CommandList, 5> c_rootCommandList{
                     CommandList{"init", c_initCommands.data(), c_initCommands.size(), nullptr, 0},
-                    CommandList{"speed", c_speedCommands.data(), c_speedCommands.size(), nullptr, 0}
+                    CommandList{"speed", c_speedCommands.data(), c_speedCommands.size(), nullptr, 0},
+                    CommandList{"osr", c_OSRCommands.data(), c_OSRCommands.size(), nullptr, 0},
+                    CommandList{"ratio", c_ratioCommands.data(), c_ratioCommands.size(), nullptr, 0},
+                    CommandList{"calibration", c_calibrationCommands.data(), c_calibrationCommands.size(), nullptr, 0}
                 };
                 //commands
-                const std::array<Command, 4> c_rootCommands{
+                const std::array<Command, 6> c_rootCommands{
                     Command{"pressure", "", [this](arg_t){
                         result_t<float_t> result = getNewPressure();
                         if(result.error == error_t::GOOD){ 
-                            Serial.print(result.data);
-                            Serial.println("pa");
+                            RocketOS::Console.print(result.data);
+                            RocketOS::Console.println("pa");
                         }
-                        else if(result.error == error_t(2)) Serial.println("Altimeter is not initialized");
-                        else Serial.println("Error reading from altimeter");
+                        else if(result.error == error_t(2)) RocketOS::Console.println("Altimeter is not initialized");
+                        else RocketOS::Console.println("Error reading from altimeter");
                     }},
                     Command{"temperature", "", [this](arg_t){
                         result_t<float_t> result = getNewTemperature();
                         if(result.error == error_t::GOOD){ 
-                            Serial.print(result.data);
-                            Serial.println("K");
+                            RocketOS::Console.print(result.data);
+                            RocketOS::Console.println("K");
                         }
-                        else if(result.error == error_t(2)) Serial.println("Altimeter is not initialized");
-                        else Serial.println("Error reading from altimeter");
+                        else if(result.error == error_t(2)) RocketOS::Console.println("Altimeter is not initialized");
+                        else RocketOS::Console.println("Error reading from altimeter");
                     }},
                     Command{"altitude", "", [this](arg_t){
                         result_t<float_t> result = getNewAltitude();
                         if(result.error == error_t::GOOD){ 
-                            Serial.print(result.data);
-                            Serial.println("m");
+                            RocketOS::Console.print(result.data);
+                            RocketOS::Console.println("m");
                         }
-                        else if(result.error == error_t(2)) Serial.println("Altimeter is not initialized");
-                        else Serial.println("Error reading from altimeter");
+                        else if(result.error == error_t(2)) RocketOS::Console.println("Altimeter is not initialized");
+                        else RocketOS::Console.println("Error reading from altimeter");
+                    }},
+                    Command{"history", "", [this](arg_t){
+                        RocketOS::Console.printf("Pressure - %u/%u samples, %u bytes\n", m_pressureHistory.size(), m_pressureHistory.capacity(), History_t::footprint());
+                        RocketOS::Console.printf("Altitude - %u/%u samples, %u bytes\n", m_altitudeHistory.size(), m_altitudeHistory.capacity(), History_t::footprint());
+                    }},
+                    Command{"timing", "", [this](arg_t){
+                        RocketOS::Console.printf("compensation: %.2fus last, %.2fus max over %u readings\n", m_compensationTimer.getLast_us(), m_compensationTimer.getMax_us(), m_compensationTimer.getCount());
                     }},
                     Command{"zero", "", [this](arg_t){
                         error_t error = zero();
-                        if(error != error_t::GOOD){
-                            if(error == error_t(2)) Serial.println("Altimeter is not initialized");
-                            else Serial.println("Error reading from altimeter");
-                        }
+                        if(error == error_t::GOOD) RocketOS::Console.printf("Calibrating over %u readings, 'calibration' shows progress\n", c_maxCalibrationSamples);
+                        else if(error == ERROR_NotInitialized) RocketOS::Console.println("Altimeter is not initialized");
+                        else RocketOS::Console.println("A calibration is already running");
                     }}
                 };
             // =========================
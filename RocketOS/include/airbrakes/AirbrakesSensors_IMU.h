@@ -1,6 +1,9 @@
 #pragma once
 #include "AirbrakesGeneral.h"
 #include "RocketOS.h"
+#include "AirbrakesSensors_Sample.h"
+#include "AirbrakesSensors_SampleHistory.h"
+#include "AirbrakesSensors_Vector.h"
 #include <SPI.h>
 #include <array>
 #include <TeensyTimerTool.h>
@@ -20,24 +23,14 @@ namespace Airbrakes{
             Orientation, AngularVelocity, LinearAcceleration, Gravity
         };
 
-        struct Vector3{
-            float_t x; 
-            float_t y; 
-            float_t z;
-
-            void print() const;
-            void println() const;
-            float_t magnitude() const;
-        };
-
-        struct Quaternion{
-            float_t r;
-            float_t i;
-            float_t j;
-            float_t k;
-
-            void print() const;
-            void println() const;
+        //how current one sensor stream is, times are micros()
+        struct IMUFreshness{
+            uint32_t age_us;            //since the newest sample was taken
+            uint32_t latency_us;        //from the newest sample being taken to its packet arriving
+            uint32_t maxLatency_us;
+            uint32_t missedReports;     //gaps in the hub's report sequence numbers
+            uint32_t stalls;            //times the running stream went stale
+            bool stale;
         };
 
         class BNO085_SPI{
@@ -52,6 +45,16 @@ namespace Airbrakes{
 
             using txCallback_t = RocketOS::inplaceFunction_t<SHTPHeader(void), Airbrakes_CFG_IMUTxCallbackCaptureSize>;
 
+            //one entry of the receive dispatch table, reports are looked up by channel and report ID
+            //dataType only matters for the sensor reports, a null decoder skips the report
+            struct SHTPReport{
+                uint8_t channel;
+                uint8_t reportID;
+                uint8_t length;
+                IMUData dataType;
+                void (BNO085_SPI::*decode)(const uint8_t*, IMUData);
+            };
+
         private:
             //error codes
             static constexpr error_t ERROR_HeaderLength = error_t(5);
@@ -59,21 +62,44 @@ namespace Airbrakes{
             static constexpr error_t ERROR_RxBufferOverflow = error_t(7);
             static constexpr error_t ERROR_ContinuationPacket = error_t(8);
         public:
+            using VectorHistory_t = SampleHistory<Vector3, Airbrakes_CFG_IMUHistorySize>;
+            using OrientationHistory_t = SampleHistory<Quaternion, Airbrakes_CFG_IMUHistorySize>;
 
         private:
             //constants
             static constexpr uint_t c_numSHTPChannels = 6;
+            static constexpr uint_t c_numIMUData = 4;
+            static const std::array<SHTPReport, 9> c_reports;
 
             //data
             const char* const m_name;
+            DeferredWork_t& m_deferredWork;
+            SPIBus_t& m_bus;
+            //set from the interrupt that starts an exchange until the deferred work has handled the received packet
+            volatile bool m_servicePending;
+            //time of the interrupt being serviced and of the newest sensor report it delivered
+            volatile uint32_t m_serviceTime_us;
+            uint32_t m_packetTime_us;
+            //hub time of the reports in the packet being decoded, set by its timebase and rebase records
+            uint32_t m_timebase_us;
+            volatile uint32_t m_lastReportTime_us;
             uint_t m_SPIFrequency;
             IMUStates m_state;
             bool m_resetComplete, m_hubInitialized, m_waking;
+            volatile bool m_configurePending;
             std::array<uint8_t, Airbrakes_CFG_IMUBufferSize> m_rxBuffer;
             std::array<uint8_t, Airbrakes_CFG_IMUBufferSize> m_txBuffer;
+            //state of the running exchange, owned by whichever context the bus runs it in
+            std::array<uint8_t, 4> m_rxHeaderBytes;
+            std::array<uint8_t, 4> m_txHeaderBytes;
+            SHTPHeader m_txHeader;
+            SHTPHeader m_rxHeader;
+            bool m_doTx;
+            bool m_rxValid;
+            uint16_t m_rxOverflow;
             std::array<uint8_t, c_numSHTPChannels> m_sequenceNumbers;
             uint8_t m_tareSequenceNumber;
-            RocketOS::Utilities::Queue<txCallback_t, Airbrekes_CFG_IMUTxQueueSize> m_txQueue;
+            RocketOS::Utilities::SPSCQueue<txCallback_t, Airbrekes_CFG_IMUTxQueueSize> m_txQueue;
             elapsedMicros m_wakeTimer;
             uint_t m_wakeTime;
 
@@ -83,16 +109,37 @@ namespace Airbrakes{
             Quaternion m_currentOrientation;
             IMUSensorStatus m_linearAccelerationStatus, m_angularVelocityStatus, m_gravityStatus, m_orientationStatus;
             uint32_t m_linearAccelerationSamplePeriod_us, m_angularVelocitySamplePeriod_us, m_gravitySamplePeriod_us, m_orientationSamplePeriod_us;
+            //longest the hub may hold reports before interrupting, 0 reports every sample as it is taken
+            uint32_t m_batchInterval_us;
+            //time and count of the reports of each data type, indexed by IMUData
+            std::array<uint32_t, c_numIMUData> m_reportTimes_us;
+            std::array<uint32_t, c_numIMUData> m_reportSequences;
+            //report freshness, indexed by IMUData, the hub numbers each stream's reports and a skipped number is a lost report
+            std::array<uint8_t, c_numIMUData> m_hubSequences;
+            std::array<bool, c_numIMUData> m_hubSequenceValid;
+            std::array<uint32_t, c_numIMUData> m_reportLatencies_us;
+            std::array<uint32_t, c_numIMUData> m_maxReportLatencies_us;
+            std::array<uint32_t, c_numIMUData> m_missedReports;
+            uint32_t m_totalMissedReports;
+            //stall tracking, updated by updateBackground
+            std::array<bool, c_numIMUData> m_stale;
+            std::array<uint32_t, c_numIMUData> m_stalls;
+            //every decoded report in order, appended by the deferred work
+            VectorHistory_t m_linearAccelerationHistory;
+            VectorHistory_t m_angularVelocityHistory;
+            VectorHistory_t m_gravityHistory;
+            OrientationHistory_t m_orientationHistory;
 
         public:
             //interface
-            BNO085_SPI(const char*, uint_t, uint32_t);
+            BNO085_SPI(const char*, DeferredWork_t&, SPIBus_t&, uint_t, uint32_t, uint32_t);
             error_t initialize();
             void updateBackground();
             IMUStates getState() const;
             RocketOS::Shell::CommandList getCommands();
             void setSamplePeriod_us(uint32_t, IMUData);
             void setSamplePeriod_us(uint32_t);
+            void setBatchInterval_us(uint32_t);
             void stopSensor(IMUData);
             void stopAllSensors();
             void startSensor(IMUData);
@@ -104,6 +151,17 @@ namespace Airbrakes{
             Vector3 getLastAngularVelocity() const;
             Vector3 getLastGravity() const;
             Quaternion getLastOrientation() const;
+            uint32_t getLastReportTime_us() const;
+            Sample<Vector3> getLinearAccelerationSample() const;
+            Sample<Vector3> getAngularVelocitySample() const;
+            Sample<Vector3> getGravitySample() const;
+            Sample<Quaternion> getOrientationSample() const;
+            const VectorHistory_t& getHistory(IMUData) const;
+            const OrientationHistory_t& getOrientationHistory() const;
+            IMUFreshness getFreshness(IMUData) const;
+            bool isStale(IMUData, uint32_t) const;
+            uint32_t getStaleLimit_us(IMUData) const;
+            void resetFreshness();
 
             //references for persistent & telemetry
             uint_t& getSPIFrequencyRef();
@@ -111,30 +169,39 @@ namespace Airbrakes{
             uint32_t& getAngularVelocitySamplePeriodRef();
             uint32_t& getOrientationSamplePeriodRef();
             uint32_t& getGravitySamplePeriodRef();
+            uint32_t& getBatchIntervalRef();
 
             const Vector3& getAccelerationRef() const;
             const Vector3& getAngularVelocitryRef() const;
             const Vector3& getGravityRef() const;
             const Quaternion& getOrientationRef() const;
+            const uint32_t& getMissedReportsRef() const;
         private:
 
             //helpers
             void resetAsync();
             void wakeAsync();
-            void serviceInterrupt();
+            bool beginExchange(const RocketOS::Utilities::InterruptEvent&);
+            void exchangeHeader();
+            void exchangePayload();
+            void finishExchange();
+            void printInterruptStatus() const;
             void debugPrintRx(SHTPHeader, bool = true);
             void debugPrintTx(SHTPHeader, bool = true);
 
             //SHTP communication
-            result_t<SHTPHeader> doSHTP(SHTPHeader);
+            RocketOS::Utilities::SPITransaction makeTransaction(const uint8_t*, uint8_t*, uint16_t, bool) const;
 
             //packet handling
-            void respondToPacket(SHTPHeader);   
-            bool handleInitializeResponse(SHTPHeader);
-            bool handleResetComplete(SHTPHeader);
-            bool handleFeatureResponse(IMUData, SHTPHeader);
-            bool handleVectorReport(IMUData, SHTPHeader);
-            bool handleOrientationReport(SHTPHeader);
+            void respondToPacket(SHTPHeader);
+            static const SHTPReport* findReport(uint8_t, uint8_t);
+            void decodeInitializeResponse(const uint8_t*, IMUData);
+            void decodeResetComplete(const uint8_t*, IMUData);
+            void decodeFeatureResponse(const uint8_t*, IMUData);
+            void decodeTimebase(const uint8_t*, IMUData);
+            void decodeRebase(const uint8_t*, IMUData);
+            void decodeVectorReport(const uint8_t*, IMUData);
+            void decodeOrientationReport(const uint8_t*, IMUData);
 
             //configuration
             SHTPHeader generateFeatureCommand(IMUData, uint32_t);
@@ -150,9 +217,24 @@ namespace Airbrakes{
 
             static uint8_t getReportID(IMUData);
             uint_t& getSamplePeriod(IMUData);
+            uint_t getSamplePeriod(IMUData) const;
             IMUSensorStatus& getStatus(IMUData);
+            IMUSensorStatus getStatus(IMUData) const;
             static uint_t getQPoint(IMUData);
             Vector3& getVector(IMUData);
+            VectorHistory_t& getVectorHistory(IMUData);
+            uint32_t getReportTime(const uint8_t*) const;
+            uint32_t stampReport(IMUData, uint32_t);
+            void trackReport(const uint8_t*, IMUData, uint32_t);
+            void printFreshness(const char*, IMUData) const;
+            template<class T>
+            Sample<T> makeSample(const T& value, IMUData dataType) const{
+                //reports are stored by the deferred work, so copy the value, time and sequence together
+                noInterrupts();
+                Sample<T> sample{value, m_reportTimes_us[static_cast<uint_t>(dataType)], m_reportSequences[static_cast<uint_t>(dataType)]};
+                interrupts();
+                return sample;
+            }
 
             uint_t getMaxSamplePeriod() const;
 
@@ -169,7 +251,7 @@ namespace Airbrakes{
                     const std::array<Command, 4> c_accelerationCommands{
                         Command{"", "", [this](arg_t){
                             m_currentLinearAcceleration.print();
-                            Serial.println("m/s^2");
+                            RocketOS::Console.println("m/s^2");
                         }},
                         Command{"period", "u", [this](arg_t args){
                             uint_t newPeriod = args[0].getUnsignedData();
@@ -208,7 +290,7 @@ namespace Airbrakes{
                     const std::array<Command, 4> c_rotationCommands{
                         Command{"", "", [this](arg_t){
                             m_currentAngularVelocity.print();
-                            Serial.println("rad/s");
+                            RocketOS::Console.println("rad/s");
                         }},
                         Command{"period", "u", [this](arg_t args){
                             uint_t newPeriod = args[0].getUnsignedData();
@@ -228,7 +310,7 @@ namespace Airbrakes{
                     const std::array<Command, 4> c_gravityCommands{
                         Command{"", "", [this](arg_t){
                             m_currentGravity.print();
-                            Serial.println("m/s^2");
+                            RocketOS::Console.println("m/s^2");
                         }},
                         Command{"period", "u", [this](arg_t args){
                             uint_t newPeriod = args[0].getUnsignedData();
@@ -247,10 +329,10 @@ namespace Airbrakes{
                     //command list
                     const std::array<Command, 2> c_periodCommands = {
                         Command{"", "", [this](arg_t){
-                            Serial.printf("Linear Acceleration - %dus\n", m_linearAccelerationSamplePeriod_us);
-                            Serial.printf("Angular Velocity - %dus\n", m_angularVelocitySamplePeriod_us);
-                            Serial.printf("Orientation - %dus\n", m_orientationSamplePeriod_us);
-                            Serial.printf("Gravity - %dus\n", m_gravitySamplePeriod_us);
+                            RocketOS::Console.printf("Linear Acceleration - %dus\n", m_linearAccelerationSamplePeriod_us);
+                            RocketOS::Console.printf("Angular Velocity - %dus\n", m_angularVelocitySamplePeriod_us);
+                            RocketOS::Console.printf("Orientation - %dus\n", m_orientationSamplePeriod_us);
+                            RocketOS::Console.printf("Gravity - %dus\n", m_gravitySamplePeriod_us);
                         }},
                         Command{"set", "u", [this](arg_t args){
                                 uint_t newPeriod = args[0].getUnsignedData();
@@ -263,7 +345,7 @@ namespace Airbrakes{
                     //commands
                     const std::array<Command, 2> c_speedCommands{
                         Command{"", "", [this](arg_t){
-                            Serial.printf("%dHz\n", m_SPIFrequency);
+                            RocketOS::Console.printf("%dHz\n", m_SPIFrequency);
                         }},
                         Command{"set", "u", [this](arg_t args){
                             uint_t newFrequency = args[0].getUnsignedData();
@@ -271,42 +353,82 @@ namespace Airbrakes{
                         }}
                     };
                 // =====================
+
+                // === BATCH COMMAND ===
+                    //commands
+                    const std::array<Command, 2> c_batchCommands{
+                        Command{"", "", [this](arg_t){
+                            RocketOS::Console.printf("%uus\n", m_batchInterval_us);
+                        }},
+                        Command{"set", "u", [this](arg_t args){
+                            uint32_t newInterval = args[0].getUnsignedData();
+                            setBatchInterval_us(newInterval);
+                        }}
+                    };
+                // =====================
+
+                // === FRESHNESS COMMAND ===
+                    //commands
+                    const std::array<Command, 2> c_freshnessCommands{
+                        Command{"", "", [this](arg_t){
+                            printFreshness("Linear Acceleration", IMUData::LinearAcceleration);
+                            printFreshness("Angular Velocity", IMUData::AngularVelocity);
+                            printFreshness("Orientation", IMUData::Orientation);
+                            printFreshness("Gravity", IMUData::Gravity);
+                        }},
+                        Command{"reset", "", [this](arg_t){
+                            resetFreshness();
+                        }}
+                    };
+                // =========================
                 //sub command list
-                const std::array<CommandList, 6> c_rootCommandList{
+                const std::array<CommandList, 8> c_rootCommandList{
                     CommandList{"acceleration", c_accelerationCommands.data(), c_accelerationCommands.size(), nullptr, 0},
                     CommandList{"orientation", c_orientationCommands.data(), c_orientationCommands.size(), nullptr, 0},
                     CommandList{"rotation", c_rotationCommands.data(), c_rotationCommands.size(), nullptr, 0},
                     CommandList{"gravity", c_gravityCommands.data(), c_gravityCommands.size(), nullptr, 0},
                     CommandList{"periods", c_periodCommands.data(), c_periodCommands.size(), nullptr, 0},
-                    CommandList{"speed", c_speedCommands.data(), c_speedCommands.size(), nullptr, 0}
+                    CommandList{"speed", c_speedCommands.data(), c_speedCommands.size(), nullptr, 0},
+                    CommandList{"batch", c_batchCommands.data(), c_batchCommands.size(), nullptr, 0},
+                    CommandList{"freshness", c_freshnessCommands.data(), c_freshnessCommands.size(), nullptr, 0}
                 };
                 //commands
-                const std::array<Command, 3> c_rootCommands{
+                const std::array<Command, 4> c_rootCommands{
                     Command{"status", "", [this](arg_t){
                         IMUStates state = getState();
-                        if(state == IMUStates::Uninitialized) Serial.println("Uninitialized");
-                        if(state == IMUStates::Reseting) Serial.println("Reseting");
-                        if(state == IMUStates::Configuring) Serial.println("Configuring");
-                        if(state == IMUStates::Operational) Serial.println("Operational");
+                        if(state == IMUStates::Uninitialized) RocketOS::Console.println("Uninitialized");
+                        if(state == IMUStates::Reseting) RocketOS::Console.println("Reseting");
+                        if(state == IMUStates::Configuring) RocketOS::Console.println("Configuring");
+                        if(state == IMUStates::Operational) RocketOS::Console.println("Operational");
                         auto printStatus = [](IMUSensorStatus status){
-                            if(status == IMUSensorStatus::Disabled) Serial.print("Disabled");
-                            if(status == IMUSensorStatus::Unreliable) Serial.print("Unreliable");
-                            if(status == IMUSensorStatus::LowAccuracy) Serial.print("Low Accuracy");
-                            if(status == IMUSensorStatus::ModerateAccuracy) Serial.print("Moderate Accuracy");
-                            if(status == IMUSensorStatus::HighAccuracy) Serial.print("High Accuracy");
+                            if(status == IMUSensorStatus::Disabled) RocketOS::Console.print("Disabled");
+                            if(status == IMUSensorStatus::Unreliable) RocketOS::Console.print("Unreliable");
+                            if(status == IMUSensorStatus::LowAccuracy) RocketOS::Console.print("Low Accuracy");
+                            if(status == IMUSensorStatus::ModerateAccuracy) RocketOS::Console.print("Moderate Accuracy");
+                            if(status == IMUSensorStatus::HighAccuracy) RocketOS::Console.print("High Accuracy");
                         };
-                        Serial.print("Linear Acceleration - ");
+                        RocketOS::Console.print("Linear Acceleration - ");
                         printStatus(m_linearAccelerationStatus);
-                        Serial.printf(", %.2fHz\n", 1000000.0 / m_linearAccelerationSamplePeriod_us);
-                        Serial.print("Angular Velocity - ");
+                        RocketOS::Console.printf(", %.2fHz\n", 1000000.0 / m_linearAccelerationSamplePeriod_us);
+                        RocketOS::Console.print("Angular Velocity - ");
                         printStatus(m_angularVelocityStatus);
-                        Serial.printf(", %.2fHz\n", 1000000.0 / m_angularVelocitySamplePeriod_us);
-                        Serial.print("Orientation - ");
+                        RocketOS::Console.printf(", %.2fHz\n", 1000000.0 / m_angularVelocitySamplePeriod_us);
+                        RocketOS::Console.print("Orientation - ");
                         printStatus(m_orientationStatus);
-                        Serial.printf(", %.2fHz\n", 1000000.0 / m_orientationSamplePeriod_us);
-                        Serial.print("Gravity - ");
+                        RocketOS::Console.printf(", %.2fHz\n", 1000000.0 / m_orientationSamplePeriod_us);
+                        RocketOS::Console.print("Gravity - ");
                         printStatus(m_gravityStatus);
-                        Serial.printf(", %.2fHz\n", 1000000.0 / m_gravitySamplePeriod_us);
+                        RocketOS::Console.printf(", %.2fHz\n", 1000000.0 / m_gravitySamplePeriod_us);
+                        printInterruptStatus();
+                    }},
+                    Command{"history", "", [this](arg_t){
+                        auto printHistory = [](const char* name, uint_t size, uint_t capacity, uint_t footprint){
+                            RocketOS::Console.printf("%s - %u/%u samples, %u bytes\n", name, size, capacity, footprint);
+                        };
+                        printHistory("Linear Acceleration", m_linearAccelerationHistory.size(), m_linearAccelerationHistory.capacity(), VectorHistory_t::footprint());
+                        printHistory("Angular Velocity", m_angularVelocityHistory.size(), m_angularVelocityHistory.capacity(), VectorHistory_t::footprint());
+                        printHistory("Orientation", m_orientationHistory.size(), m_orientationHistory.capacity(), OrientationHistory_t::footprint());
+                        printHistory("Gravity", m_gravityHistory.size(), m_gravityHistory.capacity(), VectorHistory_t::footprint());
                     }},
                     Command{"tare", "", [this](arg_t){
                         tare();
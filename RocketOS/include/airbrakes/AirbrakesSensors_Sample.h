@@ -0,0 +1,17 @@
+#pragma once
+#include "AirbrakesGeneral.h"
+
+namespace Airbrakes{
+    namespace Sensors{
+        /*Sensor sample
+         * A reading together with the micros() time it was acquired at and the number of readings taken before it.
+         * The sequence only changes when the sensor delivers a new reading, so a consumer can tell a fresh sample from one it has already used.
+        */
+        template<class T>
+        struct Sample{
+            T value;
+            uint32_t time_us;
+            uint32_t sequence;
+        };
+    }
+}
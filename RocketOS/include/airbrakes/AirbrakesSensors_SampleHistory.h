@@ -0,0 +1,123 @@
+#pragma once
+#include "AirbrakesGeneral.h"
+#include "AirbrakesSensors_Sample.h"
+#include <array>
+#include <atomic>
+
+namespace Airbrakes{
+    namespace Sensors{
+        /*Sample history
+         * The last t_size samples of one sensor stream, oldest overwritten first.
+         * One producer appends in O(1) from the driver's context. Any number of consumers read without removing anything, so the
+         * observer, telemetry and the shell can each take what they need from the same stream.
+         *
+         * Appends are counted by a free running index that the producer publishes with a release store after writing the slot.
+         * A reader copies a slot and then checks the index again: if the producer has come round to that slot in the meantime the copy
+         * may be torn and is dropped. Readers never block the producer and interrupts are never masked. The slot the next append
+         * goes to can be mid-write at any time, so t_size - 1 samples are readable.
+         *
+         * Samples are appended in time order, each with a higher sequence than the one before. Sequences and times may wrap, the
+         * append count is not expected to (2^32 samples is months at the IMU rate).
+         * t_size must be a power of two.
+        */
+        template<class T, std::size_t t_size>
+        class SampleHistory{
+        private:
+            static_assert(t_size > 1 && (t_size & (t_size - 1)) == 0, "SampleHistory size must be a power of two");
+            static constexpr uint32_t c_mask = t_size - 1;
+            static constexpr uint32_t c_readable = t_size - 1;
+            std::array<Sample<T>, t_size> m_data;
+            std::atomic<uint32_t> m_count;
+        public:
+            SampleHistory() : m_count(0) {}
+
+            // --- producer side ---
+            void append(const Sample<T>& sample){
+                uint32_t count = m_count.load(std::memory_order_relaxed);
+                m_data[count & c_mask] = sample;
+                m_count.store(count + 1, std::memory_order_release);
+            }
+
+            //only while no consumer is reading
+            void clear(){
+                m_count.store(0, std::memory_order_release);
+            }
+
+            // --- consumer side ---
+            result_t<Sample<T>> latest() const{
+                uint32_t count = m_count.load(std::memory_order_acquire);
+                Sample<T> sample;
+                if(count == 0 || !copy(count - 1, sample)) return error_t::ERROR;
+                return sample;
+            }
+
+            //copies the samples with a sequence after the given one, oldest first, returns the number copied
+            //if there are more than fit, the newest ones are kept, a gap to the sequence means the history was overwritten
+            uint_t since(uint32_t sequence, Sample<T>* samples, uint_t maximum) const{
+                uint32_t count = m_count.load(std::memory_order_acquire);
+                uint32_t available = (count < c_readable)? count : c_readable;
+                //walk back from the newest to find the first sample after the sequence
+                uint32_t first = count;
+                while(count - first < available && count - first < maximum){
+                    Sample<T> sample;
+                    if(!copy(first - 1, sample) || static_cast<int32_t>(sample.sequence - sequence) <= 0) break;
+                    first--;
+                }
+                uint_t copied = 0;
+                for(uint32_t index = first; index != count; index++){
+                    if(!copy(index, samples[copied])) continue;
+                    copied++;
+                }
+                return copied;
+            }
+
+            //the sample taken closest to the given micros() time
+            result_t<Sample<T>> nearest(uint32_t time_us) const{
+                uint32_t count = m_count.load(std::memory_order_acquire);
+                uint32_t available = (count < c_readable)? count : c_readable;
+                result_t<Sample<T>> best = error_t::ERROR;
+                uint32_t bestDistance = UINT32_MAX;
+                //samples are in time order, so stop once they get further away again
+                for(uint32_t age = 1; age <= available; age++){
+                    Sample<T> sample;
+                    if(!copy(count - age, sample)) break;
+                    int32_t difference = static_cast<int32_t>(sample.time_us - time_us);
+                    uint32_t distance = (difference < 0)? -static_cast<uint32_t>(difference) : difference;
+                    if(distance > bestDistance) break;
+                    bestDistance = distance;
+                    best = sample;
+                }
+                return best;
+            }
+
+            //samples currently held
+            uint_t size() const{
+                uint32_t count = m_count.load(std::memory_order_acquire);
+                return (count < c_readable)? count : c_readable;
+            }
+
+            constexpr uint_t capacity() const{
+                return c_readable;
+            }
+
+            //samples appended since the last clear
+            uint32_t getCount() const{
+                return m_count.load(std::memory_order_acquire);
+            }
+
+            static constexpr std::size_t footprint(){
+                return sizeof(SampleHistory);
+            }
+
+        private:
+            //copies the sample with the given append index, false if it was overwritten before or during the copy
+            bool copy(uint32_t index, Sample<T>& sample) const{
+                //the producer writes slot count & mask before publishing count + 1, so index is safe while count - index < t_size
+                if(m_count.load(std::memory_order_acquire) - index >= t_size) return false;
+                sample = m_data[index & c_mask];
+                std::atomic_thread_fence(std::memory_order_acquire);
+                return m_count.load(std::memory_order_relaxed) - index < t_size;
+            }
+        };
+    }
+}
@@ -0,0 +1,121 @@
+#pragma once
+#include "AirbrakesGeneral.h"
+#include "RocketOS.h"
+
+namespace Airbrakes{
+    namespace Sensors{
+        struct Vector3{
+            float_t x;
+            float_t y;
+            float_t z;
+
+            void print() const;
+            void println() const;
+            float_t magnitude() const;
+        };
+
+        struct Quaternion{
+            float_t r;
+            float_t i;
+            float_t j;
+            float_t k;
+
+            void print() const;
+            void println() const;
+        };
+
+        /*Vector math
+         * Fixed size kernels for the IMU readings, written out per component so they compile to straight line FPU code.
+         * Orientations are unit quaternions that rotate body frame vectors into the world frame (the BNO085 rotation vector), the
+         * world frame has z pointing up. normalize() brings a quaternion back to unit length after quantization or accumulation.
+         * The square roots and angles use the kernels Airbrakes_CFG_ObserverFastMath selects for the observer.
+        */
+        namespace VectorMath{
+        #if Airbrakes_CFG_ObserverFastMath
+            namespace Kernels = RocketOS::Processing::FastMath;
+        #else
+            namespace Kernels = RocketOS::Processing::StandardMath;
+        #endif
+
+            inline Vector3 add(const Vector3& a, const Vector3& b){
+                return Vector3{a.x + b.x, a.y + b.y, a.z + b.z};
+            }
+
+            inline Vector3 scale(const Vector3& v, float_t s){
+                return Vector3{v.x * s, v.y * s, v.z * s};
+            }
+
+            inline float_t dot(const Vector3& a, const Vector3& b){
+                return a.x * b.x + a.y * b.y + a.z * b.z;
+            }
+
+            inline Vector3 cross(const Vector3& a, const Vector3& b){
+                return Vector3{a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x};
+            }
+
+            //zero stays zero
+            inline Vector3 normalize(const Vector3& v){
+                float_t squared = dot(v, v);
+                if(squared <= 0) return v;
+                return scale(v, Kernels::rsqrt(squared));
+            }
+
+            inline Quaternion conjugate(const Quaternion& q){
+                return Quaternion{q.r, -q.i, -q.j, -q.k};
+            }
+
+            //a * b applies b first, then a
+            inline Quaternion multiply(const Quaternion& a, const Quaternion& b){
+                return Quaternion{
+                    a.r * b.r - a.i * b.i - a.j * b.j - a.k * b.k,
+                    a.r * b.i + a.i * b.r + a.j * b.k - a.k * b.j,
+                    a.r * b.j - a.i * b.k + a.j * b.r + a.k * b.i,
+                    a.r * b.k + a.i * b.j - a.j * b.i + a.k * b.r
+                };
+            }
+
+            //the zero quaternion becomes the identity
+            inline Quaternion normalize(const Quaternion& q){
+                float_t squared = q.r * q.r + q.i * q.i + q.j * q.j + q.k * q.k;
+                if(squared <= 0) return Quaternion{1, 0, 0, 0};
+                float_t inverse = Kernels::rsqrt(squared);
+                return Quaternion{q.r * inverse, q.i * inverse, q.j * inverse, q.k * inverse};
+            }
+
+            //q * v * q', expanded as v + r * t + u x t with u = (i, j, k) and t = 2 * u x v (18 multiplies instead of 32)
+            inline Vector3 rotate(const Quaternion& q, const Vector3& v){
+                float_t tx = 2 * (q.j * v.z - q.k * v.y);
+                float_t ty = 2 * (q.k * v.x - q.i * v.z);
+                float_t tz = 2 * (q.i * v.y - q.j * v.x);
+                return Vector3{
+                    v.x + q.r * tx + q.j * tz - q.k * ty,
+                    v.y + q.r * ty + q.k * tx - q.i * tz,
+                    v.z + q.r * tz + q.i * ty - q.j * tx
+                };
+            }
+
+            //world frame vector into the body frame
+            inline Vector3 rotateInverse(const Quaternion& q, const Vector3& v){
+                return rotate(conjugate(q), v);
+            }
+
+            //vertical (world z) part of a body frame vector, the last row of the rotation matrix
+            inline float_t rotateVertical(const Quaternion& q, const Vector3& v){
+                return 2 * (q.i * q.k - q.r * q.j) * v.x + 2 * (q.j * q.k + q.r * q.i) * v.y + (1 - 2 * (q.i * q.i + q.j * q.j)) * v.z;
+            }
+
+            //angle of a vector above the horizontal plane in radians, zero for the zero vector
+            //atan2 rather than asin(z / |v|), which loses the square root's precision near vertical
+            inline float_t elevation(const Vector3& v){
+                return Kernels::atan2(v.z, Kernels::sqrt(v.x * v.x + v.y * v.y));
+            }
+
+            //rotation angle of a unit quaternion in radians, [0, pi]
+            inline float_t angle(const Quaternion& q){
+                float_t vector = Kernels::sqrt(q.i * q.i + q.j * q.j + q.k * q.k);
+                float_t real = (q.r < 0)? -q.r : q.r;
+                return 2 * Kernels::atan2(vector, real);
+            }
+        }
+    }
+}
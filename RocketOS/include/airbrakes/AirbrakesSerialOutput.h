@@ -0,0 +1,43 @@
+#pragma once
+#include "RocketOS.h"
+#include "AirbrakesGeneral.h"
+#include "RocketOSSerial.h"
+
+namespace Airbrakes{
+    template<std::size_t t_numLanes>
+    class SerialOutputWithCommands : public RocketOS::SerialOutput<t_numLanes>{
+    private:
+        const char* const m_name;
+
+    public:
+        SerialOutputWithCommands(const char* name, const std::array<RocketOS::OutputLane*, t_numLanes>& lanes) : RocketOS::SerialOutput<t_numLanes>(lanes), m_name(name) {}
+
+        RocketOS::Shell::CommandList getCommands() const{
+            return {m_name, c_rootCommands.data(), c_rootCommands.size(), nullptr, 0};
+        }
+
+    private:
+        void printStatistics() const{
+            RocketOS::Console.println("lane       written   dropped  buffered      peak      size");
+            for(const RocketOS::OutputLane* lane : this->getLanes())
+                RocketOS::Console.printf("%-8s %9u %9u %9u %9u %9u\n", lane->getName(), lane->getWritten(), lane->getDropped(), lane->getBuffered(), lane->getPeak(), lane->getSize());
+        }
+
+        // ##### COMMAND LIST #####
+        using Command = RocketOS::Shell::Command;
+        using CommandList = RocketOS::Shell::CommandList;
+        using arg_t = RocketOS::Shell::arg_t;
+
+        // === ROOT COMMAND LIST ===
+            //list of commands
+            const std::array<Command, 2> c_rootCommands{
+                Command{"", "", [this](arg_t){
+                    printStatistics();
+                }},
+                Command{"reset", "", [this](arg_t){
+                    for(RocketOS::OutputLane* lane : this->getLanes()) lane->resetStatistics();
+                }}
+            };
+        // =========================
+    };
+}
@@ -62,7 +62,7 @@ namespace Airbrakes{
                 //list of local commands
                 const std::array<Command, 2> c_nameCommands{
                     Command{"", "", [this](arg_t){
-                        Serial.println(m_fileName.data());
+                        RocketOS::Console.println(m_fileName.data());
                     }},
                     Command{"set", "s", [this](arg_t args){
                         args[0].copyStringData(m_fileName.data(), m_fileName.size());
@@ -74,8 +74,8 @@ namespace Airbrakes{
                 //list of local commands
                 const std::array<Command, 3> c_modeCommands{
                     Command{"", "", [this](arg_t){
-                        if(this->getMode() == RocketOS::Telemetry::SDFileModes::Buffer) Serial.println("Buffer");
-                        else Serial.println("Record");
+                        if(this->getMode() == RocketOS::Telemetry::SDFileModes::Buffer) RocketOS::Console.println("Buffer");
+                        else RocketOS::Console.println("Record");
                     }},
                     Command{"buffer", "", [this](arg_t){
                         this->setMode(RocketOS::Telemetry::SDFileModes::Buffer);
@@ -89,8 +89,8 @@ namespace Airbrakes{
             // === OVERRIDE SUBCOMMAND ===
                 const std::array<Command, 3> c_overrideCommands{
                     Command{"", "", [this](arg_t){
-                        if(m_enableOverride) Serial.println("log is disabled");
-                        else Serial.println("log is enabled");
+                        if(m_enableOverride) RocketOS::Console.println("log is disabled");
+                        else RocketOS::Console.println("log is enabled");
                     }},
                     Command{"set", "", [this](arg_t){
                         m_enableOverride = true;
@@ -188,7 +188,7 @@ namespace Airbrakes{
                 //list of local commands
                 const std::array<Command, 2> c_nameCommands{
                     Command{"", "", [this](arg_t){
-                        Serial.println(m_fileName.data());
+                        RocketOS::Console.println(m_fileName.data());
                     }},
                     Command{"set", "s", [this](arg_t args){
                         args[0].copyStringData(m_fileName.data(), m_fileName.size());
@@ -200,8 +200,8 @@ namespace Airbrakes{
                 //list of local commands
                 const std::array<Command, 3> c_modeCommands{
                     Command{"", "", [this](arg_t){
-                        if(this->getFileMode() == RocketOS::Telemetry::SDFileModes::Buffer) Serial.println("Buffer");
-                        else Serial.println("Record");
+                        if(this->getFileMode() == RocketOS::Telemetry::SDFileModes::Buffer) RocketOS::Console.println("Buffer");
+                        else RocketOS::Console.println("Record");
                     }},
                     Command{"buffer", "", [this](arg_t){
                         this->setFileMode(RocketOS::Telemetry::SDFileModes::Buffer);
@@ -216,8 +216,8 @@ namespace Airbrakes{
                 //list of commands
                 const std::array<Command, 2> c_refreshCommands{
                     Command{"", "", [this](arg_t){
-                        Serial.print(m_refreshPeriod);
-                        Serial.println(" ms");
+                        RocketOS::Console.print(m_refreshPeriod);
+                        RocketOS::Console.println(" ms");
                     }},
                     Command{"set", "u", [this](arg_t args){
                         this->m_refreshPeriod = args[0].getUnsignedData();
@@ -228,8 +228,8 @@ namespace Airbrakes{
             // === OVERRIDE SUBCOMMAND ===
                 const std::array<Command, 3> c_overrideCommands{
                     Command{"", "", [this](arg_t){
-                        if(m_enableOverride) Serial.println("Telemetry is disabled");
-                        else Serial.println("Telemetry is enabled");
+                        if(m_enableOverride) RocketOS::Console.println("Telemetry is disabled");
+                        else RocketOS::Console.println("Telemetry is enabled");
                     }},
                     Command{"set", "", [this](arg_t){
                         m_enableOverride = true;
@@ -1 +1,12 @@
-#pragma once
\ No newline at end of file
+#pragma once
+/*RocketOS Processing Configuration File----------------------------
+ * This file is used to configure the Processing module of RocketOS.
+*/
+
+/*Atmosphere Parameters
+ * These macros parameterize the standard atmosphere lookup tables (see RocketOS_ProcessingAtmosphere.h).
+ * Macros:
+ * RocketOS_Processing_AtmosphereTableSize - Number of samples in each atmosphere table. Each table uses 4 bytes per sample. Interpolation error falls with the square of this value.
+ * 
+*/
+#define RocketOS_Processing_AtmosphereTableSize 512
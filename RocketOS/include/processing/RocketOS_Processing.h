@@ -3,4 +3,7 @@
 #include "RocketOS_ProcessingGeneral.h"
 #include "RocketOS_ProcessingFilters.h"  
 #include "RocketOS_ProcessingDerivative.h"
-#include "RocketOS_ProcessingLowPass.h"
\ No newline at end of file
+#include "RocketOS_ProcessingLowPass.h"
+#include "RocketOS_ProcessingLookupTable.h"
+#include "RocketOS_ProcessingAtmosphere.h"
+#include "RocketOS_ProcessingFastMath.h"
\ No newline at end of file
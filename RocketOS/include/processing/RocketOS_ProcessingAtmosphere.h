@@ -0,0 +1,87 @@
+#pragma once
+#include "RocketOS_ProcessingGeneral.h"
+#include "RocketOS_ProcessingLookupTable.h"
+#include <cmath>
+
+/* Standard Atmosphere
+ * International Standard Atmosphere (troposphere) model served from lookup tables instead of calls to pow.
+ * 
+ * Both ISA relations only depend on the ground conditions through a scale factor:
+ *      density(h)  = p0 * M / (R * T0) * (1 - L * h / T0)^(g * M / (R * L) - 1)
+ *      altitude(p) = T0 / L * ((p / p0)^(-R * L / (g * M)) - 1)
+ * so the tables hold the normalized functions (1 - x)^(gM/RL - 1) and r^(-RL/gM) - 1. 
+ * They are built once at startup and stay valid when the ground pressure or temperature change, which makes one instance shareable by every user.
+ * Lookups cost a division, a few multiplies and one table interpolation. Inputs outside of the tables fall back to the closed form model.
+ * 
+ * Table ranges & accuracy with the default 512 samples (linear interpolation bound, see RocketOS_ProcessingLookupTable.h):
+ *      density:  L*h/T0 from -0.05 to 0.3 (about -2km to 13km at 15C), relative error < 2e-6
+ *      altitude: p/p0 from 0.2 to 1.2 (about -1.5km to 12km at 15C), error < 0.0004% of T0/L (< 0.2m at 12km, < 0.01m below 1km)
+ * Both bounds are below the resolution of single precision floats over most of the range.
+*/
+
+namespace RocketOS{
+    namespace Processing{
+
+        template<std::size_t t_size = RocketOS_Processing_AtmosphereTableSize>
+        class StandardAtmosphere{
+        public:
+            //natural constants
+            static constexpr double c_lapseRate = 0.0065;         //unit: K/m
+            static constexpr double c_gravity = 9.80665;          //unit: m/s^2
+            static constexpr double c_gasConstant = 8.31446;      //unit: J/mol/K
+            static constexpr double c_molarMass = 0.0289652;      //unit: kg/mol
+        private:
+            static constexpr double c_densityExponent = c_gravity * c_molarMass / (c_gasConstant * c_lapseRate) - 1;
+            static constexpr double c_altitudeExponent = -c_gasConstant * c_lapseRate / (c_gravity * c_molarMass);
+            //table ranges
+            static constexpr float_t c_minimumNormalizedAltitude = -0.05;
+            static constexpr float_t c_maximumNormalizedAltitude = 0.3;
+            static constexpr float_t c_minimumPressureRatio = 0.2;
+            static constexpr float_t c_maximumPressureRatio = 1.2;
+
+            LookupTable<t_size> m_densityTable;
+            LookupTable<t_size> m_altitudeTable;
+        public:
+            StandardAtmosphere() : 
+                m_densityTable(normalizedDensity, c_minimumNormalizedAltitude, c_maximumNormalizedAltitude),
+                m_altitudeTable(normalizedAltitude, c_minimumPressureRatio, c_maximumPressureRatio) {}
+
+            float_t density(float_t altitude, float_t groundPressure, float_t groundTemperature) const{
+                float_t inverseTemperature = 1 / groundTemperature;
+                float_t x = static_cast<float_t>(c_lapseRate) * altitude * inverseTemperature;
+                float_t scale = groundPressure * static_cast<float_t>(c_molarMass / c_gasConstant) * inverseTemperature;
+                if(!m_densityTable.contains(x)) return scale * normalizedDensity(x);
+                return scale * m_densityTable(x);
+            }
+
+            float_t altitude(float_t pressure, float_t groundPressure, float_t groundTemperature) const{
+                float_t ratio = pressure / groundPressure;
+                float_t scale = groundTemperature * static_cast<float_t>(1 / c_lapseRate);
+                if(!m_altitudeTable.contains(ratio)) return scale * normalizedAltitude(ratio);
+                return scale * m_altitudeTable(ratio);
+            }
+
+            //closed form model (reference for the tables)
+            static float_t exactDensity(float_t altitude, float_t groundPressure, float_t groundTemperature){
+                return groundPressure * c_molarMass / (c_gasConstant * groundTemperature) * normalizedDensity(c_lapseRate * altitude / groundTemperature);
+            }
+
+            static float_t exactAltitude(float_t pressure, float_t groundPressure, float_t groundTemperature){
+                return groundTemperature / c_lapseRate * normalizedAltitude(pressure / groundPressure);
+            }
+
+            constexpr uint_t size() const{
+                return t_size;
+            }
+
+        private:
+            static float_t normalizedDensity(float_t x){
+                return std::pow(1 - static_cast<double>(x), c_densityExponent);
+            }
+
+            static float_t normalizedAltitude(float_t ratio){
+                return std::pow(static_cast<double>(ratio), c_altitudeExponent) - 1;
+            }
+        };
+    }
+}
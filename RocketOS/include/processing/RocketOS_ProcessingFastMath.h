@@ -0,0 +1,243 @@
+#pragma once
+#include "RocketOS_ProcessingGeneral.h"
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+/* Fast Math Kernels
+ * Range reduced polynomial approximations of the transcendental functions used in the control path.
+ * The kernels only use multiplies, adds and at most one division or sqrt, so they avoid the errno handling and double precision
+ * fallbacks of libm and have a short, fixed cost on the single precision FPU.
+ *
+ * The functions are templated on the floating point type but the polynomials are single precision,
+ * so using them with double gives single precision accuracy.
+ *
+ * Maximum error over the stated range (measured against double precision libm):
+ *      sin, cos:   |x| <= 1e4           absolute error < 1e-7
+ *      asin:       |x| <= 1             absolute error < 2e-7, inputs outside [-1, 1] are clamped
+ *      atan:       all x                absolute error < 1.5e-7
+ *      atan2:      all (y, x)           absolute error < 3e-7, atan2(0, 0) = 0
+ *      rsqrt:      normal x > 0         relative error < 5e-6 (2 newton iterations)
+ *      sqrt:       normal x >= 0        relative error < 5e-6, sqrt(0) = 0
+ *      log:        normal x > 0         absolute error < 5e-8 on [0.5, 2], relative error < 1e-7 elsewhere
+ *      exp:        |x| <= 87            relative error < 1e-7
+ *      pow:        x > 0                relative error < 1e-7 + 1.5e-7 * |y * log(x)|
+ * pow is exp(y * log(x)) in single precision. The relative errors of log and of the rounded product both become absolute errors of
+ * the exponent, which exp turns back into relative error, so the error grows with |y * log(x)| at about 1.4e-7 per unit.
+ * sqrt is x * rsqrt(x). On cores with a hardware square root (Cortex-M7) std::sqrt is as fast and exact, so only use it where
+ * the reciprocal is also needed.
+ *
+ * The StandardMath namespace wraps the matching std:: functions under the same names so callers can switch between the two
+ * with a namespace alias.
+*/
+
+namespace RocketOS{
+    namespace Processing{
+        namespace FastMath{
+            namespace Internal{
+                constexpr float c_pi = 3.14159265358979f;
+                constexpr float c_halfPi = 1.57079632679490f;
+                constexpr float c_quarterPi = 0.785398163397448f;
+                constexpr float c_twoOverPi = 0.636619772367581f;
+                //pi/2 split so k * c_halfPiHigh is exact for the supported range (Cody-Waite reduction)
+                constexpr float c_halfPiHigh = 1.5703125f;
+                constexpr float c_halfPiMiddle = 4.83751296997070e-4f;
+                constexpr float c_halfPiLow = 7.54978995489e-8f;
+                //ln(2) split the same way
+                constexpr float c_ln2High = 0.693359375f;
+                constexpr float c_ln2Low = -2.12194440e-4f;
+                constexpr float c_log2e = 1.44269504088896f;
+                constexpr float c_sqrtHalf = 0.707106781186548f;
+
+                //minimax polynomials on [-pi/4, pi/4]
+                inline float sinKernel(float x){
+                    float z = x * x;
+                    return x + x * z * (-1.6666654611e-1f + z * (8.3321608736e-3f + z * -1.9515295891e-4f));
+                }
+
+                inline float cosKernel(float x){
+                    float z = x * x;
+                    return 1.0f - 0.5f * z + z * z * (4.166664568298827e-2f + z * (-1.388731625493765e-3f + z * 2.443315711809948e-5f));
+                }
+
+                //asin(x) = x + x * z * P(z) on [0, 0.5], z = x^2
+                inline float asinKernel(float x){
+                    float z = x * x;
+                    return x + x * z * ((((4.2163199048e-2f * z + 2.4181311049e-2f) * z + 4.5470025998e-2f) * z + 7.4953002686e-2f) * z + 1.6666752422e-1f);
+                }
+
+                //atan(x) on [-tan(pi/8), tan(pi/8)]
+                inline float atanKernel(float x){
+                    float z = x * x;
+                    return x + x * z * (((8.05374449538e-2f * z - 1.38776856032e-1f) * z + 1.99777106478e-1f) * z - 3.33329491539e-1f);
+                }
+
+                inline uint32_t bits(float x){
+                    uint32_t i;
+                    std::memcpy(&i, &x, sizeof(i));
+                    return i;
+                }
+
+                inline float fromBits(uint32_t i){
+                    float x;
+                    std::memcpy(&x, &i, sizeof(x));
+                    return x;
+                }
+
+                //round to nearest without going through libm
+                inline int32_t roundToInt(float x){
+                    return static_cast<int32_t>(x < 0 ? x - 0.5f : x + 0.5f);
+                }
+
+                //returns the quadrant of x and stores the reduced argument in [-pi/4, pi/4]
+                inline int32_t reduce(float x, float& reduced){
+                    int32_t quadrant = roundToInt(x * c_twoOverPi);
+                    float k = static_cast<float>(quadrant);
+                    reduced = ((x - k * c_halfPiHigh) - k * c_halfPiMiddle) - k * c_halfPiLow;
+                    return quadrant;
+                }
+            }
+
+            template<class T>
+            T sin(T x){
+                float r;
+                switch(Internal::reduce(static_cast<float>(x), r) & 3){
+                    case 0: return Internal::sinKernel(r);
+                    case 1: return Internal::cosKernel(r);
+                    case 2: return -Internal::sinKernel(r);
+                    default: return -Internal::cosKernel(r);
+                }
+            }
+
+            template<class T>
+            T cos(T x){
+                float r;
+                switch(Internal::reduce(static_cast<float>(x), r) & 3){
+                    case 0: return Internal::cosKernel(r);
+                    case 1: return -Internal::sinKernel(r);
+                    case 2: return -Internal::cosKernel(r);
+                    default: return Internal::sinKernel(r);
+                }
+            }
+
+            template<class T>
+            T rsqrt(T x){
+                float f = static_cast<float>(x);
+                float y = Internal::fromBits(0x5f375a86 - (Internal::bits(f) >> 1));
+                float half = 0.5f * f;
+                y = y * (1.5f - half * y * y);
+                y = y * (1.5f - half * y * y);
+                return y;
+            }
+
+            template<class T>
+            T sqrt(T x){
+                if(x <= 0) return 0;
+                return x * rsqrt(x);
+            }
+
+            template<class T>
+            T asin(T x){
+                float f = static_cast<float>(x);
+                float a = f < 0 ? -f : f;
+                if(a > 1.0f) a = 1.0f;
+                float r;
+                if(a > 0.5f){
+                    //asin(a) = pi/2 - 2 * asin(sqrt((1 - a) / 2))
+                    float z = 0.5f * (1.0f - a);
+                    r = Internal::c_halfPi - 2.0f * Internal::asinKernel(std::sqrt(z));
+                }
+                else{
+                    r = Internal::asinKernel(a);
+                }
+                return f < 0 ? -r : r;
+            }
+
+            template<class T>
+            T atan(T x){
+                float f = static_cast<float>(x);
+                float a = f < 0 ? -f : f;
+                float r;
+                if(a > 2.414213562373095f)          //tan(3pi/8)
+                    r = Internal::c_halfPi + Internal::atanKernel(-1.0f / a);
+                else if(a > 0.4142135623730950f)    //tan(pi/8)
+                    r = Internal::c_quarterPi + Internal::atanKernel((a - 1.0f) / (a + 1.0f));
+                else
+                    r = Internal::atanKernel(a);
+                return f < 0 ? -r : r;
+            }
+
+            template<class T>
+            T atan2(T y, T x){
+                float fy = static_cast<float>(y);
+                float fx = static_cast<float>(x);
+                if(fx == 0.0f){
+                    if(fy > 0) return Internal::c_halfPi;
+                    if(fy < 0) return -Internal::c_halfPi;
+                    return 0;
+                }
+                float r = atan(fy / fx);
+                if(fx > 0) return r;
+                return fy < 0 ? r - Internal::c_pi : r + Internal::c_pi;
+            }
+
+            template<class T>
+            T log(T x){
+                float f = static_cast<float>(x);
+                if(!(f > 0)) return -INFINITY;
+                //split into mantissa in [sqrt(1/2), sqrt(2)) and exponent
+                uint32_t i = Internal::bits(f);
+                int32_t e = static_cast<int32_t>((i >> 23) & 0xff) - 126;
+                float m = Internal::fromBits((i & 0x007fffff) | 0x3f000000);
+                if(m < Internal::c_sqrtHalf){
+                    e -= 1;
+                    m = m + m - 1.0f;
+                }
+                else{
+                    m = m - 1.0f;
+                }
+                float z = m * m;
+                float p = ((((((((7.0376836292e-2f * m - 1.1514610310e-1f) * m + 1.1676998740e-1f) * m - 1.2420140846e-1f) * m + 1.4249322787e-1f) * m - 1.6668057665e-1f) * m + 2.0000714765e-1f) * m - 2.4999993993e-1f) * m + 3.3333331174e-1f) * m * z;
+                float fe = static_cast<float>(e);
+                p += Internal::c_ln2Low * fe;
+                p -= 0.5f * z;
+                return m + p + Internal::c_ln2High * fe;
+            }
+
+            template<class T>
+            T exp(T x){
+                float f = static_cast<float>(x);
+                if(f > 88.0f) return INFINITY;
+                if(f < -87.0f) return 0;
+                int32_t k = Internal::roundToInt(f * Internal::c_log2e);
+                float n = static_cast<float>(k);
+                f = (f - n * Internal::c_ln2High) - n * Internal::c_ln2Low;
+                float z = f * f;
+                float r = (((((1.9875691500e-4f * f + 1.3981999507e-3f) * f + 8.3334519073e-3f) * f + 4.1665795894e-2f) * f + 1.6666665459e-1f) * f + 5.0000001201e-1f) * z + f + 1.0f;
+                //scale by 2^n, split in two so n = 128 does not overflow the exponent field
+                int32_t half = k / 2;
+                r *= Internal::fromBits(static_cast<uint32_t>(half + 127) << 23);
+                return r * Internal::fromBits(static_cast<uint32_t>(k - half + 127) << 23);
+            }
+
+            template<class T>
+            T pow(T x, T y){
+                if(x <= 0) return std::pow(x, y);
+                return exp(y * log(x));
+            }
+        }
+
+        namespace StandardMath{
+            template<class T> T sin(T x){ return std::sin(x); }
+            template<class T> T cos(T x){ return std::cos(x); }
+            template<class T> T asin(T x){ return std::asin(x); }
+            template<class T> T atan(T x){ return std::atan(x); }
+            template<class T> T atan2(T y, T x){ return std::atan2(y, x); }
+            template<class T> T sqrt(T x){ return std::sqrt(x); }
+            template<class T> T rsqrt(T x){ return 1 / std::sqrt(x); }
+            template<class T> T log(T x){ return std::log(x); }
+            template<class T> T exp(T x){ return std::exp(x); }
+            template<class T> T pow(T x, T y){ return std::pow(x, y); }
+        }
+    }
+}
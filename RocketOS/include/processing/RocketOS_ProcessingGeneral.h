@@ -1,3 +1,16 @@
 #pragma once
 #include "RocketOS_Processing.cfg.h"
-#include "RocketOSGeneral.h"
\ No newline at end of file
+#include "RocketOSGeneral.h"
+
+/*Configuration Validity Checks
+ * These are compile time checks that ensure all configuration macros are exist and are valid.
+ * If a macro is missing or invalid a compilation error will be thrown.
+ *
+*/
+
+//RocketOS_Processing_AtmosphereTableSize check
+#ifndef RocketOS_Processing_AtmosphereTableSize
+    static_assert(false, "RocketOS_Processing_AtmosphereTableSize must be defined in the file RocketOS_Processing.cfg.h");
+#else
+    static_assert(RocketOS_Processing_AtmosphereTableSize > 1, "RocketOS_Processing_AtmosphereTableSize must be greater than 1");
+#endif
@@ -0,0 +1,84 @@
+#pragma once
+#include "RocketOS_ProcessingGeneral.h"
+#include <array>
+
+/* Uniform Lookup Table
+ * Samples a function at evenly spaced points once and serves linearly interpolated values afterwards.
+ * A lookup costs one multiply to find the index plus one multiply-add to interpolate, so it is much cheaper than most transcendental functions.
+ * 
+ * The interpolation error is bounded by step^2 / 8 * max|f''| over the table range (step = (end - start) / (size - 1)).
+ * Inputs outside of the table range are clamped to the first and last samples, use contains() to detect them.
+ * 
+ * Tables of strictly increasing samples can also be searched backwards with inverse(), which finds the bracketing samples by
+ * binary search and inverts the same linear interpolation, so inverse(table(x)) == x up to rounding inside the table range.
+*/
+
+namespace RocketOS{
+    namespace Processing{
+
+        template<std::size_t t_size>
+        class LookupTable{
+        private:
+            static_assert(t_size > 1, "A lookup table needs at least 2 samples");
+            std::array<float_t, t_size> m_values;
+            float_t m_start;
+            float_t m_end;
+            float_t m_inverseStep;
+        public:
+            LookupTable() : m_values{}, m_start(0), m_end(0), m_inverseStep(0) {}
+
+            template<class T_function>
+            LookupTable(T_function function, float_t start, float_t end){
+                build(function, start, end);
+            }
+
+            template<class T_function>
+            void build(T_function function, float_t start, float_t end){
+                m_start = start;
+                m_end = end;
+                m_inverseStep = (t_size - 1) / (end - start);
+                for(uint_t i=0; i<t_size; i++)
+                    m_values[i] = function(start + (end - start) * i / (t_size - 1));
+            }
+
+            float_t operator()(float_t x) const{
+                float_t position = (x - m_start) * m_inverseStep;
+                if(position <= 0) return m_values.front();
+                if(position >= t_size - 1) return m_values.back();
+                uint_t index = static_cast<uint_t>(position);
+                float_t fraction = position - index;
+                return m_values[index] + fraction * (m_values[index + 1] - m_values[index]);
+            }
+
+            float_t inverse(float_t y) const{
+                if(y <= m_values.front()) return m_start;
+                if(y >= m_values.back()) return m_end;
+                uint_t low = 0;
+                uint_t high = t_size - 1;
+                while(high - low > 1){
+                    uint_t middle = (low + high) / 2;
+                    if(m_values[middle] <= y) low = middle;
+                    else high = middle;
+                }
+                float_t fraction = (y - m_values[low]) / (m_values[high] - m_values[low]);
+                return m_start + (low + fraction) / m_inverseStep;
+            }
+
+            bool contains(float_t x) const{
+                return x >= m_start && x <= m_end;
+            }
+
+            float_t start() const{
+                return m_start;
+            }
+
+            float_t end() const{
+                return m_end;
+            }
+
+            constexpr uint_t size() const{
+                return t_size;
+            }
+        };
+    }
+}
@@ -0,0 +1,13 @@
+#pragma once
+/*RocketOS Scheduler Configuration File----------------------------
+ * This file is used to configure the Scheduler module of RocketOS.
+ * The scheduler dispatches cooperative periodic and one-shot tasks from a single time base.
+*/
+
+/*Task Parameters
+ * These macros parameterize the tasks of the scheduler.
+ * Macros:
+ * RocketOS_Scheduler_TaskCallbackCaptureSize - Determines the max size of the data (in bytes) task callbacks can capture.
+ * 
+*/
+#define RocketOS_Scheduler_TaskCallbackCaptureSize 4
@@ -0,0 +1,6 @@
+#pragma once
+
+#include "RocketOS_SchedulerGeneral.h"
+#include "RocketOS_SchedulerClock.h"
+#include "RocketOS_SchedulerTask.h"
+#include "RocketOS_SchedulerDispatcher.h"
@@ -0,0 +1,42 @@
+#pragma once
+#include "RocketOS_SchedulerGeneral.h"
+#include <Arduino.h>
+
+/*Scheduler Clocks
+ * The scheduler reads time through a clock class given as a template parameter. A clock only needs a now_us() member returning a 
+ * free running 32 bit microsecond count. Wrap around is handled by the scheduler, so the count may overflow.
+ * 
+ * MicrosClock - Hardware time base from micros().
+ * SimulatedClock - Time only moves when advance() or set() is called. Tasks can advance it to model their own execution time, which
+ *                  makes schedules reproducible on a host build.
+*/
+
+namespace RocketOS{
+    namespace Scheduler{
+        class MicrosClock{
+        public:
+            uint32_t now_us() const{
+                return micros();
+            }
+        };
+
+        class SimulatedClock{
+        private:
+            uint32_t m_now_us;
+        public:
+            SimulatedClock() : m_now_us(0) {}
+
+            uint32_t now_us() const{
+                return m_now_us;
+            }
+
+            void advance(uint32_t time_us){
+                m_now_us += time_us;
+            }
+
+            void set(uint32_t time_us){
+                m_now_us = time_us;
+            }
+        };
+    }
+}
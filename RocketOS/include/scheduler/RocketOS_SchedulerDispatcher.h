@@ -0,0 +1,159 @@
+#pragma once
+#include "RocketOS_SchedulerGeneral.h"
+#include "RocketOS_SchedulerClock.h"
+#include "RocketOS_SchedulerTask.h"
+#include <array>
+
+/*Dispatcher
+ * Cooperative time triggered scheduler. Tasks are registered with a period (or a delay for one-shot tasks), a deadline and a priority,
+ * and dispatch() runs every task whose release time has passed, highest priority first. Each task runs at most once per dispatch() so
+ * background tasks (period 0) cannot starve the rest of the main loop.
+ * All timing comes from the clock template parameter so the same schedule can run on hardware or against a SimulatedClock.
+ * 
+ * Tasks are not preempted by each other, so a task's lateness includes the execution time of the tasks that ran before it.
+ * Periodic tasks are released on a fixed grid (release += period). When a task falls more than a period behind, the missed
+ * releases are counted as skipped and the grid is moved forward instead of running the task back to back.
+ * Interrupt driven work (controller, observer and sensor timers) stays on hardware timers, the dispatcher only handles the main loop.
+ * 
+ * Times are 32 bit microseconds compared through signed differences, so the clock may wrap but periods and deadlines must be below 2^31 us.
+*/
+
+namespace RocketOS{
+    namespace Scheduler{
+        template<std::size_t t_maxTasks, class T_clock = MicrosClock>
+        class Dispatcher{
+        public:
+            //error codes
+            static constexpr error_t ERROR_Full = error_t(2);
+            static constexpr error_t ERROR_InvalidTask = error_t(3);
+        private:
+            T_clock m_clock;
+            std::array<Task, t_maxTasks> m_tasks;
+            uint_t m_numTasks;
+            uint32_t m_dispatchCount;
+        public:
+            Dispatcher() : m_numTasks(0), m_dispatchCount(0) {}
+
+            result_t<uint_t> addPeriodic(const char* name, taskCallback_t callback, TaskTiming timing, uint32_t offset_us = 0){
+                return addTask(name, callback, timing, offset_us, true);
+            }
+
+            result_t<uint_t> addOneShot(const char* name, taskCallback_t callback, uint32_t delay_us, uint32_t deadline_us = 0, uint_t priority = 0){
+                return addTask(name, callback, TaskTiming{0, deadline_us, priority}, delay_us, false);
+            }
+
+            //rearms a one-shot task or restarts the period grid of a periodic task
+            error_t start(uint_t task, uint32_t delay_us = 0){
+                if(task >= m_numTasks) return ERROR_InvalidTask;
+                m_tasks[task].release_us = m_clock.now_us() + delay_us;
+                m_tasks[task].enabled = true;
+                return error_t::GOOD;
+            }
+
+            error_t stop(uint_t task){
+                if(task >= m_numTasks) return ERROR_InvalidTask;
+                m_tasks[task].enabled = false;
+                return error_t::GOOD;
+            }
+
+            error_t setPeriod(uint_t task, uint32_t period_us){
+                if(task >= m_numTasks) return ERROR_InvalidTask;
+                m_tasks[task].timing.period_us = period_us;
+                return error_t::GOOD;
+            }
+
+            //runs all ready tasks, returns the number of tasks that ran
+            uint_t dispatch(){
+                uint_t numRuns = 0;
+                m_dispatchCount++;
+                while(true){
+                    uint32_t now = m_clock.now_us();
+                    Task* next = nullptr;
+                    for(uint_t i=0; i<m_numTasks; i++){
+                        Task& task = m_tasks[i];
+                        if(!task.enabled || task.lastDispatch == m_dispatchCount || !isReleased(task, now)) continue;
+                        if(next == nullptr || task.timing.priority < next->timing.priority) next = &task;
+                    }
+                    if(next == nullptr) return numRuns;
+                    run(*next, now);
+                    numRuns++;
+                }
+            }
+
+            //time until the next release, 0 if a task is ready
+            uint32_t timeUntilNextRelease_us() const{
+                uint32_t now = m_clock.now_us();
+                uint32_t minimum = UINT32_MAX;
+                for(uint_t i=0; i<m_numTasks; i++){
+                    const Task& task = m_tasks[i];
+                    if(!task.enabled) continue;
+                    if(isReleased(task, now)) return 0;
+                    uint32_t remaining = task.release_us - now;
+                    if(remaining < minimum) minimum = remaining;
+                }
+                return minimum;
+            }
+
+            void resetStatistics(){
+                for(uint_t i=0; i<m_numTasks; i++)
+                    m_tasks[i].statistics = TaskStatistics{};
+            }
+
+            const Task& getTask(uint_t task) const{
+                return m_tasks[task];
+            }
+
+            uint_t size() const{
+                return m_numTasks;
+            }
+
+            constexpr uint_t capacity() const{
+                return t_maxTasks;
+            }
+
+            T_clock& getClock(){
+                return m_clock;
+            }
+
+        private:
+            result_t<uint_t> addTask(const char* name, taskCallback_t callback, TaskTiming timing, uint32_t delay_us, bool periodic){
+                if(m_numTasks >= t_maxTasks) return ERROR_Full;
+                m_tasks[m_numTasks] = Task{name, callback, timing, TaskStatistics{}, m_clock.now_us() + delay_us, m_dispatchCount, periodic, true};
+                return m_numTasks++;
+            }
+
+            static bool isReleased(const Task& task, uint32_t now){
+                return static_cast<int32_t>(now - task.release_us) >= 0;
+            }
+
+            void run(Task& task, uint32_t start){
+                TaskStatistics& statistics = task.statistics;
+                uint32_t lateness = start - task.release_us;
+                if(lateness > statistics.maxLateness_us) statistics.maxLateness_us = lateness;
+                task.lastDispatch = m_dispatchCount;
+                task.callback();
+                uint32_t end = m_clock.now_us();
+                statistics.lastExecution_us = end - start;
+                if(statistics.lastExecution_us > statistics.maxExecution_us) statistics.maxExecution_us = statistics.lastExecution_us;
+                if(task.timing.deadline_us != 0 && end - task.release_us > task.timing.deadline_us) statistics.overruns++;
+                statistics.runs++;
+                //schedule the next release
+                if(!task.periodic){
+                    task.enabled = false;
+                }
+                else if(task.timing.period_us == 0){
+                    task.release_us = end;
+                }
+                else{
+                    task.release_us += task.timing.period_us;
+                    if(isReleased(task, end)){
+                        //behind by at least a full period, drop the missed releases
+                        uint32_t missed = (end - task.release_us) / task.timing.period_us + 1;
+                        statistics.skipped += missed;
+                        task.release_us += missed * task.timing.period_us;
+                    }
+                }
+            }
+        };
+    }
+}
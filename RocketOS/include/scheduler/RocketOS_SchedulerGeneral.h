@@ -0,0 +1,16 @@
+#pragma once
+#include "RocketOS_Scheduler.cfg.h"
+#include "RocketOSGeneral.h"
+
+/*Configuration Validity Checks
+ * These are compile time checks that ensure all configuration macros are exist and are valid.
+ * If a macro is missing or invalid a compilation error will be thrown.
+ *
+*/
+
+//RocketOS_Scheduler_TaskCallbackCaptureSize check
+#ifndef RocketOS_Scheduler_TaskCallbackCaptureSize
+    static_assert(false, "RocketOS_Scheduler_TaskCallbackCaptureSize must be defined in the file RocketOS_Scheduler.cfg.h");
+#else
+    static_assert(RocketOS_Scheduler_TaskCallbackCaptureSize > 0, "RocketOS_Scheduler_TaskCallbackCaptureSize must be positive");
+#endif
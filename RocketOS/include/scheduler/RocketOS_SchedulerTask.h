@@ -0,0 +1,46 @@
+#pragma once
+#include "RocketOS_SchedulerGeneral.h"
+
+namespace RocketOS{
+    namespace Scheduler{
+        using taskCallback_t = inplaceFunction_t<void(), RocketOS_Scheduler_TaskCallbackCaptureSize>;
+
+        /*Task Timing
+         * period_us - Time between releases of a periodic task. 0 releases the task on every dispatch (background task).
+         * deadline_us - Maximum time from release to completion before the run counts as an overrun. 0 disables the check.
+         * priority - When several tasks are ready, lower numbers run first. Tasks with equal priority run in registration order.
+        */
+        struct TaskTiming{
+            uint32_t period_us;
+            uint32_t deadline_us;
+            uint_t priority;
+        };
+
+        /*Task Statistics
+         * runs - Number of completed runs
+         * overruns - Runs that completed after their deadline
+         * skipped - Periodic releases that were dropped because the task was still late from an earlier release
+         * last/max execution - Time spent in the task callback
+         * max lateness - Longest delay between a release and the start of the run
+        */
+        struct TaskStatistics{
+            uint32_t runs;
+            uint32_t overruns;
+            uint32_t skipped;
+            uint32_t lastExecution_us;
+            uint32_t maxExecution_us;
+            uint32_t maxLateness_us;
+        };
+
+        struct Task{
+            const char* name;
+            taskCallback_t callback;
+            TaskTiming timing;
+            TaskStatistics statistics;
+            uint32_t release_us;
+            uint32_t lastDispatch;
+            bool periodic;
+            bool enabled;
+        };
+    }
+}
@@ -46,6 +46,22 @@ namespace RocketOS{
     namespace Shell{
         using commandCallback_t = inplaceFunction_t<void(const Shell::Token*), RocketOS_Shell_CommandCallbackCaptureSize>;
 
+        /*Command Modes
+         * Commands run with interrupts enabled by default so a slow command (printing, SD access, blocking sensor reads) does not
+         * delay the timer interrupts of the rest of the program.
+         * Preemptible - the callback can be interrupted at any point. Use this unless the command changes state shared with an interrupt.
+         * Atomic - the interpreter masks interrupts for the whole callback. Keep these commands short.
+         * Commands that change state used by a periodic interrupt can instead hand the change to that interrupt, see RocketOS::Utilities::SafePoint.
+         *
+         * Outstanding: the worst case ISR latency with this scheme has not been measured on a Teensy yet, there are no before and
+         * after numbers for the change from masking every command. To record them, reset "controller timing" and "observer timing",
+         * run the slowest commands (plan properties, persistent restore, restartSD) a few times while both are running
+         * and read back the worst late tick of each. The host tests cannot stand in for this, their clock is simulated.
+        */
+        enum class CommandModes : uint8_t{
+            Preemptible, Atomic
+        };
+
         /*Command
          * Commands are defined by a name, argument list, and callback function. 
          * The name "" is used to define a default inplementation for the parent command list. Names of commands should be unique within the same command list and cannot contain spaces or reserved characters.
@@ -58,11 +74,13 @@ namespace RocketOS{
          * unsigned number - 'u'
          * signed number - 'i'
          * floating point number - 'f'
+         * The mode is optional and defaults to CommandModes::Preemptible.
         */
         struct Command{
             const char* name;
             const char* args;
             const commandCallback_t callback;
+            const CommandModes mode = CommandModes::Preemptible;
         };
 
         /*CommandList
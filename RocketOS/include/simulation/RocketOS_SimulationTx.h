@@ -1,8 +1,9 @@
 #pragma once 
 #include "RocketOS_SimulationGeneral.h"
+#include "RocketOSSerial.h"
 #include <array>
 #include <tuple>
-#include <Arduino.h>//for serial
+#include <cstdio>
 
 namespace RocketOS{
     namespace Simulation{
@@ -11,20 +12,27 @@ namespace RocketOS{
         private:
             static constexpr uint_t c_size = sizeof...(T_types);
             static constexpr uint_t c_formatStringSize = (3 + ((c_size>0) ? (2 + (c_size-1)*3) : 2));
+            //room for each value printed with %f up to about 1e16
+            static constexpr uint_t c_frameSize = 3 + c_size * 24;
             std::tuple<const T_types&...> m_values;
             const std::array<char, c_formatStringSize> m_formatString;
+            OutputLane& m_output;
         public:
             template<std::enable_if_t<(std::is_convertible_v<T_types, float_t> && ...), bool> = true>
-            TxHIL(const T_types&... values) : m_values(values...), m_formatString(makeFormatString()){}
+            TxHIL(OutputLane& output, const T_types&... values) : m_values(values...), m_formatString(makeFormatString()), m_output(output){}
 
-            void sendUpdate() const{
-                sendAll(std::make_index_sequence<c_size>());
+            //the frame is queued whole or dropped, so the host never reads part of one
+            error_t sendUpdate() const{
+                return sendAll(std::make_index_sequence<c_size>());
             }
 
         private:
             template<std::size_t... tt_indexSeq>
-            void sendAll(std::index_sequence<tt_indexSeq...>) const{
-                Serial.printf(m_formatString.data(), static_cast<float_t>(std::get<tt_indexSeq>(m_values))...);
+            error_t sendAll(std::index_sequence<tt_indexSeq...>) const{
+                std::array<char, c_frameSize> frame;
+                int length = std::snprintf(frame.data(), frame.size(), m_formatString.data(), static_cast<double>(static_cast<float_t>(std::get<tt_indexSeq>(m_values)))...);
+                if(length < 0 || static_cast<uint_t>(length) >= frame.size()) return error_t::ERROR;
+                return m_output.writeFrame(frame.data(), length);
             }
 
             std::array<char, c_formatStringSize> makeFormatString(){
@@ -1,4 +1,12 @@
 #pragma once
 
 #define RocketOS_Utilities_InterruptCallbackCaptureSize 4
-#define RocketOS_Utilities_NumberOfInterruptPins 41
\ No newline at end of file
+#define RocketOS_Utilities_NumberOfInterruptPins 41
+#define RocketOS_Utilities_InterruptMaxHandlers 4
+#define RocketOS_Utilities_SeqLockReadAttempts 4
+#define RocketOS_Utilities_WorkCallbackCaptureSize 8
+#define RocketOS_Utilities_SafePointCallbackCaptureSize 8
+#define RocketOS_Utilities_SPICallbackCaptureSize 8
+#define RocketOS_Utilities_SPIDMAThreshold 16
+#define RocketOS_Utilities_SPIBlockingTimeout_us 10000
+#define RocketOS_Utilities_SPIMockDeviceCaptureSize 8
@@ -1,4 +1,14 @@
 #pragma once
 #include "RocketOS_UtilitiesGeneral.h"
 #include "RocketOS_UtilitiesInplaceInterrupt.h"
-#include "RocketOS_UtilitiesQueue.h"
\ No newline at end of file
+#include "RocketOS_UtilitiesInterruptDispatcher.h"
+#include "RocketOS_UtilitiesQueue.h"
+#include "RocketOS_UtilitiesSPSCQueue.h"
+#include "RocketOS_UtilitiesCycleTimer.h"
+#include "RocketOS_UtilitiesSeqLock.h"
+#include "RocketOS_UtilitiesMPSCQueue.h"
+#include "RocketOS_UtilitiesDeferredWork.h"
+#include "RocketOS_UtilitiesTopic.h"
+#include "RocketOS_UtilitiesSafePoint.h"
+#include "RocketOS_UtilitiesSPIBus.h"
+#include "RocketOS_UtilitiesSPITeensy.h"
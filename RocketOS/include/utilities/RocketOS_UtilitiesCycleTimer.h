@@ -0,0 +1,121 @@
+#pragma once
+#include "RocketOS_UtilitiesGeneral.h"
+#include <Arduino.h>
+
+namespace RocketOS{
+    namespace Utilities{
+        /*Cycle timer
+         * Measures the execution time of a section of code with the DWT cycle counter
+         * Keeps the last and worst case duration so interrupt routines can be profiled in flight
+        */
+        class CycleTimer{
+        private:
+            uint32_t m_start;
+            uint32_t m_last;
+            uint32_t m_max;
+            uint32_t m_count;
+        public:
+            CycleTimer() : m_start(0), m_last(0), m_max(0), m_count(0){}
+
+            inline void start(){
+                m_start = ARM_DWT_CYCCNT;
+            }
+
+            inline uint32_t stop(){
+                m_last = ARM_DWT_CYCCNT - m_start;
+                if(m_last > m_max) m_max = m_last;
+                m_count++;
+                return m_last;
+            }
+
+            void reset(){
+                m_last = 0;
+                m_max = 0;
+                m_count = 0;
+            }
+
+            uint32_t getLastCycles() const{
+                return m_last;
+            }
+
+            uint32_t getMaxCycles() const{
+                return m_max;
+            }
+
+            uint32_t getCount() const{
+                return m_count;
+            }
+
+            float_t getLast_us() const{
+                return toMicroseconds(m_last);
+            }
+
+            float_t getMax_us() const{
+                return toMicroseconds(m_max);
+            }
+
+            static float_t toMicroseconds(uint32_t cycles){
+                return static_cast<float_t>(cycles) / (F_CPU_ACTUAL / 1000000);
+            }
+        };
+
+        /*Tick jitter monitor
+         * Measures how far the start of a periodic interrupt drifts from its nominal period with the DWT cycle counter.
+         * Call tick() first thing in the interrupt. The worst case late and early deviations are kept, a late tick is usually
+         * a tick that was held off by masked interrupts or a higher priority interrupt.
+        */
+        class JitterMonitor{
+        private:
+            uint32_t m_lastTick;
+            uint32_t m_period;
+            uint32_t m_maxLate;
+            uint32_t m_maxEarly;
+            uint32_t m_count;
+        public:
+            JitterMonitor() : m_lastTick(0), m_period(0), m_maxLate(0), m_maxEarly(0), m_count(0){}
+
+            //restarts the measurement, the next tick only sets the reference time
+            void setPeriod_us(uint32_t period_us){
+                m_period = period_us * (F_CPU_ACTUAL / 1000000);
+                reset();
+            }
+
+            inline void tick(){
+                uint32_t now = ARM_DWT_CYCCNT;
+                if(m_count > 0){
+                    int32_t deviation = static_cast<int32_t>((now - m_lastTick) - m_period);
+                    if(deviation > 0 && static_cast<uint32_t>(deviation) > m_maxLate) m_maxLate = deviation;
+                    if(deviation < 0 && static_cast<uint32_t>(-deviation) > m_maxEarly) m_maxEarly = -deviation;
+                }
+                m_lastTick = now;
+                m_count++;
+            }
+
+            void reset(){
+                m_maxLate = 0;
+                m_maxEarly = 0;
+                m_count = 0;
+            }
+
+            uint32_t getMaxLateCycles() const{
+                return m_maxLate;
+            }
+
+            uint32_t getMaxEarlyCycles() const{
+                return m_maxEarly;
+            }
+
+            uint32_t getCount() const{
+                return m_count;
+            }
+
+            float_t getMaxLate_us() const{
+                return CycleTimer::toMicroseconds(m_maxLate);
+            }
+
+            float_t getMaxEarly_us() const{
+                return CycleTimer::toMicroseconds(m_maxEarly);
+            }
+        };
+    }
+}
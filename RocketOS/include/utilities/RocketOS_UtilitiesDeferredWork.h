@@ -0,0 +1,110 @@
+#pragma once
+#include "RocketOS_UtilitiesGeneral.h"
+#include "RocketOS_UtilitiesMPSCQueue.h"
+#include <Arduino.h>
+
+namespace RocketOS{
+    namespace Utilities{
+        using workCallback_t = inplaceFunction_t<void(void), RocketOS_Utilities_WorkCallbackCaptureSize>;
+
+        /*Deferred work
+         * Lets interrupt routines hand long running work (SPI transactions, packet parsing) to a lower priority context.
+         * post() is lock-free and safe from any interrupt. Items run in the order they were posted.
+         * 
+         * After begin() the items run from the software interrupt of an EventResponder, which sits below every hardware interrupt,
+         * so timer and pin interrupts keep their latency while the work runs and the work still preempts the main loop.
+         * Without begin(), drain() can be called from the main loop instead.
+         * 
+         * Latency (post to start) and execution time are measured per item with the cycle counter.
+         * Items that do not fit in the queue are dropped and counted, the poster decides how to recover.
+        */
+        template<std::size_t t_size>
+        class DeferredWork{
+        private:
+            struct WorkItem{
+                workCallback_t callback;
+                uint32_t posted;
+            };
+            MPSCQueue<WorkItem, t_size> m_queue;
+            EventResponder m_event;
+            bool m_interruptDriven;
+            //statistics
+            uint32_t m_count;
+            uint32_t m_overflows;
+            uint32_t m_lastLatency;
+            uint32_t m_maxLatency;
+            uint32_t m_maxExecution;
+        public:
+            DeferredWork() : m_interruptDriven(false), m_count(0), m_overflows(0), m_lastLatency(0), m_maxLatency(0), m_maxExecution(0) {}
+
+            //run posted work from the EventResponder software interrupt
+            void begin(){
+                m_event.setContext(this);
+                m_event.attachInterrupt(eventISR);
+                m_interruptDriven = true;
+            }
+
+            error_t post(workCallback_t callback){
+                if(m_queue.push(WorkItem{callback, ARM_DWT_CYCCNT}) != error_t::GOOD){
+                    m_overflows++;
+                    return error_t::ERROR;
+                }
+                if(m_interruptDriven) m_event.triggerEvent();
+                return error_t::GOOD;
+            }
+
+            //runs every posted item, returns the number of items run
+            uint_t drain(){
+                uint_t numRun = 0;
+                for(result_t<WorkItem> item = m_queue.pop(); item.error == error_t::GOOD; item = m_queue.pop()){
+                    uint32_t start = ARM_DWT_CYCCNT;
+                    m_lastLatency = start - item.data.posted;
+                    if(m_lastLatency > m_maxLatency) m_maxLatency = m_lastLatency;
+                    item.data.callback();
+                    uint32_t execution = ARM_DWT_CYCCNT - start;
+                    if(execution > m_maxExecution) m_maxExecution = execution;
+                    m_count++;
+                    numRun++;
+                }
+                return numRun;
+            }
+
+            void resetStatistics(){
+                m_count = 0;
+                m_overflows = 0;
+                m_lastLatency = 0;
+                m_maxLatency = 0;
+                m_maxExecution = 0;
+            }
+
+            uint32_t getCount() const{
+                return m_count;
+            }
+
+            uint32_t getOverflows() const{
+                return m_overflows;
+            }
+
+            uint32_t getLastLatencyCycles() const{
+                return m_lastLatency;
+            }
+
+            uint32_t getMaxLatencyCycles() const{
+                return m_maxLatency;
+            }
+
+            uint32_t getMaxExecutionCycles() const{
+                return m_maxExecution;
+            }
+
+            uint_t pending() const{
+                return m_queue.size();
+            }
+
+        private:
+            static void eventISR(EventResponderRef event){
+                static_cast<DeferredWork*>(event.getContext())->drain();
+            }
+        };
+    }
+}
@@ -13,4 +13,58 @@
     static_assert(false, "RocketOS_Utilities_InterruptCallbackCaptureSize must be defined in the file RocketOS_Utilities.cfg.h");
 #else
     static_assert(RocketOS_Utilities_InterruptCallbackCaptureSize > 0, "RocketOS_Utilities_InterruptCallbackCaptureSize must be positive");
-#endif
\ No newline at end of file
+#endif
+//RocketOS_Utilities_InterruptMaxHandlers check
+#ifndef RocketOS_Utilities_InterruptMaxHandlers
+    static_assert(false, "RocketOS_Utilities_InterruptMaxHandlers must be defined in the file RocketOS_Utilities.cfg.h");
+#else
+    static_assert(RocketOS_Utilities_InterruptMaxHandlers > 0, "RocketOS_Utilities_InterruptMaxHandlers must be positive");
+#endif
+//RocketOS_Utilities_SeqLockReadAttempts check
+#ifndef RocketOS_Utilities_SeqLockReadAttempts
+    static_assert(false, "RocketOS_Utilities_SeqLockReadAttempts must be defined in the file RocketOS_Utilities.cfg.h");
+#else
+    static_assert(RocketOS_Utilities_SeqLockReadAttempts > 0, "RocketOS_Utilities_SeqLockReadAttempts must be positive");
+#endif
+
+//RocketOS_Utilities_WorkCallbackCaptureSize check
+#ifndef RocketOS_Utilities_WorkCallbackCaptureSize
+    static_assert(false, "RocketOS_Utilities_WorkCallbackCaptureSize must be defined in the file RocketOS_Utilities.cfg.h");
+#else
+    static_assert(RocketOS_Utilities_WorkCallbackCaptureSize > 0, "RocketOS_Utilities_WorkCallbackCaptureSize must be positive");
+#endif
+
+//RocketOS_Utilities_SafePointCallbackCaptureSize check
+#ifndef RocketOS_Utilities_SafePointCallbackCaptureSize
+    static_assert(false, "RocketOS_Utilities_SafePointCallbackCaptureSize must be defined in the file RocketOS_Utilities.cfg.h");
+#else
+    static_assert(RocketOS_Utilities_SafePointCallbackCaptureSize > 0, "RocketOS_Utilities_SafePointCallbackCaptureSize must be positive");
+#endif
+
+//RocketOS_Utilities_SPICallbackCaptureSize check
+#ifndef RocketOS_Utilities_SPICallbackCaptureSize
+    static_assert(false, "RocketOS_Utilities_SPICallbackCaptureSize must be defined in the file RocketOS_Utilities.cfg.h");
+#else
+    static_assert(RocketOS_Utilities_SPICallbackCaptureSize > 0, "RocketOS_Utilities_SPICallbackCaptureSize must be positive");
+#endif
+
+//RocketOS_Utilities_SPIDMAThreshold check
+#ifndef RocketOS_Utilities_SPIDMAThreshold
+    static_assert(false, "RocketOS_Utilities_SPIDMAThreshold must be defined in the file RocketOS_Utilities.cfg.h");
+#else
+    static_assert(RocketOS_Utilities_SPIDMAThreshold > 0, "RocketOS_Utilities_SPIDMAThreshold must be positive");
+#endif
+
+//RocketOS_Utilities_SPIBlockingTimeout_us check
+#ifndef RocketOS_Utilities_SPIBlockingTimeout_us
+    static_assert(false, "RocketOS_Utilities_SPIBlockingTimeout_us must be defined in the file RocketOS_Utilities.cfg.h");
+#else
+    static_assert(RocketOS_Utilities_SPIBlockingTimeout_us > 0, "RocketOS_Utilities_SPIBlockingTimeout_us must be positive");
+#endif
+
+//RocketOS_Utilities_SPIMockDeviceCaptureSize check
+#ifndef RocketOS_Utilities_SPIMockDeviceCaptureSize
+    static_assert(false, "RocketOS_Utilities_SPIMockDeviceCaptureSize must be defined in the file RocketOS_Utilities.cfg.h");
+#else
+    static_assert(RocketOS_Utilities_SPIMockDeviceCaptureSize > 0, "RocketOS_Utilities_SPIMockDeviceCaptureSize must be positive");
+#endif
@@ -0,0 +1,126 @@
+#pragma once
+#include "RocketOS_UtilitiesGeneral.h"
+#include <Arduino.h>
+#include <array>
+
+namespace RocketOS{
+    namespace Utilities{
+        /*Interrupt event
+         * Timing of one pin interrupt, captured as the first thing the interrupt does.
+         * cycles is the cycle counter (fine resolution, wraps every few seconds) and time_us is micros() (wraps every 71 minutes).
+         * sequence counts every event on the pin, so a handler can tell how many it did not see.
+         * recovered events were found by polling the pin after the edge was lost, their time is when the loss was noticed.
+        */
+        struct InterruptEvent{
+            uint32_t cycles;
+            uint32_t time_us;
+            uint32_t sequence;
+            bool recovered;
+        };
+
+        //returns false if the handler was still busy with an earlier event and this one was folded into it
+        using interruptHandler_t = inplaceFunction_t<bool(const InterruptEvent&), RocketOS_Utilities_InterruptCallbackCaptureSize>;
+
+        /*Interrupt dispatcher
+         * Timestamped replacement for inplaceInterrupt. Each pin can have up to RocketOS_Utilities_InterruptMaxHandlers handlers,
+         * which run in priority order (0 first) and all receive the same event.
+         *
+         * Counters:
+         *      count - events dispatched
+         *      coalesced - times a handler refused an event because it had not finished with the previous one
+         *      missed - edges that never interrupted and were later found with recover()
+         *
+         * dispatch() is the body of the interrupt and can be called directly to drive the handlers from a simulated event source.
+         * Attach handlers before begin(), the handler table is not protected against a running interrupt.
+        */
+        template<uint8_t t_pin>
+        class InterruptDispatcher{
+        private:
+            struct Handler{
+                interruptHandler_t callback;
+                uint8_t priority;
+            };
+            static std::array<Handler, RocketOS_Utilities_InterruptMaxHandlers> s_handlers;
+            static uint_t s_numHandlers;
+            static volatile uint32_t s_count;
+            static volatile uint32_t s_coalesced;
+            static volatile uint32_t s_missed;
+            static volatile uint32_t s_lastTime_us;
+        public:
+            static error_t attach(interruptHandler_t handler, uint8_t priority = 0){
+                if(s_numHandlers >= s_handlers.size()) return error_t::ERROR;
+                //insert after handlers of the same or a higher priority
+                uint_t index = s_numHandlers;
+                for(; index > 0 && s_handlers[index - 1].priority > priority; index--)
+                    s_handlers[index] = s_handlers[index - 1];
+                s_handlers[index] = Handler{handler, priority};
+                s_numHandlers++;
+                return error_t::GOOD;
+            }
+
+            static void begin(int mode){
+                attachInterrupt(digitalPinToInterrupt(t_pin), ISR, mode);
+            }
+
+            static void end(){
+                detachInterrupt(digitalPinToInterrupt(t_pin));
+                s_numHandlers = 0;
+            }
+
+            static void ISR(void){
+                uint32_t cycles = ARM_DWT_CYCCNT;
+                dispatch(cycles, micros(), false);
+            }
+
+            static void dispatch(uint32_t cycles, uint32_t time_us, bool recovered){
+                InterruptEvent event{cycles, time_us, s_count, recovered};
+                s_count = event.sequence + 1;
+                s_lastTime_us = time_us;
+                for(uint_t i=0; i<s_numHandlers; i++)
+                    if(!s_handlers[i].callback(event)) s_coalesced = s_coalesced + 1;
+            }
+
+            //call from the main loop when the pin shows an event that never interrupted
+            static void recover(){
+                noInterrupts();
+                s_missed = s_missed + 1;
+                dispatch(ARM_DWT_CYCCNT, micros(), true);
+                interrupts();
+            }
+
+            static uint32_t getCount(){
+                return s_count;
+            }
+
+            static uint32_t getCoalesced(){
+                return s_coalesced;
+            }
+
+            static uint32_t getMissed(){
+                return s_missed;
+            }
+
+            static uint32_t getLastTime_us(){
+                return s_lastTime_us;
+            }
+
+            static void resetStatistics(){
+                s_coalesced = 0;
+                s_missed = 0;
+            }
+        };
+
+        template<uint8_t t_pin>
+        std::array<typename InterruptDispatcher<t_pin>::Handler, RocketOS_Utilities_InterruptMaxHandlers> InterruptDispatcher<t_pin>::s_handlers{};
+        template<uint8_t t_pin>
+        uint_t InterruptDispatcher<t_pin>::s_numHandlers = 0;
+        template<uint8_t t_pin>
+        volatile uint32_t InterruptDispatcher<t_pin>::s_count = 0;
+        template<uint8_t t_pin>
+        volatile uint32_t InterruptDispatcher<t_pin>::s_coalesced = 0;
+        template<uint8_t t_pin>
+        volatile uint32_t InterruptDispatcher<t_pin>::s_missed = 0;
+        template<uint8_t t_pin>
+        volatile uint32_t InterruptDispatcher<t_pin>::s_lastTime_us = 0;
+    }
+}
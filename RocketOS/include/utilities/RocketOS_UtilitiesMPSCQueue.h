@@ -0,0 +1,74 @@
+#pragma once
+#include "RocketOS_UtilitiesGeneral.h"
+#include <array>
+#include <atomic>
+
+namespace RocketOS{
+    namespace Utilities{
+        /*Multi producer single consumer queue
+         * Bounded lock-free queue that interrupt routines of any priority can push into while one context pops.
+         * Each cell carries a sequence number: a producer claims a cell by advancing the tail with compare-and-swap, fills it and then
+         * publishes it by bumping the cell's sequence. The consumer only takes a cell once it is published, so a producer that is 
+         * preempted between claiming and publishing only delays the items behind it and never exposes a half written item.
+         * 
+         * push() fails instead of blocking when the queue is full. t_size must be a power of two.
+        */
+        template<class T, std::size_t t_size>
+        class MPSCQueue{
+        private:
+            static_assert(t_size > 1 && (t_size & (t_size - 1)) == 0, "MPSCQueue size must be a power of two");
+            static constexpr uint32_t c_mask = t_size - 1;
+            struct Cell{
+                std::atomic<uint32_t> sequence;
+                T value;
+            };
+            std::array<Cell, t_size> m_cells;
+            std::atomic<uint32_t> m_tail;
+            uint32_t m_head;
+        public:
+            MPSCQueue() : m_tail(0), m_head(0){
+                for(uint32_t i=0; i<t_size; i++)
+                    m_cells[i].sequence.store(i, std::memory_order_relaxed);
+            }
+
+            error_t push(const T& value){
+                uint32_t position = m_tail.load(std::memory_order_relaxed);
+                while(true){
+                    Cell& cell = m_cells[position & c_mask];
+                    int32_t difference = static_cast<int32_t>(cell.sequence.load(std::memory_order_acquire) - position);
+                    if(difference == 0){
+                        if(m_tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)){
+                            cell.value = value;
+                            cell.sequence.store(position + 1, std::memory_order_release);
+                            return error_t::GOOD;
+                        }
+                    }
+                    else if(difference < 0) return error_t::ERROR; //full
+                    else position = m_tail.load(std::memory_order_relaxed);
+                }
+            }
+
+            //only one context may pop
+            result_t<T> pop(){
+                Cell& cell = m_cells[m_head & c_mask];
+                if(static_cast<int32_t>(cell.sequence.load(std::memory_order_acquire) - (m_head + 1)) < 0) return error_t::ERROR; //empty or not yet published
+                T value = cell.value;
+                cell.sequence.store(m_head + t_size, std::memory_order_release);
+                m_head++;
+                return value;
+            }
+
+            bool empty() const{
+                return static_cast<int32_t>(m_cells[m_head & c_mask].sequence.load(std::memory_order_acquire) - (m_head + 1)) < 0;
+            }
+
+            uint_t size() const{
+                return m_tail.load(std::memory_order_relaxed) - m_head;
+            }
+
+            constexpr uint_t capacity() const{
+                return t_size;
+            }
+        };
+    }
+}
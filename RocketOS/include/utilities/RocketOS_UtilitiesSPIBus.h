@@ -0,0 +1,202 @@
+#pragma once
+#include "RocketOS_UtilitiesGeneral.h"
+#include "RocketOS_UtilitiesMPSCQueue.h"
+#include <atomic>
+#include <Arduino.h> //cycle counter for the blocking timeout
+
+namespace RocketOS{
+    namespace Utilities{
+        using spiCallback_t = inplaceFunction_t<void(void), RocketOS_Utilities_SPICallbackCaptureSize>;
+
+        /*SPI transaction
+         * One chip select assertion worth of transfer, handed to an SPIBus by value.
+         * tx and rx must stay valid until done runs. A null tx sends filler bytes and a null rx discards what the device sends.
+         * With holdSelect the chip select stays asserted after the transfer so done can chain() the next part of the same exchange,
+         * for protocols where the length of the payload is only known after the header was read.
+        */
+        struct SPITransaction{
+            uint8_t chipSelect;
+            uint32_t frequency;
+            uint8_t mode;
+            const uint8_t* tx;
+            uint8_t* rx;
+            uint16_t length;
+            bool holdSelect;
+            spiCallback_t done;
+        };
+
+        /*SPI bus
+         * Queue of transactions for one SPI peripheral, run one after the other on a backend.
+         * submit() never waits: the transaction is queued and, if the bus is idle, started right away in the caller's context.
+         * When the backend finishes a transfer on its own (DMA) the bus continues from the backend's completion interrupt, so the
+         * done callbacks run in whatever context the bus happens to be running in and must be short. Post longer work elsewhere.
+         *
+         * Any context can submit. Only one context runs the bus at a time, a submit that finds it running leaves its transaction
+         * for the running context to pick up. transferBlocking() waits for the transaction, so only use it from the main loop.
+         * A blocking transfer that timed out stays queued and still runs, so its buffers must outlive it. Each blocking transfer
+         * waits for its own ticket, the late completion can not end the wait of the next one, and the next one runs after it.
+         *
+         * The backend is any class with:
+         *      void begin();
+         *      void configure(uint32_t frequency, uint8_t mode);   //before a chip select is asserted
+         *      void release();                                     //after it is deasserted
+         *      void select(uint8_t pin);
+         *      void deselect(uint8_t pin);
+         *      bool transfer(const uint8_t* tx, uint8_t* rx, uint16_t length, void (*complete)(void*), void* context);
+         *      void poll();
+         * transfer() returns true if it finished before returning, otherwise it calls complete(context) once it has.
+         * poll() is called while transferBlocking() waits, for backends that need to be driven.
+         * t_depth must be a power of two.
+        */
+        template<class t_backend, std::size_t t_depth>
+        class SPIBus{
+        private:
+            t_backend& m_backend;
+            MPSCQueue<SPITransaction, t_depth> m_queue;
+            std::atomic<bool> m_running;
+            //owned by the running context
+            SPITransaction m_current;
+            SPITransaction m_chained;
+            bool m_hasChained;
+            bool m_selected;
+            //ticket of the last blocking transfer issued and of the last one that completed
+            uint32_t m_blockingIssued;
+            volatile uint32_t m_blockingCompleted;
+            //statistics
+            uint32_t m_count;
+            uint32_t m_bytes;
+            uint32_t m_deferred;
+            uint32_t m_overflows;
+            uint32_t m_timeouts;
+        public:
+            SPIBus(t_backend& backend) : m_backend(backend), m_running(false), m_hasChained(false), m_selected(false), m_blockingIssued(0), m_blockingCompleted(0), m_count(0), m_bytes(0), m_deferred(0), m_overflows(0), m_timeouts(0) {}
+
+            void begin(){
+                m_backend.begin();
+            }
+
+            error_t submit(const SPITransaction& transaction){
+                if(m_queue.push(transaction) != error_t::GOOD){
+                    m_overflows++;
+                    return error_t::ERROR;
+                }
+                if(!m_running.exchange(true, std::memory_order_acquire)) drive(m_queue.pop());
+                return error_t::GOOD;
+            }
+
+            //continues the exchange of a holdSelect transaction, only valid from its done callback
+            error_t chain(const SPITransaction& transaction){
+                if(!m_current.holdSelect || m_hasChained) return error_t::ERROR;
+                m_chained = transaction;
+                m_hasChained = true;
+                return error_t::GOOD;
+            }
+
+            //submits the transaction and waits for it, its done callback is replaced
+            error_t transferBlocking(SPITransaction transaction, uint32_t timeout_us = RocketOS_Utilities_SPIBlockingTimeout_us){
+                uint32_t ticket = ++m_blockingIssued;
+                transaction.holdSelect = false;
+                transaction.done = [this, ticket](){ this->m_blockingCompleted = ticket; };
+                if(submit(transaction) != error_t::GOOD) return error_t::ERROR;
+                uint32_t start = ARM_DWT_CYCCNT;
+                uint32_t timeout = timeout_us * (F_CPU_ACTUAL / 1000000);
+                while(m_blockingCompleted != ticket){
+                    m_backend.poll();
+                    if(ARM_DWT_CYCCNT - start > timeout){
+                        m_timeouts++;
+                        return error_t::ERROR;
+                    }
+                }
+                return error_t::GOOD;
+            }
+
+            bool idle() const{
+                return !m_running.load(std::memory_order_acquire) && m_queue.empty();
+            }
+
+            uint_t pending() const{
+                return m_queue.size();
+            }
+
+            t_backend& getBackend(){
+                return m_backend;
+            }
+
+            void resetStatistics(){
+                m_count = 0;
+                m_bytes = 0;
+                m_deferred = 0;
+                m_overflows = 0;
+                m_timeouts = 0;
+            }
+
+            uint32_t getCount() const{
+                return m_count;
+            }
+
+            uint32_t getBytes() const{
+                return m_bytes;
+            }
+
+            //transfers the backend finished asynchronously
+            uint32_t getDeferred() const{
+                return m_deferred;
+            }
+
+            uint32_t getOverflows() const{
+                return m_overflows;
+            }
+
+            uint32_t getTimeouts() const{
+                return m_timeouts;
+            }
+
+        private:
+            //runs transactions until the queue is empty or one is left running on the backend, called with m_running held
+            void drive(result_t<SPITransaction> next){
+                while(true){
+                    while(next.error == error_t::GOOD){
+                        if(!start(next.data)) return;
+                        next = finish();
+                    }
+                    m_running.store(false, std::memory_order_release);
+                    //a submit that found the bus running left its transaction here, pick it up unless another context already has
+                    if(m_queue.empty() || m_running.exchange(true, std::memory_order_acquire)) return;
+                    next = m_queue.pop();
+                }
+            }
+
+            //returns true if the transfer already finished
+            bool start(const SPITransaction& transaction){
+                m_current = transaction;
+                if(!m_selected){
+                    m_backend.configure(m_current.frequency, m_current.mode);
+                    m_backend.select(m_current.chipSelect);
+                    m_selected = true;
+                }
+                m_count++;
+                m_bytes += m_current.length;
+                if(m_current.length == 0) return true;
+                if(m_backend.transfer(m_current.tx, m_current.rx, m_current.length, complete, this)) return true;
+                m_deferred++;
+                return false;
+            }
+
+            //runs the callback and returns the transaction to run next
+            result_t<SPITransaction> finish(){
+                m_hasChained = false;
+                if(m_current.done) m_current.done();
+                if(m_current.holdSelect && m_hasChained) return m_chained;
+                m_backend.deselect(m_current.chipSelect);
+                m_backend.release();
+                m_selected = false;
+                return m_queue.pop();
+            }
+
+            static void complete(void* context){
+                SPIBus* bus = static_cast<SPIBus*>(context);
+                bus->drive(bus->finish());
+            }
+        };
+    }
+}
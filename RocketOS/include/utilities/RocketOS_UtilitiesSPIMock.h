@@ -0,0 +1,202 @@
+#pragma once
+#include "RocketOS_UtilitiesGeneral.h"
+#include <array>
+
+namespace RocketOS{
+    namespace Utilities{
+        using spiDevice_t = inplaceFunction_t<void(const uint8_t*, uint8_t*, uint16_t, bool), RocketOS_Utilities_SPIMockDeviceCaptureSize>;
+
+        /*Mock SPI backend
+         * SPIBus backend without hardware, so drivers can be run and timed on a host.
+         * Every chip select pin can have a device attached. A device is either
+         *      scripted: a fixed byte stream that is replayed to the driver across transfers (0xFF once it runs out), or
+         *      modeled: a callback that gets the bytes sent, fills in the reply and is told whether the transfer starts a selection.
+         * Transfers to pins without a device read 0xFF. The bytes sent are kept in a log for the test to compare against.
+         *
+         * In deferred mode transfers finish when poll() is called, like a DMA transfer finishing in an interrupt, so the
+         * asynchronous paths of the bus and drivers can be exercised. Otherwise they finish immediately.
+         * The bus time the transfers would take at the configured frequency is accumulated for benchmarks.
+         * Not interrupt safe, the mock is meant for single threaded host tests. It is not part of RocketOS_Utilities.h, the host
+         * test build (test/CMakeLists.txt) includes it and selects it as Airbrakes_CFG_SPIBackend.
+        */
+        template<std::size_t t_devices = 4, std::size_t t_logSize = 256>
+        class MockSPIBackend{
+        private:
+            struct Device{
+                uint8_t pin;
+                const uint8_t* script;
+                uint_t scriptLength;
+                uint_t scriptPosition;
+                spiDevice_t model;
+                uint32_t selections;
+            };
+            std::array<Device, t_devices> m_devices;
+            uint_t m_numDevices;
+            std::array<uint8_t, t_logSize> m_log;
+            uint_t m_logLength;
+            Device* m_selected;
+            bool m_firstOfSelection;
+            uint32_t m_frequency;
+            bool m_configured;
+            bool m_deferred;
+            void (*m_complete)(void*);
+            void* m_context;
+            //statistics
+            uint32_t m_transfers;
+            uint32_t m_bytes;
+            double m_busTime_us;
+            uint32_t m_errors;
+        public:
+            MockSPIBackend() : m_numDevices(0), m_logLength(0), m_selected(nullptr), m_firstOfSelection(false), m_frequency(0), m_configured(false), m_deferred(false), m_complete(nullptr), m_context(nullptr), m_transfers(0), m_bytes(0), m_busTime_us(0), m_errors(0) {}
+
+            //stands in for a backend constructed on an SPI port, the port is not used
+            template<class t_port>
+            explicit MockSPIBackend(t_port&) : MockSPIBackend() {}
+
+            error_t attach(uint8_t pin, const uint8_t* script, uint_t length){
+                Device* device = addDevice(pin);
+                if(device == nullptr) return error_t::ERROR;
+                device->script = script;
+                device->scriptLength = length;
+                return error_t::GOOD;
+            }
+
+            error_t attach(uint8_t pin, spiDevice_t model){
+                Device* device = addDevice(pin);
+                if(device == nullptr) return error_t::ERROR;
+                device->model = model;
+                return error_t::GOOD;
+            }
+
+            void setDeferred(bool deferred){
+                m_deferred = deferred;
+            }
+
+            // --- backend interface ---
+            void begin(){}
+
+            void configure(uint32_t frequency, uint8_t){
+                //configuring twice means the bus did not release the previous transaction
+                if(m_configured) m_errors++;
+                m_frequency = frequency;
+                m_configured = true;
+            }
+
+            void release(){
+                if(!m_configured) m_errors++;
+                m_configured = false;
+            }
+
+            void select(uint8_t pin){
+                if(m_selected != nullptr) m_errors++;
+                m_selected = findDevice(pin);
+                m_firstOfSelection = true;
+                if(m_selected != nullptr) m_selected->selections++;
+            }
+
+            void deselect(uint8_t){
+                m_selected = nullptr;
+            }
+
+            bool transfer(const uint8_t* tx, uint8_t* rx, uint16_t length, void (*complete)(void*), void* context){
+                if(m_complete != nullptr) m_errors++;
+                exchange(tx, rx, length);
+                if(!m_deferred) return true;
+                m_complete = complete;
+                m_context = context;
+                return false;
+            }
+
+            //finishes a deferred transfer
+            void poll(){
+                if(m_complete == nullptr) return;
+                void (*complete)(void*) = m_complete;
+                m_complete = nullptr;
+                complete(m_context);
+            }
+
+            // --- inspection ---
+            bool busy() const{
+                return m_complete != nullptr;
+            }
+
+            const uint8_t* getLog() const{
+                return m_log.data();
+            }
+
+            uint_t getLogLength() const{
+                return m_logLength;
+            }
+
+            void clearLog(){
+                m_logLength = 0;
+            }
+
+            uint32_t getSelections(uint8_t pin) const{
+                for(uint_t i=0; i<m_numDevices; i++)
+                    if(m_devices[i].pin == pin) return m_devices[i].selections;
+                return 0;
+            }
+
+            uint32_t getTransfers() const{
+                return m_transfers;
+            }
+
+            uint32_t getBytes() const{
+                return m_bytes;
+            }
+
+            double getBusTime_us() const{
+                return m_busTime_us;
+            }
+
+            //protocol misuse seen by the mock (overlapping selections or transfers, unbalanced configure and release)
+            uint32_t getErrors() const{
+                return m_errors;
+            }
+
+        private:
+            Device* addDevice(uint8_t pin){
+                Device* device = findDevice(pin);
+                if(device == nullptr){
+                    if(m_numDevices >= t_devices) return nullptr;
+                    device = &m_devices[m_numDevices++];
+                }
+                *device = Device{pin, nullptr, 0, 0, spiDevice_t(), 0};
+                return device;
+            }
+
+            Device* findDevice(uint8_t pin){
+                for(uint_t i=0; i<m_numDevices; i++)
+                    if(m_devices[i].pin == pin) return &m_devices[i];
+                return nullptr;
+            }
+
+            void exchange(const uint8_t* tx, uint8_t* rx, uint16_t length){
+                m_transfers++;
+                m_bytes += length;
+                if(m_frequency > 0) m_busTime_us += length * 8 * 1000000.0 / m_frequency;
+                for(uint_t i=0; i<length && m_logLength < t_logSize; i++)
+                    m_log[m_logLength++] = (tx != nullptr)? tx[i] : 0xFF;
+                if(m_selected != nullptr && m_selected->model){
+                    std::array<uint8_t, 1> discard;
+                    //the model always gets somewhere to write, even if the driver ignores the reply
+                    if(rx != nullptr) m_selected->model(tx, rx, length, m_firstOfSelection);
+                    else for(uint_t i=0; i<length; i++) m_selected->model((tx != nullptr)? tx + i : nullptr, discard.data(), 1, m_firstOfSelection && i == 0);
+                }
+                else if(rx != nullptr){
+                    for(uint_t i=0; i<length; i++){
+                        bool scripted = m_selected != nullptr && m_selected->scriptPosition < m_selected->scriptLength;
+                        rx[i] = scripted? m_selected->script[m_selected->scriptPosition++] : 0xFF;
+                    }
+                }
+                else if(m_selected != nullptr){
+                    //a discarded reply still consumes the script
+                    m_selected->scriptPosition += length;
+                    if(m_selected->scriptPosition > m_selected->scriptLength) m_selected->scriptPosition = m_selected->scriptLength;
+                }
+                m_firstOfSelection = false;
+            }
+        };
+    }
+}
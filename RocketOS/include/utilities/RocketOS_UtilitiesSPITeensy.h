@@ -0,0 +1,73 @@
+#pragma once
+#include "RocketOS_UtilitiesGeneral.h"
+#include <Arduino.h>
+#include <SPI.h>
+
+namespace RocketOS{
+    namespace Utilities{
+        /*Teensy SPI backend
+         * SPIBus backend for one of the Teensy SPI peripherals.
+         * Transfers of at least RocketOS_Utilities_SPIDMAThreshold bytes are handed to the SPI library's DMA transfer and finish from
+         * its EventResponder, shorter ones are written directly since setting up DMA takes longer than sending a few bytes.
+         * If the DMA transfer can not be started the transfer falls back to the direct one.
+         * Chip select pins must be configured as outputs (and idle high) by the drivers.
+        */
+        class TeensySPIBackend{
+        private:
+            SPIClass& m_spi;
+            EventResponder m_event;
+            void (*m_complete)(void*);
+            void* m_context;
+            bool m_begun;
+        public:
+            TeensySPIBackend(SPIClass& spi) : m_spi(spi), m_complete(nullptr), m_context(nullptr), m_begun(false) {}
+
+            void begin(){
+                if(m_begun) return;
+                m_spi.begin();
+                m_event.setContext(this);
+                m_event.attachImmediate(eventISR);
+                m_begun = true;
+            }
+
+            void configure(uint32_t frequency, uint8_t mode){
+                m_spi.beginTransaction(SPISettings(frequency, MSBFIRST, mode));
+            }
+
+            void release(){
+                m_spi.endTransaction();
+            }
+
+            void select(uint8_t pin){
+                digitalWriteFast(pin, LOW);
+            }
+
+            void deselect(uint8_t pin){
+                digitalWriteFast(pin, HIGH);
+            }
+
+            bool transfer(const uint8_t* tx, uint8_t* rx, uint16_t length, void (*complete)(void*), void* context){
+                if(length >= RocketOS_Utilities_SPIDMAThreshold){
+                    m_complete = complete;
+                    m_context = context;
+                    if(m_spi.transfer(tx, rx, length, m_event)) return false;
+                }
+                m_spi.transfer(tx, rx, length);
+                return true;
+            }
+
+            //DMA completions arrive through the EventResponder
+            void poll(){}
+
+            SPIClass& getSPI(){
+                return m_spi;
+            }
+
+        private:
+            static void eventISR(EventResponderRef event){
+                TeensySPIBackend* backend = static_cast<TeensySPIBackend*>(event.getContext());
+                backend->m_complete(backend->m_context);
+            }
+        };
+    }
+}
@@ -0,0 +1,88 @@
+#pragma once
+#include "RocketOS_UtilitiesGeneral.h"
+#include <array>
+#include <atomic>
+
+namespace RocketOS{
+    namespace Utilities{
+        /*Single producer single consumer queue
+         * Lock-free channel between exactly one producer context and one consumer context, for example the main loop and an
+         * interrupt routine. The head is only written by the consumer and the tail only by the producer. Each side publishes its
+         * index with a release store after touching the data and reads the other side's index with an acquire load, so an element
+         * is always fully written before the consumer can see it and fully read before the producer can reuse its slot.
+         *
+         * The indices run freely and are masked into the buffer, so all t_size slots are usable and t_size must be a power of two.
+         * clear() moves the head and so belongs to the consumer; call it from the producer only while the consumer is masked.
+        */
+        template<class T, std::size_t t_size>
+        class SPSCQueue{
+        private:
+            static_assert(t_size > 1 && (t_size & (t_size - 1)) == 0, "SPSCQueue size must be a power of two");
+            static constexpr uint32_t c_mask = t_size - 1;
+            std::array<T, t_size> m_data;
+            std::atomic<uint32_t> m_head;
+            std::atomic<uint32_t> m_tail;
+        public:
+            SPSCQueue() : m_head(0), m_tail(0) {}
+
+            // --- producer side ---
+            error_t push(const T& newElement){
+                uint32_t tail = m_tail.load(std::memory_order_relaxed);
+                if(tail - m_head.load(std::memory_order_acquire) == t_size) return error_t::ERROR;
+                m_data[tail & c_mask] = newElement;
+                m_tail.store(tail + 1, std::memory_order_release);
+                return error_t::GOOD;
+            }
+
+            //pushes as many of the elements as fit, returns the number pushed
+            uint_t push(const T* elements, uint_t count){
+                uint32_t tail = m_tail.load(std::memory_order_relaxed);
+                uint32_t space = t_size - (tail - m_head.load(std::memory_order_acquire));
+                if(count > space) count = space;
+                for(uint_t i=0; i<count; i++)
+                    m_data[(tail + i) & c_mask] = elements[i];
+                m_tail.store(tail + count, std::memory_order_release);
+                return count;
+            }
+
+            // --- consumer side ---
+            result_t<T> pop(){
+                uint32_t head = m_head.load(std::memory_order_relaxed);
+                if(head == m_tail.load(std::memory_order_acquire)) return error_t::ERROR;
+                T returnData = m_data[head & c_mask];
+                m_head.store(head + 1, std::memory_order_release);
+                return returnData;
+            }
+
+            //pops up to count elements into the buffer, returns the number popped
+            uint_t pop(T* elements, uint_t count){
+                uint32_t head = m_head.load(std::memory_order_relaxed);
+                uint32_t available = m_tail.load(std::memory_order_acquire) - head;
+                if(count > available) count = available;
+                for(uint_t i=0; i<count; i++)
+                    elements[i] = m_data[(head + i) & c_mask];
+                m_head.store(head + count, std::memory_order_release);
+                return count;
+            }
+
+            void clear(){
+                m_head.store(m_tail.load(std::memory_order_acquire), std::memory_order_release);
+            }
+
+            // --- either side ---
+            uint_t size() const{
+                //head first so a pop between the loads can not make the size negative
+                uint32_t head = m_head.load(std::memory_order_acquire);
+                return m_tail.load(std::memory_order_acquire) - head;
+            }
+
+            constexpr uint_t capacity() const{
+                return t_size;
+            }
+
+            bool empty() const{
+                return size() == 0;
+            }
+        };
+    }
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include "RocketOS_UtilitiesGeneral.h"
+#include "RocketOS_UtilitiesSPSCQueue.h"
+
+namespace RocketOS{
+    namespace Utilities{
+        using safePointCallback_t = inplaceFunction_t<void(void), RocketOS_Utilities_SafePointCallbackCaptureSize>;
+
+        /*Safe point
+         * Hands changes from the main loop to a periodic interrupt so they are applied between two of its ticks.
+         * The interrupt calls apply() at the start of each tick, which runs every change posted since the last tick.
+         * This keeps a tick from seeing half of a multi-value change without masking interrupts in the main loop.
+         *
+         * While the interrupt is not running (setActive(false)) changes are applied immediately by post().
+         * The owner should mark the safe point active before starting its timer and inactive after stopping it.
+         * post() is for one producer context (the main loop), apply() for the interrupt.
+        */
+        template<std::size_t t_size>
+        class SafePoint{
+        private:
+            SPSCQueue<safePointCallback_t, t_size> m_pending;
+            volatile bool m_active;
+        public:
+            SafePoint() : m_active(false) {}
+
+            error_t post(safePointCallback_t change){
+                if(!m_active){
+                    change();
+                    return error_t::GOOD;
+                }
+                return m_pending.push(change);
+            }
+
+            //call at the start of the interrupt, returns the number of changes applied
+            uint_t apply(){
+                uint_t numApplied = 0;
+                for(result_t<safePointCallback_t> change = m_pending.pop(); change.error == error_t::GOOD; change = m_pending.pop()){
+                    change.data();
+                    numApplied++;
+                }
+                return numApplied;
+            }
+
+            void setActive(bool active){
+                m_active = active;
+                //the interrupt is stopped, so anything it did not get to is applied here
+                if(!active) apply();
+            }
+
+            bool isActive() const{
+                return m_active;
+            }
+
+            uint_t pending() const{
+                return m_pending.size();
+            }
+        };
+    }
+}
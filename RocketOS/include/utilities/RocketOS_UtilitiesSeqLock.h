@@ -0,0 +1,74 @@
+#pragma once
+#include "RocketOS_UtilitiesGeneral.h"
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <type_traits>
+
+namespace RocketOS{
+    namespace Utilities{
+        /*Sequence lock
+         * Shares a value from one writer to any number of readers without disabling interrupts on the read side.
+         * The writer makes the sequence number odd, stores the value and makes it even again.
+         * A reader copies the value and keeps the copy only if the sequence number was even and unchanged across the copy, so a
+         * copy is never a mix of two writes. The value is stored as relaxed atomic words so concurrent access is well defined.
+         * 
+         * Writers must not run concurrently with each other. A writer that can be preempted by another writer must mask interrupts
+         * around write(). A reader that preempts the writer can never see the write finish, so interrupt routines should use
+         * tryRead() (bounded attempts) and keep their previous copy when it fails. read() retries until it succeeds and is meant for
+         * lower priority contexts such as the main loop.
+        */
+        template<class T>
+        class SeqLock{
+        private:
+            static_assert(std::is_trivially_copyable_v<T>, "SeqLock values must be trivially copyable");
+            static constexpr std::size_t c_numWords = (sizeof(T) + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+            using Words = std::array<uint32_t, c_numWords>;
+            std::atomic<uint32_t> m_sequence;
+            std::array<std::atomic<uint32_t>, c_numWords> m_data;
+        public:
+            SeqLock() : m_sequence(0), m_data{} {}
+
+            explicit SeqLock(const T& value) : SeqLock(){
+                write(value);
+            }
+
+            void write(const T& value){
+                Words words{};
+                std::memcpy(words.data(), &value, sizeof(T));
+                uint32_t sequence = m_sequence.load(std::memory_order_relaxed);
+                m_sequence.store(sequence + 1, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_release);
+                for(std::size_t i=0; i<c_numWords; i++)
+                    m_data[i].store(words[i], std::memory_order_relaxed);
+                m_sequence.store(sequence + 2, std::memory_order_release);
+            }
+
+            bool tryRead(T& value, uint_t attempts = RocketOS_Utilities_SeqLockReadAttempts) const{
+                for(uint_t attempt=0; attempt<attempts; attempt++){
+                    uint32_t before = m_sequence.load(std::memory_order_acquire);
+                    if(before & 1) continue; //write in progress
+                    Words words;
+                    for(std::size_t i=0; i<c_numWords; i++)
+                        words[i] = m_data[i].load(std::memory_order_relaxed);
+                    std::atomic_thread_fence(std::memory_order_acquire);
+                    if(m_sequence.load(std::memory_order_relaxed) != before) continue; //value changed during the copy
+                    std::memcpy(&value, words.data(), sizeof(T));
+                    return true;
+                }
+                return false;
+            }
+
+            T read() const{
+                T value;
+                while(!tryRead(value)){}
+                return value;
+            }
+
+            //number of completed writes, can be used to detect new values
+            uint32_t getVersion() const{
+                return m_sequence.load(std::memory_order_acquire) / 2;
+            }
+        };
+    }
+}
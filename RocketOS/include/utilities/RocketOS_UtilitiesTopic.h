@@ -0,0 +1,180 @@
+#pragma once
+#include "RocketOS_UtilitiesGeneral.h"
+#include <array>
+#include <atomic>
+#include <type_traits>
+
+namespace RocketOS{
+    namespace Utilities{
+        /*Topic
+         * Publish/subscribe channel for one message type with a fixed number of slots and no allocation.
+         * The producer fills the next slot in place (loan() then commit(), or publish() to copy) and subscribers read the slots in
+         * place, so a message is never copied between the producer and a consumer unless the consumer asks for a copy.
+         *
+         * Each slot carries the index of the message it holds: index while it is being written and index + 1 once committed.
+         * A reader checks the tag before and after using a slot, so a reader that is preempted long enough for the producer to
+         * wrap around onto its slot sees that the message was overwritten instead of reading a mix of two messages.
+         * Unlike SeqLock the slots are plain memory so they can be used in place, which is only well defined when the producer and
+         * subscribers share one core (interrupt priorities) as they do on the Teensy.
+         *
+         * There must be a single producer context. Subscribers can run in any context, including interrupts that preempt the
+         * producer, since the slot being written is never the newest committed one.
+        */
+        class TopicBase{
+        private:
+            const char* const m_name;
+            const uint_t m_depth;
+        protected:
+            std::atomic<uint32_t> m_count;
+        public:
+            TopicBase(const char* name, uint_t depth) : m_name(name), m_depth(depth), m_count(0) {}
+
+            const char* getName() const{
+                return m_name;
+            }
+
+            uint_t getDepth() const{
+                return m_depth;
+            }
+
+            //number of messages committed so far
+            uint32_t getCount() const{
+                return m_count.load(std::memory_order_acquire);
+            }
+        };
+
+        template<class T, std::size_t t_depth>
+        class Topic : public TopicBase{
+        private:
+            static_assert(t_depth > 1, "Topic needs at least two slots so the newest message is never the one being written");
+            static_assert(std::is_trivially_copyable_v<T>, "Topic messages must be trivially copyable");
+            struct Slot{
+                std::atomic<uint32_t> tag;
+                T value;
+            };
+            std::array<Slot, t_depth> m_slots;
+        public:
+            Topic(const char* name) : TopicBase(name, t_depth){
+                for(Slot& slot : m_slots) slot.tag.store(UINT32_MAX, std::memory_order_relaxed);
+            }
+
+            //slot for the next message, only valid until commit()
+            T& loan(){
+                uint32_t index = m_count.load(std::memory_order_relaxed);
+                Slot& slot = m_slots[index % t_depth];
+                slot.tag.store(index, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_release);
+                return slot.value;
+            }
+
+            void commit(){
+                uint32_t index = m_count.load(std::memory_order_relaxed);
+                m_slots[index % t_depth].tag.store(index + 1, std::memory_order_release);
+                m_count.store(index + 1, std::memory_order_release);
+            }
+
+            void publish(const T& message){
+                loan() = message;
+                commit();
+            }
+
+            //message number index if it is still held, nullptr if it was overwritten or not published yet
+            const T* at(uint32_t index) const{
+                if(!intact(index)) return nullptr;
+                return &m_slots[index % t_depth].value;
+            }
+
+            //true if message number index is still held, check after reading through at()
+            bool intact(uint32_t index) const{
+                std::atomic_thread_fence(std::memory_order_acquire);
+                return m_slots[index % t_depth].tag.load(std::memory_order_acquire) == index + 1;
+            }
+        };
+
+        /*Subscriber
+         * Consumer side of a topic with its own read position and rate.
+         * latest() gives the newest message and next() walks the queued messages in order, counting the ones that were overwritten
+         * before they were read. Both return a pointer into the topic, valid() tells if that message survived the read.
+         * due() is an optional rate limit for consumers that poll faster than they want data.
+        */
+        template<class T, std::size_t t_depth>
+        class Subscriber{
+        private:
+            const Topic<T, t_depth>& m_topic;
+            uint32_t m_next;
+            uint32_t m_current;
+            uint32_t m_dropped;
+            uint32_t m_period_us;
+            uint32_t m_lastRead_us;
+        public:
+            Subscriber(const Topic<T, t_depth>& topic, uint32_t period_us = 0) : m_topic(topic), m_next(topic.getCount()), m_current(0), m_dropped(0), m_period_us(period_us), m_lastRead_us(0) {}
+
+            //number of unread messages still held by the topic
+            uint_t available() const{
+                uint32_t count = m_topic.getCount();
+                uint32_t unread = count - m_next;
+                return unread < t_depth ? unread : t_depth - 1;
+            }
+
+            const T* latest(){
+                uint32_t count = m_topic.getCount();
+                if(count == 0) return nullptr;
+                m_next = count;
+                m_current = count - 1;
+                return m_topic.at(m_current);
+            }
+
+            const T* next(){
+                uint32_t count = m_topic.getCount();
+                if(count == m_next) return nullptr;
+                //the oldest slot may be the one being written, so only the newest depth - 1 messages are readable
+                if(count - m_next > t_depth - 1){
+                    m_dropped += count - m_next - (t_depth - 1);
+                    m_next = count - (t_depth - 1);
+                }
+                m_current = m_next++;
+                const T* message = m_topic.at(m_current);
+                if(message == nullptr) m_dropped++;
+                return message;
+            }
+
+            //true if the message returned by the last latest() or next() was not overwritten while it was being used
+            bool valid() const{
+                return m_topic.intact(m_current);
+            }
+
+            //copies the newest message, false if there is none or the producer kept overwriting it
+            bool copyLatest(T& message, uint_t attempts = RocketOS_Utilities_SeqLockReadAttempts){
+                for(uint_t attempt=0; attempt<attempts; attempt++){
+                    const T* source = latest();
+                    if(source == nullptr) continue;
+                    message = *source;
+                    if(valid()) return true;
+                }
+                return false;
+            }
+
+            bool due(uint32_t now_us){
+                if(now_us - m_lastRead_us < m_period_us) return false;
+                m_lastRead_us = now_us;
+                return true;
+            }
+
+            void setPeriod_us(uint32_t period_us){
+                m_period_us = period_us;
+            }
+
+            uint32_t getPeriod_us() const{
+                return m_period_us;
+            }
+
+            uint32_t getDropped() const{
+                return m_dropped;
+            }
+
+            const Topic<T, t_depth>& getTopic() const{
+                return m_topic;
+            }
+        };
+    }
+}
@@ -17,51 +17,70 @@ Application::Application(char* telemetryBuffer, uint_t telemetryBufferSize, char
     m_launchDetectionParameters("launch", Airbrakes_CFG_LaunchMaximumAltitude_m, Airbrakes_CFG_LaunchMinimumVelocity_mPerS, Airbrakes_CFG_LaunchMinimumAcceleration_mPerS2, Airbrakes_CFG_LaunchMinimumSamples, Airbrakes_CFG_LaunchMinimumTime_ms),
     m_burnoutDetectionParameters("burnout", Airbrakes_CFG_BurnoutMinimumAltitude_m, Airbrakes_CFG_BurnoutMinimumVelocity_mPerS, Airbrakes_CFG_BurnoutMaximumAcceleration_mPerS2, Airbrakes_CFG_BurnoutMinimumSamples, Airbrakes_CFG_BurnoutMinimumTime_ms),
     m_apogeeDetectionParameters("apogee", Airbrakes_CFG_ApogeeMinimumAltitude_m, Airbrakes_CFG_ApogeeMaximumVelocity_mPerS, Airbrakes_CFG_ApogeeMaximumAcceleration_mPerS2, Airbrakes_CFG_ApogeeMinimumSamples, Airbrakes_CFG_ApogeeMinimumTime_ms),
+    //shared models
+    m_deferredWork("deferred"),
     //peripherals
-    m_altimeter("altimeter", Airbrakes_CFG_AltimeterNominalGroundTemperature, Airbrakes_CFG_AltimeterNominalGroundPressure, Airbrakes_CFG_AltimeterSPIFrequency, TeensyTimerTool::TMR1),
-    m_imu("imu", Airbrakes_CFG_IMU_SPIFrequency, Airbrakes_CFG_IMU_SamplePeriod_us),
+    m_spi0Backend(SPI),
+    m_spi1Backend(SPI1),
+    m_spi0("spi0", m_spi0Backend),
+    m_spi1("spi1", m_spi1Backend),
+    m_altimeter("altimeter", m_atmosphere, m_spi0, Airbrakes_CFG_AltimeterNominalGroundTemperature, Airbrakes_CFG_AltimeterNominalGroundPressure, Airbrakes_CFG_AltimeterSPIFrequency, Airbrakes_CFG_AltimeterPressureOSR, Airbrakes_CFG_AltimeterTemperatureOSR, Airbrakes_CFG_AltimeterTemperatureRatio, TeensyTimerTool::TMR1),
+    m_altimeterCalibrationState(Sensors::MS5607_SPI::CalibrationStates::Idle),
+    m_imu("imu", m_deferredWork, m_spi1, Airbrakes_CFG_IMU_SPIFrequency, Airbrakes_CFG_IMU_SamplePeriod_us, Airbrakes_CFG_IMU_BatchInterval_us),
     m_actuator("motor"),
     m_actuateInFlight(true),
     //control syatems
-    m_controller("controller", 100000, m_flightPlan, m_observer, m_actuator, Airbrakes_CFG_DecayRate),
-    m_flightPlan("plan", m_sdCard, flightPlanMem, flightPlanMemSize, Airbrakes_CFG_DefaultFlightPlanFileName),
     m_observer(m_imu, m_altimeter),
+    m_controller("controller", 100000, m_flightPlan, m_observer, m_actuator, m_atmosphere, Airbrakes_CFG_DecayRate),
+    m_flightPlan("plan", m_sdCard, flightPlanMem, flightPlanMemSize, Airbrakes_CFG_DefaultFlightPlanFileName),
+    m_detectionSubscriber(m_observer.getOutputTopic()),
+    m_observerState{},
+    m_telemetryState(m_observer.getOutputTopic(), m_controller.getOutputTopic()),
+    m_HILState(m_observer.getOutputTopic(), m_controller.getOutputTopic()),
+    m_shellState(m_observer.getOutputTopic(), m_controller.getOutputTopic()),
     m_simulationType(ObserverModes::FullSimulation),
     //telemetry systems
     m_telemetry("telemetry", m_sdCard, telemetryBuffer, telemetryBufferSize, Airbrakes_CFG_DefaultTelemetryFile, Airbrakes_CFG_TelemetryRefreshPeriod_ms,
         DataLogSettings<const char*>{m_stateName, "State"},
-        DataLogSettings<float_t>{m_observer.getPredictedAltitudeRef(), "Predicted Altitude"}, 
-        DataLogSettings<float_t>{m_observer.getPredictedVerticalVelocityRef(), "Predicted Vertical Velocity"},
-        DataLogSettings<float_t>{m_observer.getPredictedVerticalAccelerationRef(), "Predicted Vertical Acceleration"},
-        DataLogSettings<float_t>{m_observer.getPredictedAngleRef(), "Predicted Angle to Horizontal"},
-        DataLogSettings<float_t>{m_observer.getMeasuredAltitudeRef(), "Measured Altitude"},
-        DataLogSettings<float_t>{m_observer.getMeasuredPressureRef(), "Measured Pressure"},
-        DataLogSettings<float_t>{m_observer.getMeasuredTemperatureRef(), "Measured Temperature"},
-        DataLogSettings<float_t>{m_observer.getMeasuredLinearAccelerationRef().x, "Measured Acceleration x"},
-        DataLogSettings<float_t>{m_observer.getMeasuredLinearAccelerationRef().y, "Measured Acceleration y"},
-        DataLogSettings<float_t>{m_observer.getMeasuredLinearAccelerationRef().z, "Measured Acceleration z"},
-        DataLogSettings<float_t>{m_observer.getMeasuredRotationRef().x, "Measured Rotation x"},
-        DataLogSettings<float_t>{m_observer.getMeasuredRotationRef().y, "Measured Rotation y"},
-        DataLogSettings<float_t>{m_observer.getMeasuredRotationRef().z, "Measured Rotation z"},
-        DataLogSettings<float_t>{m_observer.getMeasuredGravityRef().x, "Measured Gravity x"},
-        DataLogSettings<float_t>{m_observer.getMeasuredGravityRef().y, "Measured Gravity y"},
-        DataLogSettings<float_t>{m_observer.getMeasuredGravityRef().z, "Measured Gravity z"},
-        DataLogSettings<float_t>{m_observer.getMeasuredOrientationRef().r, "Measured Orientation real part"},
-        DataLogSettings<float_t>{m_observer.getMeasuredOrientationRef().i, "Measured Orientation i part"},
-        DataLogSettings<float_t>{m_observer.getMeasuredOrientationRef().j, "Measured Orientation j part"},
-        DataLogSettings<float_t>{m_observer.getMeasuredOrientationRef().k, "Measured Orientation k part"},
-        DataLogSettings<float_t>{m_observer.getMeasuredAngleRef(), "Measured Angle to Horizontal"},
-        DataLogSettings<float_t>{m_controller.getErrorRef(), "Controller error"},
-        DataLogSettings<float_t>{m_controller.getFlightPathRef(), "Flight path"},
-        DataLogSettings<float_t>{m_controller.getVPartialRef(), "Flght path velocity partial derivative"},
-        DataLogSettings<float_t>{m_controller.getAnglePartialRef(), "Flght path angle partial derivative"},
-        DataLogSettings<float_t>{m_controller.getUpdateRuleDragRef(), "Update rule drag area"},
-        DataLogSettings<float_t>{m_controller.getAdjustedDragRef(), "Adjusted drag area"},
-        DataLogSettings<float_t>{m_controller.getRequestedDragRef(), "Requested drag area"},
-        DataLogSettings<float_t>{m_controller.getCurrentDragRef(), "Current drag area"},
-        DataLogSettings<bool>{m_controller.getClampFlagRef(), "Update rule shutdown"},
-        DataLogSettings<bool>{m_controller.getSaturationFlagRef(), "Controller saturation"},
-        DataLogSettings<bool>{m_controller.getFaultFlagRef(), "Controller fault"}
+        DataLogSettings<float_t>{m_telemetryState.observer.altitude, "Predicted Altitude"}, 
+        DataLogSettings<float_t>{m_telemetryState.observer.verticalVelocity, "Predicted Vertical Velocity"},
+        DataLogSettings<float_t>{m_telemetryState.observer.verticalAcceleration, "Predicted Vertical Acceleration"},
+        DataLogSettings<float_t>{m_telemetryState.observer.angleToHorizontal, "Predicted Angle to Horizontal"},
+        DataLogSettings<float_t>{m_telemetryState.observer.measuredAltitude, "Measured Altitude"},
+        DataLogSettings<float_t>{m_telemetryState.observer.measuredPressure, "Measured Pressure"},
+        DataLogSettings<float_t>{m_telemetryState.observer.measuredTemperature, "Measured Temperature"},
+        DataLogSettings<float_t>{m_telemetryState.observer.measuredLinearAcceleration.x, "Measured Acceleration x"},
+        DataLogSettings<float_t>{m_telemetryState.observer.measuredLinearAcceleration.y, "Measured Acceleration y"},
+        DataLogSettings<float_t>{m_telemetryState.observer.measuredLinearAcceleration.z, "Measured Acceleration z"},
+        DataLogSettings<float_t>{m_telemetryState.observer.measuredRotation.x, "Measured Rotation x"},
+        DataLogSettings<float_t>{m_telemetryState.observer.measuredRotation.y, "Measured Rotation y"},
+        DataLogSettings<float_t>{m_telemetryState.observer.measuredRotation.z, "Measured Rotation z"},
+        DataLogSettings<float_t>{m_telemetryState.observer.measuredGravity.x, "Measured Gravity x"},
+        DataLogSettings<float_t>{m_telemetryState.observer.measuredGravity.y, "Measured Gravity y"},
+        DataLogSettings<float_t>{m_telemetryState.observer.measuredGravity.z, "Measured Gravity z"},
+        DataLogSettings<float_t>{m_telemetryState.observer.measuredOrientation.r, "Measured Orientation real part"},
+        DataLogSettings<float_t>{m_telemetryState.observer.measuredOrientation.i, "Measured Orientation i part"},
+        DataLogSettings<float_t>{m_telemetryState.observer.measuredOrientation.j, "Measured Orientation j part"},
+        DataLogSettings<float_t>{m_telemetryState.observer.measuredOrientation.k, "Measured Orientation k part"},
+        DataLogSettings<float_t>{m_telemetryState.observer.measuredAngleToHorizontal, "Measured Angle to Horizontal"},
+        DataLogSettings<uint_t>{m_telemetryState.observer.altitudeTime_us, "Altitude sample time"},
+        DataLogSettings<uint_t>{m_telemetryState.observer.accelerationTime_us, "Acceleration sample time"},
+        DataLogSettings<uint_t>{m_telemetryState.observer.accelerationAge_us, "Acceleration sample age"},
+        DataLogSettings<uint_t>{m_telemetryState.observer.gravityAge_us, "Gravity sample age"},
+        DataLogSettings<uint_t>{m_telemetryState.observer.orientationAge_us, "Orientation sample age"},
+        DataLogSettings<uint_t>{m_imu.getMissedReportsRef(), "IMU missed reports"},
+        DataLogSettings<float_t>{m_telemetryState.controller.error, "Controller error"},
+        DataLogSettings<float_t>{m_telemetryState.controller.flightPath, "Flight path"},
+        DataLogSettings<float_t>{m_telemetryState.controller.flightPathVelocityPartial, "Flght path velocity partial derivative"},
+        DataLogSettings<float_t>{m_telemetryState.controller.flightPathAnglePartial, "Flght path angle partial derivative"},
+        DataLogSettings<float_t>{m_telemetryState.controller.updateRuleDragArea, "Update rule drag area"},
+        DataLogSettings<float_t>{m_telemetryState.controller.adjustedDragArea, "Adjusted drag area"},
+        DataLogSettings<float_t>{m_telemetryState.controller.requestedDragArea, "Requested drag area"},
+        DataLogSettings<float_t>{m_telemetryState.controller.currentDragArea, "Current drag area"},
+        DataLogSettings<float_t>{m_telemetryState.controller.predictedApogee, "Predicted apogee"},
+        DataLogSettings<bool>{m_telemetryState.controller.updateRuleClamped, "Update rule shutdown"},
+        DataLogSettings<bool>{m_telemetryState.controller.isSaturated, "Controller saturation"},
+        DataLogSettings<bool>{m_telemetryState.controller.fault, "Controller fault"}
     ),
     m_log("log", m_sdCard, logBuffer, logBufferSize, Airbrakes_CFG_DefaultLogFile),
     m_bufferFlightTelemetry(false),
@@ -81,14 +100,19 @@ Application::Application(char* telemetryBuffer, uint_t telemetryBufferSize, char
         EEPROMSettings<uint_t>{m_HILRefreshPeriod, Airbrakes_CFG_HILRefresh_ms, "simulation refresh"},
         EEPROMSettings<float_t>{m_controller.getDecayRateRef(), Airbrakes_CFG_DecayRate, "controller decay rate"},
         EEPROMSettings<float_t>{m_controller.getCoastVelocityRef(), 0, "controller coast velocity"},
+        EEPROMSettings<Controls::ControlModes>{m_controller.getModeRef(), Controls::ControlModes::FlightPath, "controller mode"},
         EEPROMSettings<uint_t>{m_altimeter.getSPIFrequencyRef(), Airbrakes_CFG_AltimeterSPIFrequency, "altimeter SPI speed"},
         EEPROMSettings<float_t>{m_altimeter.getGroundTemperatureRef(), Airbrakes_CFG_AltimeterNominalGroundTemperature, "altimeter ground temperature"},
         EEPROMSettings<float_t>{m_altimeter.getGroundPressureRef(), Airbrakes_CFG_AltimeterNominalGroundPressure, "altimeter ground pressure"},
+        EEPROMSettings<uint_t>{m_altimeter.getPressureOSRRef(), Airbrakes_CFG_AltimeterPressureOSR, "altimeter pressure OSR"},
+        EEPROMSettings<uint_t>{m_altimeter.getTemperatureOSRRef(), Airbrakes_CFG_AltimeterTemperatureOSR, "altimeter temperature OSR"},
+        EEPROMSettings<uint_t>{m_altimeter.getTemperatureRatioRef(), Airbrakes_CFG_AltimeterTemperatureRatio, "altimeter temperature ratio"},
         EEPROMSettings<uint_t>{m_imu.getSPIFrequencyRef(), Airbrakes_CFG_IMU_SPIFrequency, "imu spi speed"},
         EEPROMSettings<uint32_t>{m_imu.getAccelerationSamplePeriodRef(), Airbrakes_CFG_IMU_SamplePeriod_us, "imu acceleration sample period"},
         EEPROMSettings<uint32_t>{m_imu.getAngularVelocitySamplePeriodRef(), Airbrakes_CFG_IMU_SamplePeriod_us, "imu angular velocity sample period"},
         EEPROMSettings<uint32_t>{m_imu.getOrientationSamplePeriodRef(), Airbrakes_CFG_IMU_SamplePeriod_us, "imu oreintation sample period"},
         EEPROMSettings<uint32_t>{m_imu.getGravitySamplePeriodRef(), Airbrakes_CFG_IMU_SamplePeriod_us, "imu gravity sample period"},
+        EEPROMSettings<uint32_t>{m_imu.getBatchIntervalRef(), Airbrakes_CFG_IMU_BatchInterval_us, "imu batch interval"},
         EEPROMSettings<float_t>{m_actuator.getActuatorLimitRef(), Airbrakes_CFG_MotorDefaultLimit, "actuator range limit"},
         EEPROMSettings<uint_t>{m_actuator.getEncoderStepsRef(), Airbrakes_CFG_MotorFullStrokeNumEncoderPositions, "actuator number of encoder positions"},
         EEPROMSettings<uint_t>{m_actuator.getMotorStepsRef(), Airbrakes_CFG_MotorFullStrokeNumSteps, "actuator number of steps"},
@@ -102,20 +126,25 @@ Application::Application(char* telemetryBuffer, uint_t telemetryBufferSize, char
 
     //serial systems
     m_inputBuffer(115200),
+    m_output("serial", {&RocketOS::HILOutput, &RocketOS::Console}),
+
+    //task scheduling
+    m_scheduler("scheduler"),
+    m_serialTask(0),
 
     //simulation systems
 #ifndef NO_TX_HIL
-    m_TxHIL(
-        m_controller.getCurrentDragRef(),
-        m_controller.getRequestedDragRef(),
-        m_controller.getFlightPathRef(),
-        m_controller.getErrorRef(),
-        m_controller.getUpdateRuleDragRef(),
-        m_controller.getAdjustedDragRef(),
-        m_observer.getPredictedAltitudeRef(),
-        m_observer.getPredictedVerticalVelocityRef(),
-        m_observer.getPredictedVerticalAccelerationRef(),
-        m_observer.getPredictedAngleRef()
+    m_TxHIL(RocketOS::HILOutput,
+        m_HILState.controller.currentDragArea,
+        m_HILState.controller.requestedDragArea,
+        m_HILState.controller.flightPath,
+        m_HILState.controller.error,
+        m_HILState.controller.updateRuleDragArea,
+        m_HILState.controller.adjustedDragArea,
+        m_HILState.observer.altitude,
+        m_HILState.observer.verticalVelocity,
+        m_HILState.observer.verticalAcceleration,
+        m_HILState.observer.angleToHorizontal
     ),
 #endif
 #ifndef NO_RX_HIL
@@ -139,89 +168,154 @@ void Application::initialize(){
     error_t anyError = error_t::GOOD;
     error_t processError;
     m_inputBuffer.init();
-    Serial.println("Initializing airbrakes application...");
+    RocketOS::Console.println("Initializing airbrakes application...");
     //resore EEPROM data
     result_t<bool> result = m_persistent.restore();
     if(result.error != error_t::GOOD){ 
-        Serial.println("Error interfacing with EEPROM");
+        RocketOS::Console.println("Error interfacing with EEPROM");
         anyError = result.error;
     }
-    if(result.data) Serial.println("Restored system defaults because of detected EEPROM layout change");
-    else Serial.println("Loaded persistent EEPROM data");
+    if(result.data) RocketOS::Console.println("Restored system defaults because of detected EEPROM layout change");
+    else RocketOS::Console.println("Loaded persistent EEPROM data");
     //initialize SD card
     if(!m_sdCard.begin(SdioConfig(FIFO_SDIO))){
-         Serial.println("Error initializing the SD card");
+         RocketOS::Console.println("Error initializing the SD card");
          anyError = error_t::ERROR;
     }
-    else Serial.println("Initialized the SD card");
+    else RocketOS::Console.println("Initialized the SD card");
     //load flight plan
     processError = m_flightPlan.loadFromFile();
-    if(processError == error_t::GOOD) Serial.printf("Loaded flight plan from '%s'\n", m_flightPlan.getFileName());
+    if(processError == error_t::GOOD) RocketOS::Console.printf("Loaded flight plan from '%s'\n", m_flightPlan.getFileName());
     else{
-        if(processError == Controls::FlightPlan::ERROR_Formating) Serial.printf("Formatting error encountered when loading flight plan from '%s'\n", m_flightPlan.getFileName());
-        else if(processError == Controls::FlightPlan::ERROR_Memory) Serial.printf("Failed to load flight plan from '%s' due to lack of allocated memory\n", m_flightPlan.getFileName());
-        else if(processError == Controls::FlightPlan::ERROR_File) Serial.printf("Failed to open flight plan with file name '%s'\n", m_flightPlan.getFileName());
-        else Serial.println("Failed to load the flight plan");
+        if(processError == Controls::FlightPlan::ERROR_Formating) RocketOS::Console.printf("Formatting error encountered when loading flight plan from '%s'\n", m_flightPlan.getFileName());
+        else if(processError == Controls::FlightPlan::ERROR_Memory) RocketOS::Console.printf("Failed to load flight plan from '%s' due to lack of allocated memory\n", m_flightPlan.getFileName());
+        else if(processError == Controls::FlightPlan::ERROR_File) RocketOS::Console.printf("Failed to open flight plan with file name '%s'\n", m_flightPlan.getFileName());
+        else RocketOS::Console.println("Failed to load the flight plan");
         anyError = error_t::ERROR;
     }
+    //start the deferred work queue before the sensors that post to it
+    m_deferredWork.begin();
     //init altimeter
     if(m_altimeter.initialize() != error_t::GOOD){
-        Serial.println("Failed to initialize the altimeter");
+        RocketOS::Console.println("Failed to initialize the altimeter");
         anyError = error_t::ERROR;
     }
-    else Serial.println("Initialized the altimeter");
+    else RocketOS::Console.println("Initialized the altimeter");
     //init IMU
     if(m_imu.initialize() != error_t::GOOD){
-        Serial.println("Failed to detect the IMU");
+        RocketOS::Console.println("Failed to detect the IMU");
         anyError = error_t::ERROR;
     }
-    else Serial.println("Initialized the IMU");
+    else RocketOS::Console.println("Initialized the IMU");
     //init motor
     m_actuator.initialize();
     //initialize control syatem
     m_controller.resetInit();
-    Serial.println("Initialized the controller");
+    RocketOS::Console.println("Initialized the controller");
     if(m_observer.setMode(ObserverModes::Sensor) != error_t::GOOD){
-        Serial.println("Failed to place the observer into sensor mode");
+        RocketOS::Console.println("Failed to place the observer into sensor mode");
+        anyError = error_t::ERROR;
+    }
+    else RocketOS::Console.println("Placed the observer into sensor mode");
+    //start background tasks
+    if(registerTasks() != error_t::GOOD){
+        RocketOS::Console.println("Failed to register the background tasks");
         anyError = error_t::ERROR;
     }
-    else Serial.println("Placed the observer into sensor mode");
+    else RocketOS::Console.println("Registered the background tasks");
     //final message
-    if(anyError == error_t::GOOD) Serial.println("Successfully initialized all systems");
-    else Serial.println("Initialization complete, some systems failed to initialize");
+    if(anyError == error_t::GOOD) RocketOS::Console.println("Successfully initialized all systems");
+    else RocketOS::Console.println("Initialization complete, some systems failed to initialize");
 }
 
 void Application::makeShutdownSafe(bool printErrors){
     //save non-volatile memory
-    if(m_persistent.save() != error_t::GOOD && printErrors) Serial.println("Error saving persistent EEPROM data");
+    if(m_persistent.save() != error_t::GOOD && printErrors) RocketOS::Console.println("Error saving persistent EEPROM data");
     //save telemetry and logs
-    if(m_telemetry.flush() != error_t::GOOD && printErrors) Serial.println("Error flushing telemetry file");
-    if(m_log.flush() != error_t::GOOD && printErrors) Serial.println("Error flushing log file");
+    if(m_telemetry.flush() != error_t::GOOD && printErrors) RocketOS::Console.println("Error flushing telemetry file");
+    if(m_log.flush() != error_t::GOOD && printErrors) RocketOS::Console.println("Error flushing log file");
     //shutdown motor
     m_actuator.sleep();
 }
 
 void Application::updateBackground(){
+    //run background tasks that are due
+    m_scheduler.dispatch();
+    //send buffered output as the USB port has room for it
+    m_output.update();
+}
+
+error_t Application::registerTasks(){
+    //serial first so commands stay responsive, then sensor buffers, then flight logic
+    result_t<uint_t> serial = m_scheduler.addPeriodic("serial", [this](){ serialTasks(); }, {m_HILRefreshPeriod * 1000, m_HILRefreshPeriod * 1000, 0});
+    if(serial.error != error_t::GOOD) return serial.error;
+    m_serialTask = serial.data;
+    //the refresh period is a persistent setting, a restore from the shell has to reach the running task
+    m_persistent.onRestore([this](){ m_scheduler.setPeriod(m_serialTask, m_HILRefreshPeriod * 1000); });
+    result_t<uint_t> imu = m_scheduler.addPeriodic("imu", [this](){ m_imu.updateBackground(); }, {0, 0, 1});
+    if(imu.error != error_t::GOOD) return imu.error;
+    result_t<uint_t> altimeter = m_scheduler.addPeriodic("altimeter", [this](){ altimeterTasks(); }, {0, 0, 1});
+    if(altimeter.error != error_t::GOOD) return altimeter.error;
+    result_t<uint_t> state = m_scheduler.addPeriodic("state", [this](){ stateTasks(); }, {0, 0, 2});
+    if(state.error != error_t::GOOD) return state.error;
+    return error_t::GOOD;
+}
+
+void Application::serialTasks(){
     //handle HIL updates and command inputs
-    if(m_serialRefresh > m_HILRefreshPeriod){
 #ifndef NO_TX_HIL
-        if(m_HILEnabled) m_TxHIL.sendUpdate();
+    if(m_HILEnabled){
+        m_HILState.update();
+        m_TxHIL.sendUpdate();
+    }
 #endif
-        m_inputBuffer.update();
-         while(m_inputBuffer.hasData()){
+    //at most one queue of lines per pass, anything still arriving is picked up next pass
+    m_inputBuffer.update();
+    while(m_inputBuffer.hasData()){
+        //commands run with interrupts enabled, ones that touch interrupt owned state are marked atomic or go through a safe point
+        m_interpreter.readLine();
+#ifndef NO_RX_HIL
+        if(m_HILEnabled){
+            m_RxHIL.readLine();
+            //the observer interrupt also publishes, so the write is masked to keep a single writer
             noInterrupts();
-            m_interpreter.readLine();
+            m_observer.publishState();
             interrupts();
-#ifndef NO_RX_HIL
-            if(m_HILEnabled) m_RxHIL.readLine();
+        }
 #endif
-            m_inputBuffer.clear();
-            m_inputBuffer.update();
-         }
-         m_serialRefresh = 0;
+        m_inputBuffer.clear();
+    }
+}
+
+void Application::altimeterTasks(){
+    //ground calibration runs in the background, log each change of its state
+    m_altimeter.updateCalibration();
+    Sensors::MS5607_SPI::Calibration calibration = m_altimeter.getCalibration();
+    if(calibration.state == m_altimeterCalibrationState) return;
+    m_altimeterCalibrationState = calibration.state;
+    char message[128];
+    switch(calibration.state){
+        case Sensors::MS5607_SPI::CalibrationStates::Running:
+            snprintf(message, sizeof(message), "Info: Started altimeter ground calibration over %u readings", calibration.target);
+        break;
+        case Sensors::MS5607_SPI::CalibrationStates::Complete:
+            snprintf(message, sizeof(message), "Info: Altimeter ground calibration complete, %.1fpa and %.2fK from %u readings, %u rejected", m_altimeter.getGroundPressureRef(), m_altimeter.getGroundTemperatureRef(), calibration.target, calibration.rejected);
+        break;
+        case Sensors::MS5607_SPI::CalibrationStates::Failed:
+            if(calibration.collected < calibration.target) snprintf(message, sizeof(message), "Error: Altimeter ground calibration timed out after %u of %u readings", calibration.collected, calibration.target);
+            else snprintf(message, sizeof(message), "Error: Altimeter ground calibration failed, %u of %u readings rejected", calibration.rejected, calibration.target);
+        break;
+        case Sensors::MS5607_SPI::CalibrationStates::Idle:
+        default:
+            snprintf(message, sizeof(message), "Warning: Altimeter ground calibration was cancelled");
+        break;
     }
-    //update IMU
-    m_imu.updateBackground();
+    logPrint(message);
+}
+
+void Application::stateTasks(){
+    //event detection reads the newest observer state, the previous copy is kept if there is none
+    m_detectionSubscriber.copyLatest(m_observerState);
     //do tasks for the current state
     switch(m_state){
         case ProgramStates::Standby:
@@ -324,15 +418,16 @@ void Application::initReArmed(){
 void Application::armedTasks(){
     //log telemetry
     if(m_telemetry.ready()){
+        m_telemetryState.update();
         m_telemetry.logLine();
         m_telemetry.clearReady();
     }
     //check for launch
     if(m_stateTransitionSampleTimer >= m_stateTransitionSamplePeriod_ms){
         m_stateTransitionSampleTimer = 0;
-        if(m_observer.getVeritcalVelocity() > m_launchDetectionParameters.getVerticalVelocityThreshold() && 
-            m_observer.getVerticalAcceleration() > m_launchDetectionParameters.getVerticalAccelerationThreshold() && 
-            m_observer.getAltitude() > m_launchDetectionParameters.getAltitudeThreshold() && 
+        if(m_observerState.verticalVelocity > m_launchDetectionParameters.getVerticalVelocityThreshold() && 
+            m_observerState.verticalAcceleration > m_launchDetectionParameters.getVerticalAccelerationThreshold() && 
+            m_observerState.altitude > m_launchDetectionParameters.getAltitudeThreshold() && 
             m_stateTransitionTimer > m_launchDetectionParameters.getTimeThreshold()
         ){
             m_stateTransitionCounter++;
@@ -386,6 +481,7 @@ void Application::initBoost(){
 void Application::boostTasks(){
     //log telemetry
     if(m_telemetry.ready()){
+        m_telemetryState.update();
         error_t error = m_telemetry.logLine();
         //flush buffer if overflow occurs
         if(error == RocketOS::Telemetry::SDFile::ERROR_BufferOverflow){
@@ -399,9 +495,9 @@ void Application::boostTasks(){
     if(m_stateTransitionSampleTimer >= m_stateTransitionSamplePeriod_ms){
         m_stateTransitionSampleTimer = 0;
         //check for false boost
-        if(m_observer.getVeritcalVelocity() < m_launchDetectionParameters.getVerticalVelocityThreshold() && 
-            m_observer.getVerticalAcceleration() < m_launchDetectionParameters.getVerticalAccelerationThreshold() && 
-            m_observer.getAltitude() < m_launchDetectionParameters.getAltitudeThreshold()
+        if(m_observerState.verticalVelocity < m_launchDetectionParameters.getVerticalVelocityThreshold() && 
+            m_observerState.verticalAcceleration < m_launchDetectionParameters.getVerticalAccelerationThreshold() && 
+            m_observerState.altitude < m_launchDetectionParameters.getAltitudeThreshold()
         ){
             m_stateTransitionCounter++;
             if(m_stateTransitionCounter >= m_launchDetectionParameters.getConsecutiveSamplesThreshold()){
@@ -411,9 +507,9 @@ void Application::boostTasks(){
             }
         }
         //check for coast
-        else if(m_observer.getVeritcalVelocity() > m_burnoutDetectionParameters.getVerticalVelocityThreshold() && 
-            m_observer.getVerticalAcceleration() < m_burnoutDetectionParameters.getVerticalAccelerationThreshold() && 
-            m_observer.getAltitude() > m_burnoutDetectionParameters.getAltitudeThreshold() && 
+        else if(m_observerState.verticalVelocity > m_burnoutDetectionParameters.getVerticalVelocityThreshold() && 
+            m_observerState.verticalAcceleration < m_burnoutDetectionParameters.getVerticalAccelerationThreshold() && 
+            m_observerState.altitude > m_burnoutDetectionParameters.getAltitudeThreshold() && 
             m_stateTransitionTimer > m_burnoutDetectionParameters.getTimeThreshold()
         ){
             m_stateTransitionCounter++;
@@ -467,6 +563,7 @@ void Application::initCoast(){
 void Application::coastTasks(){
     //log telemetry
     if(m_telemetry.ready()){
+        m_telemetryState.update();
         error_t error = m_telemetry.logLine();
         //flush buffer if overflow occurs
         if(error == RocketOS::Telemetry::SDFile::ERROR_BufferOverflow){
@@ -480,9 +577,9 @@ void Application::coastTasks(){
     if(m_stateTransitionSampleTimer >= m_stateTransitionSamplePeriod_ms){
         m_stateTransitionSampleTimer = 0;
         //check for false burnout
-        if(m_observer.getVeritcalVelocity() < m_burnoutDetectionParameters.getVerticalVelocityThreshold() && 
-            m_observer.getVerticalAcceleration() > m_burnoutDetectionParameters.getVerticalAccelerationThreshold() && 
-            m_observer.getAltitude() < m_burnoutDetectionParameters.getAltitudeThreshold()
+        if(m_observerState.verticalVelocity < m_burnoutDetectionParameters.getVerticalVelocityThreshold() && 
+            m_observerState.verticalAcceleration > m_burnoutDetectionParameters.getVerticalAccelerationThreshold() && 
+            m_observerState.altitude < m_burnoutDetectionParameters.getAltitudeThreshold()
         ){
             m_stateTransitionCounter++;
             if(m_stateTransitionCounter >= m_burnoutDetectionParameters.getConsecutiveSamplesThreshold()){
@@ -492,9 +589,9 @@ void Application::coastTasks(){
             }
         }
         //check for apogee
-        else if(m_observer.getVeritcalVelocity() < m_apogeeDetectionParameters.getVerticalVelocityThreshold() && 
-            m_observer.getVerticalAcceleration() < m_apogeeDetectionParameters.getVerticalAccelerationThreshold() && 
-            m_observer.getAltitude() > m_apogeeDetectionParameters.getAltitudeThreshold() && 
+        else if(m_observerState.verticalVelocity < m_apogeeDetectionParameters.getVerticalVelocityThreshold() && 
+            m_observerState.verticalAcceleration < m_apogeeDetectionParameters.getVerticalAccelerationThreshold() && 
+            m_observerState.altitude > m_apogeeDetectionParameters.getAltitudeThreshold() && 
             m_stateTransitionTimer > m_apogeeDetectionParameters.getTimeThreshold()
         ){
             m_stateTransitionCounter++;
@@ -547,6 +644,7 @@ void Application::initRecovery(){
 void Application::recoveryTasks(){
     //log telemetry
     if(m_telemetry.ready()){
+        m_telemetryState.update();
         error_t error = m_telemetry.logLine();
         //flush buffer if overflow occurs
         if(error == RocketOS::Telemetry::SDFile::ERROR_BufferOverflow){
@@ -562,9 +660,9 @@ void Application::recoveryTasks(){
     if(m_stateTransitionSampleTimer >= m_stateTransitionSamplePeriod_ms){
         m_stateTransitionSampleTimer = 0;
         //check for false apogee
-        if(m_observer.getVeritcalVelocity() > m_apogeeDetectionParameters.getVerticalVelocityThreshold() && 
-            m_observer.getVerticalAcceleration() > m_apogeeDetectionParameters.getVerticalAccelerationThreshold() && 
-            m_observer.getAltitude() < m_apogeeDetectionParameters.getAltitudeThreshold()
+        if(m_observerState.verticalVelocity > m_apogeeDetectionParameters.getVerticalVelocityThreshold() && 
+            m_observerState.verticalAcceleration > m_apogeeDetectionParameters.getVerticalAccelerationThreshold() && 
+            m_observerState.altitude < m_apogeeDetectionParameters.getAltitudeThreshold()
         ){
             m_stateTransitionCounter++;
             if(m_stateTransitionCounter >= m_apogeeDetectionParameters.getConsecutiveSamplesThreshold()){
@@ -635,8 +733,25 @@ void Application::logPrint(const char* message){
     if(m_log.logLine(message) == RocketOS::Telemetry::SDFile::ERROR_BufferOverflow){
         m_log.flush();
         m_log.logLine("Info: Log buffer overflow detected");
-        Serial.println("Info: Log buffer overflow detected");
+        RocketOS::Console.println("Info: Log buffer overflow detected");
         m_log.logLine(message);
     }
-    Serial.println(message);
+    RocketOS::Console.println(message);
+}
+
+void Application::printTopics() const{
+    RocketOS::Console.println("topic        messages  depth");
+    const RocketOS::Utilities::TopicBase* topics[] = {&m_observer.getOutputTopic(), &m_controller.getOutputTopic()};
+    for(const RocketOS::Utilities::TopicBase* topic : topics){
+        RocketOS::Console.printf("%-12s %8u %6u\n", topic->getName(), topic->getCount(), topic->getDepth());
+    }
+}
+
+void Application::printSnapshot(){
+    //the shell reads the topics through its own subscribers, independent of the telemetry and HIL rates
+    m_shellState.update();
+    const ObserverState& observer = m_shellState.observer;
+    const Controls::ControllerOutput& controller = m_shellState.controller;
+    RocketOS::Console.printf("observer: altitude %.2fm, vertical velocity %.2fm/s, vertical acceleration %.2fm/s^2, angle %.4frad\n", observer.altitude, observer.verticalVelocity, observer.verticalAcceleration, observer.angleToHorizontal);
+    RocketOS::Console.printf("controller: error %.2fm, requested drag %.5fm^2, current drag %.5fm^2, predicted apogee %.2fm%s%s\n", controller.error, controller.requestedDragArea, controller.currentDragArea, controller.predictedApogee, controller.isSaturated ? ", saturated" : "", controller.fault ? ", fault" : "");
 }
\ No newline at end of file
@@ -2,16 +2,24 @@
 
 using namespace Airbrakes;
 using namespace Airbrakes::Controls;
+using RocketOS::Utilities::CycleTimer;
 
 //Natural Constants
-#define TEMPERATURE_LAPSE_RATE 0.0065       //unit: K/m
 #define GRAVITATIONAL_CONSTANT 9.80665      //unit: m/s^2
-#define IDEAL_GAS_CONSTANT 8.31446          //unit: J/mol/K
-#define MOLAR_MASS_OF_DRY_AIR 0.0289652     //unit: kg/mol
 
+//math kernels
+#if Airbrakes_CFG_ControllerFastMath
+namespace ControllerMath = RocketOS::Processing::FastMath;
+#else
+namespace ControllerMath = RocketOS::Processing::StandardMath;
+#endif
 
-Controller::Controller(const char* name, uint_t clockPeriod, const FlightPlan& plan, const Observer& observer, Motor::Actuator& motor, float_t decayRate) : 
-    m_name(name), m_flightPlan(plan), m_observer(observer), m_motor(motor), m_fault(false), m_decayRate(decayRate), m_updateRuleShutdownVelocity(0), m_clockPeriod(clockPeriod), m_isActive(false){}
+//Apogee Predictor Constants
+#define PREDICTOR_MINIMUM_ANGLE 0.01        //unit: rad
+
+
+Controller::Controller(const char* name, uint_t clockPeriod, FlightPlan& plan, const Observer& observer, Motor::Actuator& motor, const RocketOS::Processing::StandardAtmosphere<>& atmosphere, float_t decayRate) : 
+    m_name(name), m_flightPlan(plan), m_observerSubscriber(observer.getOutputTopic()), m_motor(motor), m_atmosphere(atmosphere), m_observerState{}, m_fault(false), m_mode(ControlModes::FlightPath), m_predictedApogee(0), m_highestApogee(0), m_lowestApogee(0), m_decayRate(decayRate), m_updateRuleShutdownVelocity(0), m_clockPeriod(clockPeriod), m_isActive(false), m_budgetOverruns(0), m_output("controller"){}
 
 RocketOS::Shell::CommandList Controller::getCommands() const{
     return {"controller", c_rootCommands.data(), c_rootCommands.size(), c_rootChildren.data(), c_rootChildren.size()};
@@ -19,10 +27,16 @@ RocketOS::Shell::CommandList Controller::getCommands() const{
 
 error_t Controller::start(){
     m_clock.end();
+    m_safePoint.setActive(false);
     if(newFlight() != error_t::GOOD){
         m_isActive = false;
+        m_flightPlan.setInUse(false);
         return error_t::ERROR;
     }
+    //the clock interrupt reads the plan from here on, keep it from being reloaded under it
+    m_flightPlan.setInUse(true);
+    m_safePoint.setActive(true);
+    m_clockJitter.setPeriod_us(m_clockPeriod);
     m_clock.begin([this](){this->clock();}, m_clockPeriod);
     m_isActive = true;
     return error_t::GOOD;
@@ -30,14 +44,21 @@ error_t Controller::start(){
 
 void Controller::stop(){
     m_clock.end();
+    m_safePoint.setActive(false);
     m_isActive = false;
+    m_flightPlan.setInUse(false);
     //set these for simulation
     m_currentDragArea = m_flightPlan.getMinDragArea();
     m_requestedDragArea = m_flightPlan.getMinDragArea();
+    publishOutput();
 }
 
 void Controller::resetInit(){
-    if(m_isActive) m_clock.begin([this](){this->clock();}, m_clockPeriod);
+    if(m_isActive){
+        m_safePoint.setActive(true);
+        m_clockJitter.setPeriod_us(m_clockPeriod);
+        m_clock.begin([this](){this->clock();}, m_clockPeriod);
+    }
 }
 
 bool Controller::isActive(){
@@ -45,12 +66,17 @@ bool Controller::isActive(){
 }
 
 void Controller::clock(){
+    m_clockJitter.tick();
+    m_clockTimer.start();
+    //apply parameter changes from the shell before they are used
+    m_safePoint.apply();
     //clear fault flag
     m_fault = false;
-    //read current state from the observer
-    float_t currentAltitude = m_observer.getAltitude();
-    float_t currentVerticalVelocity = m_observer.getVeritcalVelocity();
-    float_t currentAngle = m_observer.getAngleToHorizontal();
+    //read current state from the observer topic, the last snapshot is reused if there is none or a consistent copy could not be made
+    if(!m_observerSubscriber.copyLatest(m_observerState)) m_fault = true;
+    float_t currentAltitude = m_observerState.altitude;
+    float_t currentVerticalVelocity = m_observerState.verticalVelocity;
+    float_t currentAngle = m_observerState.angleToHorizontal;
     //get flight path parameters from flight plan
     if(!m_flightPlan.isLoaded()){
         m_fault = true;
@@ -58,11 +84,29 @@ void Controller::clock(){
     m_flightPath = m_flightPlan.getAltitude(currentVerticalVelocity, currentAngle);
     m_flightPathVelocityPartial = m_flightPlan.getVelocityPartial(currentVerticalVelocity, currentAngle);
     m_flightPathAnglePartial = m_flightPlan.getAnglePartial(currentVerticalVelocity, currentAngle);
+    //read current deployment from the motor
+    result_t<float_t> result = m_flightPlan.getDragArea(m_motor.getCurrentDeployment());
+    if(result.error != error_t::GOOD) m_fault = true;
+    m_currentDragArea = result;
+    //predict apogee with the current deployment
+    if(m_mode == ControlModes::ApogeePrediction){
+        //the apogee rule needs both actuator extremes, the current deployment lies on the line between them that the rule assumes
+        m_highestApogee = predictApogee(currentAltitude, currentVerticalVelocity, currentAngle, m_flightPlan.getMinDragArea());
+        m_lowestApogee = predictApogee(currentAltitude, currentVerticalVelocity, currentAngle, m_flightPlan.getMaxDragArea());
+        m_predictedApogee = interpolateApogee(m_currentDragArea);
+    }
+    else{
+        m_predictedApogee = predictApogee(currentAltitude, currentVerticalVelocity, currentAngle, m_currentDragArea);
+    }
     //use update rule to compute base airbrake deployment
-    m_error = currentAltitude - m_flightPath;
+    if(m_mode == ControlModes::ApogeePrediction) m_error = m_predictedApogee - m_flightPlan.getTargetApogee();
+    else m_error = currentAltitude - m_flightPath;
     if(currentVerticalVelocity < m_updateRuleShutdownVelocity){
          m_updateRuleClamped = true;
     }
+    else if(m_mode == ControlModes::ApogeePrediction){
+        m_updateRuleDragArea = apogeeRule();
+    }
     else{
         m_updateRuleDragArea = updateRule(m_error, currentVerticalVelocity, currentAngle, currentAltitude, m_flightPathVelocityPartial, m_flightPathAnglePartial);
     }
@@ -71,19 +115,19 @@ void Controller::clock(){
     //limit control input to the physical range of the actuators
     m_requestedDragArea = getBestPossibleDragArea(m_adjustedDragArea, m_error);
     m_isSaturated = (m_requestedDragArea != m_adjustedDragArea);
-    //exchange info with the motor
-    result_t<float_t> result = convertMotorPositionToDragArea(m_motor.getCurrentDeployment());
-    if(result.error != error_t::GOOD) m_fault = true;
-    m_currentDragArea = result;
-    result = convertDragAreaToMotorPosition(m_requestedDragArea);
+    //send request to the motor
+    result = m_flightPlan.getDeployment(m_requestedDragArea);
     if(result.error != error_t::GOOD) m_fault = true;
-    m_motor.setTargetDeployment(convertDragAreaToMotorPosition(m_requestedDragArea));
+    m_motor.setTargetDeployment(result);
+    publishOutput();
+    //check the timing budget
+    if(CycleTimer::toMicroseconds(m_clockTimer.stop()) > Airbrakes_CFG_ControllerBudget_us) m_budgetOverruns++;
 }
 
 //helpers
 
 float_t Controller::airDensity(float_t altitude) const{
-    return m_flightPlan.getGroundPressure() * MOLAR_MASS_OF_DRY_AIR / (IDEAL_GAS_CONSTANT * m_flightPlan.getGroundTemperature()) * std::pow(1-TEMPERATURE_LAPSE_RATE * altitude / m_flightPlan.getGroundTemperature(), GRAVITATIONAL_CONSTANT * MOLAR_MASS_OF_DRY_AIR / (IDEAL_GAS_CONSTANT * TEMPERATURE_LAPSE_RATE)-1);
+    return m_atmosphere.density(altitude, m_flightPlan.getGroundPressure(), m_flightPlan.getGroundTemperature());
 }
 
 float_t Controller::updateRule(float_t error, float_t verticalVelocity, float_t angle, float_t altitude, float_t velocityPartial, float_t anglePartial) const{
@@ -94,29 +138,73 @@ float_t Controller::updateRule(float_t error, float_t verticalVelocity, float_t
     
     Derrived from 2d rocket dynamics
     */
-    return 2 * m_flightPlan.getDryMass() * std::sin(angle) * (m_decayRate * error - verticalVelocity - GRAVITATIONAL_CONSTANT * (velocityPartial + anglePartial * std::sin(2 * angle) / (2 * verticalVelocity))) / (airDensity(altitude) * verticalVelocity * verticalVelocity * velocityPartial);
+    return 2 * m_flightPlan.getDryMass() * ControllerMath::sin(angle) * (m_decayRate * error - verticalVelocity - GRAVITATIONAL_CONSTANT * (velocityPartial + anglePartial * ControllerMath::sin(2 * angle) / (2 * verticalVelocity))) / (airDensity(altitude) * verticalVelocity * verticalVelocity * velocityPartial);
 }
 
-float_t Controller::getBestPossibleDragArea(float_t dragArea, float_t error) const{
-    if(dragArea <= m_flightPlan.getMaxDragArea() && dragArea >= m_flightPlan.getMinDragArea()) return dragArea;
-    if(error > 0) return m_flightPlan.getMaxDragArea();
-    return m_flightPlan.getMinDragArea();
+float_t Controller::predictApogee(float_t altitude, float_t verticalVelocity, float_t angle, float_t dragArea) const{
+    /*Fixed step RK4 integration of the 2d coast dynamics
+     * The step is sized so the drag free coast (v/g) takes Airbrakes_CFG_ApogeePredictorSteps steps
+     * Drag only shortens the coast, so apogee is always reached within the fixed number of steps
+    */
+    if(verticalVelocity <= 0) return altitude;
+    angle = max(angle, PREDICTOR_MINIMUM_ANGLE);
+    const float_t dragConstant = dragArea / (2 * m_flightPlan.getDryMass());
+    const float_t step = verticalVelocity / (GRAVITATIONAL_CONSTANT * Airbrakes_CFG_ApogeePredictorSteps);
+    auto acceleration = [this, dragConstant](float_t height, float_t vx, float_t vy, float_t& ax, float_t& ay){
+        float_t drag = dragConstant * airDensity(height) * ControllerMath::sqrt(vx * vx + vy * vy);
+        ax = -drag * vx;
+        ay = -drag * vy - GRAVITATIONAL_CONSTANT;
+    };
+    float_t height = altitude;
+    float_t vx = verticalVelocity * ControllerMath::cos(angle) / ControllerMath::sin(angle);
+    float_t vy = verticalVelocity;
+    for(uint_t i=0; i<Airbrakes_CFG_ApogeePredictorSteps; i++){
+        float_t ax1, ay1, ax2, ay2, ax3, ay3, ax4, ay4;
+        acceleration(height, vx, vy, ax1, ay1);
+        float_t vy2 = vy + step / 2 * ay1;
+        acceleration(height + step / 2 * vy, vx + step / 2 * ax1, vy2, ax2, ay2);
+        float_t vy3 = vy + step / 2 * ay2;
+        acceleration(height + step / 2 * vy2, vx + step / 2 * ax2, vy3, ax3, ay3);
+        float_t vy4 = vy + step * ay3;
+        acceleration(height + step * vy3, vx + step * ax3, vy4, ax4, ay4);
+        float_t newVy = vy + step / 6 * (ay1 + 2 * ay2 + 2 * ay3 + ay4);
+        float_t newHeight = height + step / 6 * (vy + 2 * vy2 + 2 * vy3 + vy4);
+        if(newVy <= 0){
+            //vertical velocity is close to linear over the last step
+            float_t timeToApogee = step * vy / (vy - newVy);
+            return height + vy * timeToApogee / 2;
+        }
+        vx += step / 6 * (ax1 + 2 * ax2 + 2 * ax3 + ax4);
+        vy = newVy;
+        height = newHeight;
+    }
+    return height;
 }
 
-result_t<float_t> Controller::convertDragAreaToMotorPosition(float_t dragArea) const{
-    if(dragArea == m_flightPlan.getMinDragArea()) return 0;
-    if(dragArea == m_flightPlan.getMaxDragArea()) return 1;
-    if(dragArea < m_flightPlan.getMinDragArea()) return {0, error_t::ERROR};
-    if(dragArea > m_flightPlan.getMaxDragArea()) return {1, error_t::ERROR};
-    return asin(sqrt((dragArea - m_flightPlan.getMinDragArea()) * sinSquared(m_flightPlan.getDeploymentAngleLimit()) / (m_flightPlan.getMaxDragArea() - m_flightPlan.getMinDragArea()))) / m_flightPlan.getDeploymentAngleLimit();
+float_t Controller::interpolateApogee(float_t dragArea) const{
+    float_t range = m_flightPlan.getMaxDragArea() - m_flightPlan.getMinDragArea();
+    if(range <= 0) return m_highestApogee;
+    return m_highestApogee + (m_lowestApogee - m_highestApogee) * (dragArea - m_flightPlan.getMinDragArea()) / range;
 }
 
-result_t<float_t> Controller::convertMotorPositionToDragArea(float_t position) const{
-    if(position == 0) return m_flightPlan.getMinDragArea();
-    if(position == 1) return m_flightPlan.getMaxDragArea();
-    if(position > 1) return {m_flightPlan.getMaxDragArea(), error_t::ERROR};
-    if(position < 0) return {m_flightPlan.getMinDragArea(), error_t::ERROR};
-    return m_flightPlan.getMinDragArea() + sinSquared(position * m_flightPlan.getDeploymentAngleLimit()) / sinSquared(m_flightPlan.getDeploymentAngleLimit()) * (m_flightPlan.getMaxDragArea() - m_flightPlan.getMinDragArea());
+float_t Controller::apogeeRule() const{
+    /*Formula
+                                                    apogee(minDragArea) - targetApogee
+    dragArea   =   minDragArea + (maxDragArea - minDragArea) * ---------------------------------------
+                                                    apogee(minDragArea) - apogee(maxDragArea)
+    
+    Linear interpolation between the predicted apogees of the two actuator extremes, predicted earlier in the same tick
+    */
+    float_t minimumDragArea = m_flightPlan.getMinDragArea();
+    float_t maximumDragArea = m_flightPlan.getMaxDragArea();
+    if(m_highestApogee <= m_lowestApogee) return m_currentDragArea;
+    return minimumDragArea + (maximumDragArea - minimumDragArea) * (m_highestApogee - m_flightPlan.getTargetApogee()) / (m_highestApogee - m_lowestApogee);
+}
+
+float_t Controller::getBestPossibleDragArea(float_t dragArea, float_t error) const{
+    if(dragArea <= m_flightPlan.getMaxDragArea() && dragArea >= m_flightPlan.getMinDragArea()) return dragArea;
+    if(error > 0) return m_flightPlan.getMaxDragArea();
+    return m_flightPlan.getMinDragArea();
 }
 
 error_t Controller::newFlight(){
@@ -127,10 +215,28 @@ error_t Controller::newFlight(){
     return error_t::GOOD;
 }
 
-float_t Controller::sinSquared(float_t x){
-    float_t s = sin(x);
-    return s * s;
+void Controller::publishOutput(){
+    //filled in place, the topic slot is only read by subscribers once it is committed
+    ControllerOutput& output = m_output.loan();
+    output.error = m_error;
+    output.flightPath = m_flightPath;
+    output.flightPathVelocityPartial = m_flightPathVelocityPartial;
+    output.flightPathAnglePartial = m_flightPathAnglePartial;
+    output.updateRuleDragArea = m_updateRuleDragArea;
+    output.adjustedDragArea = m_adjustedDragArea;
+    output.requestedDragArea = m_requestedDragArea;
+    output.currentDragArea = m_currentDragArea;
+    output.predictedApogee = m_predictedApogee;
+    output.updateRuleClamped = m_updateRuleClamped;
+    output.isSaturated = m_isSaturated;
+    output.fault = m_fault;
+    m_output.commit();
 }
+
+const ControllerTopic_t& Controller::getOutputTopic() const{
+    return m_output;
+}
+
 //references
 uint_t& Controller::getClockPeriodRef(){
     return m_clockPeriod;
@@ -141,54 +247,14 @@ bool& Controller::getActiveFlagRef(){
 }
 
 
-const float_t& Controller::getErrorRef() const{
-    return m_error;
-}
-const float_t& Controller::getFlightPathRef() const{
-    return m_flightPath;
-}
-const float_t& Controller::getVPartialRef() const{
-    return m_flightPathVelocityPartial;
-}
-
-const float_t& Controller::getAnglePartialRef() const{
-    return m_flightPathAnglePartial;
-}
-
-const float_t& Controller::getUpdateRuleDragRef() const{
-    return m_updateRuleDragArea;
-}
-
-const float_t& Controller::getAdjustedDragRef() const{
-    return m_adjustedDragArea;
-}
-
-const float_t& Controller::getRequestedDragRef() const{
-    return m_requestedDragArea;
-}
-
-const float_t& Controller::getCurrentDragRef() const{
-    return m_currentDragArea;
-}
-
-
-const bool& Controller::getClampFlagRef() const{
-    return m_updateRuleClamped;
-}
-
-const bool& Controller::getSaturationFlagRef() const{
-    return m_isSaturated;
-}
-
-const bool& Controller::getFaultFlagRef() const{
-    return m_fault;
-}
-
-
 float_t& Controller::getDecayRateRef(){
     return m_decayRate;
 }
 
 float_t& Controller::getCoastVelocityRef(){
     return m_updateRuleShutdownVelocity;
+}
+
+ControlModes& Controller::getModeRef(){
+    return m_mode;
 }
\ No newline at end of file
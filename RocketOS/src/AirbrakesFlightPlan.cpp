@@ -3,7 +3,7 @@
 using namespace Airbrakes;
 using namespace Airbrakes::Controls;
 
-FlightPlan::FlightPlan(const char* name, SdFat& sd, float_t* memory, uint_t size, const char* file) : m_name(name), m_sd(sd), m_memory(memory), m_memorySize(size), m_isLoaded(false){
+FlightPlan::FlightPlan(const char* name, SdFat& sd, float_t* memory, uint_t size, const char* file) : m_name(name), m_sd(sd), m_memory(memory), m_memorySize(size), m_isLoaded(false), m_inUse(false){
     strncpy(m_fileName.data(), file, m_fileName.size()-1);
 }
 
@@ -20,6 +20,7 @@ FileName_t& FlightPlan::getFileNameRef(){
 }
 
 error_t FlightPlan::loadFromFile(){
+    if(m_inUse) return ERROR_InUse;
     auto errorOut = [this](error_t error){
         m_file.close(); 
         m_isLoaded = false; 
@@ -43,10 +44,12 @@ error_t FlightPlan::loadFromFile(){
     readValue = readNextFloat();
     if(readValue.error != error_t::GOOD) return errorOut(ERROR_Formating);
     m_deploymentAngleLimit = readValue.data * PI / 180;
+    if(m_deploymentAngleLimit <= 0 || m_deploymentAngleLimit > PI / 2) return errorOut(ERROR_Formating); //deployment mapping must be monotonic
     //read dry mass
     readValue = readNextFloat();
     if(readValue.error != error_t::GOOD) return errorOut(ERROR_Formating);
     m_dryMass = readValue.data;
+    if(m_maximumDragArea <= m_minimumDragArea) return errorOut(ERROR_Formating);
     //read temperature
     readValue = readNextFloat();
     if(readValue.error != error_t::GOOD) return errorOut(ERROR_Formating);
@@ -77,6 +80,10 @@ error_t FlightPlan::loadFromFile(){
             if(memErr != error_t::GOOD) return errorOut(ERROR_Formating);
         }
     }
+    //tabulate the deployment mapping so the controller does not evaluate it every tick
+    float_t angleLimit = m_deploymentAngleLimit;
+    float_t inverseLimitSin = 1 / std::sin(angleLimit);
+    m_deploymentTable.build([angleLimit, inverseLimitSin](float_t deployment){ return std::sin(deployment * angleLimit) * inverseLimitSin; }, 0, 1);
     m_isLoaded = true;
     m_file.close();
     return error_t::GOOD;
@@ -87,6 +94,14 @@ bool FlightPlan::isLoaded() const{
 
 }
 
+void FlightPlan::setInUse(bool inUse){
+    m_inUse = inUse;
+}
+
+bool FlightPlan::isInUse() const{
+    return m_inUse;
+}
+
 result_t<float_t> FlightPlan::getAltitude(float_t velocity, float_t angle) const{
     if(!isLoaded()) return ERROR_NotLoaded;
     result_t<float_t> truncated = getValueInMesh(velocityIndex(velocity), angleIndex(angle));
@@ -146,6 +161,24 @@ result_t<float_t> FlightPlan::getGroundPressure() const{
     return m_groundLevelPressure;
 }
 
+result_t<float_t> FlightPlan::getDragArea(float_t deployment) const{
+    /*Formula
+    dragArea = minDragArea + (maxDragArea - minDragArea) * (sin(deployment * angleLimit) / sin(angleLimit))^2
+    */
+    if(!isLoaded()) return ERROR_NotLoaded;
+    if(deployment > 1) return {m_maximumDragArea, ERROR_OutOfBounds};
+    if(deployment < 0) return {m_minimumDragArea, ERROR_OutOfBounds};
+    float_t opening = m_deploymentTable(deployment);
+    return m_minimumDragArea + (m_maximumDragArea - m_minimumDragArea) * opening * opening;
+}
+
+result_t<float_t> FlightPlan::getDeployment(float_t dragArea) const{
+    if(!isLoaded()) return ERROR_NotLoaded;
+    if(dragArea < m_minimumDragArea) return {0, ERROR_OutOfBounds};
+    if(dragArea > m_maximumDragArea) return {1, ERROR_OutOfBounds};
+    return m_deploymentTable.inverse(std::sqrt((dragArea - m_minimumDragArea) / (m_maximumDragArea - m_minimumDragArea)));
+}
+
 error_t FlightPlan::setValueInMesh(float_t val, uint_t velocityIndex, uint_t angleIndex){
     if(velocityIndex >= m_numVelocitySamples || angleIndex >= m_numAngleSamples) return ERROR_OutOfBounds;
     uint_t index = m_numVelocitySamples * velocityIndex + angleIndex;
@@ -1,21 +1,28 @@
 #include "airbrakes\AirbrakesObserver.h"
+#include <algorithm>
 
 using namespace Airbrakes;
+
 //implementation of interface
 
-Observer::Observer(Sensors::BNO085_SPI& imu, Sensors::MS5607_SPI& altimeter) : m_mode(ObserverModes::FullSimulation), m_imu(imu), m_altimeter(altimeter) {}
+Observer::Observer(Sensors::BNO085_SPI& imu, Sensors::MS5607_SPI& altimeter) : m_mode(ObserverModes::FullSimulation), m_imu(imu), m_altimeter(altimeter), m_altitudeTimeIndex(0), m_altitudeTimeCount(0),
+    m_newAltitude(false), m_newAcceleration(false), m_newGravity(false), m_altitudeSequence(0), m_accelerationSequence(0), m_gravitySequence(0), m_rotationSequence(0), m_orientationSequence(0), m_missedIMUSamples(0), m_staleIMUSamples(0), m_staleOrientations(0), m_altitudeTime_us(0), m_accelerationTime_us(0),
+    m_newestAccelerationTime_us(0), m_newestGravityTime_us(0), m_newestOrientationTime_us(0), m_accelerationAge_us(0), m_gravityAge_us(0), m_orientationAge_us(0), m_output("observer") {}
 
 error_t Observer::setMode(ObserverModes mode){
     if(mode == m_mode) return error_t::GOOD;
     if(mode == ObserverModes::FullSimulation){
         m_timer.end();
         m_imu.stopAllSensors();
+        m_altimeter.setContinuous(false);
         m_mode = ObserverModes::FullSimulation;
         return error_t::GOOD;
     }
     if(mode == ObserverModes::FilteredSimulation){
         m_timer.end();
         m_imu.stopAllSensors();
+        m_altimeter.setContinuous(false);
+        m_tickJitter.setPeriod_us(c_SamplePeriod_us);
         m_timer.begin([this](){this->filterSimModeTimerISR();}, c_SamplePeriod_us);
         m_mode = ObserverModes::FilteredSimulation;
         return error_t::GOOD;
@@ -27,6 +34,15 @@ error_t Observer::setMode(ObserverModes mode){
             m_mode = ObserverModes::FullSimulation;
             return error_t::ERROR;
         }
+        m_tickJitter.setPeriod_us(c_SamplePeriod_us);
+        //the altimeter free runs while the observer uses it, each tick takes its newest sample
+        m_altimeter.setContinuous(true);
+        //start from the newest IMU samples instead of everything the histories hold
+        m_accelerationSequence = m_imu.getLinearAccelerationSample().sequence;
+        m_gravitySequence = m_imu.getGravitySample().sequence;
+        m_rotationSequence = m_imu.getAngularVelocitySample().sequence;
+        m_orientationSequence = m_imu.getOrientationSample().sequence;
+        m_newestAccelerationTime_us = m_newestGravityTime_us = m_newestOrientationTime_us = micros();
         m_timer.begin([this](){this->sensorModeTimerISR();}, c_SamplePeriod_us);
         m_mode = ObserverModes::Sensor;
         return error_t::GOOD;
@@ -34,30 +50,69 @@ error_t Observer::setMode(ObserverModes mode){
     return error_t::ERROR;
 }
 
+RocketOS::Shell::CommandList Observer::getCommands() const{
+    return {"observer", nullptr, 0, c_rootChildren.data(), c_rootChildren.size()};
+}
+
 //helpers
 void Observer::sensorModeTimerISR(){
+    m_tickJitter.tick();
     readSensors();
     updateFilters();
     m_altimeter.updateAsync();
 }
 
 void Observer::filterSimModeTimerISR(){
+    m_tickJitter.tick();
+    //the simulation overwrites the readings every tick, so treat them as fresh samples taken now
+    uint32_t now = micros();
+    m_newAltitude = m_newAcceleration = m_newGravity = true;
+    m_altitudeTime_us = now;
+    m_accelerationTime_us = now;
+    m_accelerationAge_us = m_gravityAge_us = m_orientationAge_us = 0;
     updateFilters();
 }
 
 void Observer::updateFilters(){
-    //compute vertical velocity (derivative of altitude)
-    m_verticalVelocityFilter.push(m_measuredAltitude);
-    m_predictedVerticalVelocity = m_verticalVelocityFilter.output() / (c_SamplePeriod_us / 1000000.0);
-    //compute altitude (lowpass of barometer reading)
-    m_altitudeFilter.push(m_measuredAltitude);
-    m_predictedAltitude = m_altitudeFilter.output();
-    //compute acceleratrion (lowpass of IMU accelerometer)
-    m_accelerationFilter.push(m_measuredVerticalAcceleration);
-    m_predictedVerticalAcceleration = m_accelerationFilter.output();
-    //compute angle to horizontal (lowpass of angle calculated from gravity)
-    m_angleFilter.push(m_measuredAngleToHorizontal);
-    m_predictedAngleToHorizontal = m_angleFilter.output();
+    //stale readings are skipped so a late sample is not counted twice, the predictions hold until the next one
+    if(m_newAltitude){
+        //compute vertical velocity (derivative of altitude over the time the samples actually span)
+        m_altitudeTimes_us[m_altitudeTimeIndex] = m_altitudeTime_us;
+        m_altitudeTimeIndex = (m_altitudeTimeIndex + 1) % c_FilterOrder;
+        if(m_altitudeTimeCount < c_FilterOrder) m_altitudeTimeCount++;
+        m_verticalVelocityFilter.push(m_measuredAltitude);
+        m_predictedVerticalVelocity = m_verticalVelocityFilter.output() / elapsedAltitudeTime_s();
+        //compute altitude (lowpass of barometer reading)
+        m_altitudeFilter.push(m_measuredAltitude);
+        m_predictedAltitude = m_altitudeFilter.output();
+    }
+    if(m_newAcceleration){
+        //compute acceleratrion (lowpass of IMU accelerometer)
+        m_accelerationFilter.push(m_measuredVerticalAcceleration);
+        m_predictedVerticalAcceleration = m_accelerationFilter.output();
+    }
+    if(m_newGravity){
+        //compute angle to horizontal (lowpass of angle calculated from gravity)
+        m_angleFilter.push(m_measuredAngleToHorizontal);
+        m_predictedAngleToHorizontal = m_angleFilter.output();
+    }
+    //make the new values visible to readers
+    publishState();
+}
+
+float_t Observer::elapsedAltitudeTime_s(){
+    //use the nominal period until the filter holds a full window of timed samples
+    if(m_altitudeTimeCount < c_FilterOrder) return c_SamplePeriod_us / 1000000.0;
+    //the differentiator is linear and ignores offsets, so running it over the sample times (relative to the newest) gives the
+    //time step its output is scaled by, exactly even when the samples are unevenly spaced
+    m_elapsedTimeFilter.reset();
+    for(uint_t i=0; i<c_FilterOrder; i++){
+        int32_t offset_us = static_cast<int32_t>(m_altitudeTimes_us[(m_altitudeTimeIndex + i) % c_FilterOrder] - m_altitudeTime_us);
+        m_elapsedTimeFilter.push(offset_us / 1000000.0);
+    }
+    float_t elapsed_s = m_elapsedTimeFilter.output();
+    if(elapsed_s <= 0) return c_SamplePeriod_us / 1000000.0;
+    return elapsed_s;
 }
 
 error_t Observer::setupSensors(){
@@ -77,33 +132,111 @@ error_t Observer::setupSensors(){
 
 void Observer::readSensors(){
     //read altimeter
-    m_measuredAltitude = m_altimeter.getLastAltitude();
+    Sensors::Sample<float_t> altitude = m_altimeter.getAltitudeSample();
+    m_newAltitude = altitude.sequence != m_altitudeSequence;
+    m_altitudeSequence = altitude.sequence;
+    m_altitudeTime_us = altitude.time_us;
+    m_measuredAltitude = altitude.value;
     m_measuredPressure = m_altimeter.getLastPressure();
     m_measuredTemperature = m_altimeter.getLastTemperature();
-    //read imu
-    m_measuredLinearAcceleration = m_imu.getLastLinearAcceleration();
-    m_measuredRotation = m_imu.getLastAngularVelocity();
-    m_measuredGravity = m_imu.getLastGravity();
-    m_measuredOrientation = m_imu.getLastOrientation();
-    m_measuredVerticalAcceleration = m_measuredLinearAcceleration.z;
-    m_measuredAngleToHorizontal = asin(m_measuredGravity.z / m_measuredGravity.magnitude());
+    //read imu, every sample batched since the last tick is used unless it is too old to describe the rocket now
+    uint32_t now = micros();
+    Sensors::Sample<Sensors::Vector3> acceleration;
+    uint_t accelerationCount = readIMU(Sensors::IMUData::LinearAcceleration, m_accelerationSequence, acceleration, m_newestAccelerationTime_us, now);
+    m_newAcceleration = accelerationCount > 0;
+    if(m_newAcceleration){
+        m_accelerationTime_us = acceleration.time_us;
+        m_measuredLinearAcceleration = acceleration.value;
+        m_measuredVerticalAcceleration = verticalAcceleration(accelerationCount);
+    }
+    Sensors::Sample<Sensors::Vector3> gravity;
+    m_newGravity = readIMU(Sensors::IMUData::Gravity, m_gravitySequence, gravity, m_newestGravityTime_us, now) > 0;
+    if(m_newGravity) m_measuredGravity = gravity.value;
+    //rotation and orientation are only reported, the newest sample is enough
+    result_t<Sensors::Sample<Sensors::Vector3>> rotation = m_imu.getHistory(Sensors::IMUData::AngularVelocity).latest();
+    if(rotation.error == error_t::GOOD && rotation.data.sequence != m_rotationSequence){
+        m_rotationSequence = rotation.data.sequence;
+        m_measuredRotation = rotation.data.value;
+    }
+    result_t<Sensors::Sample<Sensors::Quaternion>> orientation = m_imu.getOrientationHistory().latest();
+    if(orientation.error == error_t::GOOD && orientation.data.sequence != m_orientationSequence){
+        m_orientationSequence = orientation.data.sequence;
+        m_measuredOrientation = orientation.data.value;
+        m_newestOrientationTime_us = orientation.data.time_us;
+    }
+    m_accelerationAge_us = now - m_newestAccelerationTime_us;
+    m_gravityAge_us = now - m_newestGravityTime_us;
+    m_orientationAge_us = now - m_newestOrientationTime_us;
+    m_measuredAngleToHorizontal = Sensors::VectorMath::elevation(m_measuredGravity);
 }
 
-//controller interface
-float_t Observer::getAltitude() const{
-    return m_predictedAltitude;
+uint_t Observer::readIMU(Sensors::IMUData dataType, uint32_t& sequence, Sensors::Sample<Sensors::Vector3>& average, uint32_t& newestTime_us, uint32_t now_us){
+    //the filters run once per tick, so the samples of a tick are averaged into one reading at their mean time
+    uint_t received = m_imu.getHistory(dataType).since(sequence, m_vectorSamples.data(), m_vectorSamples.size());
+    if(received == 0) return 0;
+    //sequences count up by one per sample, a larger step means samples were overwritten or did not fit
+    m_missedIMUSamples += m_vectorSamples[0].sequence - sequence - 1;
+    sequence = m_vectorSamples[received - 1].sequence;
+    newestTime_us = m_vectorSamples[received - 1].time_us;
+    //samples are in time order, so the ones held back too long by a stalled stream are at the front
+    uint_t first = 0;
+    while(first < received && static_cast<int32_t>(now_us - m_vectorSamples[first].time_us) > Airbrakes_CFG_ObserverMaxIMUAge_us) first++;
+    m_staleIMUSamples += first;
+    uint_t count = received - first;
+    if(count == 0) return 0;
+    if(first > 0) std::copy(m_vectorSamples.begin() + first, m_vectorSamples.begin() + received, m_vectorSamples.begin());
+    Sensors::Vector3 sum{0, 0, 0};
+    int32_t offsetSum_us = 0;
+    for(uint_t i=0; i<count; i++){
+        sum.x += m_vectorSamples[i].value.x;
+        sum.y += m_vectorSamples[i].value.y;
+        sum.z += m_vectorSamples[i].value.z;
+        offsetSum_us += static_cast<int32_t>(m_vectorSamples[i].time_us - m_vectorSamples[0].time_us);
+    }
+    average.value = Sensors::Vector3{sum.x / count, sum.y / count, sum.z / count};
+    average.time_us = m_vectorSamples[0].time_us + offsetSum_us / static_cast<int32_t>(count);
+    average.sequence = m_vectorSamples[count - 1].sequence;
+    return count;
 }
 
-float_t Observer::getVeritcalVelocity() const{
-    return m_predictedVerticalVelocity;
+float_t Observer::verticalAcceleration(uint_t count){
+    //called right after the acceleration samples were read, so m_vectorSamples still holds them
+#if Airbrakes_CFG_ObserverWorldFrame
+    //the rocket can be tilted and rolling, so every sample is rotated by the orientation reported closest to it
+    const Sensors::BNO085_SPI::OrientationHistory_t& orientations = m_imu.getOrientationHistory();
+    float_t sum = 0;
+    for(uint_t i=0; i<count; i++){
+        result_t<Sensors::Sample<Sensors::Quaternion>> orientation = orientations.nearest(m_vectorSamples[i].time_us);
+        if(orientation.error != error_t::GOOD) return m_measuredLinearAcceleration.z;
+        //an orientation from a stalled stream no longer describes the rocket, keep the body frame reading
+        int32_t offset_us = static_cast<int32_t>(orientation.data.time_us - m_vectorSamples[i].time_us);
+        if(offset_us > Airbrakes_CFG_ObserverMaxIMUAge_us || offset_us < -Airbrakes_CFG_ObserverMaxIMUAge_us){
+            m_staleOrientations++;
+            return m_measuredLinearAcceleration.z;
+        }
+        sum += Sensors::VectorMath::rotateVertical(Sensors::VectorMath::normalize(orientation.data.value), m_vectorSamples[i].value);
+    }
+    return sum / count;
+#else
+    return m_measuredLinearAcceleration.z;
+#endif
 }
 
-float_t Observer::getVerticalAcceleration() const{
-    return m_predictedVerticalAcceleration;
+//published state
+const ObserverTopic_t& Observer::getOutputTopic() const{
+    return m_output;
 }
 
-float_t Observer::getAngleToHorizontal() const{
-    return m_predictedAngleToHorizontal;
+void Observer::publishState(){
+    //filled in place, subscribers only read the slot once it is committed
+    m_output.loan() = {
+        m_predictedAltitude, m_predictedVerticalVelocity, m_predictedVerticalAcceleration, m_predictedAngleToHorizontal,
+        m_measuredAltitude, m_measuredPressure, m_measuredTemperature, m_measuredVerticalAcceleration, m_measuredAngleToHorizontal,
+        m_measuredLinearAcceleration, m_measuredRotation, m_measuredGravity, m_measuredOrientation,
+        m_altitudeTime_us, m_accelerationTime_us,
+        m_accelerationAge_us, m_gravityAge_us, m_orientationAge_us
+    };
+    m_output.commit();
 }
 
 //implementation of helpers
@@ -136,56 +269,3 @@ float_t& Observer::getPredictedAngleRef(){
 float_t& Observer::getMeasuredAngleRef(){
     return m_measuredAngleToHorizontal;
 }
-
-//read only references for telemetry
-const float_t& Observer::getPredictedAltitudeRef() const{
-    return m_predictedAltitude;
-}
-
-const float_t& Observer::getMeasuredAltitudeRef() const{
-    return m_measuredAltitude;
-}
-
-const float_t& Observer::getMeasuredTemperatureRef() const{
-    return m_measuredTemperature;
-}
-
-const float_t& Observer::getMeasuredPressureRef() const{
-    return m_measuredPressure;
-}
-
-const float_t& Observer::getPredictedVerticalVelocityRef() const{
-    return m_predictedVerticalVelocity;
-}
-
-const float_t& Observer::getPredictedVerticalAccelerationRef() const{
-    return m_predictedVerticalAcceleration;
-}
-
-const float_t& Observer::getMeasuredVerticalAccelerationRef() const{
-    return m_measuredVerticalAcceleration;
-}
-
-const Sensors::Vector3& Observer::getMeasuredLinearAccelerationRef() const{
-    return m_measuredLinearAcceleration;
-}
-
-const float_t& Observer::getPredictedAngleRef() const{
-    return m_predictedAngleToHorizontal;
-}
-
-const float_t& Observer::getMeasuredAngleRef() const{
-    return m_measuredAngleToHorizontal;
-}
-
-const Sensors::Vector3& Observer::getMeasuredGravityRef() const{
-    return m_measuredGravity;
-}
-
-const Sensors::Vector3& Observer::getMeasuredRotationRef() const{
-    return m_measuredRotation;
-}
-
-const Sensors::Quaternion& Observer::getMeasuredOrientationRef() const{
-    return m_measuredOrientation;
-}
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include "airbrakes\AirbrakesSensors_Altimeter.h"
 #include <Arduino.h>
 #include <SPI.h>
+#include <algorithm>
 
 using namespace Airbrakes;
 using namespace Sensors;
@@ -8,31 +9,80 @@ using namespace Sensors;
 #define CS_PIN 10
 #define RESET_COMMAND 0x1E
 #define PROM_COMMAND_BASE 0xA0
-#define PRESSURE_CONVERSION_COMMAND 0x48
-#define TEMPERATURE_CONVERSION_COMMAND 0x58
+#define PRESSURE_CONVERSION_COMMAND_BASE 0x40
+#define TEMPERATURE_CONVERSION_COMMAND_BASE 0x50
 #define ADC_READ_COMMAND 0x00
 
 #define BLOCKING_TIMEOUT_ms 25
 
-//natural constants
-#define ISA_LAPSE_RATE 0.0065           // Units: K/m
-#define ISA_GRAVITY 9.80665             // Units: m/s^2
-#define ISA_MOLAR_MASS_AIR 0.0289652    // Units: kg/mol
-#define ISA_IDEAL_GAS 8.31446           // Units: j/(mol*K)
+//ground calibration rejects readings further from the median than this many robust standard deviations (1.4826 MAD)
+#define CALIBRATION_OUTLIER_DEVIATIONS 3
+//smallest rejection bounds, a quiet sensor can have a median absolute deviation of zero
+#define CALIBRATION_MINIMUM_BOUND_pa 6
+#define CALIBRATION_MINIMUM_BOUND_cC 5
+
+//conversion commands and times for each oversampling ratio (MS5607 data sheet)
+//conversions are waited on for the maximum time, readings are stamped with the middle of the typical pressure conversion
+struct OSRSetting{
+    uint_t oversampling;
+    uint8_t pressureCommand;
+    uint8_t temperatureCommand;
+    uint32_t typicalTime_us;
+    uint32_t maximumTime_us;
+};
+
+static const OSRSetting c_OSRSettings[] = {
+    {256, PRESSURE_CONVERSION_COMMAND_BASE + 0, TEMPERATURE_CONVERSION_COMMAND_BASE + 0, 540, 600},
+    {512, PRESSURE_CONVERSION_COMMAND_BASE + 2, TEMPERATURE_CONVERSION_COMMAND_BASE + 2, 1060, 1170},
+    {1024, PRESSURE_CONVERSION_COMMAND_BASE + 4, TEMPERATURE_CONVERSION_COMMAND_BASE + 4, 2080, 2280},
+    {2048, PRESSURE_CONVERSION_COMMAND_BASE + 6, TEMPERATURE_CONVERSION_COMMAND_BASE + 6, 4130, 4540},
+    {4096, PRESSURE_CONVERSION_COMMAND_BASE + 8, TEMPERATURE_CONVERSION_COMMAND_BASE + 8, 8220, 9040}
+};
+
+static const OSRSetting* findOSR(uint_t oversampling){
+    for(const OSRSetting& setting : c_OSRSettings)
+        if(setting.oversampling == oversampling) return &setting;
+    return nullptr;
+}
+
+//an invalid stored value falls back to the slowest, most precise setting
+static const OSRSetting& getOSR(uint_t oversampling){
+    const OSRSetting* setting = findOSR(oversampling);
+    return (setting != nullptr)? *setting : c_OSRSettings[4];
+}
+
+//transmitted bytes, these outlive the transactions that send them
+static const uint8_t c_resetCommand[] = {RESET_COMMAND};
+static const uint8_t c_ADCReadCommand[] = {ADC_READ_COMMAND, 0xFF, 0xFF, 0xFF};
+static const uint8_t c_PROMCommands[][3] = {
+    {PROM_COMMAND_BASE + 0, 0xFF, 0xFF}, {PROM_COMMAND_BASE + 2, 0xFF, 0xFF}, {PROM_COMMAND_BASE + 4, 0xFF, 0xFF}, {PROM_COMMAND_BASE + 6, 0xFF, 0xFF},
+    {PROM_COMMAND_BASE + 8, 0xFF, 0xFF}, {PROM_COMMAND_BASE + 10, 0xFF, 0xFF}, {PROM_COMMAND_BASE + 12, 0xFF, 0xFF}, {PROM_COMMAND_BASE + 14, 0xFF, 0xFF}
+};
 
-MS5607_SPI::MS5607_SPI(const char* name, float_t groundTemperature, float_t groundPressure, uint_t frequency, TeensyTimerTool::TimerGenerator* timer) : m_name(name), m_SPIFrequency(frequency), m_timer(timer), m_state(AltimeterStates::Standby), m_newData(false), m_groundLevelTemperature_k(groundTemperature), m_groundLevelPressure_pa(groundPressure) {}
+MS5607_SPI::MS5607_SPI(const char* name, const RocketOS::Processing::StandardAtmosphere<>& atmosphere, SPIBus_t& bus, float_t groundTemperature, float_t groundPressure, uint_t frequency, uint_t pressureOSR, uint_t temperatureOSR, uint_t temperatureRatio, TeensyTimerTool::TimerGenerator* timer) : m_name(name), m_atmosphere(atmosphere), m_bus(bus), m_temperatureADC(0), m_pressureADC(0), m_SPIFrequency(frequency), m_pressureOSR(pressureOSR), m_temperatureOSR(temperatureOSR), m_temperatureRatio(temperatureRatio), m_temperatureCountdown(0), m_continuous(false), m_timer(timer), m_state(AltimeterStates::Standby), m_convertingPressure(false), m_conversionStart_us(0), m_pressureTime_us(0), m_sampleTime_us(0), m_sequence(0), m_pressure_pa(0), m_temperature_k(0), m_altitude_m(0), m_groundLevelTemperature_k(groundTemperature), m_groundLevelPressure_pa(groundPressure), m_calibrationState(CalibrationStates::Idle), m_calibrationCount(0), m_calibrationTarget(0), m_calibrationRejected(0), m_calibrationSpread_pa(0), m_calibrationStart_us(0), m_calibrationTimeout_us(0) {}
 
 RocketOS::Shell::CommandList MS5607_SPI::getCommands(){
     return CommandList{m_name, c_rootCommands.data(), c_rootCommands.size(), c_rootCommandList.data(), c_rootCommandList.size()};
 }
 
 error_t MS5607_SPI::initialize(){
+    //the observer can be running conversions from its interrupt, claim the device between two of them like updateBlocking()
+    bool claimed = false;
+    elapsedMillis waited = 0;
+    while(!claimed && waited <= BLOCKING_TIMEOUT_ms){
+        noInterrupts();
+        claimed = m_state == AltimeterStates::Standby;
+        if(claimed) m_state = AltimeterStates::Blocking;
+        interrupts();
+    }
+    if(!claimed) return ERROR_Busy;
     //configuration into SPI mode
 
     //setup SPI
     pinMode(CS_PIN, OUTPUT);
     digitalWriteFast(CS_PIN, HIGH);
-    SPI.begin();
+    m_bus.begin();
+    m_timer.begin([this](){this->asyncConversionDone();});
     resetDevice();
     //read calibration data
     result_t<uint16_t> result;
@@ -40,11 +90,9 @@ error_t MS5607_SPI::initialize(){
         result = getCalibrationCoefficient(i);
         m_calibrationCoeffieicents[i] = result.data;
     }
-    if(result.error != error_t::GOOD){
-        markAsUninitialized();
-        return result.error;
-    }
-    return error_t::GOOD;
+    if(result.error != error_t::GOOD) markAsUninitialized();
+    m_state = AltimeterStates::Standby;
+    return result.error;
 }
 
 bool MS5607_SPI::initialized() const{
@@ -52,15 +100,31 @@ bool MS5607_SPI::initialized() const{
 }
 
 error_t MS5607_SPI::updateBlocking(){
-    if(m_state == AltimeterStates::Standby){
-        m_state = AltimeterStates::Blocking;
-        beginPressureConversion();
-        delay(10);
-        if(readPressureVal() != error_t::GOOD) return error_t::ERROR;
-        beginTemperatureConversion();
-        delay(10);
-        if(readTemperatureVal() != error_t::GOOD) return error_t::ERROR;
-        m_newData = true;
+    //the observer can start an async update from its interrupt, so claim the device atomically
+    noInterrupts();
+    bool claimed = m_state == AltimeterStates::Standby;
+    if(claimed) m_state = AltimeterStates::Blocking;
+    interrupts();
+    if(claimed){
+        const OSRSetting& pressureOSR = getOSR(m_pressureOSR);
+        const OSRSetting& temperatureOSR = getOSR(m_temperatureOSR);
+        if(command(&pressureOSR.pressureCommand) != error_t::GOOD){
+            m_state = AltimeterStates::Standby;
+            return error_t::ERROR;
+        }
+        m_conversionStart_us = micros();
+        m_convertingPressure = true;
+        delayMicroseconds(pressureOSR.maximumTime_us);
+        if(readADC() != error_t::GOOD || storePressureVal() != error_t::GOOD || command(&temperatureOSR.temperatureCommand) != error_t::GOOD){
+            m_state = AltimeterStates::Standby;
+            return error_t::ERROR;
+        }
+        delayMicroseconds(temperatureOSR.maximumTime_us);
+        if(readADC() != error_t::GOOD || storeTemperatureVal() != error_t::GOOD){
+            m_state = AltimeterStates::Standby;
+            return error_t::ERROR;
+        }
+        publishSample();
         m_state = AltimeterStates::Standby;
         return error_t::GOOD;
     }
@@ -68,83 +132,257 @@ error_t MS5607_SPI::updateBlocking(){
 }
 
 void MS5607_SPI::updateAsync(){
+    //called from the observer interrupt, the bus runs the conversion chain from its own and the timer's interrupts
     if(m_state == AltimeterStates::Standby){
         m_state = AltimeterStates::Async;
-        beginPressureConversion();
-        m_timer.begin([this](){this->asyncStep1();});
-        m_timer.trigger(10000);
+        startCycle();
     }
 }
 
+void MS5607_SPI::setContinuous(bool continuous){
+    //in continuous mode every finished cycle starts the next one, so pressure converts back to back
+    m_continuous = continuous;
+}
+
+error_t MS5607_SPI::setPressureOSR(uint_t oversampling){
+    if(findOSR(oversampling) == nullptr) return error_t::ERROR;
+    m_pressureOSR = oversampling;
+    return error_t::GOOD;
+}
+
+error_t MS5607_SPI::setTemperatureOSR(uint_t oversampling){
+    if(findOSR(oversampling) == nullptr) return error_t::ERROR;
+    m_temperatureOSR = oversampling;
+    return error_t::GOOD;
+}
+
+error_t MS5607_SPI::setTemperatureRatio(uint_t ratio){
+    if(ratio == 0) return error_t::ERROR;
+    m_temperatureRatio = ratio;
+    return error_t::GOOD;
+}
+
 
 result_t<float_t> MS5607_SPI::getNewPressure(){
     if(!initialized()) return ERROR_NotInitialized;
     if(updateBlocking() != error_t::GOOD) return ERROR_NotResponsive;
-    updateOutputValues();
     return m_pressure_pa;
 }
 result_t<float_t> MS5607_SPI::getNewTemperature(){
     if(!initialized()) return ERROR_NotInitialized;
     if(updateBlocking() != error_t::GOOD) return ERROR_NotResponsive;
-    updateOutputValues();
     return m_temperature_k;
 }
 
 result_t<float_t> MS5607_SPI::getNewAltitude(){
     if(!initialized()) return ERROR_NotInitialized;
     if(updateBlocking() != error_t::GOOD) return ERROR_NotResponsive;
-    updateOutputValues();
     return m_altitude_m;
 }
 
-float_t MS5607_SPI::getLastPressure(){
-    updateOutputValues();
+float_t MS5607_SPI::getLastPressure() const{
     return m_pressure_pa;
 }
 
-float_t MS5607_SPI::getLastTemperature(){
-    updateOutputValues();
+float_t MS5607_SPI::getLastTemperature() const{
     return m_temperature_k;
 }
 
-float_t MS5607_SPI::getLastAltitude(){
-    updateOutputValues();
+float_t MS5607_SPI::getLastAltitude() const{
     return m_altitude_m;
 }
 
+Sample<float_t> MS5607_SPI::getAltitudeSample() const{
+    noInterrupts();
+    Sample<float_t> sample{m_altitude_m, m_sampleTime_us, m_sequence};
+    interrupts();
+    return sample;
+}
+
+Sample<float_t> MS5607_SPI::getPressureSample() const{
+    noInterrupts();
+    Sample<float_t> sample{m_pressure_pa, m_sampleTime_us, m_sequence};
+    interrupts();
+    return sample;
+}
+
+const MS5607_SPI::History_t& MS5607_SPI::getPressureHistory() const{
+    return m_pressureHistory;
+}
+
+const MS5607_SPI::History_t& MS5607_SPI::getAltitudeHistory() const{
+    return m_altitudeHistory;
+}
+
 error_t MS5607_SPI::zero(){
+    return startCalibration(c_maxCalibrationSamples);
+}
+
+error_t MS5607_SPI::startCalibration(uint_t samples){
+    //readings are collected as they are published, updateCalibration() reduces them once there are enough
     if(!initialized()) return ERROR_NotInitialized;
-    if(updateBlocking() != error_t::GOOD) return ERROR_NotResponsive;
-    updateOutputValues();
-    m_groundLevelPressure_pa = m_pressure_pa;
-    m_groundLevelTemperature_k = m_temperature_k;
-    updateOutputValues();
+    if(m_calibrationState == CalibrationStates::Running) return ERROR_Calibrating;
+    if(samples == 0 || samples > c_maxCalibrationSamples) return error_t::ERROR;
+    //twice the time of a cycle that converts temperature as well as pressure for every reading
+    m_calibrationTimeout_us = 2 * samples * (getOSR(m_pressureOSR).maximumTime_us + getOSR(m_temperatureOSR).maximumTime_us);
+    m_calibrationStart_us = micros();
+    m_calibrationTarget = samples;
+    m_calibrationRejected = 0;
+    m_calibrationSpread_pa = 0;
+    m_calibrationCount = 0;
+    //publishSample only starts collecting once the state changes
+    m_calibrationState = CalibrationStates::Running;
     return error_t::GOOD;
 }
 
+void MS5607_SPI::cancelCalibration(){
+    if(m_calibrationState == CalibrationStates::Running) m_calibrationState = CalibrationStates::Idle;
+}
+
+void MS5607_SPI::updateCalibration(){
+    //called from the main loop, never waits on the device
+    if(m_calibrationState != CalibrationStates::Running) return;
+    if(m_calibrationCount >= m_calibrationTarget){
+        finishCalibration();
+        return;
+    }
+    if(micros() - m_calibrationStart_us > m_calibrationTimeout_us){
+        m_calibrationState = CalibrationStates::Failed;
+        return;
+    }
+    //in sensor mode the observer keeps the conversions running, otherwise start the next cycle whenever the device is free
+    noInterrupts();
+    bool claimed = m_state == AltimeterStates::Standby;
+    if(claimed) m_state = AltimeterStates::Async;
+    interrupts();
+    if(claimed) startCycle();
+}
+
+MS5607_SPI::Calibration MS5607_SPI::getCalibration() const{
+    CalibrationStates state = m_calibrationState;
+    uint_t collected = m_calibrationCount;
+    return Calibration{state, collected, m_calibrationTarget, m_calibrationRejected, m_calibrationSpread_pa};
+}
+
+MS5607_SPI::Compensated MS5607_SPI::compensate(const std::array<uint16_t, c_numCalibrationCoefficients>& C, uint32_t D1, uint32_t D2){
+    //first order compensation (MS5607 data sheet), 64 bit intermediates keep every bit of OFF and SENS
+    int32_t dT = static_cast<int32_t>(D2) - static_cast<int32_t>(static_cast<uint32_t>(C[5]) << 8);
+    int32_t TEMP = 2000 + static_cast<int32_t>(static_cast<int64_t>(dT) * C[6] / (1LL << 23));
+    int64_t OFF = (static_cast<int64_t>(C[2]) << 17) + static_cast<int64_t>(C[4]) * dT / (1LL << 6);
+    int64_t SENS = (static_cast<int64_t>(C[1]) << 16) + static_cast<int64_t>(C[3]) * dT / (1LL << 7);
+    //second order compensation below 20C
+    if(TEMP < 2000){
+        int32_t T2 = static_cast<int32_t>(static_cast<int64_t>(dT) * dT / (1LL << 31));
+        int64_t low = static_cast<int64_t>(TEMP - 2000) * (TEMP - 2000);
+        int64_t OFF2 = 61 * low / (1LL << 4);
+        int64_t SENS2 = 2 * low;
+        //below -15C
+        if(TEMP < -1500){
+            int64_t veryLow = static_cast<int64_t>(TEMP + 1500) * (TEMP + 1500);
+            OFF2 += 15 * veryLow;
+            SENS2 += 8 * veryLow;
+        }
+        TEMP -= T2;
+        OFF -= OFF2;
+        SENS -= SENS2;
+    }
+    int32_t P = static_cast<int32_t>((static_cast<int64_t>(D1) * SENS / (1LL << 21) - OFF) / (1LL << 15));
+    return {TEMP, P};
+}
+
 
 //helper functions
-void MS5607_SPI::resetDevice(){
+//median of the values, reorders them
+static int32_t median(int32_t* values, uint_t count){
+    std::nth_element(values, values + count / 2, values + count);
+    return values[count / 2];
+}
+
+//the median and the bound around it that readings must fall within
+struct RobustBound{
+    int32_t median;
+    int32_t bound;
+};
+
+static RobustBound robustBound(int32_t* values, uint_t count, int32_t minimumBound){
+    int32_t center = median(values, count);
+    for(uint_t i=0; i<count; i++) values[i] = (values[i] > center)? values[i] - center : center - values[i];
+    int32_t deviation = median(values, count);
+    int32_t bound = static_cast<int32_t>(CALIBRATION_OUTLIER_DEVIATIONS * 1.4826f * deviation + 0.5f);
+    return RobustBound{center, (bound > minimumBound)? bound : minimumBound};
+}
+
+void MS5607_SPI::finishCalibration(){
+    //collection has stopped, so the readings are only touched here
+    uint_t count = m_calibrationTarget;
+    std::array<int32_t, c_maxCalibrationSamples> values;
+    for(uint_t i=0; i<count; i++) values[i] = m_calibrationReadings[i].pressure_pa;
+    RobustBound pressure = robustBound(values.data(), count, CALIBRATION_MINIMUM_BOUND_pa);
+    for(uint_t i=0; i<count; i++) values[i] = m_calibrationReadings[i].temperature_cC;
+    RobustBound temperature = robustBound(values.data(), count, CALIBRATION_MINIMUM_BOUND_cC);
+    //average the readings that are inside both bounds
+    int64_t pressureSum = 0;
+    int64_t temperatureSum = 0;
+    uint_t inliers = 0;
+    for(uint_t i=0; i<count; i++){
+        const Compensated& reading = m_calibrationReadings[i];
+        if(std::abs(reading.pressure_pa - pressure.median) > pressure.bound || std::abs(reading.temperature_cC - temperature.median) > temperature.bound) continue;
+        pressureSum += reading.pressure_pa;
+        temperatureSum += reading.temperature_cC;
+        inliers++;
+    }
+    m_calibrationRejected = count - inliers;
+    m_calibrationSpread_pa = static_cast<float_t>(pressure.bound) / CALIBRATION_OUTLIER_DEVIATIONS;
+    //a mostly rejected set means the readings were not settled, keep the previous ground level
+    if(2 * inliers < count){
+        m_calibrationState = CalibrationStates::Failed;
+        return;
+    }
+    float_t groundPressure = static_cast<float_t>(pressureSum) / inliers;
+    float_t groundTemperature = (static_cast<float_t>(temperatureSum) / inliers + 27315) / 100;
+    //publishSample reads the ground level from interrupts, so swap it in with the altitude it gives
     noInterrupts();
-    SPI.beginTransaction(SPISettings(m_SPIFrequency, MSBFIRST, SPI_MODE0));
-    digitalWrite(CS_PIN, LOW);
-    SPI.transfer(RESET_COMMAND);
-    digitalWrite(CS_PIN, HIGH);
-    SPI.endTransaction();
+    float_t pressureNow = m_pressure_pa;
     interrupts();
+    float_t altitude = m_atmosphere.altitude(pressureNow, groundPressure, groundTemperature);
+    noInterrupts();
+    m_groundLevelPressure_pa = groundPressure;
+    m_groundLevelTemperature_k = groundTemperature;
+    m_altitude_m = altitude;
+    interrupts();
+    m_calibrationState = CalibrationStates::Complete;
+}
+
+void MS5607_SPI::printCalibration() const{
+    Calibration calibration = getCalibration();
+    switch(calibration.state){
+        case CalibrationStates::Idle:
+        default:
+            RocketOS::Console.println("No calibration has run");
+        break;
+        case CalibrationStates::Running:
+            RocketOS::Console.printf("Running - %u/%u readings\n", calibration.collected, calibration.target);
+        break;
+        case CalibrationStates::Complete:
+            RocketOS::Console.printf("Complete - %u readings, %u rejected, spread %.1fpa\n", calibration.target, calibration.rejected, calibration.spread_pa);
+        break;
+        case CalibrationStates::Failed:
+            if(calibration.collected < calibration.target) RocketOS::Console.printf("Failed - timed out after %u/%u readings\n", calibration.collected, calibration.target);
+            else RocketOS::Console.printf("Failed - %u of %u readings rejected\n", calibration.rejected, calibration.target);
+        break;
+    }
+    RocketOS::Console.printf("ground: %.1fpa, %.2fK\n", m_groundLevelPressure_pa, m_groundLevelTemperature_k);
+}
+
+void MS5607_SPI::resetDevice(){
+    command(c_resetCommand);
     delay(5);
 }
 
 result_t<uint16_t> MS5607_SPI::getCalibrationCoefficient(uint_t n){
     if(n >= c_numCalibrationCoefficients) return error_t::ERROR;
-    noInterrupts();
-    SPI.beginTransaction(SPISettings(m_SPIFrequency, MSBFIRST, SPI_MODE0));
-    digitalWrite(CS_PIN, LOW);
-    SPI.transfer(PROM_COMMAND_BASE + 2 * (n));
-    uint16_t coeffecient = SPI.transfer16(0xFFFF);
-    digitalWrite(CS_PIN, HIGH);
-    SPI.endTransaction();
-    interrupts();
+    if(m_bus.transferBlocking(makeTransaction(c_PROMCommands[n], m_rxBuffer.data(), sizeof(c_PROMCommands[n]))) != error_t::GOOD) return error_t::ERROR;
+    uint16_t coeffecient = static_cast<uint16_t>(m_rxBuffer[1]) << 8 | static_cast<uint16_t>(m_rxBuffer[2]);
     if(coeffecient == 0 || coeffecient == 0xFFFF) return {coeffecient, error_t::ERROR};
     return coeffecient;
 }
@@ -153,83 +391,122 @@ void MS5607_SPI::markAsUninitialized(){
     m_calibrationCoeffieicents[0] = 0;
 }
 
-void MS5607_SPI::beginPressureConversion(){
-    noInterrupts();
-    SPI.beginTransaction(SPISettings(m_SPIFrequency, MSBFIRST, SPI_MODE0));
-    digitalWrite(CS_PIN, LOW);
-    SPI.transfer(PRESSURE_CONVERSION_COMMAND);
-    digitalWrite(CS_PIN, HIGH);
-    SPI.endTransaction();
-    interrupts();
+RocketOS::Utilities::SPITransaction MS5607_SPI::makeTransaction(const uint8_t* tx, uint8_t* rx, uint16_t length) const{
+    return RocketOS::Utilities::SPITransaction{CS_PIN, m_SPIFrequency, SPI_MODE0, tx, rx, length, false, {}};
 }
 
-void MS5607_SPI::beginTemperatureConversion(){
-    noInterrupts();
-    SPI.beginTransaction(SPISettings(m_SPIFrequency, MSBFIRST, SPI_MODE0));
-    digitalWrite(CS_PIN, LOW);
-    SPI.transfer(TEMPERATURE_CONVERSION_COMMAND);
-    digitalWrite(CS_PIN, HIGH);
-    SPI.endTransaction();
-    interrupts();
+error_t MS5607_SPI::command(const uint8_t* command){
+    return m_bus.transferBlocking(makeTransaction(command, nullptr, 1));
 }
 
-error_t MS5607_SPI::readPressureVal(){
-    noInterrupts();
-    SPI.beginTransaction(SPISettings(m_SPIFrequency, MSBFIRST, SPI_MODE0));
-    digitalWrite(CS_PIN, LOW);
-    SPI.transfer(ADC_READ_COMMAND);
-    uint8_t byte1 = SPI.transfer(0xFF);
-    uint8_t byte2 = SPI.transfer(0xFF);
-    uint8_t byte3 = SPI.transfer(0xFF);
-    digitalWrite(CS_PIN, HIGH);
-    SPI.endTransaction();
-    interrupts();
+error_t MS5607_SPI::readADC(){
+    return m_bus.transferBlocking(makeTransaction(c_ADCReadCommand, m_rxBuffer.data(), c_ADCReadLength));
+}
+
+result_t<uint32_t> MS5607_SPI::parseADC() const{
+    //the first byte was clocked in while the read command was sent
+    uint8_t byte1 = m_rxBuffer[1];
+    uint8_t byte2 = m_rxBuffer[2];
+    uint8_t byte3 = m_rxBuffer[3];
     if((byte1 == 0x00 && byte2 == 0x00 && byte3 == 0x00) || (byte1 == 0xFF && byte2 == 0xFF && byte3 == 0xFF)) return error_t::ERROR;
-    m_pressureADC = 0x00000000 | static_cast<uint32_t>(byte1) << 16 | static_cast<uint32_t>(byte2) << 8 | static_cast<uint32_t>(byte3);
+    return 0x00000000 | static_cast<uint32_t>(byte1) << 16 | static_cast<uint32_t>(byte2) << 8 | static_cast<uint32_t>(byte3);
+}
+
+error_t MS5607_SPI::storePressureVal(){
+    result_t<uint32_t> result = parseADC();
+    if(result.error != error_t::GOOD) return result.error;
+    m_pressureADC = result.data;
+    m_pressureTime_us = m_conversionStart_us + getOSR(m_pressureOSR).typicalTime_us / 2;
     return error_t::GOOD;
 }
 
-error_t MS5607_SPI::readTemperatureVal(){
-    noInterrupts();
-    SPI.beginTransaction(SPISettings(m_SPIFrequency, MSBFIRST, SPI_MODE0));
-    digitalWrite(CS_PIN, LOW);
-    SPI.transfer(ADC_READ_COMMAND);
-    uint8_t byte1 = SPI.transfer(0xFF);
-    uint8_t byte2 = SPI.transfer(0xFF);
-    uint8_t byte3 = SPI.transfer(0xFF);
-    digitalWrite(CS_PIN, HIGH);
-    SPI.endTransaction();
-    interrupts();
-    if((byte1 == 0x00 && byte2 == 0x00 && byte3 == 0x00) || (byte1 == 0xFF && byte2 == 0xFF && byte3 == 0xFF)) return error_t::ERROR;
-    m_temperatureADC = 0x00000000 | static_cast<uint32_t>(byte1) << 16 | static_cast<uint32_t>(byte2) << 8 | static_cast<uint32_t>(byte3);
+error_t MS5607_SPI::storeTemperatureVal(){
+    result_t<uint32_t> result = parseADC();
+    if(result.error != error_t::GOOD) return result.error;
+    m_temperatureADC = result.data;
     return error_t::GOOD;
 }
 
-void MS5607_SPI::asyncStep1(){
-    readPressureVal();
-    beginTemperatureConversion();
-    m_timer.begin([this]{this->asyncStep2();});
-    m_timer.trigger(10000);
+void MS5607_SPI::startCycle(){
+    //temperature drifts slowly, so it is only converted every m_temperatureRatio cycles, ahead of the pressure it compensates
+    bool convertTemperature = m_temperatureCountdown == 0;
+    if(convertTemperature) m_temperatureCountdown = (m_temperatureRatio > 0)? m_temperatureRatio : 1;
+    m_temperatureCountdown--;
+    m_convertingPressure = !convertTemperature;
+    if(submitConversion() != error_t::GOOD) m_state = AltimeterStates::Standby;
 }
 
-void MS5607_SPI::asyncStep2(){
-    readTemperatureVal();
-    m_state = AltimeterStates::Standby;
-    m_newData = true;
-}
-
-void MS5607_SPI::updateOutputValues(){
-    if(m_newData){
-        //compute temperature and pressure from ADC readings (MS5607 data sheet)
-        float_t dT = static_cast<float_t>(m_temperatureADC) - (static_cast<float_t>(m_calibrationCoeffieicents[5]) * static_cast<float_t>(1 << 8));
-        float_t TEMP = 29315 + ((dT*static_cast<float_t>(m_calibrationCoeffieicents[6])) / static_cast<float_t>(1 << 23));
-        float_t OFF = (static_cast<float_t>(m_calibrationCoeffieicents[2]) * static_cast<float_t>(1 << 17)) + ((static_cast<float_t>(m_calibrationCoeffieicents[4]) * dT)  / static_cast<float_t>(1 << 6));
-        float_t SENS = (static_cast<float_t>(m_calibrationCoeffieicents[1]) * static_cast<float_t>(1 << 16)) + ((static_cast<float_t>(m_calibrationCoeffieicents[3]) * dT)  / static_cast<float_t>(1 << 7));
-        float_t P = static_cast<float_t>((m_pressureADC * (SENS / static_cast<float_t>(1 << 21)) - OFF) / static_cast<float_t>(1 << 15));
-        m_temperature_k = TEMP / 100;
-        m_pressure_pa = P;
-        //compute altitude from ISA model
-        m_altitude_m = m_groundLevelTemperature_k / ISA_LAPSE_RATE * (pow(m_groundLevelPressure_pa/m_pressure_pa, ISA_IDEAL_GAS * ISA_LAPSE_RATE / (ISA_GRAVITY * ISA_MOLAR_MASS_AIR))-1);
+error_t MS5607_SPI::submitConversion(){
+    const uint8_t* command = (m_convertingPressure)? &getOSR(m_pressureOSR).pressureCommand : &getOSR(m_temperatureOSR).temperatureCommand;
+    RocketOS::Utilities::SPITransaction transaction = makeTransaction(command, nullptr, 1);
+    transaction.done = [this](){this->asyncConversionStarted();};
+    return m_bus.submit(transaction);
+}
+
+uint32_t MS5607_SPI::conversionTime_us() const{
+    return (m_convertingPressure)? getOSR(m_pressureOSR).maximumTime_us : getOSR(m_temperatureOSR).maximumTime_us;
+}
+
+void MS5607_SPI::asyncConversionStarted(){
+    //runs once the conversion command is out, the timer interrupt reads the result
+    if(m_convertingPressure) m_conversionStart_us = micros();
+    m_timer.trigger(conversionTime_us());
+}
+
+void MS5607_SPI::asyncConversionDone(){
+    RocketOS::Utilities::SPITransaction transaction = makeTransaction(c_ADCReadCommand, m_rxBuffer.data(), c_ADCReadLength);
+    transaction.done = [this](){this->asyncReadDone();};
+    if(m_bus.submit(transaction) != error_t::GOOD) m_state = AltimeterStates::Standby;
+}
+
+void MS5607_SPI::asyncReadDone(){
+    //a failed read leaves the last sample in place so the observer sees it as stale
+    if(!m_convertingPressure){
+        if(storeTemperatureVal() != error_t::GOOD){
+            //retry the temperature on the next cycle
+            m_temperatureCountdown = 0;
+            m_state = AltimeterStates::Standby;
+            return;
+        }
+        m_convertingPressure = true;
+        if(submitConversion() != error_t::GOOD) m_state = AltimeterStates::Standby;
+        return;
+    }
+    if(storePressureVal() != error_t::GOOD){
+        m_state = AltimeterStates::Standby;
+        return;
+    }
+    publishSample();
+    if(m_continuous) startCycle();
+    else m_state = AltimeterStates::Standby;
+}
+
+void MS5607_SPI::publishSample(){
+    //compensate once per reading, the getters only load the results
+    m_compensationTimer.start();
+    Compensated reading = compensate(m_calibrationCoeffieicents, m_pressureADC, m_temperatureADC);
+    m_compensationTimer.stop();
+    float_t pressure = static_cast<float_t>(reading.pressure_pa);
+    float_t temperature = static_cast<float_t>(reading.temperature_cC + 27315) / 100;
+    //compute altitude from ISA model
+    float_t altitude = m_atmosphere.altitude(pressure, m_groundLevelPressure_pa, m_groundLevelTemperature_k);
+    //the observer interrupt reads the results, time and sequence together, so update them atomically
+    noInterrupts();
+    m_pressure_pa = pressure;
+    m_temperature_k = temperature;
+    m_altitude_m = altitude;
+    m_sampleTime_us = m_pressureTime_us;
+    uint32_t sequence = ++m_sequence;
+    interrupts();
+    m_pressureHistory.append(Sample<float_t>{pressure, m_pressureTime_us, sequence});
+    m_altitudeHistory.append(Sample<float_t>{altitude, m_pressureTime_us, sequence});
+    //keep the raw compensated reading for a running ground calibration
+    if(m_calibrationState == CalibrationStates::Running){
+        uint_t count = m_calibrationCount;
+        if(count < m_calibrationTarget){
+            m_calibrationReadings[count] = reading;
+            m_calibrationCount = count + 1;
+        }
     }
 }
 
@@ -238,6 +515,18 @@ uint_t& MS5607_SPI::getSPIFrequencyRef(){
     return m_SPIFrequency;
 }
 
+uint_t& MS5607_SPI::getPressureOSRRef(){
+    return m_pressureOSR;
+}
+
+uint_t& MS5607_SPI::getTemperatureOSRRef(){
+    return m_temperatureOSR;
+}
+
+uint_t& MS5607_SPI::getTemperatureRatioRef(){
+    return m_temperatureRatio;
+}
+
 float_t& MS5607_SPI::getGroundPressureRef(){
     return m_groundLevelPressure_pa;
 }
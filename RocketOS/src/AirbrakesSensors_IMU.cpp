@@ -59,9 +59,7 @@ using namespace Sensors;
 // === reset complete command (rx) ===
 //page 23 in BNO08x Data Sheet
 #define SHTP_RESET_COMPLETE_PAYLOAD_LENGTH 1
-#define SHTP_RESET_COMPLETE_STATUS_BYTE 0
-
-#define SHTP_RESET_COMPLETE_SUCESS 1
+#define SHTP_RESET_COMPLETE_ID 1
 
 
 
@@ -104,19 +102,23 @@ using namespace Sensors;
 /*same structure as set feature command*/
 
 // === batch report ===
+//page 70 of SH-2 Reference Manual
 #define SHTP_BATCH_REPORT_LENGTH 5
-#define SHTP_BATCH_REPORT_ID 0xFB
+#define SHTP_BATCH_REPORT_ID 0xFB //base timestamp, how long before the interrupt the reports that follow are referenced to
+#define SHTP_REBASE_REPORT_ID 0xFA //timestamp rebase, same layout as the batch report, moves the base of the reports that follow
 
 #define SHTP_BATCH_REPORT_ID_BYTE 0
 #define SHTP_BATCH_REPORT_DELTA_LSB 1
 #define SHTP_BATCH_REPORT_DELTA_SIZE 4
 
+#define SHTP_TIMESTAMP_UNIT_us 100 //base timestamp, rebase and report delay ticks
+
 // === vector report ===
 #define SHTP_VECTOR_REPORT_LENGTH 10
 #define SHTP_VECTOR_REPORT_ID_BYTE 0
-#define SHTP_VECTOR_REPORT_SEQUENCE_BYTE 1 //ignored
-#define SHTP_VECTOR_REPORT_STATUS_BYTE 2 //low bits give sensor accuracy (used), upper bits used for delay (not used)
-#define SHTP_VECTOR_REPORT_DELAY_BYTE 3 //ignored (this may be usefull for other applications)
+#define SHTP_VECTOR_REPORT_SEQUENCE_BYTE 1
+#define SHTP_VECTOR_REPORT_STATUS_BYTE 2 //low bits give sensor accuracy, upper bits are the top of the delay
+#define SHTP_VECTOR_REPORT_DELAY_BYTE 3 //low byte of the delay from the base timestamp
 #define SHTP_VECTOR_REPORT_X_LSB_BYTE 4
 #define SHTP_VECTOR_REPORT_X_MSB_BYTE 5
 #define SHTP_VECTOR_REPORT_Y_LSB_BYTE 6
@@ -130,6 +132,13 @@ using namespace Sensors;
 
 #define SHTP_VECTOR_REPORT_ACCURACY_BITS 0x03
 
+// === report delay ===
+//every sensor report has the same sequence, status and delay bytes, page 57 of SH-2 Reference Manual
+#define SHTP_REPORT_SEQUENCE_BYTE 1 //counts the reports of each sensor, a skipped number is a report the hub dropped
+#define SHTP_REPORT_STATUS_BYTE 2
+#define SHTP_REPORT_DELAY_BYTE 3
+#define SHTP_REPORT_DELAY_MSB_SHIFT 2 //the delay's upper 6 bits sit above the accuracy bits of the status byte
+
 // === orientation report ===
 #define SHTP_ORIENTATION_REPORT_LENGTH 14
 #define SHTP_ORIENTATION_REPORT_ID_BYTE 0
@@ -188,13 +197,25 @@ using namespace Sensors;
 
 
 //public interface implementation
-BNO085_SPI::BNO085_SPI(const char* name, uint_t frequency, uint32_t samplePeriod) : m_name(name), m_SPIFrequency(frequency), m_state(IMUStates::Uninitialized), m_resetComplete(false), m_hubInitialized(false), m_waking(false), m_tareSequenceNumber(0), m_wakeTimer(0), m_wakeTime(NO_WAKEUP),
+BNO085_SPI::BNO085_SPI(const char* name, DeferredWork_t& deferredWork, SPIBus_t& bus, uint_t frequency, uint32_t samplePeriod, uint32_t batchInterval) : m_name(name), m_deferredWork(deferredWork), m_bus(bus), m_servicePending(false), m_serviceTime_us(0), m_packetTime_us(0), m_timebase_us(0), m_lastReportTime_us(0), m_SPIFrequency(frequency), m_state(IMUStates::Uninitialized), m_resetComplete(false), m_hubInitialized(false), m_waking(false), m_configurePending(false), m_txHeader(NULL_PACKET), m_rxHeader(NULL_PACKET), m_doTx(false), m_rxValid(false), m_rxOverflow(0), m_tareSequenceNumber(0), m_wakeTimer(0), m_wakeTime(NO_WAKEUP),
     m_linearAccelerationStatus(IMUSensorStatus::Disabled), m_angularVelocityStatus(IMUSensorStatus::Disabled), m_gravityStatus(IMUSensorStatus::Disabled), m_orientationStatus(IMUSensorStatus::Disabled), 
-    m_linearAccelerationSamplePeriod_us(samplePeriod), m_angularVelocitySamplePeriod_us(samplePeriod), m_gravitySamplePeriod_us(samplePeriod), m_orientationSamplePeriod_us(samplePeriod)
+    m_linearAccelerationSamplePeriod_us(samplePeriod), m_angularVelocitySamplePeriod_us(samplePeriod), m_gravitySamplePeriod_us(samplePeriod), m_orientationSamplePeriod_us(samplePeriod), m_batchInterval_us(batchInterval)
     {
         m_txBuffer.fill(0xFF);
         m_rxBuffer.fill(0xFF);
+        m_txHeaderBytes.fill(0xFF);
+        m_rxHeaderBytes.fill(0xFF);
         m_sequenceNumbers.fill(0);
+        m_reportTimes_us.fill(0);
+        m_reportSequences.fill(0);
+        m_hubSequences.fill(0);
+        m_hubSequenceValid.fill(false);
+        m_reportLatencies_us.fill(0);
+        m_maxReportLatencies_us.fill(0);
+        m_missedReports.fill(0);
+        m_totalMissedReports = 0;
+        m_stale.fill(false);
+        m_stalls.fill(0);
     }
 
 RocketOS::Shell::CommandList BNO085_SPI::getCommands(){
@@ -214,13 +235,16 @@ error_t BNO085_SPI::initialize(){
     digitalWriteFast(RESET_PIN, HIGH);
     //initialize interrupt pin
     pinMode(INTERRUPT_PIN, INPUT_PULLUP);
-    RocketOS::Utilities::inplaceInterrupt<INTERRUPT_PIN>::configureInterrupt([this](){this->serviceInterrupt();}, FALLING);
+    using Dispatcher = RocketOS::Utilities::InterruptDispatcher<INTERRUPT_PIN>;
+    Dispatcher::end();
+    Dispatcher::attach([this](const RocketOS::Utilities::InterruptEvent& event){return this->beginExchange(event);});
+    Dispatcher::begin(FALLING);
     //initialize select pin
     pinMode(CS_PIN, OUTPUT);
     digitalWriteFast(CS_PIN, HIGH);
-    //initialize SPI1
+    //initialize SPI1, the bus runs on it
     SPI1.setMISO(MISO_PIN);
-    SPI1.begin();
+    m_bus.begin();
     //reset bno085
     resetAsync();
     elapsedMicros timeout = 0;
@@ -249,6 +273,14 @@ void BNO085_SPI::setSamplePeriod_us(uint32_t period){
     m_txQueue.push(makeFeatureCallback(IMUData::Gravity, period));
 }
 
+void BNO085_SPI::setBatchInterval_us(uint32_t interval){
+    //the batch interval is sent with the sample period, so resend the features of the running sensors
+    m_batchInterval_us = interval;
+    const std::array<IMUData, c_numIMUData> dataTypes{IMUData::Orientation, IMUData::AngularVelocity, IMUData::LinearAcceleration, IMUData::Gravity};
+    for(IMUData dataType : dataTypes)
+        if(getStatus(dataType) != IMUSensorStatus::Disabled) m_txQueue.push(makeFeatureCallback(dataType, getSamplePeriod(dataType)));
+}
+
 void BNO085_SPI::stopSensor(IMUData dataType){
     m_txQueue.push(makeFeatureCallback(dataType, 0));
     m_txQueue.push(makeFeatureResponseCallback(dataType));
@@ -294,6 +326,73 @@ Quaternion BNO085_SPI::getLastOrientation() const{
     return m_currentOrientation;
 }
 
+uint32_t BNO085_SPI::getLastReportTime_us() const{
+    return m_lastReportTime_us;
+}
+
+Sample<Vector3> BNO085_SPI::getLinearAccelerationSample() const{
+    return makeSample(m_currentLinearAcceleration, IMUData::LinearAcceleration);
+}
+
+Sample<Vector3> BNO085_SPI::getAngularVelocitySample() const{
+    return makeSample(m_currentAngularVelocity, IMUData::AngularVelocity);
+}
+
+Sample<Vector3> BNO085_SPI::getGravitySample() const{
+    return makeSample(m_currentGravity, IMUData::Gravity);
+}
+
+Sample<Quaternion> BNO085_SPI::getOrientationSample() const{
+    return makeSample(m_currentOrientation, IMUData::Orientation);
+}
+
+const BNO085_SPI::VectorHistory_t& BNO085_SPI::getHistory(IMUData dataType) const{
+    //orientation has its own history, asking for it here gives gravity like the other vector lookups
+    switch(dataType){
+        case IMUData::AngularVelocity: return m_angularVelocityHistory;
+        case IMUData::LinearAcceleration: return m_linearAccelerationHistory;
+        case IMUData::Gravity:
+        default: return m_gravityHistory;
+    }
+}
+
+const BNO085_SPI::OrientationHistory_t& BNO085_SPI::getOrientationHistory() const{
+    return m_orientationHistory;
+}
+
+IMUFreshness BNO085_SPI::getFreshness(IMUData dataType) const{
+    uint_t index = static_cast<uint_t>(dataType);
+    uint32_t now = micros();
+    noInterrupts();
+    IMUFreshness freshness{now - m_reportTimes_us[index], m_reportLatencies_us[index], m_maxReportLatencies_us[index], m_missedReports[index], m_stalls[index], false};
+    interrupts();
+    freshness.stale = isStale(dataType, now);
+    return freshness;
+}
+
+bool BNO085_SPI::isStale(IMUData dataType, uint32_t now_us) const{
+    //stopped streams are not expected to report, and a stream is only stale once it has reported
+    uint_t index = static_cast<uint_t>(dataType);
+    IMUSensorStatus status = getStatus(dataType);
+    if(status == IMUSensorStatus::Disabled || m_reportSequences[index] == 0) return false;
+    return static_cast<int32_t>(now_us - m_reportTimes_us[index]) > static_cast<int32_t>(getStaleLimit_us(dataType));
+}
+
+uint32_t BNO085_SPI::getStaleLimit_us(IMUData dataType) const{
+    //a batched report can be held for the batch interval on top of its period
+    return Airbrakes_CFG_IMU_StalePeriods * getSamplePeriod(dataType) + m_batchInterval_us;
+}
+
+void BNO085_SPI::resetFreshness(){
+    //the deferred work updates the counters, so keep it out while they are cleared
+    noInterrupts();
+    m_maxReportLatencies_us.fill(0);
+    m_missedReports.fill(0);
+    m_totalMissedReports = 0;
+    m_stalls.fill(0);
+    interrupts();
+}
+
 //helper functions
 
 void BNO085_SPI::resetAsync(){
@@ -304,7 +403,13 @@ void BNO085_SPI::resetAsync(){
     m_angularVelocityStatus = IMUSensorStatus::Disabled;
     m_gravityStatus = IMUSensorStatus::Disabled;
     m_orientationStatus = IMUSensorStatus::Disabled;
+    m_configurePending = false;
+    //the hub numbers reports from zero again after a reset
+    m_hubSequenceValid.fill(false);
+    //the queue is emptied by its consumer, so keep the interrupt side out while it is cleared
+    noInterrupts();
     m_txQueue.clear();
+    interrupts();
     m_wakeTime = NO_WAKEUP;
     //assert reset pin
     digitalWriteFast(RESET_PIN, LOW);
@@ -318,225 +423,290 @@ void BNO085_SPI::wakeAsync(){
     digitalWriteFast(P0_PIN, LOW);
 }
 
-void BNO085_SPI::serviceInterrupt(){
-    if(digitalReadFast(INTERRUPT_PIN) == LOW){
-        //prepare tx SHTP packet
-        result_t<txCallback_t> nextTransmission = m_txQueue.pop();
-        SHTPHeader txPacket = NULL_PACKET;
-        if(nextTransmission.error == error_t::GOOD){
-            txPacket = nextTransmission.data.operator()();
-            //debugPrintTx(txPacket, true); //debug
-        }
-        //send and receive a SHTP packet
-        result_t<BNO085_SPI::SHTPHeader> result = doSHTP(txPacket);
-        //interpret received SHTP packet
-        if(result.error == error_t::GOOD){
-             respondToPacket(result.data);
-             //debugPrintRx(result.data, true); //debug
-        }
-        //do state transition
-        if(m_state == IMUStates::Reseting && m_hubInitialized && m_resetComplete){
-            m_state = IMUStates::Configuring;
-            m_txQueue.push(makeFeatureCallback(IMUData::Orientation, m_orientationSamplePeriod_us));
-            m_txQueue.push(makeFeatureCallback(IMUData::LinearAcceleration, m_linearAccelerationSamplePeriod_us));
-            m_txQueue.push(makeFeatureCallback(IMUData::AngularVelocity, m_angularVelocitySamplePeriod_us));
-            m_txQueue.push(makeFeatureCallback(IMUData::Gravity, m_gravitySamplePeriod_us));
-            m_txQueue.push(makeFeatureResponseCallback(IMUData::Orientation));
-            m_txQueue.push(makeFeatureResponseCallback(IMUData::LinearAcceleration));
-            m_txQueue.push(makeFeatureResponseCallback(IMUData::AngularVelocity));
-            m_txQueue.push(makeFeatureResponseCallback(IMUData::Gravity));
-            //set first wakeup
-            m_wakeTimer = 0;
-            m_wakeTime = FIRST_WAKEUP_PERIOD_us;
-        }
-        if(m_state == IMUStates::Configuring && m_angularVelocityStatus != IMUSensorStatus::Disabled && m_linearAccelerationStatus != IMUSensorStatus::Disabled && m_orientationStatus != IMUSensorStatus::Disabled && m_gravityStatus != IMUSensorStatus::Disabled){
-            m_state = IMUStates::Operational;
-        }
-        //handle wakeups
-        m_wakeTimer = 0;
-        if(m_waking){
-            digitalWriteFast(P0_PIN, HIGH);
-            m_waking = false;
-        }
+bool BNO085_SPI::beginExchange(const RocketOS::Utilities::InterruptEvent& event){
+    //runs in the pin interrupt, the exchange continues from the bus and the received packet is handled by the deferred work
+    if(m_servicePending) return false;
+    m_servicePending = true;
+    m_serviceTime_us = event.time_us;
+    //prepare tx SHTP packet
+    result_t<txCallback_t> nextTransmission = m_txQueue.pop();
+    m_txHeader = NULL_PACKET;
+    if(nextTransmission.error == error_t::GOOD){
+        m_txHeader = nextTransmission.data.operator()();
+        //debugPrintTx(m_txHeader, true); //debug
     }
-}
-
-void BNO085_SPI::updateBackground(){
-    if(!m_txQueue.empty() && m_wakeTime != NO_WAKEUP && m_wakeTimer >= m_wakeTime){
-        m_wakeTime = max(MINIMUM_NOMINAL_WAKEUP_PERIOD_us, getMaxSamplePeriod() * NOMINAL_WAKEUP_PERIOD_GAIN);
-        m_wakeTimer = 0;
-        wakeAsync();
+    m_doTx = !(m_txHeader.continuation || m_txHeader.channel > c_numSHTPChannels || m_txHeader.length <= SHTP_HEADER_SIZE || m_txHeader.length-SHTP_HEADER_SIZE >= m_txBuffer.size());
+    //set tx header bytes
+    if(m_doTx){
+        m_txHeaderBytes[SHTP_LENGTH_LSB] = static_cast<uint8_t>(0x00FF & m_txHeader.length);
+        m_txHeaderBytes[SHTP_LENGTH_MSB] = static_cast<uint8_t>((0x7F00 & m_txHeader.length) >> 8);
+        m_txHeaderBytes[SHTP_CHANNEL] = m_txHeader.channel;
+        m_txHeaderBytes[SHTP_SEQUENCE] = m_sequenceNumbers[m_txHeader.channel]++;
     }
+    //exchange headers, the select is held so the payload can follow once its length is known
+    RocketOS::Utilities::SPITransaction header = makeTransaction((m_doTx)? m_txHeaderBytes.data() : nullptr, m_rxHeaderBytes.data(), SHTP_HEADER_SIZE, true);
+    header.done = [this](){this->exchangeHeader();};
+    if(m_bus.submit(header) != error_t::GOOD){
+        m_servicePending = false;
+        return false;
+    }
+    return true;
 }
 
-result_t<BNO085_SPI::SHTPHeader> BNO085_SPI::doSHTP(SHTPHeader txPacket){
-    bool doTx = !(txPacket.continuation || txPacket.channel > c_numSHTPChannels || txPacket.length <= SHTP_HEADER_SIZE || txPacket.length-SHTP_HEADER_SIZE >= m_txBuffer.size());
-    bool failRx = false;
-    SHTPHeader rxHeader;
-    uint8_t rxHeaderBytes[SHTP_HEADER_SIZE];
-    uint8_t txHeaderBytes[SHTP_HEADER_SIZE];
-    //set tx header bytes
-    if(doTx){
-        txHeaderBytes[SHTP_LENGTH_LSB] = static_cast<uint8_t>(0x00FF & txPacket.length);
-        txHeaderBytes[SHTP_LENGTH_MSB] = static_cast<uint8_t>(0x7F00 & txPacket.length);
-        txHeaderBytes[SHTP_CHANNEL] = txPacket.channel;
-        txHeaderBytes[SHTP_SEQUENCE] = m_sequenceNumbers[txPacket.channel]++;
-    }
-    //begin SPI transaction
-    noInterrupts();
-    SPI1.beginTransaction(SPISettings(m_SPIFrequency, MSBFIRST, SPI_MODE3));
-    digitalWriteFast(CS_PIN, LOW);
-    //exchange headers
-    SPI1.transfer((doTx)? txHeaderBytes : nullptr, rxHeaderBytes, SHTP_HEADER_SIZE);
+void BNO085_SPI::exchangeHeader(){
+    //runs in the bus context once the headers are exchanged
     //interpret rx header
-    rxHeader.continuation = rxHeaderBytes[SHTP_LENGTH_MSB] & SHTP_CONTINUATION_BIT;
-    rxHeader.length = static_cast<uint16_t>(rxHeaderBytes[SHTP_LENGTH_LSB]) | (static_cast<uint16_t>((rxHeaderBytes[SHTP_LENGTH_MSB] & ~SHTP_CONTINUATION_BIT)) << 8);
-    rxHeader.channel = rxHeaderBytes[SHTP_CHANNEL];
+    m_rxHeader.continuation = m_rxHeaderBytes[SHTP_LENGTH_MSB] & SHTP_CONTINUATION_BIT;
+    m_rxHeader.length = static_cast<uint16_t>(m_rxHeaderBytes[SHTP_LENGTH_LSB]) | (static_cast<uint16_t>((m_rxHeaderBytes[SHTP_LENGTH_MSB] & ~SHTP_CONTINUATION_BIT)) << 8);
+    m_rxHeader.channel = m_rxHeaderBytes[SHTP_CHANNEL];
     //check for invalid rx header
-    if(rxHeader.length <= SHTP_HEADER_SIZE || rxHeader.channel >= c_numSHTPChannels) failRx = true;
+    bool failRx = m_rxHeader.length <= SHTP_HEADER_SIZE || m_rxHeader.channel >= c_numSHTPChannels;
     //determine remaining transfer size
-    uint_t numAfterOverflow = 0;
     uint_t remainingTransferSize = 0;
+    m_rxOverflow = 0;
     if(!failRx){
-        if(rxHeader.length-SHTP_HEADER_SIZE > m_rxBuffer.size()){
+        if(m_rxHeader.length-SHTP_HEADER_SIZE > m_rxBuffer.size()){
             remainingTransferSize = m_rxBuffer.size();
-            numAfterOverflow = (rxHeader.length-SHTP_HEADER_SIZE) - m_rxBuffer.size();
+            m_rxOverflow = (m_rxHeader.length-SHTP_HEADER_SIZE) - m_rxBuffer.size();
         }
         else {
-            remainingTransferSize = rxHeader.length - SHTP_HEADER_SIZE;
+            remainingTransferSize = m_rxHeader.length - SHTP_HEADER_SIZE;
         }
     }
-    if(doTx) remainingTransferSize = max(remainingTransferSize, txPacket.length - SHTP_HEADER_SIZE);
+    if(m_doTx) remainingTransferSize = max(remainingTransferSize, static_cast<uint_t>(m_txHeader.length - SHTP_HEADER_SIZE));
+    m_rxValid = !failRx && !m_rxHeader.continuation && remainingTransferSize != 0;
     //transfer payloads
-    if(remainingTransferSize > 0) SPI1.transfer((doTx)? m_txBuffer.data() : nullptr, m_rxBuffer.data(), remainingTransferSize);
+    if(remainingTransferSize > 0){
+        RocketOS::Utilities::SPITransaction payload = makeTransaction((m_doTx)? m_txBuffer.data() : nullptr, m_rxBuffer.data(), remainingTransferSize, m_rxOverflow > 0);
+        payload.done = [this](){this->exchangePayload();};
+        if(m_bus.chain(payload) == error_t::GOOD) return;
+        m_rxValid = false;
+    }
+    exchangePayload();
+}
+
+void BNO085_SPI::exchangePayload(){
     //skip remaining BNO payload if too large
-    if(numAfterOverflow > 0) SPI1.transfer(nullptr, numAfterOverflow);
-    //end SPI transaction
-    digitalWriteFast(CS_PIN, HIGH);
-    SPI1.endTransaction();
-    interrupts();
-    return {rxHeader, (!failRx && !rxHeader.continuation && remainingTransferSize != 0)? error_t::GOOD : error_t::ERROR};
+    if(m_rxOverflow > 0){
+        RocketOS::Utilities::SPITransaction discard = makeTransaction(nullptr, nullptr, m_rxOverflow, false);
+        m_rxOverflow = 0;
+        discard.done = [this](){this->exchangePayload();};
+        if(m_bus.chain(discard) == error_t::GOOD) return;
+    }
+    //the bus deselects once this returns, the packet is handled outside of its interrupt
+    if(m_deferredWork.post([this](){this->finishExchange();}) != error_t::GOOD) m_servicePending = false;
 }
 
-void BNO085_SPI::respondToPacket(BNO085_SPI::SHTPHeader packet){
-    if(handleInitializeResponse(packet)) return;
-    if(handleResetComplete(packet)) return;
-    if(handleFeatureResponse(IMUData::LinearAcceleration, packet)) return;
-    if(handleFeatureResponse(IMUData::AngularVelocity, packet)) return;
-    if(handleFeatureResponse(IMUData::Orientation, packet)) return;
-    if(handleFeatureResponse(IMUData::Gravity, packet)) return;
-    if(handleVectorReport(IMUData::LinearAcceleration, packet)) return;
-    if(handleVectorReport(IMUData::AngularVelocity, packet)) return;
-    if(handleVectorReport(IMUData::Gravity, packet)) return;
-    if(handleOrientationReport(packet)) return;
+void BNO085_SPI::finishExchange(){
+    //reports in this packet were ready when the interrupt line fell
+    m_packetTime_us = m_serviceTime_us;
+    //interpret received SHTP packet
+    if(m_rxValid){
+        respondToPacket(m_rxHeader);
+        //debugPrintRx(m_rxHeader, true); //debug
+    }
+    //do state transition
+    if(m_state == IMUStates::Reseting && m_hubInitialized && m_resetComplete){
+        //the tx queue only has one producer, so the configuration commands are queued by updateBackground
+        m_state = IMUStates::Configuring;
+        m_configurePending = true;
+    }
+    if(m_state == IMUStates::Configuring && m_angularVelocityStatus != IMUSensorStatus::Disabled && m_linearAccelerationStatus != IMUSensorStatus::Disabled && m_orientationStatus != IMUSensorStatus::Disabled && m_gravityStatus != IMUSensorStatus::Disabled){
+        m_state = IMUStates::Operational;
+    }
+    //handle wakeups
+    m_wakeTimer = 0;
+    if(m_waking){
+        digitalWriteFast(P0_PIN, HIGH);
+        m_waking = false;
+    }
+    //the next falling edge can start an exchange
+    m_servicePending = false;
 }
 
-//command responses--------------------------------------------
-bool BNO085_SPI::handleInitializeResponse(SHTPHeader packet){
-    if(packet.continuation || packet.channel != SHTP_HUB_CHANNEL) return false;
-    if(packet.length != SHTP_INITIALIZATION_PAYLOAD_LENGTH + SHTP_HEADER_SIZE) return false;
-    if(m_rxBuffer[SHTP_INITIALIZATION_ID_BYTE] != SHTP_INITIALIZATION_ID) return false;
-    if(m_rxBuffer[SHTP_INITIALIZATION_COMMAND_BYTE] != SHTP_INITIALIZATION_COMMAND && m_rxBuffer[SHTP_INITIALIZATION_COMMAND_BYTE] != SHTP_INITIALIZATION_COMMAND_UNSOLICITED) return false;
-    if(m_rxBuffer[SHTP_INITIALIZATION_STATUS_BYTE] == 0 && m_rxBuffer[SHTP_INITIALIZATION_SUBSYSTEM_BYTE] == 1){
-        //recived an initialization packet
-        m_hubInitialized = true;
-        return true;
+void BNO085_SPI::updateBackground(){
+    //queue the sensor configuration after a reset
+    if(m_configurePending){
+        m_configurePending = false;
+        const std::array<txCallback_t, 8> configuration{
+            makeFeatureCallback(IMUData::Orientation, m_orientationSamplePeriod_us),
+            makeFeatureCallback(IMUData::LinearAcceleration, m_linearAccelerationSamplePeriod_us),
+            makeFeatureCallback(IMUData::AngularVelocity, m_angularVelocitySamplePeriod_us),
+            makeFeatureCallback(IMUData::Gravity, m_gravitySamplePeriod_us),
+            makeFeatureResponseCallback(IMUData::Orientation),
+            makeFeatureResponseCallback(IMUData::LinearAcceleration),
+            makeFeatureResponseCallback(IMUData::AngularVelocity),
+            makeFeatureResponseCallback(IMUData::Gravity)
+        };
+        m_txQueue.push(configuration.data(), configuration.size());
+        //set first wakeup
+        m_wakeTimer = 0;
+        m_wakeTime = FIRST_WAKEUP_PERIOD_us;
+    }
+    //the falling edge is lost if the bus or deferred work queue was full, service the held interrupt line from here
+    if(m_state != IMUStates::Uninitialized && !m_servicePending && digitalReadFast(INTERRUPT_PIN) == LOW) RocketOS::Utilities::InterruptDispatcher<INTERRUPT_PIN>::recover();
+    if(!m_txQueue.empty() && m_wakeTime != NO_WAKEUP && m_wakeTimer >= m_wakeTime){
+        m_wakeTime = max(MINIMUM_NOMINAL_WAKEUP_PERIOD_us, getMaxSamplePeriod() * NOMINAL_WAKEUP_PERIOD_GAIN);
+        m_wakeTimer = 0;
+        wakeAsync();
+    }
+    //count each time a running stream goes stale
+    uint32_t now = micros();
+    for(uint_t i=0; i<c_numIMUData; i++){
+        bool stale = isStale(static_cast<IMUData>(i), now);
+        if(stale && !m_stale[i]) m_stalls[i]++;
+        m_stale[i] = stale;
     }
-    return false;
 }
 
-bool BNO085_SPI::handleResetComplete(SHTPHeader packet){
-    if(packet.continuation || packet.channel != SHTP_EXECUTABLE_CHANNEL) return false;
-    if(packet.length != SHTP_RESET_COMPLETE_PAYLOAD_LENGTH + SHTP_HEADER_SIZE) return false;
-    if(m_rxBuffer[SHTP_RESET_COMPLETE_STATUS_BYTE] == SHTP_RESET_COMPLETE_SUCESS){
-        m_resetComplete = true;
-        return true;
+RocketOS::Utilities::SPITransaction BNO085_SPI::makeTransaction(const uint8_t* tx, uint8_t* rx, uint16_t length, bool holdSelect) const{
+    return RocketOS::Utilities::SPITransaction{CS_PIN, m_SPIFrequency, SPI_MODE3, tx, rx, length, holdSelect, {}};
+}
+
+//receive dispatch table, the command responses fill their whole payload and the sensor reports can be packed back to back
+const std::array<BNO085_SPI::SHTPReport, 9> BNO085_SPI::c_reports{
+    SHTPReport{SHTP_HUB_CHANNEL, SHTP_INITIALIZATION_ID, SHTP_INITIALIZATION_PAYLOAD_LENGTH, IMUData::Orientation, &BNO085_SPI::decodeInitializeResponse},
+    SHTPReport{SHTP_HUB_CHANNEL, SHTP_FEATURE_RESPONSE_ID, SHTP_FEATURE_RESPONSE_PAYLOAD_LENGTH, IMUData::Orientation, &BNO085_SPI::decodeFeatureResponse},
+    SHTPReport{SHTP_EXECUTABLE_CHANNEL, SHTP_RESET_COMPLETE_ID, SHTP_RESET_COMPLETE_PAYLOAD_LENGTH, IMUData::Orientation, &BNO085_SPI::decodeResetComplete},
+    SHTPReport{SHTP_INPUT_SENSOR_CHANNEL, SHTP_BATCH_REPORT_ID, SHTP_BATCH_REPORT_LENGTH, IMUData::Orientation, &BNO085_SPI::decodeTimebase},
+    SHTPReport{SHTP_INPUT_SENSOR_CHANNEL, SHTP_REBASE_REPORT_ID, SHTP_BATCH_REPORT_LENGTH, IMUData::Orientation, &BNO085_SPI::decodeRebase},
+    SHTPReport{SHTP_INPUT_SENSOR_CHANNEL, SHTP_LINEAR_ID, SHTP_VECTOR_REPORT_LENGTH, IMUData::LinearAcceleration, &BNO085_SPI::decodeVectorReport},
+    SHTPReport{SHTP_INPUT_SENSOR_CHANNEL, SHTP_ANGULAR_VELOCITY_ID, SHTP_VECTOR_REPORT_LENGTH, IMUData::AngularVelocity, &BNO085_SPI::decodeVectorReport},
+    SHTPReport{SHTP_INPUT_SENSOR_CHANNEL, SHTP_GRAVITY_ID, SHTP_VECTOR_REPORT_LENGTH, IMUData::Gravity, &BNO085_SPI::decodeVectorReport},
+    SHTPReport{SHTP_INPUT_SENSOR_CHANNEL, SHTP_ORIENTATION_ID, SHTP_ORIENTATION_REPORT_LENGTH, IMUData::Orientation, &BNO085_SPI::decodeOrientationReport}
+};
+
+void BNO085_SPI::respondToPacket(BNO085_SPI::SHTPHeader packet){
+    //the header is checked once, then every report in the payload is decoded in order
+    if(packet.continuation) return;
+    uint_t length = min(static_cast<uint_t>(packet.length - SHTP_HEADER_SIZE), static_cast<uint_t>(m_rxBuffer.size()));
+    uint_t offset = 0;
+    //reports without a base timestamp in front of them are referenced to the interrupt
+    m_timebase_us = m_packetTime_us;
+    while(offset < length){
+        const SHTPReport* report = findReport(packet.channel, m_rxBuffer[offset]);
+        //reports do not carry their length, so the rest of the payload can not be walked past an unknown one
+        if(report == nullptr || offset + report->length > length) return;
+        if(report->decode != nullptr) (this->*(report->decode))(&m_rxBuffer[offset], report->dataType);
+        offset += report->length;
     }
-    return false;
-}
-
-bool BNO085_SPI::handleFeatureResponse(IMUData dataType, SHTPHeader packet){
-    if(packet.length != SHTP_FEATURE_RESPONSE_PAYLOAD_LENGTH + SHTP_HEADER_SIZE) return false;
-    if(packet.channel != SHTP_HUB_CHANNEL) return false;
-    if(packet.continuation) return false;
-    if(m_rxBuffer[SHTP_FEATURE_ID_BYTE] != SHTP_FEATURE_RESPONSE_ID) return false;
-    if(m_rxBuffer[SHTP_FEATURE_SENSOR_ID_BYTE] == getReportID(dataType)){
-        uint32_t actualPeriod_us = static_cast<uint32_t>(m_rxBuffer[SHTP_FEATURE_REPORT_INTERVAL_LSB_BYTE]) | 
-        static_cast<uint32_t>(m_rxBuffer[SHTP_FEATURE_REPORT_INTERVAL_LSB_BYTE + 1] << 8) |
-        static_cast<uint32_t>(m_rxBuffer[SHTP_FEATURE_REPORT_INTERVAL_LSB_BYTE + 2] << 16) |
-        static_cast<uint32_t>(m_rxBuffer[SHTP_FEATURE_REPORT_INTERVAL_LSB_BYTE + 3] << 24);
-        //check if sensor is shutdown
-        if(actualPeriod_us == 0){
-             getStatus(dataType) = IMUSensorStatus::Disabled;
-             return true;
-        }
-        //update actual sample period
-        getSamplePeriod(dataType) = actualPeriod_us;
-        //check if sensor is starting up
-        if(getStatus(dataType) == IMUSensorStatus::Disabled) getStatus(dataType) = IMUSensorStatus::Unreliable;
-        return true;
+}
+
+const BNO085_SPI::SHTPReport* BNO085_SPI::findReport(uint8_t channel, uint8_t reportID){
+    for(const SHTPReport& report : c_reports)
+        if(report.reportID == reportID && report.channel == channel) return &report;
+    return nullptr;
+}
+
+//command responses--------------------------------------------
+void BNO085_SPI::decodeInitializeResponse(const uint8_t* report, IMUData){
+    if(report[SHTP_INITIALIZATION_COMMAND_BYTE] != SHTP_INITIALIZATION_COMMAND && report[SHTP_INITIALIZATION_COMMAND_BYTE] != SHTP_INITIALIZATION_COMMAND_UNSOLICITED) return;
+    //recived an initialization packet
+    if(report[SHTP_INITIALIZATION_STATUS_BYTE] == 0 && report[SHTP_INITIALIZATION_SUBSYSTEM_BYTE] == 1) m_hubInitialized = true;
+}
+
+void BNO085_SPI::decodeResetComplete(const uint8_t*, IMUData){
+    //the report ID is the reset complete status
+    m_resetComplete = true;
+}
+
+void BNO085_SPI::decodeFeatureResponse(const uint8_t* report, IMUData){
+    //find which stream the response is for from its sensor report ID
+    const SHTPReport* sensor = findReport(SHTP_INPUT_SENSOR_CHANNEL, report[SHTP_FEATURE_SENSOR_ID_BYTE]);
+    if(sensor == nullptr || sensor->decode == nullptr) return;
+    IMUData dataType = sensor->dataType;
+    uint32_t actualPeriod_us = static_cast<uint32_t>(report[SHTP_FEATURE_REPORT_INTERVAL_LSB_BYTE]) | 
+    static_cast<uint32_t>(report[SHTP_FEATURE_REPORT_INTERVAL_LSB_BYTE + 1] << 8) |
+    static_cast<uint32_t>(report[SHTP_FEATURE_REPORT_INTERVAL_LSB_BYTE + 2] << 16) |
+    static_cast<uint32_t>(report[SHTP_FEATURE_REPORT_INTERVAL_LSB_BYTE + 3] << 24);
+    //check if sensor is shutdown
+    if(actualPeriod_us == 0){
+         getStatus(dataType) = IMUSensorStatus::Disabled;
+         return;
     }
-    return false;
+    //update actual sample period
+    getSamplePeriod(dataType) = actualPeriod_us;
+    //check if sensor is starting up, its first report starts the sequence count again
+    if(getStatus(dataType) == IMUSensorStatus::Disabled){
+        getStatus(dataType) = IMUSensorStatus::Unreliable;
+        m_hubSequenceValid[static_cast<uint_t>(dataType)] = false;
+    }
+}
+
+//timestamps---------------------------------------------------
+void BNO085_SPI::decodeTimebase(const uint8_t* report, IMUData){
+    //the delta is how long before the interrupt the base was taken
+    uint32_t delta = 0;
+    for(uint_t i=0; i<SHTP_BATCH_REPORT_DELTA_SIZE; i++)
+        delta |= static_cast<uint32_t>(report[SHTP_BATCH_REPORT_DELTA_LSB + i]) << (8 * i);
+    m_timebase_us = m_packetTime_us - delta * SHTP_TIMESTAMP_UNIT_us;
+}
+
+void BNO085_SPI::decodeRebase(const uint8_t* report, IMUData){
+    //a batch spanning longer than the report delays can count moves the base forward (or back) for the reports after it
+    uint32_t delta = 0;
+    for(uint_t i=0; i<SHTP_BATCH_REPORT_DELTA_SIZE; i++)
+        delta |= static_cast<uint32_t>(report[SHTP_BATCH_REPORT_DELTA_LSB + i]) << (8 * i);
+    //the delta is signed, unsigned arithmetic wraps to the same base without overflowing on a corrupt value
+    m_timebase_us += delta * SHTP_TIMESTAMP_UNIT_us;
 }
 
-bool BNO085_SPI::handleVectorReport(IMUData dataType, SHTPHeader packet){
-    if(packet.length != SHTP_BATCH_REPORT_LENGTH + SHTP_VECTOR_REPORT_LENGTH + SHTP_HEADER_SIZE) return false;
-    if(packet.channel != SHTP_INPUT_SENSOR_CHANNEL) return false;
-    if(packet.continuation) return false;
-    //check for batch report id
-    if(m_rxBuffer[SHTP_BATCH_REPORT_ID_BYTE] != SHTP_BATCH_REPORT_ID) return false;
-    //check sensor report ID
-    if(m_rxBuffer[SHTP_VECTOR_REPORT_ID_BYTE + SHTP_BATCH_REPORT_LENGTH] != getReportID(dataType)) return false;
+void BNO085_SPI::decodeVectorReport(const uint8_t* report, IMUData dataType){
     //read status value
     IMUSensorStatus status = IMUSensorStatus::Unreliable;
-    uint8_t statusBits = m_rxBuffer[SHTP_VECTOR_REPORT_STATUS_BYTE + SHTP_BATCH_REPORT_LENGTH] & SHTP_VECTOR_REPORT_ACCURACY_BITS;
+    uint8_t statusBits = report[SHTP_VECTOR_REPORT_STATUS_BYTE] & SHTP_VECTOR_REPORT_ACCURACY_BITS;
     if(statusBits == 1) status = IMUSensorStatus::LowAccuracy;
     if(statusBits == 2) status = IMUSensorStatus::ModerateAccuracy;
     if(statusBits == 3) status = IMUSensorStatus::HighAccuracy;
-    getStatus(dataType) = status;
+    //a report still batched when the stream was stopped does not restart it
+    if(getStatus(dataType) != IMUSensorStatus::Disabled) getStatus(dataType) = status;
     //read vector value
-    int16_t xValue = static_cast<int16_t>(m_rxBuffer[SHTP_VECTOR_REPORT_X_LSB_BYTE + SHTP_BATCH_REPORT_LENGTH]) | (static_cast<int16_t>(m_rxBuffer[SHTP_VECTOR_REPORT_X_MSB_BYTE + SHTP_BATCH_REPORT_LENGTH]) << 8);
-    int16_t yValue = static_cast<int16_t>(m_rxBuffer[SHTP_VECTOR_REPORT_Y_LSB_BYTE + SHTP_BATCH_REPORT_LENGTH]) | (static_cast<int16_t>(m_rxBuffer[SHTP_VECTOR_REPORT_Y_MSB_BYTE + SHTP_BATCH_REPORT_LENGTH]) << 8);
-    int16_t zValue = static_cast<int16_t>(m_rxBuffer[SHTP_VECTOR_REPORT_Z_LSB_BYTE + SHTP_BATCH_REPORT_LENGTH]) | (static_cast<int16_t>(m_rxBuffer[SHTP_VECTOR_REPORT_Z_MSB_BYTE + SHTP_BATCH_REPORT_LENGTH]) << 8);
+    int16_t xValue = static_cast<int16_t>(report[SHTP_VECTOR_REPORT_X_LSB_BYTE]) | (static_cast<int16_t>(report[SHTP_VECTOR_REPORT_X_MSB_BYTE]) << 8);
+    int16_t yValue = static_cast<int16_t>(report[SHTP_VECTOR_REPORT_Y_LSB_BYTE]) | (static_cast<int16_t>(report[SHTP_VECTOR_REPORT_Y_MSB_BYTE]) << 8);
+    int16_t zValue = static_cast<int16_t>(report[SHTP_VECTOR_REPORT_Z_LSB_BYTE]) | (static_cast<int16_t>(report[SHTP_VECTOR_REPORT_Z_MSB_BYTE]) << 8);
     float_t xFloat = static_cast<float_t>(xValue) / (1u << getQPoint(dataType));
     float_t yFloat = static_cast<float_t>(yValue) / (1u << getQPoint(dataType));
     float_t zFloat = static_cast<float_t>(zValue) / (1u << getQPoint(dataType));
+    //the observer interrupt can preempt the deferred work, so store the vector atomically
     Vector3& storageValue = getVector(dataType);
+    uint32_t time_us = getReportTime(report);
+    trackReport(report, dataType, time_us);
+    noInterrupts();
     storageValue.x = xFloat;
     storageValue.y = yFloat;
     storageValue.z = zFloat;
-    return true;
+    uint32_t sequence = stampReport(dataType, time_us);
+    interrupts();
+    getVectorHistory(dataType).append(Sample<Vector3>{Vector3{xFloat, yFloat, zFloat}, time_us, sequence});
 }
 
-bool BNO085_SPI::handleOrientationReport(SHTPHeader packet){
-    if(packet.length != SHTP_BATCH_REPORT_LENGTH + SHTP_ORIENTATION_REPORT_LENGTH + SHTP_HEADER_SIZE) return false;
-    if(packet.channel != SHTP_INPUT_SENSOR_CHANNEL) return false;
-    if(packet.continuation) return false;
-    //check for batch report id
-    if(m_rxBuffer[SHTP_BATCH_REPORT_ID_BYTE] != SHTP_BATCH_REPORT_ID) return false;
-    //check report id
-    if(m_rxBuffer[SHTP_ORIENTATION_REPORT_ID_BYTE + SHTP_BATCH_REPORT_LENGTH] != getReportID(IMUData::Orientation)) return false;
+void BNO085_SPI::decodeOrientationReport(const uint8_t* report, IMUData){
     //read status value
     IMUSensorStatus status = IMUSensorStatus::Unreliable;
-    uint8_t statusBits = m_rxBuffer[SHTP_ORIENTATION_REPORT_STATUS_BYTE + SHTP_BATCH_REPORT_LENGTH] & SHTP_ORIENTATION_REPORT_ACCURACY_BITS;
+    uint8_t statusBits = report[SHTP_ORIENTATION_REPORT_STATUS_BYTE] & SHTP_ORIENTATION_REPORT_ACCURACY_BITS;
     if(statusBits == 1) status = IMUSensorStatus::LowAccuracy;
     if(statusBits == 2) status = IMUSensorStatus::ModerateAccuracy;
     if(statusBits == 3) status = IMUSensorStatus::HighAccuracy;
-    m_orientationStatus = status;
+    if(m_orientationStatus != IMUSensorStatus::Disabled) m_orientationStatus = status;
     //read quaternion value
-    int16_t rValue = static_cast<int16_t>(m_rxBuffer[SHTP_ORIENTATION_REPORT_REAL_LSB_BYTE + SHTP_BATCH_REPORT_LENGTH]) | (static_cast<int16_t>(m_rxBuffer[SHTP_ORIENTATION_REPORT_REAL_MSB_BYTE + SHTP_BATCH_REPORT_LENGTH]) << 8);
-    int16_t iValue = static_cast<int16_t>(m_rxBuffer[SHTP_ORIENTATION_REPORT_I_LSB_BYTE + SHTP_BATCH_REPORT_LENGTH]) | (static_cast<int16_t>(m_rxBuffer[SHTP_ORIENTATION_REPORT_I_MSB_BYTE + SHTP_BATCH_REPORT_LENGTH]) << 8);
-    int16_t jValue = static_cast<int16_t>(m_rxBuffer[SHTP_ORIENTATION_REPORT_J_LSB_BYTE + SHTP_BATCH_REPORT_LENGTH]) | (static_cast<int16_t>(m_rxBuffer[SHTP_ORIENTATION_REPORT_J_MSB_BYTE + SHTP_BATCH_REPORT_LENGTH]) << 8);
-    int16_t kValue = static_cast<int16_t>(m_rxBuffer[SHTP_ORIENTATION_REPORT_K_LSB_BYTE + SHTP_BATCH_REPORT_LENGTH]) | (static_cast<int16_t>(m_rxBuffer[SHTP_ORIENTATION_REPORT_K_MSB_BYTE + SHTP_BATCH_REPORT_LENGTH]) << 8);
+    int16_t rValue = static_cast<int16_t>(report[SHTP_ORIENTATION_REPORT_REAL_LSB_BYTE]) | (static_cast<int16_t>(report[SHTP_ORIENTATION_REPORT_REAL_MSB_BYTE]) << 8);
+    int16_t iValue = static_cast<int16_t>(report[SHTP_ORIENTATION_REPORT_I_LSB_BYTE]) | (static_cast<int16_t>(report[SHTP_ORIENTATION_REPORT_I_MSB_BYTE]) << 8);
+    int16_t jValue = static_cast<int16_t>(report[SHTP_ORIENTATION_REPORT_J_LSB_BYTE]) | (static_cast<int16_t>(report[SHTP_ORIENTATION_REPORT_J_MSB_BYTE]) << 8);
+    int16_t kValue = static_cast<int16_t>(report[SHTP_ORIENTATION_REPORT_K_LSB_BYTE]) | (static_cast<int16_t>(report[SHTP_ORIENTATION_REPORT_K_MSB_BYTE]) << 8);
     float_t rFloat = static_cast<float_t>(rValue) / (1u << getQPoint(IMUData::Orientation));
     float_t iFloat = static_cast<float_t>(iValue) / (1u << getQPoint(IMUData::Orientation));
     float_t jFloat = static_cast<float_t>(jValue) / (1u << getQPoint(IMUData::Orientation));
     float_t kFloat = static_cast<float_t>(kValue) / (1u << getQPoint(IMUData::Orientation));
+    uint32_t time_us = getReportTime(report);
+    trackReport(report, IMUData::Orientation, time_us);
+    noInterrupts();
     m_currentOrientation.r = rFloat;
     m_currentOrientation.i = iFloat;
     m_currentOrientation.j = jFloat;
     m_currentOrientation.k = kFloat;
-    return true;
+    uint32_t sequence = stampReport(IMUData::Orientation, time_us);
+    interrupts();
+    m_orientationHistory.append(Sample<Quaternion>{Quaternion{rFloat, iFloat, jFloat, kFloat}, time_us, sequence});
 }
 
 //command generation-------------------------------------------
@@ -565,11 +735,12 @@ BNO085_SPI::SHTPHeader BNO085_SPI::generateFeatureCommand(IMUData dataType, uint
     m_txBuffer[SHTP_FEATURE_REPORT_INTERVAL_LSB_BYTE + 1] = static_cast<uint8_t>(interval_us >> 8);
     m_txBuffer[SHTP_FEATURE_REPORT_INTERVAL_LSB_BYTE + 2] = static_cast<uint8_t>(interval_us >> 16);
     m_txBuffer[SHTP_FEATURE_REPORT_INTERVAL_LSB_BYTE + 3] = static_cast<uint8_t>(interval_us >> 24);
-    //set batch size (not used)
-    m_txBuffer[SHTP_FEATURE_BATCH_INTERVAL_LSB_BYTE] = 0;
-    m_txBuffer[SHTP_FEATURE_BATCH_INTERVAL_LSB_BYTE + 1] = 0;
-    m_txBuffer[SHTP_FEATURE_BATCH_INTERVAL_LSB_BYTE + 2] = 0;
-    m_txBuffer[SHTP_FEATURE_BATCH_INTERVAL_LSB_BYTE + 3] = 0;
+    //set batch interval, the hub holds reports up to this long and sends them together
+    uint32_t batch_us = m_batchInterval_us;
+    m_txBuffer[SHTP_FEATURE_BATCH_INTERVAL_LSB_BYTE] = static_cast<uint8_t>(batch_us);
+    m_txBuffer[SHTP_FEATURE_BATCH_INTERVAL_LSB_BYTE + 1] = static_cast<uint8_t>(batch_us >> 8);
+    m_txBuffer[SHTP_FEATURE_BATCH_INTERVAL_LSB_BYTE + 2] = static_cast<uint8_t>(batch_us >> 16);
+    m_txBuffer[SHTP_FEATURE_BATCH_INTERVAL_LSB_BYTE + 3] = static_cast<uint8_t>(batch_us >> 24);
     //set sensor specific data (not used by implemented sensors)
     m_txBuffer[SHTP_FEATURE_SENSOR_SPECIFIC_LSB_BYTE] = 0;
     m_txBuffer[SHTP_FEATURE_SENSOR_SPECIFIC_LSB_BYTE + 1] = 0;
@@ -663,6 +834,16 @@ uint_t& BNO085_SPI::getSamplePeriod(IMUData data){
     }
 }
 
+uint_t BNO085_SPI::getSamplePeriod(IMUData data) const{
+    switch(data){
+        case IMUData::Orientation: return m_orientationSamplePeriod_us;
+        case IMUData::AngularVelocity: return m_angularVelocitySamplePeriod_us;
+        case IMUData::LinearAcceleration: return m_linearAccelerationSamplePeriod_us;
+        case IMUData::Gravity: 
+        default: return m_gravitySamplePeriod_us;
+    }
+}
+
 IMUSensorStatus& BNO085_SPI::getStatus(IMUData data){
     switch(data){
         case IMUData::Orientation: return m_orientationStatus;
@@ -673,6 +854,16 @@ IMUSensorStatus& BNO085_SPI::getStatus(IMUData data){
     }
 }
 
+IMUSensorStatus BNO085_SPI::getStatus(IMUData data) const{
+    switch(data){
+        case IMUData::Orientation: return m_orientationStatus;
+        case IMUData::AngularVelocity: return m_angularVelocityStatus;
+        case IMUData::LinearAcceleration: return m_linearAccelerationStatus;
+        case IMUData::Gravity: 
+        default: return m_gravityStatus;
+    }
+}
+
 uint_t BNO085_SPI::getQPoint(IMUData data){
     switch(data){
         case IMUData::Orientation: return SHTP_ORIENTATION_Q_POINT;
@@ -692,6 +883,52 @@ Vector3& BNO085_SPI::getVector(IMUData data){
     }
 }
 
+BNO085_SPI::VectorHistory_t& BNO085_SPI::getVectorHistory(IMUData data){
+    switch(data){
+        case IMUData::AngularVelocity: return m_angularVelocityHistory;
+        case IMUData::LinearAcceleration: return m_linearAccelerationHistory;
+        case IMUData::Gravity:
+        default: return m_gravityHistory;
+    }
+}
+
+uint32_t BNO085_SPI::getReportTime(const uint8_t* report) const{
+    //the delay is counted from the base timestamp, so batched reports keep the time they were taken at
+    uint32_t delay = (static_cast<uint32_t>(report[SHTP_REPORT_STATUS_BYTE] >> SHTP_REPORT_DELAY_MSB_SHIFT) << 8) | report[SHTP_REPORT_DELAY_BYTE];
+    return m_timebase_us + delay * SHTP_TIMESTAMP_UNIT_us;
+}
+
+uint32_t BNO085_SPI::stampReport(IMUData data, uint32_t time_us){
+    //called with interrupts masked, together with the store of the report value
+    m_reportTimes_us[static_cast<uint_t>(data)] = time_us;
+    m_lastReportTime_us = time_us;
+    return ++m_reportSequences[static_cast<uint_t>(data)];
+}
+
+void BNO085_SPI::trackReport(const uint8_t* report, IMUData data, uint32_t time_us){
+    //called before the report is stamped, so the time of the one before it is still stored
+    uint_t index = static_cast<uint_t>(data);
+    //how long the report waited in the hub, a corrupt delay can put it after the interrupt
+    int32_t latency_us = static_cast<int32_t>(m_packetTime_us - time_us);
+    m_reportLatencies_us[index] = (latency_us > 0)? latency_us : 0;
+    if(m_reportLatencies_us[index] > m_maxReportLatencies_us[index]) m_maxReportLatencies_us[index] = m_reportLatencies_us[index];
+    uint8_t sequence = report[SHTP_REPORT_SEQUENCE_BYTE];
+    if(m_hubSequenceValid[index]){
+        uint32_t missed = static_cast<uint8_t>(sequence - m_hubSequences[index] - 1);
+        //the sequence numbers are 8 bits, so whole wraps of a long run of lost reports are counted from the time between the reports
+        uint32_t period_us = getSamplePeriod(data);
+        int32_t elapsed_us = static_cast<int32_t>(time_us - m_reportTimes_us[index]);
+        if(period_us > 0 && elapsed_us > 0){
+            uint32_t periods = (static_cast<uint32_t>(elapsed_us) + period_us / 2) / period_us;
+            if(periods > missed + 1) missed += (periods - 1 - missed + 128) / 256 * 256;
+        }
+        m_missedReports[index] += missed;
+        m_totalMissedReports += missed;
+    }
+    m_hubSequences[index] = sequence;
+    m_hubSequenceValid[index] = true;
+}
+
 uint_t BNO085_SPI::getMaxSamplePeriod() const{
     return max(m_linearAccelerationSamplePeriod_us, max(m_orientationSamplePeriod_us, max(m_gravitySamplePeriod_us, m_angularVelocitySamplePeriod_us)));
 }
@@ -717,6 +954,10 @@ uint32_t& BNO085_SPI::getGravitySamplePeriodRef(){
     return m_gravitySamplePeriod_us;
 }
 
+uint32_t& BNO085_SPI::getBatchIntervalRef(){
+    return m_batchInterval_us;
+}
+
 const Vector3& BNO085_SPI::getAccelerationRef() const{
     return m_currentLinearAcceleration;
 }
@@ -733,42 +974,36 @@ const Quaternion& BNO085_SPI::getOrientationRef() const{
     return m_currentOrientation;
 }
 
-//output struct methods
-void Vector3::print() const{
-    Serial.printf("<%.2f, %.2f, %.2f>", x, y, z);
-}
-
-void Vector3::println() const{
-    Serial.printf("<%.2f, %.2f, %.2f>\n", x, y, z);
+const uint32_t& BNO085_SPI::getMissedReportsRef() const{
+    return m_totalMissedReports;
 }
 
-float_t Vector3::magnitude() const{
-    return sqrt(x * x + y * y + z * z);
-}
-
-void Quaternion::print() const{
-    Serial.printf("%.2f + %.2fi + %.2fj + %.2fk", r, i, j, k);
+//debugging
+void BNO085_SPI::printInterruptStatus() const{
+    using Dispatcher = RocketOS::Utilities::InterruptDispatcher<INTERRUPT_PIN>;
+    RocketOS::Console.printf("Interrupts - %u, %u coalesced, %u missed\n", Dispatcher::getCount(), Dispatcher::getCoalesced(), Dispatcher::getMissed());
+    RocketOS::Console.printf("Last report - %uus ago\n", micros() - getLastReportTime_us());
 }
 
-void Quaternion::println() const{
-    Serial.printf("%.2f + %.2fi + %.2fj + %.2fk\n", r, i, j, k);
+void BNO085_SPI::printFreshness(const char* name, IMUData dataType) const{
+    IMUFreshness freshness = getFreshness(dataType);
+    RocketOS::Console.printf("%s - %uus old%s, latency %uus (%uus max), %u missed reports, %u stalls\n", name, freshness.age_us, (freshness.stale)? " (stale)" : "", freshness.latency_us, freshness.maxLatency_us, freshness.missedReports, freshness.stalls);
 }
 
-//debugging
 void BNO085_SPI::debugPrintRx(SHTPHeader packet, bool printBuffer){
-    Serial.printf("Rx: Packet - length: %d, channel: %d, continuation: %d\n", packet.length, packet.channel, (packet.continuation)? 1 : 0);
+    RocketOS::Console.printf("Rx: Packet - length: %d, channel: %d, continuation: %d\n", packet.length, packet.channel, (packet.continuation)? 1 : 0);
     if(printBuffer){
         for(uint_t i=0; i<min(packet.length - SHTP_HEADER_SIZE, m_rxBuffer.size()); i++)
-            Serial.printf("%d ", m_rxBuffer[i]);
-        Serial.println();
+            RocketOS::Console.printf("%d ", m_rxBuffer[i]);
+        RocketOS::Console.println();
     }
 }
 void BNO085_SPI::debugPrintTx(SHTPHeader packet, bool printBuffer){
-    Serial.printf("Tx: Packet - length: %d, channel: %d, continuation: %d\n", packet.length, packet.channel, (packet.continuation)? 1 : 0);
+    RocketOS::Console.printf("Tx: Packet - length: %d, channel: %d, continuation: %d\n", packet.length, packet.channel, (packet.continuation)? 1 : 0);
     if(printBuffer){
         for(uint_t i=0; i<min(packet.length - SHTP_HEADER_SIZE, m_txBuffer.size()); i++)
-            Serial.printf("%d ", m_txBuffer[i]);
-        Serial.println();
+            RocketOS::Console.printf("%d ", m_txBuffer[i]);
+        RocketOS::Console.println();
     }
 }
 
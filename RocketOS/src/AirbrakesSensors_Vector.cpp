@@ -0,0 +1,27 @@
+#include "airbrakes\AirbrakesSensors_Vector.h"
+#include <Arduino.h>
+
+using namespace Airbrakes;
+using namespace Sensors;
+
+//output struct methods
+void Vector3::print() const{
+    RocketOS::Console.printf("<%.2f, %.2f, %.2f>", x, y, z);
+}
+
+void Vector3::println() const{
+    RocketOS::Console.printf("<%.2f, %.2f, %.2f>\n", x, y, z);
+}
+
+float_t Vector3::magnitude() const{
+    return sqrt(x * x + y * y + z * z);
+}
+
+void Quaternion::print() const{
+    RocketOS::Console.printf("%.2f + %.2fi + %.2fj + %.2fk", r, i, j, k);
+}
+
+void Quaternion::println() const{
+    RocketOS::Console.printf("%.2f + %.2fi + %.2fj + %.2fk\n", r, i, j, k);
+}
+
@@ -3,7 +3,13 @@
 
 using namespace RocketOS;
 
-SerialInput::SerialInput(uint_t baud) : m_hasData(false),  m_baud(baud) {
+//output lanes
+static std::array<char, RocketOS_CFG_SerialTxConsoleBufferSize> s_consoleBuffer;
+static std::array<char, RocketOS_CFG_SerialTxHILBufferSize> s_HILBuffer;
+OutputLane RocketOS::Console("console", s_consoleBuffer.data(), s_consoleBuffer.size());
+OutputLane RocketOS::HILOutput("hil", s_HILBuffer.data(), s_HILBuffer.size());
+
+SerialInput::SerialInput(uint_t baud) : m_lines{}, m_front(0), m_count(0), m_length(0), m_discarding(false), m_overflows(0), m_baud(baud) {
     //nothing to do
 }
 
@@ -13,22 +19,22 @@ int_t SerialInput::size() const{
 
 char& SerialInput::operator[](int_t index){
     int_t m = (index % size() + size()) % size();
-	return m_rxBuffer[m];
+	return m_lines[m_front][m];
 }
 
 char& SerialInput::at(int_t index){
     int_t m = (index % size() + size()) % size();
-	return m_rxBuffer[m];
+	return m_lines[m_front][m];
 }
 
 char SerialInput::operator[](int_t index) const{
     int_t m = (index % size() + size()) % size();
-	return m_rxBuffer[m];
+	return m_lines[m_front][m];
 }
 
 char SerialInput::at(int_t index) const{
     int_t m = (index % size() + size()) % size();
-	return m_rxBuffer[m];
+	return m_lines[m_front][m];
 }
 
 void SerialInput::copy(char* newBuffer, int_t start, int_t stop) const{
@@ -38,7 +44,6 @@ void SerialInput::copy(char* newBuffer, int_t start, int_t stop) const{
 
 error_t SerialInput::init(){
     Serial.begin(m_baud);
-    Serial.setTimeout(10);
     while(!Serial) {
         delay(10);
     }
@@ -46,18 +51,159 @@ error_t SerialInput::init(){
 }
 
 error_t SerialInput::update(){
-    if(Serial.available()){
-        m_hasData = true;
-        Serial.readBytesUntil('\r', m_rxBuffer, c_size);
-        if(Serial.available() && Serial.peek() == '\n') Serial.read();
+    error_t error = error_t::GOOD;
+    //only read what has already arrived so this never waits on the host
+    for(int_t available = Serial.available(); available > 0 && m_count < c_depth; available--){
+        char c = static_cast<char>(Serial.read());
+        if(c == '\r' || c == '\n'){
+            if(m_discarding){
+                m_discarding = false;
+                m_length = 0;
+            }
+            else if(m_length > 0) finishLine();
+            continue;
+        }
+        if(m_discarding) continue;
+        //keep room for the null terminator
+        if(m_length >= c_size - 1){
+            m_discarding = true;
+            m_overflows++;
+            error = error_t::ERROR;
+            continue;
+        }
+        m_lines[(m_front + m_count) % c_depth][m_length++] = c;
     }
-    return error_t::GOOD;
+    return error;
 }
 
 bool SerialInput::hasData() const{
-    return m_hasData;
+    return m_count > 0;
 }
 
 void SerialInput::clear(){
-    m_hasData = false;
-}
\ No newline at end of file
+    if(m_count == 0) return;
+    m_front = (m_front + 1) % c_depth;
+    m_count--;
+}
+
+uint_t SerialInput::linesQueued() const{
+    return m_count;
+}
+
+uint_t SerialInput::getOverflows() const{
+    return m_overflows;
+}
+
+void SerialInput::finishLine(){
+    m_lines[(m_front + m_count) % c_depth][m_length] = '\0';
+    m_length = 0;
+    m_count++;
+}
+
+//OutputLane implementation
+OutputLane::OutputLane(const char* name, char* buffer, uint_t size) : m_name(name), m_buffer(buffer), m_size(size), m_head(0), m_committed(0), m_tail(0), m_lineOpen(false), m_discarding(false), m_written(0), m_dropped(0), m_peak(0) {}
+
+size_t OutputLane::write(uint8_t c){
+    if(m_discarding){
+        m_dropped++;
+        if(c == '\n') m_discarding = false;
+        return 0;
+    }
+    if(m_tail - m_head == m_size){
+        m_dropped++;
+        //nothing complete to send means one line filled the whole ring, release what fit
+        if(m_committed == m_head){
+            m_committed = m_tail;
+            return 0;
+        }
+        //otherwise drop the whole line so a later line is not joined onto its start
+        m_dropped += m_tail - m_committed;
+        m_written -= m_tail - m_committed;
+        m_tail = m_committed;
+        m_discarding = (c != '\n');
+        return 0;
+    }
+    m_buffer[m_tail & (m_size - 1)] = static_cast<char>(c);
+    m_tail++;
+    m_written++;
+    if(c == '\n') m_committed = m_tail;
+    if(m_tail - m_head > m_peak) m_peak = m_tail - m_head;
+    return 1;
+}
+
+size_t OutputLane::write(const uint8_t* data, size_t length){
+    size_t numWritten = 0;
+    for(size_t i=0; i<length; i++)
+        numWritten += write(data[i]);
+    return numWritten;
+}
+
+int OutputLane::availableForWrite(){
+    return m_size - (m_tail - m_head);
+}
+
+error_t OutputLane::writeFrame(const char* frame, uint_t length){
+    if(length > m_size - (m_tail - m_head)){
+        m_dropped += length;
+        return error_t::ERROR;
+    }
+    for(uint_t i=0; i<length; i++)
+        m_buffer[(m_tail + i) & (m_size - 1)] = frame[i];
+    m_tail += length;
+    m_committed = m_tail;
+    m_written += length;
+    if(m_tail - m_head > m_peak) m_peak = m_tail - m_head;
+    return error_t::GOOD;
+}
+
+uint_t OutputLane::ready() const{
+    return m_committed - m_head;
+}
+
+uint_t OutputLane::send(uint_t maxLength){
+    uint_t length = ready();
+    if(length > maxLength) length = maxLength;
+    if(length == 0) return 0;
+    //the ready bytes can wrap around the end of the ring
+    uint_t start = m_head & (m_size - 1);
+    uint_t first = (length < m_size - start) ? length : m_size - start;
+    Serial.write(reinterpret_cast<const uint8_t*>(m_buffer + start), first);
+    if(length > first) Serial.write(reinterpret_cast<const uint8_t*>(m_buffer), length - first);
+    m_lineOpen = m_buffer[(m_head + length - 1) & (m_size - 1)] != '\n';
+    m_head += length;
+    return length;
+}
+
+bool OutputLane::lineOpen() const{
+    return m_lineOpen;
+}
+
+const char* OutputLane::getName() const{
+    return m_name;
+}
+
+uint_t OutputLane::getSize() const{
+    return m_size;
+}
+
+uint_t OutputLane::getBuffered() const{
+    return m_tail - m_head;
+}
+
+uint32_t OutputLane::getWritten() const{
+    return m_written;
+}
+
+uint32_t OutputLane::getDropped() const{
+    return m_dropped;
+}
+
+uint32_t OutputLane::getPeak() const{
+    return m_peak;
+}
+
+void OutputLane::resetStatistics(){
+    m_written = 0;
+    m_dropped = 0;
+    m_peak = m_tail - m_head;
+}
@@ -26,23 +26,23 @@ void CommandList::printLocalCommands() const{
     for(uint_t i=0; i<m_numCommands; i++){
         //print each command except for the default command
         if(std::strcmp("", m_commands[i].name) != 0){
-            Serial.print(m_commands[i].name);
-            Serial.print(" {");
-            Serial.print(m_commands[i].args);
-            Serial.println("}");
+            Console.print(m_commands[i].name);
+            Console.print(" {");
+            Console.print(m_commands[i].args);
+            Console.println("}");
         }
     }
     for(uint_t i=0; i<m_numChildren; i++){
         //print each subcommand name
-        Serial.print(m_children[i].getName());
+        Console.print(m_children[i].getName());
         //print the arg list as would be for a command if a default command exists
         const Command* defaultCommand = m_children[i].getCommandWithName("");
         if(defaultCommand != nullptr){
-            Serial.print(" {");
-            Serial.print(defaultCommand->args);
-            Serial.print("}");
+            Console.print(" {");
+            Console.print(defaultCommand->args);
+            Console.print("}");
         }
-        Serial.println(" [...]");
+        Console.println(" [...]");
     }
 }
 
@@ -51,32 +51,32 @@ void CommandList::printAllCommands(uint_t depth) const{
     for(uint_t i=0; i<m_numCommands; i++){
         if(std::strcmp("", m_commands[i].name) != 0){
             printIndent(depth);
-            Serial.print(m_commands[i].name);
-            Serial.print(" {");
-            Serial.print(m_commands[i].args);
-            Serial.println("}");
+            Console.print(m_commands[i].name);
+            Console.print(" {");
+            Console.print(m_commands[i].args);
+            Console.println("}");
         }
     }
     //print each commandList
     for(uint_t i=0; i<m_numChildren; i++){
         printIndent(depth);
-        Serial.print(m_children[i].getName());
+        Console.print(m_children[i].getName());
         //print the arg list as would be for a command if a default command exists
         const Command* defaultCommand = m_children[i].getCommandWithName("");
         if(defaultCommand != nullptr){
-            Serial.print(" {");
-            Serial.print(defaultCommand->args);
-            Serial.print("}");
+            Console.print(" {");
+            Console.print(defaultCommand->args);
+            Console.print("}");
         }
-        Serial.println(" [");
+        Console.println(" [");
         //recursively print all commands of children
         m_children[i].printAllCommands(depth+1);
         printIndent(depth);
-        Serial.println("]");
+        Console.println("]");
     }
 }
 
 void CommandList::printIndent(uint_t num){
     for(uint_t i=0; i<num; i++)
-        Serial.print("    ");
+        Console.print("    ");
 }
\ No newline at end of file
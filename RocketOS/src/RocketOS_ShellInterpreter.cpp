@@ -33,7 +33,7 @@ error_t Interpreter::readLine() {
 	uint_t currentToken;
 	for (currentToken = 0; currentToken < m_tokens.size() && !m_tokens[currentToken].extract(currentCharacter); currentToken++);
 	if (currentToken == m_tokens.size()) { 
-		Serial.println("<[Cmd:error] Command has too many arguments for interpretation\n");
+		Console.println("<[Cmd:error] Command has too many arguments for interpretation\n");
 		return error_t::GOOD;
 	}
 	//check for wraparound
@@ -55,7 +55,7 @@ error_t Interpreter::readLine() {
 error_t Interpreter::interpretCommandList(const CommandList* list, Token* tokens, uint_t numTokens){
 	//check that commandList is valid
     if(list == nullptr){
-		Serial.printf("<[Cmd:error] Command list not found for '%s'\n", m_commandBuffer);
+		Console.printf("<[Cmd:error] Command list not found for '%s'\n", m_commandBuffer);
     	return error_t::GOOD;
 	}
 	const Command* command = nullptr;
@@ -70,8 +70,8 @@ error_t Interpreter::interpretCommandList(const CommandList* list, Token* tokens
 		}
 		else {
 			//error if no default command
-			if(tokens == m_tokens.data()) Serial.printf("<[Cmd:error] No default command exists for '%s' directory\n", m_currentCommandList->getName());
-			else Serial.printf("<[Cmd:error] Invalid number of arguments for '%s'. Expected at least one more argument\n", m_commandBuffer);
+			if(tokens == m_tokens.data()) Console.printf("<[Cmd:error] No default command exists for '%s' directory\n", m_currentCommandList->getName());
+			else Console.printf("<[Cmd:error] Invalid number of arguments for '%s'. Expected at least one more argument\n", m_commandBuffer);
 			return error_t::GOOD;
 		}
 	}
@@ -86,14 +86,14 @@ error_t Interpreter::interpretCommandList(const CommandList* list, Token* tokens
 		} 
 		else{
 			//error if no default command
-			Serial.println("<[Cmd:error] Command or Sub-Command name must be interpretable as a word\n");
+			Console.println("<[Cmd:error] Command or Sub-Command name must be interpretable as a word\n");
 			return error_t::GOOD;
 		}
 	}
 	//copy command name from first token and look for a command if no default command match found before
 	if(command == nullptr){
 		if (tokens->copyStringData(m_commandBuffer, c_commandBufferSize) == error_t::ERROR){ 
-			Serial.println("<[Cmd:error] Command name is too long for interpretation\n");
+			Console.println("<[Cmd:error] Command name is too long for interpretation\n");
 			return error_t::GOOD;
 		}
 		//check for special start commands 
@@ -104,7 +104,7 @@ error_t Interpreter::interpretCommandList(const CommandList* list, Token* tokens
 				return error_t::GOOD;
 			}
 			if(std::strcmp(m_commandBuffer, "wd") == 0){
-				Serial.println(m_currentCommandList->getName());
+				Console.println(m_currentCommandList->getName());
 				printEOC();
 				return error_t::GOOD;
 			}
@@ -144,7 +144,7 @@ error_t Interpreter::interpretCommandList(const CommandList* list, Token* tokens
 			} 
 			else{
 				//error if no command match, commandList match or default command exists
-				Serial.printf("<[Cmd:error] Command '%s' is not available in '%s' directory\n", m_commandBuffer, list->getName());
+				Console.printf("<[Cmd:error] Command '%s' is not available in '%s' directory\n", m_commandBuffer, list->getName());
 				return error_t::GOOD;
 			}
 		}
@@ -156,7 +156,7 @@ error_t Interpreter::interpretCommandList(const CommandList* list, Token* tokens
 	//found matching command case
 	//check number of args
 	if(numTokens-1 != std::strlen(command->args)){
-		Serial.printf("<[Cmd:error] Invalid number of arguments for '%s'. Expected %d, actual was %d\n", m_commandBuffer, std::strlen(command->args), numTokens-1);
+		Console.printf("<[Cmd:error] Invalid number of arguments for '%s'. Expected %d, actual was %d\n", m_commandBuffer, std::strlen(command->args), numTokens-1);
 		return error_t::GOOD;
 	}
 	//check each arg type
@@ -164,21 +164,26 @@ error_t Interpreter::interpretCommandList(const CommandList* list, Token* tokens
 	for (i = 0; i < numTokens-1; i++) {
 		TokenTypes expected = getTokenTypeFromArgCharacter(command->args[i]);
 		if (expected == TokenTypes::Invalid) {
-			Serial.printf("<[Cmd:error] Argument types specifier for '%s' contains invalid character '%c'\n", m_commandBuffer, command->args[i]);
+			Console.printf("<[Cmd:error] Argument types specifier for '%s' contains invalid character '%c'\n", m_commandBuffer, command->args[i]);
 			return error_t::GOOD;
 		}
 		if (tokens[i + 1].setInterpretation(expected) != error_t::GOOD) {
-			Serial.printf("<[Cmd:error] Invalid argument type for '%s'. Expected type '%c' for argument %d\n", m_commandBuffer, command->args[i], i+1);
+			Console.printf("<[Cmd:error] Invalid argument type for '%s'. Expected type '%c' for argument %d\n", m_commandBuffer, command->args[i], i+1);
 			return error_t::GOOD;
 		}
 	}
 	//check that callback exists
 	if (command->callback == nullptr) {
-		Serial.printf("<[Cmd:error] Implementation for '%s' not found\n", m_commandBuffer);
+		Console.printf("<[Cmd:error] Implementation for '%s' not found\n", m_commandBuffer);
 		return error_t::GOOD;
 	}
 	//call command implementation
-	command->callback(tokens+1);
+	if(command->mode == CommandModes::Atomic){
+		noInterrupts();
+		command->callback(tokens+1);
+		interrupts();
+	}
+	else command->callback(tokens+1);
 	printEOC();
 	return error_t::GOOD;
 }
@@ -216,5 +221,5 @@ TokenTypes Interpreter::getTokenTypeFromArgCharacter(char arg) {
 }
 
 void Interpreter::printEOC() {
-	Serial.println("<\n");
+	Console.println("<\n");
 }
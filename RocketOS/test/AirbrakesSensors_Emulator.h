@@ -0,0 +1,695 @@
+#pragma once
+#include "airbrakes/AirbrakesGeneral.h"
+#include "RocketOS.h"
+#include "airbrakes/AirbrakesSensors_Vector.h"
+#include "airbrakes/AirbrakesSensors_Altimeter.h"
+#include <array>
+#include <algorithm>
+#include <cmath>
+
+/*Sensor emulators
+ * Device side models of the BNO085 and MS5607 for the host tests. They attach to a MockSPIBackend as modeled devices and answer the
+ * drivers with the bytes the real parts would send, generated from a simulated flight, so BNO085_SPI and MS5607_SPI can be run,
+ * benchmarked and fuzzed without hardware. SensorRig.h wires them to the drivers.
+ *
+ * Time comes from a clock class with a now_us() member (see RocketOS_SchedulerClock.h). With a SimulatedClock a whole flight runs
+ * as fast as the drivers can parse it.
+ * setCorruption() flips random reply bits (1 in oneIn bytes) from a seeded generator, so a fuzz run is reproducible.
+ * Nothing here is interrupt safe or meant for the flight build.
+*/
+
+namespace Airbrakes{
+    namespace Sensors{
+        namespace Emulation{
+            //what the sensors would see at one instant, body frame vectors are in the frame the BNO085 reports in
+            struct FlightState{
+                float_t altitude_m;
+                float_t velocity_mps;
+                Vector3 linearAcceleration;
+                Vector3 gravity;
+                Vector3 angularVelocity;
+                Quaternion orientation;
+            };
+
+            /*Flight trajectory
+             * Drag free vertical flight: on the pad until launch, constant net acceleration during the burn, ballistic after it and
+             * back on the ground once the altitude reaches zero again.
+             * The rocket is tilted by a fixed angle about the world x axis and rolls about its own axis at a constant rate while flying.
+             * The path itself stays vertical, so the world frame acceleration is exactly vertical whatever the attitude.
+            */
+            class FlightTrajectory{
+            private:
+                static constexpr float_t c_gravity = 9.80665;
+                uint32_t m_launchTime_us;
+                float_t m_boostAcceleration;
+                float_t m_burnTime_s;
+                Quaternion m_tilt;
+                float_t m_rollRate;
+                //end of the burn
+                float_t m_burnoutAltitude_m;
+                float_t m_burnoutVelocity_mps;
+                float_t m_landingTime_s;
+            public:
+                FlightTrajectory(uint32_t launchTime_us, float_t boostAcceleration, float_t burnTime_s, float_t tilt, float_t rollRate) : m_launchTime_us(launchTime_us), m_boostAcceleration(boostAcceleration), m_burnTime_s(burnTime_s),
+                    m_tilt{std::cos(tilt / 2), std::sin(tilt / 2), 0, 0}, m_rollRate(rollRate)
+                {
+                    m_burnoutVelocity_mps = boostAcceleration * burnTime_s;
+                    m_burnoutAltitude_m = boostAcceleration * burnTime_s * burnTime_s / 2;
+                    //positive root of h + v t - g t^2 / 2 = 0
+                    float_t coast_s = (m_burnoutVelocity_mps + std::sqrt(m_burnoutVelocity_mps * m_burnoutVelocity_mps + 2 * c_gravity * m_burnoutAltitude_m)) / c_gravity;
+                    m_landingTime_s = burnTime_s + coast_s;
+                }
+
+                FlightState at(uint32_t time_us) const{
+                    float_t time_s = static_cast<int32_t>(time_us - m_launchTime_us) * 1e-6f;
+                    float_t altitude = 0, velocity = 0, acceleration = 0;
+                    bool flying = time_s > 0 && time_s < m_landingTime_s;
+                    if(flying && time_s < m_burnTime_s){
+                        acceleration = m_boostAcceleration;
+                        velocity = m_boostAcceleration * time_s;
+                        altitude = m_boostAcceleration * time_s * time_s / 2;
+                    }
+                    else if(flying){
+                        float_t coast_s = time_s - m_burnTime_s;
+                        acceleration = -c_gravity;
+                        velocity = m_burnoutVelocity_mps - c_gravity * coast_s;
+                        altitude = m_burnoutAltitude_m + m_burnoutVelocity_mps * coast_s - c_gravity * coast_s * coast_s / 2;
+                    }
+                    //roll about the body axis after the tilt
+                    float_t roll = flying? m_rollRate * time_s : 0;
+                    Quaternion orientation = VectorMath::multiply(m_tilt, Quaternion{std::cos(roll / 2), 0, 0, std::sin(roll / 2)});
+                    FlightState state;
+                    state.altitude_m = altitude;
+                    state.velocity_mps = velocity;
+                    state.linearAcceleration = VectorMath::rotateInverse(orientation, Vector3{0, 0, acceleration});
+                    state.gravity = VectorMath::rotateInverse(orientation, Vector3{0, 0, c_gravity});
+                    state.angularVelocity = Vector3{0, 0, flying? m_rollRate : 0};
+                    state.orientation = orientation;
+                    return state;
+                }
+
+                float_t getApogee_m() const{
+                    return m_burnoutAltitude_m + m_burnoutVelocity_mps * m_burnoutVelocity_mps / (2 * c_gravity);
+                }
+            };
+
+            //xorshift32, reproducible reply corruption for fuzzing
+            class Corruption{
+            private:
+                uint32_t m_state;
+                uint32_t m_oneIn;
+                uint32_t m_flipped;
+            public:
+                Corruption() : m_state(1), m_oneIn(0), m_flipped(0) {}
+
+                void set(uint32_t oneIn, uint32_t seed){
+                    m_oneIn = oneIn;
+                    m_state = (seed != 0)? seed : 1;
+                }
+
+                uint8_t apply(uint8_t byte){
+                    if(m_oneIn == 0) return byte;
+                    uint32_t random = next();
+                    if(random % m_oneIn != 0) return byte;
+                    m_flipped++;
+                    return byte ^ static_cast<uint8_t>(1u << (next() & 7));
+                }
+
+                uint32_t getFlipped() const{
+                    return m_flipped;
+                }
+            private:
+                uint32_t next(){
+                    m_state ^= m_state << 13;
+                    m_state ^= m_state >> 17;
+                    m_state ^= m_state << 5;
+                    return m_state;
+                }
+            };
+
+            /*BNO085 emulator
+             * SHTP over SPI as the hub speaks it (BNO08x data sheet, SH-2 reference manual).
+             * After reset() the hub has its reset complete and unsolicited initialize response queued. Set feature commands start and
+             * stop the linear acceleration, angular velocity, gravity and rotation vector reports and are answered with a get feature
+             * response, as are get feature requests. Other host packets are counted and ignored.
+             *
+             * update() takes the samples of the running sensors up to the clock, each one at its own time. Samples wait until the batch
+             * interval of their sensor has passed and then go out oldest first, packed into input report packets of at most t_packetSize
+             * bytes behind a base timestamp, with rebase records when the delays would no longer fit. Values are Q point encoded from the
+             * trajectory at the sample time with high accuracy status. If more than t_reports samples wait the oldest are dropped.
+             *
+             * interruptAsserted() is the H_INTN line: low while a packet waits or after wake(). The rig drives the driver's interrupt
+             * pin with it, the driver's exchange then starts from the pin interrupt like on the target.
+            */
+            template<class t_clock, std::size_t t_packetSize = 256, std::size_t t_reports = 128>
+            class BNO085Emulator{
+            private:
+                //protocol, the offsets of one report are the driver's
+                static constexpr uint_t c_headerSize = 4;
+                static constexpr uint8_t c_continuationBit = 0x80;
+                static constexpr uint8_t c_executableChannel = 1;
+                static constexpr uint8_t c_hubChannel = 2;
+                static constexpr uint8_t c_inputChannel = 3;
+                static constexpr uint_t c_numChannels = 6;
+                static constexpr uint8_t c_resetCompleteID = 0x01;
+                static constexpr uint8_t c_commandResponseID = 0xF1;
+                static constexpr uint8_t c_commandRequestID = 0xF2;
+                static constexpr uint8_t c_featureResponseID = 0xFC;
+                static constexpr uint8_t c_featureRequestID = 0xFE;
+                static constexpr uint8_t c_setFeatureID = 0xFD;
+                static constexpr uint8_t c_timebaseID = 0xFB;
+                static constexpr uint8_t c_rebaseID = 0xFA;
+                static constexpr uint8_t c_initializeCommand = 0x84;
+                static constexpr uint_t c_commandResponseLength = 16;
+                static constexpr uint_t c_featureLength = 17;
+                static constexpr uint_t c_timestampLength = 5;
+                static constexpr uint_t c_vectorLength = 10;
+                static constexpr uint_t c_orientationLength = 14;
+                static constexpr uint32_t c_timestampUnit_us = 100;
+                static constexpr uint32_t c_maximumDelay = 0x3FFF;
+                static constexpr uint8_t c_highAccuracy = 3;
+                //fastest rate the hub runs these sensors at (400Hz)
+                static constexpr uint32_t c_minimumPeriod_us = 2500;
+                static constexpr uint_t c_numSensors = 4;
+                static constexpr uint_t c_maximumPacket = c_headerSize + c_featureLength;
+
+                static_assert(t_packetSize >= c_headerSize + c_timestampLength + 2 * c_timestampLength + c_orientationLength, "BNO085Emulator packets must hold a report");
+                static_assert(t_packetSize < 0x8000, "BNO085Emulator packets must fit the SHTP length field");
+
+                struct Sensor{
+                    uint8_t reportID;
+                    uint_t qPoint;
+                    uint32_t period_us;
+                    uint32_t batch_us;
+                    uint32_t next_us;
+                    uint8_t sequence;
+                    bool running;
+                };
+
+                //numbered when sampled like the hub does, so dropped reports leave a gap in the sequence
+                struct Report{
+                    uint8_t sensor;
+                    uint8_t sequence;
+                    uint32_t time_us;
+                };
+
+                struct ControlPacket{
+                    uint8_t channel;
+                    uint8_t length;
+                    std::array<uint8_t, c_featureLength> payload;
+                };
+
+                const t_clock& m_clock;
+                const FlightTrajectory& m_trajectory;
+                std::array<Sensor, c_numSensors> m_sensors;
+                //samples waiting to be sent, oldest first
+                std::array<Report, t_reports> m_reports;
+                uint_t m_reportFront;
+                uint_t m_reportCount;
+                uint32_t m_due_us;
+                RocketOS::Utilities::Queue<ControlPacket, 9> m_controlPackets;
+                std::array<uint8_t, c_numChannels> m_sequenceNumbers;
+                bool m_wakeRequested;
+                //packet going out in the current selection
+                std::array<uint8_t, t_packetSize> m_out;
+                uint_t m_outLength;
+                uint_t m_outPosition;
+                //packet coming in from the host
+                std::array<uint8_t, c_maximumPacket> m_in;
+                uint_t m_inPosition;
+                Corruption m_corruption;
+                //statistics
+                uint32_t m_packets;
+                uint32_t m_reportsSent;
+                uint32_t m_reportsDropped;
+                uint32_t m_hostPackets;
+                uint32_t m_ignoredPackets;
+            public:
+                BNO085Emulator(const t_clock& clock, const FlightTrajectory& trajectory) : m_clock(clock), m_trajectory(trajectory), m_packets(0), m_reportsSent(0), m_reportsDropped(0), m_hostPackets(0), m_ignoredPackets(0){
+                    reset();
+                }
+
+                void reset(){
+                    m_sensors = {
+                        Sensor{0x05, 14, 0, 0, 0, 0, false},    //rotation vector
+                        Sensor{0x02, 9, 0, 0, 0, 0, false},     //calibrated gyroscope
+                        Sensor{0x04, 8, 0, 0, 0, 0, false},     //linear acceleration
+                        Sensor{0x06, 8, 0, 0, 0, 0, false}      //gravity
+                    };
+                    m_reportFront = 0;
+                    m_reportCount = 0;
+                    m_controlPackets.clear();
+                    m_sequenceNumbers.fill(0);
+                    m_wakeRequested = false;
+                    m_outLength = 0;
+                    m_outPosition = 0;
+                    m_inPosition = 0;
+                    //reset complete, then the unsolicited initialize response with status 0 for the hub subsystem
+                    ControlPacket resetComplete{c_executableChannel, 1, {}};
+                    resetComplete.payload[0] = c_resetCompleteID;
+                    m_controlPackets.push(resetComplete);
+                    ControlPacket initialize{c_hubChannel, c_commandResponseLength, {}};
+                    initialize.payload[0] = c_commandResponseID;
+                    initialize.payload[2] = c_initializeCommand;
+                    initialize.payload[6] = 1;
+                    m_controlPackets.push(initialize);
+                }
+
+                //the driver pulls P0 low to get a chance to send, the rig forwards it here
+                void wake(){
+                    m_wakeRequested = true;
+                }
+
+                void setCorruption(uint32_t oneIn, uint32_t seed){
+                    m_corruption.set(oneIn, seed);
+                }
+
+                //takes the samples due up to now, in time order across the sensors
+                void update(){
+                    uint32_t now = m_clock.now_us();
+                    while(true){
+                        Sensor* next = nullptr;
+                        for(Sensor& sensor : m_sensors)
+                            if(sensor.running && static_cast<int32_t>(now - sensor.next_us) >= 0 && (next == nullptr || static_cast<int32_t>(sensor.next_us - next->next_us) < 0)) next = &sensor;
+                        if(next == nullptr) return;
+                        pushReport(Report{static_cast<uint8_t>(next - m_sensors.data()), next->sequence++, next->next_us});
+                        next->next_us += next->period_us;
+                    }
+                }
+
+                bool interruptAsserted(){
+                    update();
+                    if(m_wakeRequested || m_controlPackets.size() > 0) return true;
+                    return m_reportCount > 0 && static_cast<int32_t>(m_clock.now_us() - m_due_us) >= 0;
+                }
+
+                RocketOS::Utilities::spiDevice_t device(){
+                    return [this](const uint8_t* tx, uint8_t* rx, uint16_t length, bool first){this->exchange(tx, rx, length, first);};
+                }
+
+                // --- inspection ---
+                uint32_t getSamplePeriod_us(uint_t sensor) const{
+                    return m_sensors[sensor].running? m_sensors[sensor].period_us : 0;
+                }
+
+                uint_t getPendingReports() const{
+                    return m_reportCount;
+                }
+
+                uint32_t getPackets() const{
+                    return m_packets;
+                }
+
+                uint32_t getReportsSent() const{
+                    return m_reportsSent;
+                }
+
+                uint32_t getReportsDropped() const{
+                    return m_reportsDropped;
+                }
+
+                uint32_t getHostPackets() const{
+                    return m_hostPackets;
+                }
+
+                //host packets that were malformed or not understood
+                uint32_t getIgnoredPackets() const{
+                    return m_ignoredPackets;
+                }
+
+                uint32_t getCorruptedBytes() const{
+                    return m_corruption.getFlipped();
+                }
+
+            private:
+                void exchange(const uint8_t* tx, uint8_t* rx, uint16_t length, bool first){
+                    if(first) beginSelection();
+                    for(uint_t i=0; i<length; i++){
+                        uint8_t out = (m_outPosition < m_outLength)? m_out[m_outPosition] : 0;
+                        m_outPosition++;
+                        rx[i] = m_corruption.apply(out);
+                        receive((tx != nullptr)? tx[i] : 0xFF);
+                    }
+                }
+
+                void beginSelection(){
+                    //the host sends and receives in the same selection, so both directions start over
+                    m_inPosition = 0;
+                    m_outPosition = 0;
+                    m_outLength = 0;
+                    m_wakeRequested = false;
+                    update();
+                    result_t<ControlPacket> control = m_controlPackets.pop();
+                    if(control.error == error_t::GOOD){
+                        std::copy(control.data.payload.begin(), control.data.payload.begin() + control.data.length, m_out.begin() + c_headerSize);
+                        writeHeader(control.data.channel, control.data.length);
+                        return;
+                    }
+                    if(m_reportCount > 0 && static_cast<int32_t>(m_clock.now_us() - m_due_us) >= 0) buildInputPacket();
+                }
+
+                void writeHeader(uint8_t channel, uint_t payloadLength){
+                    uint_t length = payloadLength + c_headerSize;
+                    m_out[0] = static_cast<uint8_t>(length);
+                    m_out[1] = static_cast<uint8_t>(length >> 8) & ~c_continuationBit;
+                    m_out[2] = channel;
+                    m_out[3] = m_sequenceNumbers[channel]++;
+                    m_outLength = length;
+                    m_packets++;
+                }
+
+                void buildInputPacket(){
+                    uint32_t now = m_clock.now_us();
+                    //the base is rounded back to a whole timestamp unit before the oldest sample, so every delay is positive
+                    uint32_t oldest = m_reports[m_reportFront].time_us;
+                    uint32_t delta = (now - oldest + c_timestampUnit_us - 1) / c_timestampUnit_us;
+                    uint32_t base = now - delta * c_timestampUnit_us;
+                    uint_t length = c_headerSize;
+                    length = writeTimestamp(length, c_timebaseID, delta);
+                    while(m_reportCount > 0){
+                        const Report& report = m_reports[m_reportFront];
+                        uint_t reportLength = (report.sensor == 0)? c_orientationLength : c_vectorLength;
+                        uint32_t delay = (report.time_us - base + c_timestampUnit_us / 2) / c_timestampUnit_us;
+                        bool rebase = delay > c_maximumDelay;
+                        if(length + reportLength + (rebase? c_timestampLength : 0) > t_packetSize) break;
+                        if(rebase){
+                            length = writeTimestamp(length, c_rebaseID, delay);
+                            base += delay * c_timestampUnit_us;
+                            delay = 0;
+                        }
+                        length = writeReport(length, report, delay);
+                        m_reportFront = (m_reportFront + 1) % t_reports;
+                        m_reportCount--;
+                        m_reportsSent++;
+                    }
+                    writeHeader(c_inputChannel, length - c_headerSize);
+                    //what is left is sent in the next selection
+                    if(m_reportCount > 0) m_due_us = now;
+                }
+
+                uint_t writeTimestamp(uint_t offset, uint8_t reportID, uint32_t delta){
+                    m_out[offset] = reportID;
+                    for(uint_t i=0; i<4; i++)
+                        m_out[offset + 1 + i] = static_cast<uint8_t>(delta >> (8 * i));
+                    return offset + c_timestampLength;
+                }
+
+                uint_t writeReport(uint_t offset, const Report& report, uint32_t delay){
+                    Sensor& sensor = m_sensors[report.sensor];
+                    FlightState state = m_trajectory.at(report.time_us);
+                    m_out[offset] = sensor.reportID;
+                    m_out[offset + 1] = report.sequence;
+                    m_out[offset + 2] = static_cast<uint8_t>(c_highAccuracy | ((delay >> 8) << 2));
+                    m_out[offset + 3] = static_cast<uint8_t>(delay);
+                    if(report.sensor == 0){
+                        const Quaternion& q = state.orientation;
+                        writeFixed(offset + 4, q.i, sensor.qPoint);
+                        writeFixed(offset + 6, q.j, sensor.qPoint);
+                        writeFixed(offset + 8, q.k, sensor.qPoint);
+                        writeFixed(offset + 10, q.r, sensor.qPoint);
+                        //accuracy estimate, Q12 radians
+                        writeFixed(offset + 12, 0.01f, 12);
+                        return offset + c_orientationLength;
+                    }
+                    const Vector3& v = (report.sensor == 1)? state.angularVelocity : (report.sensor == 2)? state.linearAcceleration : state.gravity;
+                    writeFixed(offset + 4, v.x, sensor.qPoint);
+                    writeFixed(offset + 6, v.y, sensor.qPoint);
+                    writeFixed(offset + 8, v.z, sensor.qPoint);
+                    return offset + c_vectorLength;
+                }
+
+                void writeFixed(uint_t offset, float_t value, uint_t qPoint){
+                    float_t scaled = std::round(value * static_cast<float_t>(1u << qPoint));
+                    if(scaled > INT16_MAX) scaled = INT16_MAX;
+                    if(scaled < INT16_MIN) scaled = INT16_MIN;
+                    uint16_t fixed = static_cast<uint16_t>(static_cast<int16_t>(scaled));
+                    m_out[offset] = static_cast<uint8_t>(fixed);
+                    m_out[offset + 1] = static_cast<uint8_t>(fixed >> 8);
+                }
+
+                void pushReport(const Report& report){
+                    if(m_reportCount == t_reports){
+                        m_reportFront = (m_reportFront + 1) % t_reports;
+                        m_reportCount--;
+                        m_reportsDropped++;
+                    }
+                    uint32_t due = report.time_us + m_sensors[report.sensor].batch_us;
+                    if(m_reportCount == 0 || static_cast<int32_t>(due - m_due_us) < 0) m_due_us = due;
+                    m_reports[(m_reportFront + m_reportCount) % t_reports] = report;
+                    m_reportCount++;
+                }
+
+                void receive(uint8_t byte){
+                    if(m_inPosition < m_in.size()) m_in[m_inPosition] = byte;
+                    m_inPosition++;
+                    if(m_inPosition < c_headerSize) return;
+                    uint_t length = static_cast<uint_t>(m_in[0]) | (static_cast<uint_t>(m_in[1] & ~c_continuationBit) << 8);
+                    //an idle host clocks out 0xFF, which reads as a continuation and is never a command
+                    if(m_inPosition == c_headerSize && (m_in[1] & c_continuationBit)) return;
+                    if(m_inPosition != length || (m_in[1] & c_continuationBit)) return;
+                    m_hostPackets++;
+                    if(length <= c_headerSize || length > m_in.size() || m_in[2] != c_hubChannel){
+                        m_ignoredPackets++;
+                        return;
+                    }
+                    respond(&m_in[c_headerSize], length - c_headerSize);
+                }
+
+                void respond(const uint8_t* payload, uint_t length){
+                    uint8_t reportID = payload[0];
+                    if(reportID == c_setFeatureID && length >= c_featureLength){
+                        Sensor* sensor = findSensor(payload[1]);
+                        if(sensor == nullptr){
+                            m_ignoredPackets++;
+                            return;
+                        }
+                        uint32_t period = readUnsigned(payload + 5);
+                        sensor->batch_us = readUnsigned(payload + 9);
+                        sensor->running = period != 0;
+                        sensor->period_us = (period == 0 || period >= c_minimumPeriod_us)? period : c_minimumPeriod_us;
+                        sensor->next_us = m_clock.now_us() + sensor->period_us;
+                        //the hub confirms every set feature with the rate it actually runs at
+                        queueFeatureResponse(*sensor);
+                        return;
+                    }
+                    if(reportID == c_featureRequestID && length >= 2){
+                        Sensor* sensor = findSensor(payload[1]);
+                        if(sensor != nullptr) queueFeatureResponse(*sensor);
+                        else m_ignoredPackets++;
+                        return;
+                    }
+                    //tare and the other commands need no answer
+                    if(reportID != c_commandRequestID) m_ignoredPackets++;
+                }
+
+                void queueFeatureResponse(const Sensor& sensor){
+                    ControlPacket response{c_hubChannel, c_featureLength, {}};
+                    response.payload[0] = c_featureResponseID;
+                    response.payload[1] = sensor.reportID;
+                    uint32_t period = sensor.running? sensor.period_us : 0;
+                    for(uint_t i=0; i<4; i++){
+                        response.payload[5 + i] = static_cast<uint8_t>(period >> (8 * i));
+                        response.payload[9 + i] = static_cast<uint8_t>(sensor.batch_us >> (8 * i));
+                    }
+                    if(m_controlPackets.push(response) != error_t::GOOD) m_ignoredPackets++;
+                }
+
+                Sensor* findSensor(uint8_t reportID){
+                    for(Sensor& sensor : m_sensors)
+                        if(sensor.reportID == reportID) return &sensor;
+                    return nullptr;
+                }
+
+                static uint32_t readUnsigned(const uint8_t* bytes){
+                    return static_cast<uint32_t>(bytes[0]) | static_cast<uint32_t>(bytes[1]) << 8 | static_cast<uint32_t>(bytes[2]) << 16 | static_cast<uint32_t>(bytes[3]) << 24;
+                }
+            };
+
+            /*MS5607 emulator
+             * The SPI command set of the MS5607 data sheet: reset, PROM read, D1 and D2 conversions at every oversampling ratio and
+             * ADC read. The PROM holds the data sheet's example coefficients with a valid CRC4 in word 7 (AN520).
+             *
+             * A conversion samples the trajectory in the middle of its typical conversion time, where the driver stamps it, and
+             * inverts the driver's own compensation for the ADC code, so a compensated reading gives back the standard atmosphere
+             * pressure and temperature at that altitude to the pascal and hundredth of a degree.
+             * Reading the ADC before the conversion has finished, or a second time, gives 0 like the real part.
+            */
+            template<class t_clock>
+            class MS5607Emulator{
+            private:
+                static constexpr uint8_t c_resetCommand = 0x1E;
+                static constexpr uint8_t c_PROMBase = 0xA0;
+                static constexpr uint8_t c_pressureBase = 0x40;
+                static constexpr uint8_t c_temperatureBase = 0x50;
+                static constexpr uint8_t c_ADCRead = 0x00;
+                static constexpr uint_t c_numCoefficients = MS5607_SPI::c_numCalibrationCoefficients;
+                using Atmosphere = RocketOS::Processing::StandardAtmosphere<>;
+
+                const t_clock& m_clock;
+                const FlightTrajectory& m_trajectory;
+                float_t m_groundPressure_pa;
+                float_t m_groundTemperature_k;
+                std::array<uint16_t, c_numCoefficients> m_PROM;
+                //conversion in progress or finished, 0 once read
+                uint32_t m_result;
+                uint32_t m_conversionEnd_us;
+                bool m_converting;
+                //reply of the current selection
+                std::array<uint8_t, 3> m_reply;
+                uint_t m_replyLength;
+                uint_t m_position;
+                Corruption m_corruption;
+                //statistics
+                uint32_t m_conversions;
+                uint32_t m_reads;
+                uint32_t m_earlyReads;
+                uint32_t m_unknownCommands;
+            public:
+                MS5607Emulator(const t_clock& clock, const FlightTrajectory& trajectory, float_t groundPressure_pa, float_t groundTemperature_k) : m_clock(clock), m_trajectory(trajectory), m_groundPressure_pa(groundPressure_pa), m_groundTemperature_k(groundTemperature_k),
+                    m_PROM{0x4B21, 46372, 43981, 29059, 27842, 31553, 28165, 0x5A00}, m_result(0), m_conversionEnd_us(0), m_converting(false), m_replyLength(0), m_position(0), m_conversions(0), m_reads(0), m_earlyReads(0), m_unknownCommands(0)
+                {
+                    m_PROM[7] |= crc4(m_PROM);
+                }
+
+                void setCorruption(uint32_t oneIn, uint32_t seed){
+                    m_corruption.set(oneIn, seed);
+                }
+
+                RocketOS::Utilities::spiDevice_t device(){
+                    return [this](const uint8_t* tx, uint8_t* rx, uint16_t length, bool first){this->exchange(tx, rx, length, first);};
+                }
+
+                const std::array<uint16_t, c_numCoefficients>& getPROM() const{
+                    return m_PROM;
+                }
+
+                //pressure and temperature the emulator encodes at an altitude
+                float_t pressure_pa(float_t altitude_m) const{
+                    float_t ratio = 1 - static_cast<float_t>(Atmosphere::c_lapseRate) * altitude_m / m_groundTemperature_k;
+                    return m_groundPressure_pa * std::pow(ratio, static_cast<float_t>(Atmosphere::c_gravity * Atmosphere::c_molarMass / (Atmosphere::c_gasConstant * Atmosphere::c_lapseRate)));
+                }
+
+                float_t temperature_k(float_t altitude_m) const{
+                    return m_groundTemperature_k - static_cast<float_t>(Atmosphere::c_lapseRate) * altitude_m;
+                }
+
+                uint32_t getConversions() const{
+                    return m_conversions;
+                }
+
+                uint32_t getReads() const{
+                    return m_reads;
+                }
+
+                //ADC reads that got 0 because no finished conversion was waiting
+                uint32_t getEarlyReads() const{
+                    return m_earlyReads;
+                }
+
+                uint32_t getUnknownCommands() const{
+                    return m_unknownCommands;
+                }
+
+                uint32_t getCorruptedBytes() const{
+                    return m_corruption.getFlipped();
+                }
+
+            private:
+                void exchange(const uint8_t* tx, uint8_t* rx, uint16_t length, bool first){
+                    for(uint_t i=0; i<length; i++){
+                        uint8_t out = 0xFF;
+                        //the first byte of a selection is the command, the reply follows it
+                        if(first && i == 0){
+                            out = 0x00;
+                            command((tx != nullptr)? tx[0] : 0xFF);
+                        }
+                        else if(m_position < m_replyLength) out = m_reply[m_position++];
+                        rx[i] = m_corruption.apply(out);
+                    }
+                }
+
+                void command(uint8_t command){
+                    m_replyLength = 0;
+                    m_position = 0;
+                    uint32_t now = m_clock.now_us();
+                    if(command == c_resetCommand){
+                        m_converting = false;
+                        m_result = 0;
+                        return;
+                    }
+                    if((command & 0xF0) == c_PROMBase && (command & 0x01) == 0){
+                        uint16_t coefficient = m_PROM[(command & 0x0E) >> 1];
+                        m_reply[0] = static_cast<uint8_t>(coefficient >> 8);
+                        m_reply[1] = static_cast<uint8_t>(coefficient);
+                        m_replyLength = 2;
+                        return;
+                    }
+                    if(command == c_ADCRead){
+                        m_reads++;
+                        uint32_t result = 0;
+                        if(m_converting && static_cast<int32_t>(now - m_conversionEnd_us) >= 0) result = m_result;
+                        if(result == 0) m_earlyReads++;
+                        m_converting = false;
+                        m_result = 0;
+                        m_reply[0] = static_cast<uint8_t>(result >> 16);
+                        m_reply[1] = static_cast<uint8_t>(result >> 8);
+                        m_reply[2] = static_cast<uint8_t>(result);
+                        m_replyLength = 3;
+                        return;
+                    }
+                    bool pressure = (command & 0xF0) == c_pressureBase;
+                    uint_t ratio = command & 0x0F;
+                    if((pressure || (command & 0xF0) == c_temperatureBase) && (ratio & 0x01) == 0 && ratio <= 8){
+                        //typical conversion times at OSR 256 to 4096
+                        static constexpr std::array<uint32_t, 5> c_conversionTimes_us{540, 1060, 2080, 4130, 8220};
+                        uint32_t duration = c_conversionTimes_us[ratio >> 1];
+                        FlightState state = m_trajectory.at(now + duration / 2);
+                        m_result = pressure? pressureADC(state.altitude_m) : temperatureADC(state.altitude_m);
+                        m_conversionEnd_us = now + duration;
+                        m_converting = true;
+                        m_conversions++;
+                        return;
+                    }
+                    m_unknownCommands++;
+                }
+
+                //D2 giving the temperature at the altitude, temperature only depends on D2
+                uint32_t temperatureADC(float_t altitude_m) const{
+                    int32_t target = static_cast<int32_t>(std::lround((temperature_k(altitude_m) - 273.15f) * 100));
+                    return search([&](uint32_t code){return MS5607_SPI::compensate(m_PROM, 0, code).temperature_cC >= target;});
+                }
+
+                //D1 giving the pressure at the altitude together with the D2 of the same altitude
+                uint32_t pressureADC(float_t altitude_m) const{
+                    int32_t target = static_cast<int32_t>(std::lround(pressure_pa(altitude_m)));
+                    uint32_t D2 = temperatureADC(altitude_m);
+                    return search([&](uint32_t code){return MS5607_SPI::compensate(m_PROM, code, D2).pressure_pa >= target;});
+                }
+
+                //smallest 24 bit code the predicate holds for, the compensation rises with both codes
+                template<class t_predicate>
+                static uint32_t search(const t_predicate& reached){
+                    uint32_t low = 1, high = 0xFFFFFE;
+                    while(low < high){
+                        uint32_t middle = low + (high - low) / 2;
+                        if(reached(middle)) high = middle;
+                        else low = middle + 1;
+                    }
+                    return low;
+                }
+
+                //AN520, over the PROM with the low byte of word 7 cleared
+                static uint16_t crc4(std::array<uint16_t, c_numCoefficients> PROM){
+                    uint16_t remainder = 0;
+                    PROM[7] &= 0xFF00;
+                    for(uint_t i=0; i<2 * c_numCoefficients; i++){
+                        remainder ^= (i % 2 == 1)? (PROM[i >> 1] & 0x00FF) : (PROM[i >> 1] >> 8);
+                        for(uint_t bit=0; bit<8; bit++)
+                            remainder = (remainder & 0x8000)? (remainder << 1) ^ 0x3000 : (remainder << 1);
+                    }
+                    return (remainder >> 12) & 0x000F;
+                }
+            };
+        }
+    }
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include "HostTest.h"
+#include "airbrakes/AirbrakesApplication.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+/*Application rig
+ * The whole Airbrakes application as main.cpp runs it, on the host simulation. No sensors are attached, so their initialization
+ * fails the way it does on a bench without them, and there is no SD card unless the test sets one.
+ * command() types a command into the shell, with the '>' the interpreter expects, and returns what the application printed while it ran.
+*/
+
+namespace HostTest{
+    class ApplicationRig{
+    private:
+        std::vector<char> m_telemetryBuffer;
+        std::vector<char> m_logBuffer;
+        std::vector<float> m_flightPlanMemory;
+    public:
+        std::unique_ptr<Airbrakes::Application> app;
+
+        ApplicationRig() : m_telemetryBuffer(Airbrakes_CFG_TelemetryBufferSize), m_logBuffer(Airbrakes_CFG_LogBufferSize), m_flightPlanMemory(Airbrakes_CFG_FlightPlanMemorySize){
+            app.reset(new Airbrakes::Application(m_telemetryBuffer.data(), m_telemetryBuffer.size(), m_logBuffer.data(), m_logBuffer.size(), m_flightPlanMemory.data(), m_flightPlanMemory.size()));
+            app->initialize();
+        }
+
+        ~ApplicationRig(){
+            app.reset();
+            Host::reset();
+        }
+
+        ApplicationRig(const ApplicationRig&) = delete;
+        ApplicationRig& operator=(const ApplicationRig&) = delete;
+
+        //runs the main loop for the given time, one pass per loop period
+        void run(uint32_t time_us, uint32_t loop_us = 1000){
+            for(uint32_t elapsed = 0; elapsed < time_us; elapsed += loop_us){
+                Host::advance(loop_us);
+                app->updateBackground();
+            }
+        }
+
+        std::string command(const std::string& line){
+            Host::takeSerialOutput();
+            Host::serialInput(">" + line + "\n");
+            run(100000);
+            return Host::takeSerialOutput();
+        }
+    };
+}
@@ -0,0 +1,55 @@
+#include "HostTest.h"
+#include "ApplicationRig.h"
+#include <sstream>
+
+namespace{
+    using RocketOS::error_t;
+    using RocketOS::uint_t;
+    using HostTest::ApplicationRig;
+
+    //period of a task in the scheduler command's table, 0 if it is not listed
+    uint32_t taskPeriod(const std::string& table, const std::string& name){
+        std::istringstream lines(table);
+        std::string line;
+        while(std::getline(lines, line)){
+            std::istringstream fields(line);
+            std::string task;
+            uint32_t period = 0;
+            if(fields >> task >> period && task == name) return period;
+        }
+        return 0;
+    }
+
+    HOST_TEST(Application, SerialTaskFollowsTheRefreshPeriod){
+        ApplicationRig rig;
+        CHECK(taskPeriod(rig.command("scheduler"), "serial") == Airbrakes_CFG_HILRefresh_ms * 1000);
+        rig.command("sim refresh set 25");
+        CHECK(taskPeriod(rig.command("scheduler"), "serial") == 25000);
+    }
+
+    HOST_TEST(Application, PersistentRestoreResyncsTheSerialTask){
+        ApplicationRig rig;
+        rig.command("sim refresh set 40");
+        rig.command("persistent save");
+        rig.command("sim refresh set 25");
+        rig.command("persistent restore");
+        CHECK(rig.command("sim refresh").find("40ms") != std::string::npos);
+        CHECK(taskPeriod(rig.command("scheduler"), "serial") == 40000);
+        rig.command("persistent restore defaults");
+        CHECK(taskPeriod(rig.command("scheduler"), "serial") == Airbrakes_CFG_HILRefresh_ms * 1000);
+    }
+
+    HOST_TEST(Application, TopicsListTheObserverAndController){
+        ApplicationRig rig;
+        std::string topics = rig.command("bus");
+        CHECK(topics.find("observer") != std::string::npos);
+        CHECK(topics.find("controller") != std::string::npos);
+    }
+
+    HOST_TEST(Application, ShellReadsTheTopicsThroughItsOwnSubscribers){
+        ApplicationRig rig;
+        std::string snapshot = rig.command("snapshot");
+        CHECK(snapshot.find("observer: altitude") != std::string::npos);
+        CHECK(snapshot.find("controller: error") != std::string::npos);
+    }
+}
@@ -0,0 +1,102 @@
+#include "HostTest.h"
+#include "processing/RocketOS_ProcessingAtmosphere.h"
+#include <vector>
+
+namespace{
+    using Atmosphere = RocketOS::Processing::StandardAtmosphere<>;
+    constexpr double c_lapseRate = Atmosphere::c_lapseRate;
+    constexpr double c_densityExponent = Atmosphere::c_gravity * Atmosphere::c_molarMass / (Atmosphere::c_gasConstant * c_lapseRate) - 1;
+    constexpr double c_altitudeExponent = -Atmosphere::c_gasConstant * c_lapseRate / (Atmosphere::c_gravity * Atmosphere::c_molarMass);
+
+    //closed form ISA in double precision, the reference for the tables
+    double density(double altitude, double groundPressure, double groundTemperature){
+        return groundPressure * Atmosphere::c_molarMass / (Atmosphere::c_gasConstant * groundTemperature) * std::pow(1 - c_lapseRate * altitude / groundTemperature, c_densityExponent);
+    }
+
+    double altitude(double pressure, double groundPressure, double groundTemperature){
+        return groundTemperature / c_lapseRate * (std::pow(pressure / groundPressure, c_altitudeExponent) - 1);
+    }
+
+    //ground conditions from a cold high field to a hot day at sea level
+    const double c_groundTemperatures[] = {253.15, 288.15, 318.15};
+    const double c_groundPressures[] = {80000, 101325, 104000};
+
+    HOST_TEST(Atmosphere, DensityMatchesTheClosedForm){
+        Atmosphere atmosphere;
+        double worst = 0;
+        for(double temperature : c_groundTemperatures){
+            for(double pressure : c_groundPressures){
+                //the table covers L*h/T0 from -0.05 to 0.3
+                for(double x = -0.05; x <= 0.3; x += 3.7e-6){
+                    double height = x * temperature / c_lapseRate;
+                    double expected = density(height, pressure, temperature);
+                    worst = std::fmax(worst, std::fabs(atmosphere.density(height, pressure, temperature) / expected - 1));
+                }
+            }
+        }
+        HOST_REPORT("density %.3g relative", worst);
+        CHECK(worst < 2e-6);
+    }
+
+    HOST_TEST(Atmosphere, AltitudeMatchesTheClosedForm){
+        Atmosphere atmosphere;
+        double worst = 0;
+        double worstBelow1km = 0;
+        for(double temperature : c_groundTemperatures){
+            for(double pressure : c_groundPressures){
+                double scaled = 0;
+                //the table covers p/p0 from 0.2 to 1.2
+                for(double ratio = 0.2; ratio <= 1.2; ratio += 1.3e-6){
+                    double expected = altitude(ratio * pressure, pressure, temperature);
+                    double error = std::fabs(atmosphere.altitude(ratio * pressure, pressure, temperature) - expected);
+                    scaled = std::fmax(scaled, error / (temperature / c_lapseRate));
+                    if(std::fabs(expected) < 1000) worstBelow1km = std::fmax(worstBelow1km, error);
+                    worst = std::fmax(worst, error);
+                }
+                CHECK(scaled < 4e-6);
+            }
+        }
+        HOST_REPORT("altitude %.3gm, %.3gm below 1km", worst, worstBelow1km);
+        CHECK(worst < 0.2 && worstBelow1km < 0.01);
+    }
+
+    HOST_TEST(Atmosphere, OutsideTheTablesFallsBackToTheClosedForm){
+        Atmosphere atmosphere;
+        for(double height : {-3000.0, 15000.0, 20000.0}){
+            CHECK_NEAR(atmosphere.density(height, 101325, 288.15) / density(height, 101325, 288.15), 1, 1e-6);
+        }
+        for(double ratio : {0.1, 0.15, 1.25, 1.4}){
+            CHECK_NEAR(atmosphere.altitude(ratio * 101325, 101325, 288.15), altitude(ratio * 101325, 101325, 288.15), 0.01);
+        }
+        //the ground is zero and the density there is the ideal gas one
+        CHECK_NEAR(atmosphere.altitude(101325, 101325, 288.15), 0, 0.01);
+        CHECK_NEAR(atmosphere.density(0, 101325, 288.15), 101325 * Atmosphere::c_molarMass / (Atmosphere::c_gasConstant * 288.15), 1e-5);
+    }
+
+    HOST_TEST(Atmosphere, Benchmark){
+        Atmosphere atmosphere;
+        std::vector<float> heights, pressures;
+        for(int i=0; i<4096; i++){
+            heights.push_back(-500.0f + 12000.0f * i / 4096);
+            pressures.push_back(25000.0f + 95000.0f * i / 4096);
+        }
+        volatile float sink = 0;
+        auto run = [&sink](const std::vector<float>& inputs, auto function){
+            double time = HostTest::time_s([&](){
+                float sum = 0;
+                for(float x : inputs) sum += function(x);
+                sink = sink + sum;
+            }, 200);
+            return time * 1e9 / inputs.size();
+        };
+        double tableDensity = run(heights, [&atmosphere](float h){ return atmosphere.density(h, 101325.0f, 288.15f); });
+        double powDensity = run(heights, [](float h){ return Atmosphere::exactDensity(h, 101325.0f, 288.15f); });
+        double powfDensity = run(heights, [](float h){ return 101325.0f * 0.0289652f / (8.31446f * 288.15f) * std::pow(1 - 0.0065f * h / 288.15f, static_cast<float>(c_densityExponent)); });
+        double tableAltitude = run(pressures, [&atmosphere](float p){ return atmosphere.altitude(p, 101325.0f, 288.15f); });
+        double powAltitude = run(pressures, [](float p){ return Atmosphere::exactAltitude(p, 101325.0f, 288.15f); });
+        double powfAltitude = run(pressures, [](float p){ return 288.15f / 0.0065f * (std::pow(p / 101325.0f, static_cast<float>(c_altitudeExponent)) - 1); });
+        HOST_REPORT("density: table %.2f ns, pow %.2f ns, powf %.2f ns", tableDensity, powDensity, powfDensity);
+        HOST_REPORT("altitude: table %.2f ns, pow %.2f ns, powf %.2f ns", tableAltitude, powAltitude, powfAltitude);
+        CHECK(tableDensity > 0 && tableAltitude > 0);
+    }
+}
@@ -0,0 +1,75 @@
+#include "HostTest.h"
+#include "SensorRig.h"
+#include "FlightPlanFile.h"
+#include "airbrakes/AirbrakesController.h"
+#include <memory>
+#include <vector>
+
+namespace{
+    using namespace Airbrakes;
+    using namespace Airbrakes::Controls;
+    using RocketOS::error_t;
+    using RocketOS::uint_t;
+
+    //the controller with a loaded plan and an observer state set the way HIL sets it, ticked directly instead of from its timer
+    struct ControllerRig{
+        HostTest::SensorRig sensors;
+        HostTest::FlightPlanFile file;
+        SdFat sd;
+        std::vector<float> memory;
+        FlightPlan plan;
+        Observer observer;
+        Motor::Actuator motor;
+        RocketOS::Processing::StandardAtmosphere<> atmosphere;
+        Controller controller;
+        ControllerSubscriber_t outputs;
+
+        ControllerRig() : file("plan.txt", 1500), memory(Airbrakes_CFG_FlightPlanMemorySize), plan("plan", sd, memory.data(), memory.size(), "plan.txt"),
+            observer(sensors.imu, sensors.altimeter), motor("motor"),
+            controller("controller", Airbrakes_CFG_ControllerPeriod_us, plan, observer, motor, atmosphere, Airbrakes_CFG_DecayRate),
+            outputs(controller.getOutputTopic()){
+            plan.loadFromFile();
+        }
+
+        void setState(float_t altitude, float_t verticalVelocity, float_t angle){
+            observer.getPredictedAltitudeRef() = altitude;
+            observer.getPredictedVerticalVelocityRef() = verticalVelocity;
+            observer.getPredictedAngleRef() = angle;
+            observer.publishState();
+        }
+
+        ControllerOutput tick(){
+            controller.clock();
+            return *outputs.latest();
+        }
+    };
+
+    HOST_TEST(Controller, ApogeeModeReusesTheExtremePredictions){
+        std::unique_ptr<ControllerRig> rig(new ControllerRig);
+        CHECK(rig->plan.isLoaded());
+        rig->setState(800, 150, 1.4f);
+        ControllerOutput flightPath = rig->tick();
+        rig->controller.getModeRef() = ControlModes::ApogeePrediction;
+        ControllerOutput apogee = rig->tick();
+        //the brakes are retracted, the prediction for the current deployment is the one for the smallest drag area
+        CHECK(!flightPath.fault && !apogee.fault);
+        CHECK_NEAR(apogee.predictedApogee, flightPath.predictedApogee, 1e-3);
+        CHECK(flightPath.predictedApogee > 800 && flightPath.predictedApogee < 800 + 150 * 150 / (2 * 9.80665));
+        //the error follows the prediction, the rule asks for a drag area the actuators can reach
+        CHECK_NEAR(apogee.error, apogee.predictedApogee - 1500, 1e-3);
+        CHECK(apogee.requestedDragArea >= rig->plan.getMinDragArea().data && apogee.requestedDragArea <= rig->plan.getMaxDragArea().data);
+    }
+
+    HOST_TEST(Controller, Budget){
+        std::unique_ptr<ControllerRig> rig(new ControllerRig);
+        rig->setState(800, 150, 1.4f);
+        constexpr uint32_t c_ticks = 2000;
+        double flightPath = HostTest::time_s([&rig](){ rig->controller.clock(); }, c_ticks);
+        rig->controller.getModeRef() = ControlModes::ApogeePrediction;
+        double apogee = HostTest::time_s([&rig](){ rig->controller.clock(); }, c_ticks);
+        HOST_REPORT("tick: %.2f us in flight path mode (one apogee prediction), %.2f us in apogee mode (two), budget %d us",
+            flightPath * 1e6, apogee * 1e6, Airbrakes_CFG_ControllerBudget_us);
+        //host time, the budget itself is checked on the Teensy by "controller timing"
+        CHECK(flightPath * 1e6 < Airbrakes_CFG_ControllerBudget_us && apogee * 1e6 < Airbrakes_CFG_ControllerBudget_us);
+    }
+}
@@ -0,0 +1,126 @@
+#include "HostTest.h"
+#include "utilities/RocketOS_UtilitiesDeferredWork.h"
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace{
+    using namespace RocketOS::Utilities;
+    using RocketOS::error_t;
+    using RocketOS::uint_t;
+    using SmallDeferredWork = DeferredWork<8>;
+
+    //what the work items of a case share, each item captures one pointer to it like the drivers capture themselves
+    struct Work{
+        SmallDeferredWork work;
+        std::string order;
+        bool ranInInterrupt = false;
+
+        workCallback_t item(char name){
+            switch(name){
+                case 'a': return [this](){ ran('a'); };
+                case 'b': return [this](){ ran('b'); };
+                case 'c': return [this](){ ran('c'); };
+                default: return [this](){ ran('?'); };
+            }
+        }
+
+        void ran(char name){
+            order += name;
+            //the software interrupt runs as an interrupt of its own, after the one that posted has returned
+            ranInInterrupt = Host::inInterrupt();
+        }
+    };
+
+    HOST_TEST(DeferredWork, DrainRunsItemsInPostOrder){
+        Work work;
+        for(char name : std::string("abcba")) CHECK(work.work.post(work.item(name)) == error_t::GOOD);
+        CHECK(work.order.empty() && work.work.pending() == 5);
+        CHECK(work.work.drain() == 5);
+        CHECK(work.order == "abcba" && work.work.getCount() == 5 && work.work.pending() == 0);
+        CHECK(work.work.drain() == 0);
+    }
+
+    HOST_TEST(DeferredWork, FullQueueDropsAndCounts){
+        Work work;
+        for(uint_t i=0; i<8; i++) CHECK(work.work.post(work.item('a')) == error_t::GOOD);
+        CHECK(work.work.post(work.item('b')) == error_t::ERROR);
+        CHECK(work.work.post(work.item('c')) == error_t::ERROR);
+        CHECK(work.work.getOverflows() == 2);
+        //the items that made it in still run, and the queue takes new ones once drained
+        CHECK(work.work.drain() == 8 && work.order == "aaaaaaaa");
+        CHECK(work.work.post(work.item('b')) == error_t::GOOD && work.work.drain() == 1);
+        CHECK(work.order == "aaaaaaaab");
+        work.work.resetStatistics();
+        CHECK(work.work.getOverflows() == 0 && work.work.getCount() == 0);
+    }
+
+    HOST_TEST(DeferredWork, SoftwareInterruptRunsAfterThePostingInterrupt){
+        Work work;
+        work.work.begin();
+        Host::interrupt([&work](){
+            work.work.post(work.item('a'));
+            work.work.post(work.item('b'));
+            //nothing runs while the posting interrupt is still active
+            CHECK(work.order.empty());
+        });
+        CHECK(work.order == "ab" && work.ranInInterrupt);
+        CHECK(work.work.pending() == 0);
+        //masked interrupts hold the software interrupt back until they are enabled again
+        noInterrupts();
+        work.work.post(work.item('c'));
+        CHECK(work.order == "ab");
+        interrupts();
+        CHECK(work.order == "abc");
+    }
+
+    HOST_TEST(DeferredWork, LatencyIsMeasuredPerItem){
+        Work work;
+        work.work.begin();
+        for(uint_t i=0; i<1000; i++){
+            Host::interrupt([&work](){ work.work.post(work.item('a')); });
+        }
+        CHECK(work.work.getCount() == 1000 && work.work.getOverflows() == 0);
+        double cyclesPerMicrosecond = F_CPU_ACTUAL / 1e6;
+        HOST_REPORT("post to start: last %.2f us, max %.2f us, longest item %.2f us (host)",
+            work.work.getLastLatencyCycles() / cyclesPerMicrosecond, work.work.getMaxLatencyCycles() / cyclesPerMicrosecond,
+            work.work.getMaxExecutionCycles() / cyclesPerMicrosecond);
+        CHECK(work.work.getMaxLatencyCycles() >= work.work.getLastLatencyCycles());
+    }
+
+    //the queue under the deferred work, producer threads standing in for interrupts of different priorities
+    HOST_TEST(DeferredWork, QueueKeepsEachProducersOrderAcrossThreads){
+        constexpr uint32_t c_producers = 3;
+        constexpr uint32_t c_items = 50000;
+        MPSCQueue<uint32_t, 64> queue;
+        std::vector<std::thread> producers;
+        std::atomic<uint32_t> full{0};
+        for(uint32_t producer=0; producer<c_producers; producer++){
+            producers.emplace_back([&queue, &full, producer](){
+                for(uint32_t i=0; i<c_items; i++){
+                    while(queue.push(producer << 24 | i) != error_t::GOOD){
+                        full++;
+                        std::this_thread::yield();
+                    }
+                }
+            });
+        }
+        uint32_t next[c_producers] = {};
+        uint32_t received = 0, outOfOrder = 0;
+        while(received < c_producers * c_items){
+            RocketOS::result_t<uint32_t> item = queue.pop();
+            if(item.error != error_t::GOOD){
+                std::this_thread::yield();
+                continue;
+            }
+            uint32_t producer = item.data >> 24;
+            if(producer >= c_producers || (item.data & 0xFFFFFF) != next[producer]) outOfOrder++;
+            else next[producer]++;
+            received++;
+        }
+        for(std::thread& producer : producers) producer.join();
+        HOST_REPORT("%u items from %u threads, %u pushes found the queue full", received, c_producers, full.load());
+        CHECK(outOfOrder == 0 && queue.empty());
+    }
+}
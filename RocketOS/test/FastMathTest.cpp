@@ -0,0 +1,145 @@
+#include "HostTest.h"
+#include "processing/RocketOS_ProcessingFastMath.h"
+#include <vector>
+
+namespace{
+    namespace FastMath = RocketOS::Processing::FastMath;
+    namespace StandardMath = RocketOS::Processing::StandardMath;
+
+    //largest error of a kernel over inputs from start to stop, error(x) compares one result against double precision libm
+    template<class T_error>
+    double maxError(double start, double stop, double step, T_error error){
+        double worst = 0;
+        for(double x = start; x <= stop; x += step) worst = std::fmax(worst, error(static_cast<float>(x)));
+        return worst;
+    }
+
+    //the same over a geometric sweep, for the kernels that cover every normal float
+    template<class T_error>
+    double maxErrorGeometric(double start, double stop, double factor, T_error error){
+        double worst = 0;
+        for(double x = start; x <= stop; x *= factor) worst = std::fmax(worst, error(static_cast<float>(x)));
+        return worst;
+    }
+
+    HOST_TEST(FastMath, SinCos){
+        double sinError = maxError(-1e4, 1e4, 0.00713, [](float x){ return std::fabs(FastMath::sin(x) - std::sin(static_cast<double>(x))); });
+        double cosError = maxError(-1e4, 1e4, 0.00713, [](float x){ return std::fabs(FastMath::cos(x) - std::cos(static_cast<double>(x))); });
+        HOST_REPORT("sin %.3g, cos %.3g absolute", sinError, cosError);
+        CHECK(sinError < 1e-7 && cosError < 1e-7);
+    }
+
+    HOST_TEST(FastMath, Asin){
+        double error = maxError(-1, 1, 1.3e-7, [](float x){ return std::fabs(FastMath::asin(x) - std::asin(static_cast<double>(x))); });
+        HOST_REPORT("asin %.3g absolute", error);
+        CHECK(error < 2e-7);
+        CHECK(FastMath::asin(1.5f) == FastMath::asin(1.0f) && FastMath::asin(-1.5f) == FastMath::asin(-1.0f));
+    }
+
+    HOST_TEST(FastMath, Atan){
+        auto error = [](float x){ return std::fabs(FastMath::atan(x) - std::atan(static_cast<double>(x))); };
+        double worst = std::fmax(maxError(-50, 50, 1.1e-5, error), maxErrorGeometric(1e-30, 1e30, 1.0003, error));
+        worst = std::fmax(worst, maxErrorGeometric(1e-30, 1e30, 1.0003, [&error](float x){ return error(-x); }));
+        HOST_REPORT("atan %.3g absolute", worst);
+        CHECK(worst < 1.5e-7);
+    }
+
+    HOST_TEST(FastMath, Atan2){
+        double worst = 0;
+        for(double radius : {1e-20, 1e-3, 1.0, 1e3, 1e20}){
+            worst = std::fmax(worst, maxError(-3.2, 3.2, 1.7e-5, [radius](float angle){
+                float y = static_cast<float>(radius * std::sin(static_cast<double>(angle)));
+                float x = static_cast<float>(radius * std::cos(static_cast<double>(angle)));
+                return std::fabs(FastMath::atan2(y, x) - std::atan2(static_cast<double>(y), static_cast<double>(x)));
+            }));
+        }
+        HOST_REPORT("atan2 %.3g absolute", worst);
+        CHECK(worst < 3e-7);
+        CHECK(FastMath::atan2(0.0f, 0.0f) == 0);
+        CHECK_NEAR(FastMath::atan2(1.0f, 0.0f), M_PI / 2, 1e-7);
+        CHECK_NEAR(FastMath::atan2(-1.0f, 0.0f), -M_PI / 2, 1e-7);
+    }
+
+    HOST_TEST(FastMath, RsqrtSqrt){
+        double rsqrtError = maxErrorGeometric(1.2e-38, 3e38, 1.00007, [](float x){ return std::fabs(FastMath::rsqrt(x) * std::sqrt(static_cast<double>(x)) - 1); });
+        double sqrtError = maxErrorGeometric(1.2e-38, 3e38, 1.00007, [](float x){ return std::fabs(FastMath::sqrt(x) / std::sqrt(static_cast<double>(x)) - 1); });
+        HOST_REPORT("rsqrt %.3g, sqrt %.3g relative", rsqrtError, sqrtError);
+        CHECK(rsqrtError < 5e-6 && sqrtError < 5e-6);
+        CHECK(FastMath::sqrt(0.0f) == 0 && FastMath::sqrt(-1.0f) == 0);
+    }
+
+    HOST_TEST(FastMath, Log){
+        double absolute = maxError(0.5, 2, 1.1e-7, [](float x){ return std::fabs(FastMath::log(x) - std::log(static_cast<double>(x))); });
+        double relative = maxErrorGeometric(1.2e-38, 3e38, 1.00003, [](float x){
+            if(x >= 0.5f && x <= 2.0f) return 0.0;
+            double expected = std::log(static_cast<double>(x));
+            return std::fabs((FastMath::log(x) - expected) / expected);
+        });
+        HOST_REPORT("log %.3g absolute on [0.5, 2], %.3g relative elsewhere", absolute, relative);
+        CHECK(absolute < 5e-8 && relative < 1e-7);
+        CHECK(FastMath::log(0.0f) == -INFINITY && FastMath::log(-1.0f) == -INFINITY);
+    }
+
+    HOST_TEST(FastMath, Exp){
+        double error = maxError(-87, 87, 3.1e-5, [](float x){ return std::fabs(FastMath::exp(x) / std::exp(static_cast<double>(x)) - 1); });
+        HOST_REPORT("exp %.3g relative", error);
+        CHECK(error < 1e-7);
+        CHECK(FastMath::exp(89.0f) == INFINITY && FastMath::exp(-88.0f) == 0);
+    }
+
+    HOST_TEST(FastMath, Pow){
+        //the bound in units of its own right hand side, 1 is at the bound
+        double worst = 0;
+        for(double x = 1e-4; x <= 1e4; x *= 1.0007){
+            for(double y = -9.5; y <= 9.5; y += 0.0137){
+                float fx = static_cast<float>(x);
+                float fy = static_cast<float>(y);
+                double exponent = fy * std::log(static_cast<double>(fx));
+                if(std::fabs(exponent) > 87) continue;
+                double error = std::fabs(FastMath::pow(fx, fy) / std::pow(static_cast<double>(fx), static_cast<double>(fy)) - 1);
+                worst = std::fmax(worst, error / (1e-7 + 1.5e-7 * std::fabs(exponent)));
+            }
+        }
+        HOST_REPORT("pow at %.2f of its bound", worst);
+        CHECK(worst < 1);
+        CHECK(FastMath::pow(0.0f, 2.0f) == 0 && FastMath::pow(-2.0f, 3.0f) == -8);
+    }
+
+    //ns per call of a kernel over a table of inputs, the sum keeps the calls from being optimized out
+    template<class T_kernel>
+    double benchmark_ns(const std::vector<float>& inputs, T_kernel kernel){
+        volatile float sink = 0;
+        double time = HostTest::time_s([&](){
+            float sum = 0;
+            for(float x : inputs) sum += kernel(x);
+            sink = sink + sum;
+        }, 200);
+        return time * 1e9 / inputs.size();
+    }
+
+    HOST_TEST(FastMath, Benchmark){
+        std::vector<float> angles, ratios, positive;
+        for(int i=0; i<4096; i++){
+            angles.push_back(-6.0f + 12.0f * i / 4096);
+            ratios.push_back(-1.0f + 2.0f * i / 4096);
+            positive.push_back(0.01f + 20.0f * i / 4096);
+        }
+        struct Row{ const char* name; double fast; double standard; };
+        const Row rows[] = {
+            {"sin", benchmark_ns(angles, [](float x){ return FastMath::sin(x); }), benchmark_ns(angles, [](float x){ return StandardMath::sin(x); })},
+            {"cos", benchmark_ns(angles, [](float x){ return FastMath::cos(x); }), benchmark_ns(angles, [](float x){ return StandardMath::cos(x); })},
+            {"asin", benchmark_ns(ratios, [](float x){ return FastMath::asin(x); }), benchmark_ns(ratios, [](float x){ return StandardMath::asin(x); })},
+            {"atan", benchmark_ns(angles, [](float x){ return FastMath::atan(x); }), benchmark_ns(angles, [](float x){ return StandardMath::atan(x); })},
+            {"atan2", benchmark_ns(angles, [](float x){ return FastMath::atan2(x, 0.7f); }), benchmark_ns(angles, [](float x){ return StandardMath::atan2(x, 0.7f); })},
+            {"rsqrt", benchmark_ns(positive, [](float x){ return FastMath::rsqrt(x); }), benchmark_ns(positive, [](float x){ return StandardMath::rsqrt(x); })},
+            {"sqrt", benchmark_ns(positive, [](float x){ return FastMath::sqrt(x); }), benchmark_ns(positive, [](float x){ return StandardMath::sqrt(x); })},
+            {"log", benchmark_ns(positive, [](float x){ return FastMath::log(x); }), benchmark_ns(positive, [](float x){ return StandardMath::log(x); })},
+            {"exp", benchmark_ns(angles, [](float x){ return FastMath::exp(x); }), benchmark_ns(angles, [](float x){ return StandardMath::exp(x); })},
+            {"pow", benchmark_ns(positive, [](float x){ return FastMath::pow(x, 1.7f); }), benchmark_ns(positive, [](float x){ return StandardMath::pow(x, 1.7f); })},
+        };
+        for(const Row& row : rows){
+            HOST_REPORT("%-6s fast %6.2f ns, libm %6.2f ns", row.name, row.fast, row.standard);
+            CHECK(row.fast > 0 && row.standard > 0);
+        }
+    }
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include "HostTest.h"
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+/*Flight plan file
+ * Writes a flight plan in the format FlightPlan::loadFromFile() reads into a fresh directory and makes it the SD card.
+ * The flight path is the drag free one, the altitude where the vertical velocity is still enough to coast to the target apogee,
+ * the same at every angle. The directory is removed again when the file goes.
+*/
+
+namespace HostTest{
+    class FlightPlanFile{
+    private:
+        std::string m_directory;
+        std::string m_path;
+    public:
+        static constexpr float c_gravity = 9.80665f;
+        const float targetApogee;
+        const float maxVelocity;
+
+        FlightPlanFile(const char* name, float apogee = 1500, float velocity = 300, unsigned velocitySamples = 60, unsigned angleSamples = 18) : targetApogee(apogee), maxVelocity(velocity){
+            char directory[] = "/tmp/rocketos-sd-XXXXXX";
+            if(mkdtemp(directory) != nullptr) m_directory = directory;
+            m_path = m_directory + "/" + name;
+            FILE* file = fopen(m_path.c_str(), "w");
+            if(file == nullptr) return;
+            //target apogee, drag area range, deployment angle limit, dry mass, ground temperature and pressure
+            fprintf(file, "%.1f, 0.0050, 0.0250, 60, 18.5, 288.15, 101325\n", apogee);
+            fprintf(file, "%.1f, %u, %u\n", velocity, velocitySamples, angleSamples);
+            //the largest angle and velocity come first
+            for(unsigned i=0; i<angleSamples; i++){
+                for(unsigned j=0; j<velocitySamples; j++){
+                    fprintf(file, "%s%.4f", (j == 0)? "" : ", ", altitude((velocitySamples - 1 - j) * velocity / velocitySamples));
+                }
+                fprintf(file, "\n");
+            }
+            fclose(file);
+            Host::setSDRoot(m_directory);
+        }
+
+        ~FlightPlanFile(){
+            std::remove(m_path.c_str());
+            std::remove(m_directory.c_str());
+        }
+
+        FlightPlanFile(const FlightPlanFile&) = delete;
+        FlightPlanFile& operator=(const FlightPlanFile&) = delete;
+
+        float altitude(float verticalVelocity) const{
+            return targetApogee - verticalVelocity * verticalVelocity / (2 * c_gravity);
+        }
+    };
+}
@@ -0,0 +1,38 @@
+#include "HostTest.h"
+#include "FlightPlanFile.h"
+#include "airbrakes/AirbrakesFlightPlan.h"
+#include <vector>
+
+namespace{
+    using Airbrakes::Controls::FlightPlan;
+    using RocketOS::error_t;
+    using RocketOS::uint_t;
+    using HostTest::FlightPlanFile;
+
+    HOST_TEST(FlightPlan, LoadsAPlanFile){
+        FlightPlanFile file("plan.txt");
+        SdFat sd;
+        std::vector<float> memory(4096);
+        FlightPlan plan("plan", sd, memory.data(), memory.size(), "plan.txt");
+        CHECK(plan.loadFromFile() == error_t::GOOD && plan.isLoaded());
+        CHECK_NEAR(plan.getTargetApogee().data, file.targetApogee, 0);
+        for(float velocity = 10; velocity < 280; velocity += 13.7f){
+            CHECK_NEAR(plan.getAltitude(velocity, 0.7f).data, file.altitude(velocity), 6);
+        }
+    }
+
+    HOST_TEST(FlightPlan, RefusesToLoadWhileInUse){
+        FlightPlanFile file("plan.txt", 1500);
+        SdFat sd;
+        std::vector<float> memory(4096);
+        FlightPlan plan("plan", sd, memory.data(), memory.size(), "plan.txt");
+        CHECK(plan.loadFromFile() == error_t::GOOD);
+        //the controller marks the plan while its interrupt reads it, a load would rewrite the mesh under it
+        plan.setInUse(true);
+        FlightPlanFile other("plan.txt", 3000);
+        CHECK(plan.loadFromFile() == FlightPlan::ERROR_InUse);
+        CHECK(plan.isLoaded() && plan.getTargetApogee().data == 1500);
+        plan.setInUse(false);
+        CHECK(plan.loadFromFile() == error_t::GOOD && plan.getTargetApogee().data == 3000);
+    }
+}
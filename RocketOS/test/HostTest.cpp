@@ -0,0 +1,63 @@
+#include "HostTest.h"
+#include <chrono>
+#include <cstdarg>
+#include <cstring>
+#include <vector>
+
+namespace{
+    std::vector<HostTest::Case>& cases(){
+        static std::vector<HostTest::Case> c;
+        return c;
+    }
+
+    const HostTest::Case* current = nullptr;
+    uint32_t failures = 0;
+}
+
+namespace HostTest{
+    void add(const Case& testCase){
+        cases().push_back(testCase);
+    }
+
+    void fail(const char* file, int line, const char* condition){
+        printf("  FAIL %s:%d: %s\n", file, line, condition);
+        failures++;
+    }
+
+    void report(const char* format, ...){
+        printf("  %s.%s: ", current->suite, current->name);
+        va_list arguments;
+        va_start(arguments, format);
+        vprintf(format, arguments);
+        va_end(arguments);
+        printf("\n");
+    }
+
+    double time_s(const std::function<void()>& function, uint32_t calls){
+        auto start = std::chrono::steady_clock::now();
+        for(uint32_t i=0; i<calls; i++) function();
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / calls;
+    }
+}
+
+//usage: RocketOSHostTests [suite...]
+int main(int argc, char** argv){
+    uint32_t run = 0;
+    uint32_t failed = 0;
+    for(const HostTest::Case& testCase : cases()){
+        bool selected = argc < 2;
+        for(int i=1; i<argc; i++) selected |= strcmp(argv[i], testCase.suite) == 0;
+        if(!selected) continue;
+        printf("%s.%s\n", testCase.suite, testCase.name);
+        fflush(stdout);
+        Host::reset();
+        current = &testCase;
+        uint32_t before = failures;
+        testCase.function();
+        if(failures != before) failed++;
+        run++;
+    }
+    printf("%u cases, %u failed\n", run, failed);
+    if(run == 0) printf("no test cases matched\n");
+    return (failed == 0 && run > 0) ? 0 : 1;
+}
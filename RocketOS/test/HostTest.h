@@ -0,0 +1,42 @@
+#pragma once
+#include "host/Host.h"
+#include <cstdio>
+#include <cmath>
+#include <functional>
+
+/*Host tests
+ * HOST_TEST(suite, name) registers a test case, the test executable runs the suites named on its command line (all without
+ * arguments). A failed CHECK reports the condition and continues, so one run shows every failure of a case.
+ * Every case starts from Host::reset(): the simulated clock at zero, no pins driven, no serial traffic.
+ * Benchmarks print what they measured with HOST_REPORT, their checks only cover what holds on any host.
+*/
+
+namespace HostTest{
+    struct Case{
+        const char* suite;
+        const char* name;
+        void (*function)();
+    };
+
+    void add(const Case& testCase);
+    void fail(const char* file, int line, const char* condition);
+    void report(const char* format, ...) __attribute__((format(printf, 1, 2)));
+
+    struct Registration{
+        Registration(const char* suite, const char* name, void (*function)()){
+            add(Case{suite, name, function});
+        }
+    };
+
+    //seconds of host time a function takes, averaged over the given number of calls
+    double time_s(const std::function<void()>& function, uint32_t calls = 1);
+}
+
+#define HOST_TEST(suite, name) \
+    static void suite##_##name(); \
+    static HostTest::Registration suite##_##name##_registration(#suite, #name, suite##_##name); \
+    static void suite##_##name()
+
+#define CHECK(condition) do{ if(!(condition)) HostTest::fail(__FILE__, __LINE__, #condition); }while(0)
+#define CHECK_NEAR(value, expected, tolerance) CHECK(std::fabs(static_cast<double>(value) - static_cast<double>(expected)) <= (tolerance))
+#define HOST_REPORT(...) HostTest::report(__VA_ARGS__)
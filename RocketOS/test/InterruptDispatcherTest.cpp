@@ -0,0 +1,131 @@
+#include "HostTest.h"
+#include "SensorRig.h"
+#include "utilities/RocketOS_UtilitiesInterruptDispatcher.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace{
+    using namespace RocketOS::Utilities;
+    using RocketOS::error_t;
+    using RocketOS::uint_t;
+
+    //what the handlers of a case share, each handler captures one pointer to it like a driver captures itself
+    struct Handlers{
+        std::string order;
+        std::vector<InterruptEvent> events;
+        bool busy = false;
+
+        interruptHandler_t handler(char name){
+            switch(name){
+                case 'a': return [this](const InterruptEvent& event){ return ran('a', event); };
+                case 'b': return [this](const InterruptEvent& event){ return ran('b', event); };
+                case 'c': return [this](const InterruptEvent& event){ return ran('c', event); };
+                default: return [this](const InterruptEvent& event){ return ran('?', event); };
+            }
+        }
+
+        bool ran(char name, const InterruptEvent& event){
+            order += name;
+            if(name == 'a') events.push_back(event);
+            return !busy;
+        }
+    };
+
+    //a falling edge on the simulated pin, the line is released again after it
+    void edge(uint8_t pin){
+        Host::setPin(pin, LOW);
+        Host::setPin(pin, HIGH);
+    }
+
+    //each case has a pin of its own, the handler tables are static per pin
+    HOST_TEST(InterruptDispatcher, EdgesAreTimestampedAtEntry){
+        using Pin = InterruptDispatcher<2>;
+        Handlers handlers;
+        Host::setPin(2, HIGH);
+        CHECK(Pin::attach(handlers.handler('a')) == error_t::GOOD);
+        Pin::begin(FALLING);
+        uint32_t count = Pin::getCount();
+        for(uint32_t time_us : {1000u, 1250u, 5000u}){
+            Host::advance(time_us - Host::clock.now_us());
+            edge(2);
+        }
+        CHECK(handlers.events.size() == 3 && Pin::getCount() == count + 3);
+        for(uint_t i=0; i<handlers.events.size(); i++){
+            CHECK(handlers.events[i].sequence == count + i);
+            CHECK(!handlers.events[i].recovered);
+        }
+        CHECK(handlers.events[0].time_us == 1000 && handlers.events[1].time_us == 1250 && handlers.events[2].time_us == 5000);
+        CHECK(Pin::getLastTime_us() == 5000);
+        //the cycle counter runs on host time, only its order is known
+        CHECK(handlers.events[2].cycles - handlers.events[0].cycles < 0x80000000u);
+        Pin::end();
+        edge(2);
+        CHECK(handlers.events.size() == 3);
+    }
+
+    HOST_TEST(InterruptDispatcher, HandlersRunByPriorityThenAttachOrder){
+        using Pin = InterruptDispatcher<3>;
+        Handlers handlers;
+        Host::setPin(3, HIGH);
+        Pin::attach(handlers.handler('c'), 2);
+        Pin::attach(handlers.handler('b'), 1);
+        Pin::attach(handlers.handler('a'), 0);
+        Pin::attach(handlers.handler('?'), 1);
+        CHECK(Pin::attach(handlers.handler('?'), 0) == error_t::ERROR);
+        Pin::begin(FALLING);
+        edge(3);
+        CHECK(handlers.order == "ab?c");
+        Pin::end();
+    }
+
+    HOST_TEST(InterruptDispatcher, BusyHandlersCoalesceAndLostEdgesAreRecovered){
+        using Pin = InterruptDispatcher<4>;
+        Handlers handlers;
+        Host::setPin(4, HIGH);
+        Pin::attach(handlers.handler('a'));
+        Pin::attach(handlers.handler('b'));
+        Pin::begin(FALLING);
+        Pin::resetStatistics();
+        //a handler still busy with the last event folds the next one into it, each refusing handler counts
+        handlers.busy = true;
+        edge(4);
+        edge(4);
+        CHECK(Pin::getCoalesced() == 4);
+        handlers.busy = false;
+        //edges while interrupts are masked reach the dispatcher once, the pin can then be polled for the one that was lost
+        noInterrupts();
+        edge(4);
+        edge(4);
+        interrupts();
+        CHECK(handlers.events.size() == 3);
+        Host::advance(700);
+        Pin::recover();
+        CHECK(handlers.events.size() == 4 && handlers.events.back().recovered && handlers.events.back().time_us == 700);
+        CHECK(Pin::getMissed() == 1 && Pin::getCoalesced() == 4);
+        Pin::resetStatistics();
+        CHECK(Pin::getMissed() == 0 && Pin::getCoalesced() == 0);
+        Pin::end();
+    }
+
+    //the IMU driver stamps its reports from the time its interrupt was taken
+    HOST_TEST(InterruptDispatcher, IMUReportsCarryTheInterruptTime){
+        using Pin = InterruptDispatcher<HostTest::SensorRig::c_IMUInterrupt>;
+        std::unique_ptr<HostTest::SensorRig> rig(new HostTest::SensorRig);
+        CHECK(rig->begin() == error_t::GOOD);
+        uint32_t count = Pin::getCount();
+        uint32_t worstAge_us = 0;
+        uint_t backwards = 0;
+        while(Host::clock.now_us() < 2000000){
+            rig->step(1000);
+            uint32_t report_us = rig->imu.getLastReportTime_us();
+            //a report is never stamped after the interrupt that delivered it
+            if(static_cast<int32_t>(Pin::getLastTime_us() - report_us) < 0) backwards++;
+            worstAge_us = std::max(worstAge_us, Host::clock.now_us() - report_us);
+        }
+        HOST_REPORT("%u interrupts, newest report at most %u us old", static_cast<unsigned>(Pin::getCount() - count), static_cast<unsigned>(worstAge_us));
+        CHECK(Pin::getCount() > count && backwards == 0);
+        //the hub holds reports for up to a batch interval (20ms), then one sample period and the exchange pass before the next batch lands
+        CHECK(worstAge_us < 2 * 20000);
+    }
+}
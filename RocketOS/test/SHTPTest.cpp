@@ -0,0 +1,259 @@
+#include "HostTest.h"
+#include "airbrakes/AirbrakesSensors_IMU.h"
+#include <deque>
+#include <memory>
+#include <vector>
+
+namespace{
+    using namespace Airbrakes::Sensors;
+    using RocketOS::error_t;
+    using RocketOS::uint_t;
+    using Packet = std::vector<uint8_t>;
+
+    //pins of src/AirbrakesSensors_IMU.cpp
+    constexpr uint8_t c_select = 38;
+    constexpr uint8_t c_wake = 29;
+    constexpr uint8_t c_reset = 33;
+    constexpr uint8_t c_interrupt = 25;
+
+    /*Captured hub traffic
+     * SHTP packets in the byte layout of the BNO08X datasheet, as a logic analyser shows them on the SPI bus: a 4 byte header
+     * (length with the continuation bit on top, channel, sequence) and the reports packed back to back behind it.
+    */
+    //after reset: reset complete on the executable channel, then the unsolicited initialize response
+    const Packet c_resetComplete{0x05, 0x00, 0x01, 0x00, 0x01};
+    const Packet c_initialize{0x14, 0x00, 0x02, 0x00, 0xF1, 0x00, 0x84, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+    //get feature responses with a 10ms report interval and a 20ms batch interval, one per sensor the driver turns on
+    Packet featureResponse(uint8_t sensorID){
+        return Packet{0x15, 0x00, 0x02, 0x00, 0xFC, sensorID, 0x00, 0x00, 0x00, 0x10, 0x27, 0x00, 0x00, 0x20, 0x4E, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+    }
+
+    //all four streams in one payload behind a base timestamp 1ms before the interrupt
+    const Packet c_fourStreams{
+        0x35, 0x00, 0x03, 0x00,
+        0xFB, 0x0A, 0x00, 0x00, 0x00,
+        //rotation vector, delay 0: i, j, k = 0, real = 1 (Q14), accuracy
+        0x05, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x40, 0xA4, 0x00,
+        //calibrated gyroscope, delay 0.5ms: 0.5, -0.25, 0 rad/s (Q9)
+        0x02, 0x00, 0x03, 0x05, 0x00, 0x01, 0x80, 0xFF, 0x00, 0x00,
+        //linear acceleration, delay 1ms: 1, 2, -9.5 m/s^2 (Q8)
+        0x04, 0x00, 0x03, 0x0A, 0x00, 0x01, 0x00, 0x02, 0x80, 0xF6,
+        //gravity, delay 1ms: 0, 0, 9.8046875 m/s^2 (Q8)
+        0x06, 0x00, 0x03, 0x0A, 0x00, 0x00, 0x00, 0x00, 0xCE, 0x09
+    };
+    //a batch of three linear acceleration reports 1ms apart, the newest at the interrupt
+    const Packet c_batch{
+        0x27, 0x00, 0x03, 0x01,
+        0xFB, 0x14, 0x00, 0x00, 0x00,
+        0x04, 0x01, 0x03, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00,
+        0x04, 0x02, 0x03, 0x0A, 0x00, 0x02, 0x00, 0x00, 0x00, 0x00,
+        0x04, 0x03, 0x03, 0x14, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00
+    };
+    //a batch longer than the delay field, the rebase moves the base 1.5s forward and the second report has a 0.5s delay
+    const Packet c_rebase{
+        0x27, 0x00, 0x03, 0x02,
+        0xFB, 0x20, 0x4E, 0x00, 0x00,
+        0x02, 0x01, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0xFA, 0x98, 0x3A, 0x00, 0x00,
+        0x02, 0x02, 0x4F, 0x88, 0x00, 0x02, 0x00, 0x00, 0x00, 0x00
+    };
+    //a report the driver does not know in the middle of a payload, the gravity report in front of it is still used
+    const Packet c_unknownReport{
+        0x27, 0x00, 0x03, 0x03,
+        0xFB, 0x00, 0x00, 0x00, 0x00,
+        0x06, 0x01, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0A,
+        0x99, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x04, 0x04, 0x03, 0x00, 0x00, 0x07, 0x00, 0x00, 0x00, 0x00
+    };
+    //the payload ends part way into the gravity report
+    const Packet c_truncated{
+        0x10, 0x00, 0x03, 0x04,
+        0xFB, 0x00, 0x00, 0x00, 0x00,
+        0x06, 0x02, 0x03, 0x00, 0x00, 0x00, 0x00
+    };
+    //the rest of a packet that did not fit, the driver does not read reports out of continuations
+    const Packet c_continuation{
+        0x0E, 0x80, 0x03, 0x05,
+        0x06, 0x03, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0B
+    };
+
+    /*Replay rig
+     * The IMU driver with a device on its bus that plays back captured packets instead of modelling the hub. H_INTN is low while
+     * a packet waits and after the driver wakes the hub; a reset queues the startup packets and every feature command the driver
+     * sends is answered with the captured feature response for its sensor.
+    */
+    struct ReplayRig{
+        Airbrakes::SPIBackend_t backend;
+        Airbrakes::SPIBus_t bus;
+        Airbrakes::DeferredWork_t work;
+        BNO085_SPI imu;
+        std::deque<Packet> packets;
+        Packet out;
+        Packet in;
+        uint_t position = 0;
+        bool wake = false;
+        bool inReset = false;
+
+        ReplayRig() : bus(backend), imu("imu", work, bus, 1000000, 10000, 20000){
+            backend.attach(c_select, [this](const uint8_t* tx, uint8_t* rx, uint16_t length, bool first){ exchange(tx, rx, length, first); });
+            Host::watchPin(c_wake, [this](uint8_t level){
+                if(level == LOW) wake = true;
+            });
+            Host::watchPin(c_reset, [this](uint8_t level){
+                if(level == LOW){
+                    inReset = true;
+                    packets.clear();
+                    Host::setPin(c_interrupt, HIGH);
+                }
+                else if(inReset){
+                    inReset = false;
+                    packets.push_back(c_resetComplete);
+                    packets.push_back(c_initialize);
+                }
+            });
+            Host::attachDevice([this](){
+                if(!inReset) Host::setPin(c_interrupt, (wake || !packets.empty())? LOW : HIGH);
+            });
+            work.begin();
+        }
+
+        ~ReplayRig(){
+            Host::reset();
+        }
+
+        void exchange(const uint8_t* tx, uint8_t* rx, uint16_t length, bool first){
+            if(first){
+                answer();
+                //the hub releases H_INTN when it is selected
+                wake = false;
+                Host::setPin(c_interrupt, HIGH);
+                out.clear();
+                if(!packets.empty()){
+                    out = packets.front();
+                    packets.pop_front();
+                }
+                position = 0;
+            }
+            for(uint_t i=0; i<length; i++, position++){
+                rx[i] = (position < out.size())? out[position] : 0;
+                in.push_back((tx != nullptr)? tx[i] : 0);
+            }
+        }
+
+        //the packet the driver sent in the last selection, set feature (0xFD) and get feature (0xFE) are answered
+        void answer(){
+            if(in.size() > 5 && in[2] == 0x02 && (in[4] == 0xFD || in[4] == 0xFE)) packets.push_back(featureResponse(in[5]));
+            in.clear();
+        }
+
+        //runs the main loop until every packet has been read and handled
+        void play(const Packet& packet){
+            packets.push_back(packet);
+            for(uint_t i=0; i<50 && !packets.empty(); i++) step(100);
+            step(1000);
+        }
+
+        void step(uint32_t time_us){
+            Host::advance(time_us);
+            imu.updateBackground();
+        }
+
+        error_t begin(){
+            if(imu.initialize() != error_t::GOOD) return error_t::ERROR;
+            for(uint_t i=0; i<1000 && imu.getState() != IMUStates::Operational; i++) step(500);
+            return (imu.getState() == IMUStates::Operational)? error_t::GOOD : error_t::ERROR;
+        }
+
+        //when the packet just played came in
+        static uint32_t interruptTime(){
+            return RocketOS::Utilities::InterruptDispatcher<c_interrupt>::getLastTime_us();
+        }
+    };
+
+    HOST_TEST(SHTP, StartupAndFeatureResponsesBringTheDriverUp){
+        std::unique_ptr<ReplayRig> rig(new ReplayRig);
+        //operational means a feature response with a running interval was decoded for each of the four streams
+        CHECK(rig->begin() == error_t::GOOD);
+        CHECK(rig->backend.getErrors() == 0);
+    }
+
+    HOST_TEST(SHTP, OnePayloadCarriesAllFourStreams){
+        std::unique_ptr<ReplayRig> rig(new ReplayRig);
+        CHECK(rig->begin() == error_t::GOOD);
+        rig->play(c_fourStreams);
+        uint32_t interrupt = ReplayRig::interruptTime();
+        Sample<Quaternion> orientation = rig->imu.getOrientationSample();
+        Sample<Vector3> angularVelocity = rig->imu.getAngularVelocitySample();
+        Sample<Vector3> linearAcceleration = rig->imu.getLinearAccelerationSample();
+        Sample<Vector3> gravity = rig->imu.getGravitySample();
+        CHECK(orientation.value.r == 1 && orientation.value.i == 0 && orientation.value.j == 0 && orientation.value.k == 0);
+        CHECK(angularVelocity.value.x == 0.5f && angularVelocity.value.y == -0.25f && angularVelocity.value.z == 0);
+        CHECK(linearAcceleration.value.x == 1 && linearAcceleration.value.y == 2 && linearAcceleration.value.z == -9.5f);
+        CHECK(gravity.value.x == 0 && gravity.value.y == 0 && gravity.value.z == 9.8046875f);
+        //each report is timed from the base 1ms before the interrupt plus its own delay
+        CHECK(orientation.time_us == interrupt - 1000);
+        CHECK(angularVelocity.time_us == interrupt - 500);
+        CHECK(linearAcceleration.time_us == interrupt && gravity.time_us == interrupt);
+    }
+
+    HOST_TEST(SHTP, BatchedReportsAllReachTheHistory){
+        std::unique_ptr<ReplayRig> rig(new ReplayRig);
+        CHECK(rig->begin() == error_t::GOOD);
+        rig->play(c_fourStreams);
+        uint32_t sequence = rig->imu.getLinearAccelerationSample().sequence;
+        rig->play(c_batch);
+        uint32_t interrupt = ReplayRig::interruptTime();
+        Sample<Vector3> samples[8];
+        uint_t count = rig->imu.getHistory(IMUData::LinearAcceleration).since(sequence, samples, 8);
+        CHECK(count == 3);
+        for(uint_t i=0; i<count; i++){
+            CHECK(samples[i].value.x == i + 1);
+            CHECK(samples[i].time_us == interrupt - 2000 + 1000 * i);
+            CHECK(samples[i].sequence == sequence + 1 + i);
+        }
+    }
+
+    HOST_TEST(SHTP, RebaseAndLongDelays){
+        std::unique_ptr<ReplayRig> rig(new ReplayRig);
+        CHECK(rig->begin() == error_t::GOOD);
+        rig->play(c_fourStreams);
+        uint32_t sequence = rig->imu.getAngularVelocitySample().sequence;
+        rig->play(c_rebase);
+        uint32_t interrupt = ReplayRig::interruptTime();
+        Sample<Vector3> samples[4];
+        CHECK(rig->imu.getHistory(IMUData::AngularVelocity).since(sequence, samples, 4) == 2);
+        CHECK(samples[0].time_us == interrupt - 2000000);
+        //1.5s of rebase and a delay of 5000 units, whose top bits are in the status byte
+        CHECK(samples[1].time_us == interrupt && samples[1].value.y == 1);
+    }
+
+    HOST_TEST(SHTP, MalformedPayloadsKeepWhatCanBeRead){
+        std::unique_ptr<ReplayRig> rig(new ReplayRig);
+        CHECK(rig->begin() == error_t::GOOD);
+        rig->play(c_fourStreams);
+        uint32_t linear = rig->imu.getLinearAccelerationSample().sequence;
+        uint32_t gravity = rig->imu.getGravitySample().sequence;
+        //the walk stops at the unknown report, the linear acceleration behind it is lost
+        rig->play(c_unknownReport);
+        CHECK(rig->imu.getGravitySample().sequence == gravity + 1 && rig->imu.getGravitySample().value.z == 10);
+        CHECK(rig->imu.getLinearAccelerationSample().sequence == linear);
+        //a report cut short and a continuation are not decoded
+        rig->play(c_truncated);
+        rig->play(c_continuation);
+        CHECK(rig->imu.getGravitySample().sequence == gravity + 1);
+        //and the driver takes the next packet as usual
+        rig->play(c_fourStreams);
+        CHECK(rig->imu.getGravitySample().sequence == gravity + 2 && rig->imu.getLinearAccelerationSample().sequence == linear + 1);
+        CHECK(rig->backend.getErrors() == 0);
+    }
+
+    HOST_TEST(SHTP, Benchmark){
+        std::unique_ptr<ReplayRig> rig(new ReplayRig);
+        CHECK(rig->begin() == error_t::GOOD);
+        constexpr uint32_t c_packets = 2000;
+        double total_s = HostTest::time_s([&rig](){ rig->play(c_fourStreams); }, c_packets);
+        uint32_t maximumCycles = rig->work.getMaxExecutionCycles();
+        HOST_REPORT("four stream packet: %.2f us per play on the host, longest deferred decode %.2f us", total_s * 1e6, maximumCycles / (F_CPU_ACTUAL / 1e6));
+        CHECK(rig->imu.getState() == IMUStates::Operational);
+    }
+}
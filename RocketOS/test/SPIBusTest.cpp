@@ -0,0 +1,129 @@
+#include "HostTest.h"
+#include "RocketOS.h"
+#include <vector>
+
+namespace{
+    using namespace RocketOS::Utilities;
+    using RocketOS::error_t;
+    using RocketOS::uint_t;
+    using Backend = MockSPIBackend<>;
+    using Bus = SPIBus<Backend, 8>;
+
+    //mock whose deferred transfers only finish once released, like a DMA transfer held up on a stuck bus
+    class StallingBackend : public Backend{
+    private:
+        bool m_stalled = true;
+    public:
+        void setStalled(bool stalled){ m_stalled = stalled; }
+        void poll(){ if(!m_stalled) Backend::poll(); }
+    };
+
+    SPITransaction transaction(uint8_t pin, const uint8_t* tx, uint8_t* rx, uint16_t length, spiCallback_t done = nullptr){
+        return SPITransaction{pin, 1000000, 0, tx, rx, length, false, done};
+    }
+
+    HOST_TEST(SPIBus, RunsTransactionsInSubmissionOrder){
+        Backend backend;
+        Bus bus(backend);
+        const uint8_t script[] = {1, 2, 3, 4, 5, 6};
+        backend.attach(10, script, sizeof(script));
+        bus.begin();
+        std::array<uint8_t, 2> first, second, third;
+        std::vector<int> order;
+        bus.submit(transaction(10, nullptr, first.data(), 2, [&order](){ order.push_back(1); }));
+        bus.submit(transaction(10, nullptr, second.data(), 2, [&order](){ order.push_back(2); }));
+        bus.submit(transaction(10, nullptr, third.data(), 2, [&order](){ order.push_back(3); }));
+        CHECK((order == std::vector<int>{1, 2, 3}));
+        CHECK(first[0] == 1 && second[0] == 3 && third[1] == 6);
+        CHECK(bus.idle() && bus.getCount() == 3 && bus.getBytes() == 6);
+        CHECK(backend.getSelections(10) == 3 && backend.getErrors() == 0);
+    }
+
+    HOST_TEST(SPIBus, DeferredTransfersContinueFromCompletion){
+        Backend backend;
+        Bus bus(backend);
+        backend.setDeferred(true);
+        uint32_t done = 0;
+        for(uint_t i=0; i<4; i++) CHECK(bus.submit(transaction(10, nullptr, nullptr, 4, [&done](){ done++; })) == error_t::GOOD);
+        CHECK(done == 0 && backend.busy() && !bus.idle());
+        for(uint_t i=0; i<4; i++) backend.poll();
+        CHECK(done == 4 && bus.idle() && bus.getDeferred() == 4 && backend.getErrors() == 0);
+    }
+
+    HOST_TEST(SPIBus, HeldSelectionChainsTheNextPart){
+        Backend backend;
+        Bus bus(backend);
+        //a header announcing two more bytes, then the payload
+        const uint8_t script[] = {2, 0xAA, 0xBB};
+        backend.attach(10, script, sizeof(script));
+        //the callback capture has the size of the target's, one reference
+        struct Exchange{
+            Bus& bus;
+            std::array<uint8_t, 1> header;
+            std::array<uint8_t, 4> payload;
+            uint16_t length;
+        } exchange{bus, {}, {}, 0};
+        SPITransaction first = transaction(10, nullptr, exchange.header.data(), 1);
+        first.holdSelect = true;
+        first.done = [&exchange](){
+            exchange.length = exchange.header[0];
+            CHECK(exchange.bus.chain(transaction(10, nullptr, exchange.payload.data(), exchange.length)) == error_t::GOOD);
+        };
+        bus.submit(first);
+        CHECK(exchange.length == 2 && exchange.payload[0] == 0xAA && exchange.payload[1] == 0xBB);
+        CHECK(backend.getSelections(10) == 1 && backend.getErrors() == 0);
+        //chain is only valid from the done callback of a held transaction
+        CHECK(bus.chain(transaction(10, nullptr, nullptr, 1)) == error_t::ERROR);
+    }
+
+    HOST_TEST(SPIBus, QueueOverflowIsCounted){
+        Backend backend;
+        Bus bus(backend);
+        backend.setDeferred(true);
+        //one transaction runs on the backend, the queue holds one less than its depth
+        uint_t accepted = 0;
+        for(uint_t i=0; i<12; i++) if(bus.submit(transaction(10, nullptr, nullptr, 1)) == error_t::GOOD) accepted++;
+        CHECK(accepted < 12 && bus.getOverflows() == 12 - accepted);
+        while(backend.busy()) backend.poll();
+        CHECK(bus.idle() && bus.getCount() == accepted);
+    }
+
+    HOST_TEST(SPIBus, BlockingTransferWaitsForDeferredCompletion){
+        Backend backend;
+        Bus bus(backend);
+        const uint8_t script[] = {0x12, 0x34};
+        backend.attach(10, script, sizeof(script));
+        backend.setDeferred(true);
+        std::array<uint8_t, 2> rx{};
+        CHECK(bus.transferBlocking(transaction(10, nullptr, rx.data(), 2)) == error_t::GOOD);
+        CHECK(rx[0] == 0x12 && rx[1] == 0x34 && bus.idle() && bus.getTimeouts() == 0);
+    }
+
+    HOST_TEST(SPIBus, TimedOutBlockingTransferCanNotEndTheNextWait){
+        StallingBackend backend;
+        SPIBus<StallingBackend, 8> bus(backend);
+        const uint8_t script[] = {0x11, 0x22, 0x33, 0x44};
+        backend.attach(10, script, sizeof(script));
+        backend.setDeferred(true);
+        std::array<uint8_t, 2> first{}, second{};
+        CHECK(bus.transferBlocking(transaction(10, nullptr, first.data(), 2), 100) == error_t::ERROR);
+        CHECK(bus.getTimeouts() == 1 && !bus.idle());
+        //the abandoned transfer finishes during the next wait, which has to keep waiting for its own
+        backend.setStalled(false);
+        CHECK(bus.transferBlocking(transaction(10, nullptr, second.data(), 2)) == error_t::GOOD);
+        CHECK(first[0] == 0x11 && first[1] == 0x22);
+        CHECK(second[0] == 0x33 && second[1] == 0x44);
+        CHECK(bus.idle() && bus.getCount() == 2 && bus.getTimeouts() == 1 && backend.getErrors() == 0);
+    }
+
+    HOST_TEST(SPIBus, SeveralTimeoutsInARow){
+        StallingBackend backend;
+        SPIBus<StallingBackend, 8> bus(backend);
+        backend.setDeferred(true);
+        for(uint_t i=0; i<3; i++) CHECK(bus.transferBlocking(transaction(10, nullptr, nullptr, 1), 50) == error_t::ERROR);
+        backend.setStalled(false);
+        std::array<uint8_t, 1> rx{};
+        CHECK(bus.transferBlocking(transaction(10, nullptr, rx.data(), 1)) == error_t::GOOD);
+        CHECK(bus.idle() && bus.getCount() == 4 && bus.getTimeouts() == 3);
+    }
+}
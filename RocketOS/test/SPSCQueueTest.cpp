@@ -0,0 +1,129 @@
+#include "HostTest.h"
+#include "utilities/RocketOS_UtilitiesSPSCQueue.h"
+#include "utilities/RocketOS_UtilitiesQueue.h"
+#include <atomic>
+#include <thread>
+
+namespace{
+    using namespace RocketOS::Utilities;
+    using RocketOS::error_t;
+    using RocketOS::uint_t;
+
+    //an element larger than a word, a consumer that reads a slot before the producer finished it sees the halves disagree
+    struct Element{
+        uint32_t value;
+        uint32_t inverse;
+    };
+
+    HOST_TEST(SPSCQueue, EverySlotIsUsableAndOrderIsKept){
+        SPSCQueue<uint32_t, 8> queue;
+        //move the indices part way round the buffer first so the fill wraps
+        for(uint32_t i=0; i<5; i++) queue.push(i);
+        for(uint32_t i=0; i<5; i++) queue.pop();
+        for(uint32_t i=0; i<8; i++) CHECK(queue.push(i) == error_t::GOOD);
+        CHECK(queue.push(8) == error_t::ERROR);
+        CHECK(queue.size() == 8 && queue.capacity() == 8);
+        for(uint32_t i=0; i<8; i++){
+            RocketOS::result_t<uint32_t> element = queue.pop();
+            CHECK(element.error == error_t::GOOD && element.data == i);
+        }
+        CHECK(queue.pop().error == error_t::ERROR && queue.empty());
+    }
+
+    HOST_TEST(SPSCQueue, BulkTransfersStopAtTheSpaceAvailable){
+        SPSCQueue<uint32_t, 8> queue;
+        const uint32_t values[] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+        CHECK(queue.push(values, 6) == 6);
+        CHECK(queue.push(values + 6, 4) == 2);
+        uint32_t out[10] = {};
+        CHECK(queue.pop(out, 3) == 3 && out[0] == 1 && out[2] == 3);
+        //the next bulk push wraps round the end of the buffer
+        CHECK(queue.push(values + 8, 2) == 2);
+        CHECK(queue.pop(out, 10) == 7);
+        CHECK(out[0] == 4 && out[4] == 8 && out[5] == 9 && out[6] == 10);
+        CHECK(queue.pop(out, 10) == 0);
+        queue.push(values, 3);
+        queue.clear();
+        CHECK(queue.empty());
+    }
+
+    //a producer thread and a consumer thread, each mixing single and bulk transfers of different lengths
+    HOST_TEST(SPSCQueue, ThreadedTransfersArriveWholeAndInOrder){
+        constexpr uint32_t c_elements = 1000000;
+        SPSCQueue<Element, 64> queue;
+        std::thread producer([&queue](){
+            Element batch[13];
+            for(uint32_t next=0; next<c_elements;){
+                if(next % 3 == 0){
+                    if(queue.push(Element{next, ~next}) == error_t::GOOD) next++;
+                    else std::this_thread::yield();
+                    continue;
+                }
+                uint_t count = std::min<uint32_t>(1 + next % 13, c_elements - next);
+                for(uint_t i=0; i<count; i++) batch[i] = Element{next + i, ~(next + i)};
+                uint_t pushed = queue.push(batch, count);
+                if(pushed == 0) std::this_thread::yield();
+                next += pushed;
+            }
+        });
+        uint32_t expected = 0, errors = 0;
+        Element batch[9];
+        while(expected < c_elements){
+            uint_t count;
+            if(expected % 2){
+                RocketOS::result_t<Element> element = queue.pop();
+                count = element.error == error_t::GOOD;
+                batch[0] = element.data;
+            }
+            else count = queue.pop(batch, 1 + expected % 9);
+            if(count == 0) std::this_thread::yield();
+            for(uint_t i=0; i<count; i++){
+                if(batch[i].value != expected || batch[i].inverse != ~expected) errors++;
+                expected++;
+            }
+        }
+        producer.join();
+        CHECK(errors == 0 && queue.empty());
+    }
+
+    HOST_TEST(SPSCQueue, Benchmark){
+        constexpr uint32_t c_rounds = 200000;
+        SPSCQueue<uint32_t, 64> spsc;
+        Queue<uint32_t, 65> queue;
+        volatile uint32_t sink = 0;
+        //bursts of 32 in and out, the pattern of the IMU transmit queue
+        double spscSingle = HostTest::time_s([&](){
+            for(uint32_t i=0; i<32; i++) spsc.push(i);
+            for(uint32_t i=0; i<32; i++) sink = sink + spsc.pop().data;
+        }, c_rounds);
+        double spscBulk = HostTest::time_s([&](){
+            uint32_t values[32];
+            for(uint32_t i=0; i<32; i++) values[i] = i;
+            spsc.push(values, 32);
+            spsc.pop(values, 32);
+            sink = sink + values[31];
+        }, c_rounds);
+        double current = HostTest::time_s([&](){
+            for(uint32_t i=0; i<32; i++) queue.push(i);
+            for(uint32_t i=0; i<32; i++) sink = sink + queue.pop().data;
+        }, c_rounds);
+        //the same through two threads, which the current queue can not do
+        constexpr uint32_t c_elements = 1000000;
+        double threaded = HostTest::time_s([&](){
+            std::thread producer([&spsc](){
+                for(uint32_t i=0; i<c_elements;){
+                    if(spsc.push(i) == error_t::GOOD) i++;
+                    else std::this_thread::yield();
+                }
+            });
+            for(uint32_t received=0; received<c_elements;){
+                if(spsc.pop().error == error_t::GOOD) received++;
+                else std::this_thread::yield();
+            }
+            producer.join();
+        });
+        HOST_REPORT("ns per element: SPSCQueue %.2f, bulk %.2f, Queue %.2f, SPSCQueue across threads %.2f",
+            spscSingle * 1e9 / 32, spscBulk * 1e9 / 32, current * 1e9 / 32, threaded * 1e9 / c_elements);
+        CHECK(spscSingle > 0 && spscBulk > 0 && current > 0 && threaded > 0);
+    }
+}
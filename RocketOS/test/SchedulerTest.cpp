@@ -0,0 +1,150 @@
+#include "HostTest.h"
+#include "scheduler/RocketOS_Scheduler.h"
+#include <string>
+
+namespace{
+    using namespace RocketOS::Scheduler;
+    using RocketOS::error_t;
+    using RocketOS::uint_t;
+    using SimulatedDispatcher = Dispatcher<8, SimulatedClock>;
+
+    //what the tasks of a case share, the callbacks capture one pointer to it like they capture the application on the target
+    struct Schedule{
+        SimulatedDispatcher dispatcher;
+        std::string order;
+        uint32_t execution_us = 0;
+
+        //a task that records its name and takes the given execution time off the clock
+        taskCallback_t task(char name){
+            switch(name){
+                case 'a': return [this](){ ran('a'); };
+                case 'b': return [this](){ ran('b'); };
+                case 'c': return [this](){ ran('c'); };
+                default: return [this](){ ran('?'); };
+            }
+        }
+
+        void ran(char name){
+            order += name;
+            dispatcher.getClock().advance(execution_us);
+        }
+
+        //dispatches every step microseconds until the clock reaches the given time
+        void runUntil(uint32_t time_us, uint32_t step_us){
+            while(static_cast<int32_t>(dispatcher.getClock().now_us() - time_us) < 0){
+                dispatcher.dispatch();
+                dispatcher.getClock().advance(step_us);
+            }
+        }
+    };
+
+    HOST_TEST(Scheduler, PeriodicTasksRunOnAFixedGrid){
+        Schedule schedule;
+        CHECK(schedule.dispatcher.addPeriodic("a", schedule.task('a'), {1000, 1000, 0}).data == 0);
+        //a dispatch every 300us releases the task up to 299us late, the grid does not drift with it
+        schedule.runUntil(100000, 300);
+        const Task& task = schedule.dispatcher.getTask(0);
+        CHECK(task.statistics.runs == 100);
+        CHECK(task.statistics.skipped == 0 && task.statistics.overruns == 0);
+        CHECK(task.statistics.maxLateness_us < 300);
+        CHECK(task.release_us == 100000);
+    }
+
+    HOST_TEST(Scheduler, ReadyTasksRunByPriorityThenRegistration){
+        Schedule schedule;
+        schedule.dispatcher.addPeriodic("c", schedule.task('c'), {1000, 0, 2});
+        schedule.dispatcher.addPeriodic("a", schedule.task('a'), {1000, 0, 1});
+        schedule.dispatcher.addPeriodic("b", schedule.task('b'), {1000, 0, 1});
+        CHECK(schedule.dispatcher.dispatch() == 3);
+        CHECK(schedule.order == "abc");
+        //nothing is released again until the next period
+        CHECK(schedule.dispatcher.dispatch() == 0);
+        CHECK(schedule.dispatcher.timeUntilNextRelease_us() == 1000);
+    }
+
+    HOST_TEST(Scheduler, BackgroundTasksRunOncePerDispatch){
+        Schedule schedule;
+        schedule.dispatcher.addPeriodic("a", schedule.task('a'), {0, 0, 0});
+        schedule.dispatcher.addPeriodic("b", schedule.task('b'), {500, 0, 1});
+        schedule.execution_us = 200;
+        //the background task is ready again after it runs, it still does not run twice in one dispatch
+        for(uint_t i=0; i<10; i++) schedule.dispatcher.dispatch();
+        CHECK(schedule.dispatcher.getTask(0).statistics.runs == 10);
+        CHECK(schedule.dispatcher.getTask(1).statistics.runs > 0);
+        CHECK(schedule.order.find("aa") != std::string::npos && schedule.order.find("bb") == std::string::npos);
+    }
+
+    HOST_TEST(Scheduler, LateTasksSkipMissedReleases){
+        Schedule schedule;
+        schedule.dispatcher.addPeriodic("a", schedule.task('a'), {1000, 800, 0});
+        schedule.execution_us = 3500;
+        schedule.dispatcher.dispatch();
+        const Task& task = schedule.dispatcher.getTask(0);
+        //ran 0-3500us, releases at 1000, 2000 and 3000 are dropped and the next one is back on the grid
+        CHECK(task.statistics.runs == 1 && task.statistics.overruns == 1);
+        CHECK(task.statistics.skipped == 3);
+        CHECK(task.release_us == 4000);
+        CHECK(task.statistics.maxExecution_us == 3500);
+        schedule.execution_us = 0;
+        schedule.dispatcher.getClock().set(4000);
+        CHECK(schedule.dispatcher.dispatch() == 1 && task.statistics.overruns == 1);
+    }
+
+    HOST_TEST(Scheduler, OneShotTasksRunOnceUntilRearmed){
+        Schedule schedule;
+        uint_t task = schedule.dispatcher.addOneShot("a", schedule.task('a'), 2500).data;
+        schedule.runUntil(10000, 500);
+        CHECK(schedule.order == "a" && schedule.dispatcher.getTask(task).release_us == 2500);
+        CHECK(!schedule.dispatcher.getTask(task).enabled);
+        CHECK(schedule.dispatcher.start(task, 1000) == error_t::GOOD);
+        schedule.runUntil(20000, 500);
+        CHECK(schedule.order == "aa" && schedule.dispatcher.getTask(task).release_us == 11000);
+        CHECK(schedule.dispatcher.start(5) == SimulatedDispatcher::ERROR_InvalidTask);
+    }
+
+    HOST_TEST(Scheduler, SetPeriodAppliesFromTheNextRelease){
+        Schedule schedule;
+        schedule.dispatcher.addPeriodic("a", schedule.task('a'), {1000, 0, 0});
+        schedule.runUntil(5000, 100);
+        CHECK(schedule.dispatcher.getTask(0).statistics.runs == 5);
+        CHECK(schedule.dispatcher.setPeriod(0, 4000) == error_t::GOOD);
+        //the release at 5000 is already armed, the ones after it are 4ms apart
+        schedule.runUntil(21100, 100);
+        CHECK(schedule.dispatcher.getTask(0).statistics.runs == 10);
+        CHECK(schedule.dispatcher.getTask(0).release_us == 25000);
+    }
+
+    HOST_TEST(Scheduler, StoppedTasksDoNotRun){
+        Schedule schedule;
+        schedule.dispatcher.addPeriodic("a", schedule.task('a'), {1000, 0, 0});
+        schedule.dispatcher.addPeriodic("b", schedule.task('b'), {1000, 0, 0});
+        CHECK(schedule.dispatcher.stop(0) == error_t::GOOD);
+        schedule.runUntil(3000, 100);
+        CHECK(schedule.order == "bbb");
+        CHECK(schedule.dispatcher.timeUntilNextRelease_us() <= 1000);
+        schedule.dispatcher.stop(1);
+        CHECK(schedule.dispatcher.timeUntilNextRelease_us() == UINT32_MAX);
+    }
+
+    HOST_TEST(Scheduler, ClockWrapAround){
+        Schedule schedule;
+        schedule.dispatcher.getClock().set(UINT32_MAX - 4999);
+        schedule.dispatcher.addPeriodic("a", schedule.task('a'), {1000, 1000, 0});
+        //the count wraps half way through, the signed comparisons keep the grid
+        schedule.runUntil(5000, 250);
+        const Task& task = schedule.dispatcher.getTask(0);
+        CHECK(task.statistics.runs == 10);
+        CHECK(task.statistics.skipped == 0 && task.statistics.overruns == 0);
+        CHECK(task.statistics.maxLateness_us < 250);
+        CHECK(task.release_us == 5000);
+    }
+
+    HOST_TEST(Scheduler, FullDispatcherRefusesTasks){
+        using SmallDispatcher = Dispatcher<2, SimulatedClock>;
+        SmallDispatcher dispatcher;
+        CHECK(dispatcher.addPeriodic("a", nullptr, {0, 0, 0}).error == error_t::GOOD);
+        CHECK(dispatcher.addOneShot("b", nullptr, 0).error == error_t::GOOD);
+        CHECK(dispatcher.addPeriodic("c", nullptr, {0, 0, 0}).error == SmallDispatcher::ERROR_Full);
+        CHECK(dispatcher.size() == 2 && dispatcher.capacity() == 2);
+    }
+}
@@ -0,0 +1,220 @@
+#include "HostTest.h"
+#include "SensorRig.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <memory>
+
+namespace{
+    using namespace Airbrakes;
+    using namespace Airbrakes::Sensors;
+    using namespace Airbrakes::Sensors::Emulation;
+    using RocketOS::error_t;
+    using RocketOS::uint_t;
+    using HostTest::SensorRig;
+
+    double difference(const Vector3& a, const Vector3& b){
+        return std::max({std::fabs(a.x - b.x), std::fabs(a.y - b.y), std::fabs(a.z - b.z)});
+    }
+
+    double difference(const Quaternion& a, const Quaternion& b){
+        return std::max({std::fabs(a.r - b.r), std::fabs(a.i - b.i), std::fabs(a.j - b.j), std::fabs(a.k - b.k)});
+    }
+
+    //reads every new sample of the IMU's histories like the observer does and keeps the worst error against the trajectory
+    class IMUChecker{
+    private:
+        const SensorRig& m_rig;
+        uint32_t m_accelerationSequence;
+        uint32_t m_orientationSequence;
+        std::array<Sample<Vector3>, 64> m_vectors;
+        std::array<Sample<Quaternion>, 64> m_orientations;
+    public:
+        uint32_t samples = 0;
+        uint32_t gaps = 0;
+        double worstAcceleration = 0;
+        double worstOrientation = 0;
+        double worstGravity = 0;
+        double worstAngularVelocity = 0;
+
+        explicit IMUChecker(const SensorRig& rig) : m_rig(rig), m_accelerationSequence(0), m_orientationSequence(0){
+            result_t<Sample<Vector3>> acceleration = rig.imu.getHistory(IMUData::LinearAcceleration).latest();
+            if(acceleration.error == error_t::GOOD) m_accelerationSequence = acceleration.data.sequence;
+            result_t<Sample<Quaternion>> orientation = rig.imu.getOrientationHistory().latest();
+            if(orientation.error == error_t::GOOD) m_orientationSequence = orientation.data.sequence;
+        }
+
+        void check(){
+            uint_t count = m_rig.imu.getHistory(IMUData::LinearAcceleration).since(m_accelerationSequence, m_vectors.data(), m_vectors.size());
+            for(uint_t i=0; i<count; i++){
+                if(m_vectors[i].sequence != m_accelerationSequence + 1) gaps++;
+                m_accelerationSequence = m_vectors[i].sequence;
+                samples++;
+                //the acceleration steps at burnout, a sample next to it may fall on either side
+                if(std::abs(static_cast<int32_t>(m_vectors[i].time_us - 5000000)) > 200)
+                    worstAcceleration = std::max(worstAcceleration, difference(m_vectors[i].value, m_rig.flight.at(m_vectors[i].time_us).linearAcceleration));
+            }
+            count = m_rig.imu.getOrientationHistory().since(m_orientationSequence, m_orientations.data(), m_orientations.size());
+            for(uint_t i=0; i<count; i++){
+                m_orientationSequence = m_orientations[i].sequence;
+                worstOrientation = std::max(worstOrientation, difference(m_orientations[i].value, m_rig.flight.at(m_orientations[i].time_us).orientation));
+            }
+            Sample<Vector3> gravity = m_rig.imu.getGravitySample();
+            if(gravity.sequence > 0) worstGravity = std::max(worstGravity, difference(gravity.value, m_rig.flight.at(gravity.time_us).gravity));
+            //the rotation starts at launch
+            Sample<Vector3> angularVelocity = m_rig.imu.getAngularVelocitySample();
+            if(angularVelocity.sequence > 0 && std::abs(static_cast<int32_t>(angularVelocity.time_us - 2000000)) > 200)
+                worstAngularVelocity = std::max(worstAngularVelocity, difference(angularVelocity.value, m_rig.flight.at(angularVelocity.time_us).angularVelocity));
+        }
+
+        uint32_t getAccelerationSequence() const{
+            return m_accelerationSequence;
+        }
+    };
+
+    HOST_TEST(SensorEmulators, AltimeterInitializesFromThePROM){
+        std::unique_ptr<SensorRig> rig(new SensorRig);
+        CHECK(rig->altimeter.initialize() == error_t::GOOD);
+        //the PROM has 8 words, a wrong coefficient would show in the first reading
+        CHECK(rig->altimeterDevice.getUnknownCommands() == 0);
+        CHECK(rig->altimeter.updateBlocking() == error_t::GOOD);
+        CHECK_NEAR(rig->altimeter.getLastPressure(), std::round(rig->altimeterDevice.pressure_pa(0)), 0);
+        CHECK_NEAR(rig->altimeter.getLastTemperature(), rig->altimeterDevice.temperature_k(0), 0.01);
+        CHECK(rig->altimeterBackend.getErrors() == 0);
+    }
+
+    HOST_TEST(SensorEmulators, AltimeterInitializeWaitsForAnAsyncCycle){
+        std::unique_ptr<SensorRig> rig(new SensorRig);
+        CHECK(rig->altimeter.initialize() == error_t::GOOD);
+        //a cycle started from the observer interrupt, initialize() has to let its timer and bus interrupts finish it
+        Host::interrupt([&rig](){ rig->altimeter.updateAsync(); });
+        uint32_t sequence = rig->altimeter.getPressureSample().sequence;
+        CHECK(rig->altimeter.initialize() == error_t::GOOD);
+        CHECK(Host::interruptsEnabled());
+        CHECK(rig->altimeter.getPressureSample().sequence == sequence + 1);
+        CHECK(rig->altimeterDevice.getEarlyReads() == 0 && rig->altimeterBackend.getErrors() == 0);
+    }
+
+    HOST_TEST(SensorEmulators, AltimeterFollowsAFlight){
+        std::unique_ptr<SensorRig> rig(new SensorRig);
+        CHECK(rig->altimeter.initialize() == error_t::GOOD);
+        double worstPad = 0, worstPressure = 0, worstTemperature = 0;
+        while(Host::clock.now_us() < 40000000){
+            rig->step(250000);
+            CHECK(rig->altimeter.updateBlocking() == error_t::GOOD);
+            //the pressure is stamped in the middle of its conversion, the temperature is converted after it
+            Sample<float_t> pressure = rig->altimeter.getPressureSample();
+            double error = std::fabs(pressure.value - std::round(rig->altimeterDevice.pressure_pa(rig->flight.at(pressure.time_us).altitude_m)));
+            worstPressure = std::max(worstPressure, error);
+            if(pressure.time_us < 1900000) worstPad = std::max(worstPad, error);
+            worstTemperature = std::max(worstTemperature, static_cast<double>(std::fabs(rig->altimeter.getLastTemperature() - rig->altimeterDevice.temperature_k(rig->flight.at(Host::clock.now_us()).altitude_m))));
+        }
+        HOST_REPORT("pad %.3f Pa, flight worst pressure %.3f Pa, worst temperature %.4f K, apogee %.1f m", worstPad, worstPressure, worstTemperature, rig->flight.getApogee_m());
+        CHECK(worstPad == 0);
+        CHECK(worstPressure <= 5);
+        CHECK(worstTemperature < 0.05);
+        CHECK(rig->altimeterDevice.getEarlyReads() == 0 && rig->altimeterBackend.getErrors() == 0);
+    }
+
+    HOST_TEST(SensorEmulators, IMUInitializesAndConfigures){
+        std::unique_ptr<SensorRig> rig(new SensorRig);
+        CHECK(rig->imu.initialize() == error_t::GOOD);
+        //initialize() returns once the hub is up, the sensors are configured from the main loop
+        CHECK(rig->IMUDevice.getSamplePeriod_us(2) == 0);
+        for(uint_t i=0; i<400 && rig->imu.getState() != IMUStates::Operational; i++) rig->step(500);
+        CHECK(rig->imu.getState() == IMUStates::Operational);
+        for(uint_t sensor=0; sensor<4; sensor++) CHECK(rig->IMUDevice.getSamplePeriod_us(sensor) == 10000);
+        CHECK(rig->IMUDevice.getIgnoredPackets() == 0 && rig->IMUBackend.getErrors() == 0);
+        HOST_REPORT("operational at %u us, %u host packets", static_cast<unsigned>(Host::clock.now_us()), static_cast<unsigned>(rig->IMUDevice.getHostPackets()));
+    }
+
+    HOST_TEST(SensorEmulators, IMUFollowsAFlight){
+        std::unique_ptr<SensorRig> rig(new SensorRig);
+        CHECK(rig->begin() == error_t::GOOD);
+        IMUChecker checker(*rig);
+        uint32_t sent = rig->IMUDevice.getReportsSent();
+        while(Host::clock.now_us() < 40000000){
+            rig->step(1000);
+            checker.check();
+        }
+        HOST_REPORT("%u acceleration samples, worst acceleration %.4f, gravity %.4f, angular velocity %.4f, orientation %.6f, %u packets for %u reports",
+            static_cast<unsigned>(checker.samples), checker.worstAcceleration, checker.worstGravity, checker.worstAngularVelocity, checker.worstOrientation,
+            static_cast<unsigned>(rig->IMUDevice.getPackets()), static_cast<unsigned>(rig->IMUDevice.getReportsSent() - sent));
+        CHECK(checker.gaps == 0 && checker.samples > 3900);
+        CHECK(checker.worstAcceleration < 0.01 && checker.worstGravity < 0.01 && checker.worstAngularVelocity < 0.01);
+        CHECK(checker.worstOrientation < 1e-3);
+        CHECK(rig->IMUDevice.getReportsDropped() == 0 && rig->IMUBackend.getErrors() == 0);
+    }
+
+    HOST_TEST(SensorEmulators, LongBatchesUseRebaseRecords){
+        std::unique_ptr<SensorRig> rig(new SensorRig);
+        CHECK(rig->begin() == error_t::GOOD);
+        //2 s between packets puts the oldest report further back than a delay can reach
+        rig->imu.setSamplePeriod_us(100000);
+        rig->imu.setBatchInterval_us(2000000);
+        for(uint_t i=0; i<20; i++) rig->step(1000);
+        IMUChecker checker(*rig);
+        uint32_t first = checker.getAccelerationSequence();
+        for(uint32_t end = Host::clock.now_us() + 3000000; Host::clock.now_us() < end; ){
+            rig->step(1000);
+            checker.check();
+        }
+        CHECK(checker.getAccelerationSequence() - first >= 20 && checker.gaps == 0);
+        CHECK(checker.worstAcceleration < 0.01);
+        CHECK(rig->IMUDevice.getReportsDropped() == 0);
+    }
+
+    HOST_TEST(SensorEmulators, CorruptedRepliesDoNotStallTheDrivers){
+        std::unique_ptr<SensorRig> rig(new SensorRig);
+        CHECK(rig->begin() == error_t::GOOD);
+        rig->IMUDevice.setCorruption(50, 12345);
+        rig->altimeterDevice.setCorruption(20, 777);
+        uint32_t rejected = 0;
+        for(uint_t i=0; i<200000; i++){
+            rig->step(1000);
+            if(i % 10 == 0 && rig->altimeter.updateBlocking() != error_t::GOOD) rejected++;
+        }
+        HOST_REPORT("imu %u bytes flipped, altimeter %u bytes flipped, %u readings rejected", static_cast<unsigned>(rig->IMUDevice.getCorruptedBytes()),
+            static_cast<unsigned>(rig->altimeterDevice.getCorruptedBytes()), static_cast<unsigned>(rejected));
+        CHECK(rig->IMUDevice.getCorruptedBytes() > 0 && rig->altimeterDevice.getCorruptedBytes() > 0);
+        CHECK(rig->IMUBackend.getErrors() == 0 && rig->altimeterBackend.getErrors() == 0);
+        //clean replies again, the drivers go back to readings that match the flight
+        rig->IMUDevice.setCorruption(0, 0);
+        rig->altimeterDevice.setCorruption(0, 0);
+        for(uint_t i=0; i<2000 && rig->imu.getState() != IMUStates::Operational; i++) rig->step(1000);
+        CHECK(rig->imu.getState() == IMUStates::Operational);
+        CHECK(rig->altimeter.updateBlocking() == error_t::GOOD);
+        IMUChecker checker(*rig);
+        for(uint_t i=0; i<1000; i++){
+            rig->step(1000);
+            checker.check();
+        }
+        CHECK(checker.samples > 90 && checker.worstAcceleration < 0.01);
+        CHECK(rig->IMUBus.idle() && rig->altimeterBus.idle());
+    }
+
+    HOST_TEST(SensorEmulators, Throughput){
+        std::unique_ptr<SensorRig> rig(new SensorRig);
+        CHECK(rig->begin() == error_t::GOOD);
+        //every sensor at the hub's fastest rate, one main loop pass per millisecond
+        rig->imu.setSamplePeriod_us(2500);
+        for(uint_t i=0; i<100; i++) rig->step(1000);
+        uint32_t reports = rig->IMUDevice.getReportsSent();
+        uint32_t packets = rig->IMUDevice.getPackets();
+        uint32_t bytes = rig->IMUBackend.getBytes();
+        constexpr uint32_t c_simulated_us = 60000000;
+        auto start = std::chrono::steady_clock::now();
+        for(uint32_t time = 0; time < c_simulated_us; time += 1000) rig->step(1000);
+        double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        reports = rig->IMUDevice.getReportsSent() - reports;
+        HOST_REPORT("imu: %.0f s simulated in %.3f s (%.0fx real time), %u packets, %u reports, %.0f ns per report with the emulation, %u bytes",
+            c_simulated_us * 1e-6, wall, c_simulated_us * 1e-6 / wall, static_cast<unsigned>(rig->IMUDevice.getPackets() - packets), static_cast<unsigned>(reports),
+            wall * 1e9 / reports, static_cast<unsigned>(rig->IMUBackend.getBytes() - bytes));
+        //400Hz on four sensors
+        CHECK(reports > 4 * 400 * 59 && rig->IMUDevice.getReportsDropped() == 0);
+        uint32_t conversions = rig->altimeterDevice.getConversions();
+        double perReading = HostTest::time_s([&rig](){ rig->altimeter.updateBlocking(); }, 10000);
+        HOST_REPORT("altimeter: %.0f ns per reading, %u conversions", perReading * 1e9, static_cast<unsigned>(rig->altimeterDevice.getConversions() - conversions));
+        CHECK(rig->altimeterDevice.getConversions() - conversions > 10000);
+    }
+}
@@ -0,0 +1,100 @@
+#pragma once
+#include "HostTest.h"
+#include "AirbrakesSensors_Emulator.h"
+#include "airbrakes/AirbrakesSensors_Altimeter.h"
+#include "airbrakes/AirbrakesSensors_IMU.h"
+
+/*Sensor rig
+ * The altimeter and IMU drivers on their own mock buses with the emulators attached, wired to the host simulation like the parts
+ * are wired on the board: the IMU's P0 and reset lines go to its emulator and the emulator's H_INTN line drives the driver's
+ * interrupt pin, so the driver runs its exchanges from the pin interrupt and the deferred work like on the target.
+ * Both emulators fly the same trajectory on Host::clock.
+ *
+ * step() is one main loop pass: time moves, then the driver's background work runs.
+ * Construct it inside a test case, it detaches itself from the host simulation when it goes.
+*/
+
+namespace HostTest{
+    class SensorRig{
+    public:
+        using Clock = RocketOS::Scheduler::SimulatedClock;
+        //pins of src/AirbrakesSensors_Altimeter.cpp and src/AirbrakesSensors_IMU.cpp
+        static constexpr uint8_t c_altimeterSelect = 10;
+        static constexpr uint8_t c_IMUSelect = 38;
+        static constexpr uint8_t c_IMUWake = 29;
+        static constexpr uint8_t c_IMUReset = 33;
+        static constexpr uint8_t c_IMUInterrupt = 25;
+
+        Airbrakes::Sensors::Emulation::FlightTrajectory flight;
+        Airbrakes::SPIBackend_t altimeterBackend;
+        Airbrakes::SPIBackend_t IMUBackend;
+        Airbrakes::SPIBus_t altimeterBus;
+        Airbrakes::SPIBus_t IMUBus;
+        RocketOS::Processing::StandardAtmosphere<> atmosphere;
+        Airbrakes::DeferredWork_t work;
+        Airbrakes::Sensors::MS5607_SPI altimeter;
+        Airbrakes::Sensors::BNO085_SPI imu;
+        Airbrakes::Sensors::Emulation::MS5607Emulator<Clock> altimeterDevice;
+        Airbrakes::Sensors::Emulation::BNO085Emulator<Clock> IMUDevice;
+    private:
+        //H_INTN stays high while the hub is held in reset
+        bool m_IMUInReset;
+        uint32_t m_IMUSelections;
+    public:
+        SensorRig() : flight(2000000, 60, 3, 0.2f, 1.5f), altimeterBus(altimeterBackend), IMUBus(IMUBackend),
+            altimeter("altimeter", atmosphere, altimeterBus, 288.15, 101325, 4000000, 4096, 1024, 8, TeensyTimerTool::TMR1),
+            imu("imu", work, IMUBus, 1000000, 10000, 20000), altimeterDevice(Host::clock, flight, 101325, 288.15), IMUDevice(Host::clock, flight),
+            m_IMUInReset(false), m_IMUSelections(0)
+        {
+            altimeterBackend.attach(c_altimeterSelect, altimeterDevice.device());
+            IMUBackend.attach(c_IMUSelect, IMUDevice.device());
+            Host::watchPin(c_IMUWake, [this](uint8_t level){
+                if(level == LOW) IMUDevice.wake();
+            });
+            Host::watchPin(c_IMUReset, [this](uint8_t level){
+                if(level == LOW){
+                    m_IMUInReset = true;
+                    Host::setPin(c_IMUInterrupt, HIGH);
+                }
+                else if(m_IMUInReset){
+                    m_IMUInReset = false;
+                    IMUDevice.reset();
+                }
+            });
+            Host::attachDevice([this](){
+                if(m_IMUInReset) return;
+                //the hub releases H_INTN when it is selected and asserts it again if it has more to send
+                uint32_t selections = IMUBackend.getSelections(c_IMUSelect);
+                if(selections != m_IMUSelections){
+                    m_IMUSelections = selections;
+                    Host::setPin(c_IMUInterrupt, HIGH);
+                }
+                Host::setPin(c_IMUInterrupt, IMUDevice.interruptAsserted()? LOW : HIGH);
+            });
+            work.begin();
+        }
+
+        ~SensorRig(){
+            Host::reset();
+        }
+
+        SensorRig(const SensorRig&) = delete;
+        SensorRig& operator=(const SensorRig&) = delete;
+
+        void step(uint32_t time_us){
+            Host::advance(time_us);
+            imu.updateBackground();
+        }
+
+        //initializes both drivers and runs the main loop until the IMU has its sensors configured
+        RocketOS::error_t begin(uint32_t timeout_us = 500000){
+            if(altimeter.initialize() != RocketOS::error_t::GOOD || imu.initialize() != RocketOS::error_t::GOOD) return RocketOS::error_t::ERROR;
+            uint32_t start = Host::clock.now_us();
+            while(imu.getState() != Airbrakes::Sensors::IMUStates::Operational){
+                if(Host::clock.now_us() - start > timeout_us) return RocketOS::error_t::ERROR;
+                step(500);
+            }
+            return RocketOS::error_t::GOOD;
+        }
+    };
+}
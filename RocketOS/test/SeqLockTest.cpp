@@ -0,0 +1,98 @@
+#include "HostTest.h"
+#include "utilities/RocketOS_UtilitiesSeqLock.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace{
+    using RocketOS::Utilities::SeqLock;
+    using RocketOS::uint_t;
+
+    //a state the size of the observer's where every field follows from the first, a torn copy breaks the relation
+    struct Snapshot{
+        uint32_t count;
+        float altitude;
+        float verticalVelocity;
+        float angle;
+        uint32_t inverse;
+        uint32_t check;
+
+        static Snapshot make(uint32_t count){
+            return Snapshot{count, static_cast<float>(count), static_cast<float>(count) * 0.5f, static_cast<float>(count & 0xFFFF), ~count, count * 2654435761u};
+        }
+
+        bool consistent() const{
+            Snapshot expected = make(count);
+            return altitude == expected.altitude && verticalVelocity == expected.verticalVelocity && angle == expected.angle
+                && inverse == expected.inverse && check == expected.check;
+        }
+    };
+
+    HOST_TEST(SeqLock, ReadsTheLastWrite){
+        SeqLock<Snapshot> lock(Snapshot::make(1));
+        CHECK(lock.getVersion() == 1 && lock.read().count == 1);
+        lock.write(Snapshot::make(7));
+        Snapshot snapshot{};
+        CHECK(lock.tryRead(snapshot) && snapshot.count == 7 && snapshot.consistent());
+        CHECK(lock.getVersion() == 2);
+    }
+
+    //one writer thread against reader threads, the readers count every copy that is torn or older than one they already saw
+    HOST_TEST(SeqLock, ThreadedReadersNeverSeeATornWrite){
+        constexpr uint32_t c_writes = 2000000;
+        const uint_t readers = std::max(2u, std::min(4u, std::thread::hardware_concurrency()));
+        SeqLock<Snapshot> lock(Snapshot::make(0));
+        std::atomic<bool> done{false};
+        std::atomic<uint32_t> torn{0}, backwards{0}, reads{0}, failedTries{0};
+        std::vector<std::thread> threads;
+        for(uint_t i=0; i<readers; i++){
+            //half the readers use the bounded attempts an interrupt routine would use
+            bool bounded = i % 2;
+            threads.emplace_back([&, bounded](){
+                uint32_t last = 0, count = 0, failed = 0;
+                while(!done.load(std::memory_order_relaxed)){
+                    Snapshot snapshot;
+                    if(bounded){
+                        if(!lock.tryRead(snapshot)){
+                            failed++;
+                            continue;
+                        }
+                    }
+                    else snapshot = lock.read();
+                    if(!snapshot.consistent()) torn++;
+                    if(snapshot.count < last) backwards++;
+                    last = snapshot.count;
+                    count++;
+                }
+                reads += count;
+                failedTries += failed;
+            });
+        }
+        for(uint32_t i=1; i<=c_writes; i++) lock.write(Snapshot::make(i));
+        done = true;
+        for(std::thread& thread : threads) thread.join();
+        HOST_REPORT("%u writes, %u reads by %u readers, %u bounded reads gave up", c_writes, reads.load(), readers, failedTries.load());
+        CHECK(torn == 0 && backwards == 0);
+        CHECK(reads > 0);
+        CHECK(lock.getVersion() == c_writes + 1 && lock.read().count == c_writes);
+    }
+
+    HOST_TEST(SeqLock, Benchmark){
+        constexpr uint32_t c_calls = 1000000;
+        SeqLock<Snapshot> lock(Snapshot::make(0));
+        Snapshot snapshot = Snapshot::make(1);
+        volatile uint32_t sink = 0;
+        double write = HostTest::time_s([&](){ lock.write(snapshot); }, c_calls);
+        double read = HostTest::time_s([&](){ sink = sink + lock.read().count; }, c_calls);
+        //the same read while another core keeps writing, every write invalidates the reader's cache line
+        std::atomic<bool> done{false};
+        std::thread writer([&](){
+            for(uint32_t i=0; !done.load(std::memory_order_relaxed); i++) lock.write(Snapshot::make(i));
+        });
+        double contended = HostTest::time_s([&](){ sink = sink + lock.read().count; }, c_calls);
+        done = true;
+        writer.join();
+        HOST_REPORT("%zu byte value: write %.2f ns, read %.2f ns, read under a writing thread %.2f ns", sizeof(Snapshot), write * 1e9, read * 1e9, contended * 1e9);
+        CHECK(write > 0 && read > 0 && contended > 0);
+    }
+}
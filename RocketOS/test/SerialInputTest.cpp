@@ -0,0 +1,97 @@
+#include "HostTest.h"
+#include "RocketOSSerial.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace{
+    using RocketOS::SerialInput;
+    using RocketOS::error_t;
+    using RocketOS::uint_t;
+
+    //reads every queued line out of the input
+    void takeLines(SerialInput& input, std::vector<std::string>& lines){
+        for(; input.hasData(); input.clear()) lines.push_back(&input[0]);
+    }
+
+    //commands and HIL lines the way a ground station sends them, mixing both terminators
+    std::string traffic(uint_t numLines, std::vector<std::string>& lines){
+        std::string stream;
+        for(uint_t i=0; i<numLines; i++){
+            std::string line = (i % 4 == 0) ? ">sim refresh set " + std::to_string(i) : "HIL," + std::to_string(i * 7) + ".25," + std::to_string(i) + ".5,-9.80665,1013.25";
+            stream += line + ((i % 3 == 0) ? "\r\n" : "\n");
+            lines.push_back(line);
+        }
+        return stream;
+    }
+
+    HOST_TEST(SerialInput, FragmentedInputAssemblesTheSameLines){
+        std::vector<std::string> expected;
+        std::string stream = traffic(500, expected);
+        //fragment lengths from a fixed LCG, from single bytes to several lines at once
+        for(uint32_t seed : {1u, 7u, 12345u}){
+            std::unique_ptr<SerialInput> input(new SerialInput(115200));
+            std::vector<std::string> lines;
+            uint32_t state = seed;
+            for(size_t position = 0; position < stream.size();){
+                state = state * 1664525u + 1013904223u;
+                size_t length = std::min<size_t>(1 + (state >> 16) % 150, stream.size() - position);
+                Host::serialInput(stream.substr(position, length));
+                position += length;
+                CHECK(input->update() == error_t::GOOD);
+                takeLines(*input, lines);
+            }
+            CHECK(lines == expected);
+            CHECK(input->getOverflows() == 0);
+        }
+    }
+
+    HOST_TEST(SerialInput, FullLineQueueLeavesTheRestInSerial){
+        std::unique_ptr<SerialInput> input(new SerialInput(115200));
+        Host::serialInput("a\nb\nc\nd\ne\nf\n");
+        input->update();
+        CHECK(input->linesQueued() == RocketOS_CFG_SerialRxLineQueueDepth);
+        CHECK(Serial.available() > 0);
+        std::vector<std::string> lines;
+        takeLines(*input, lines);
+        input->update();
+        takeLines(*input, lines);
+        CHECK((lines == std::vector<std::string>{"a", "b", "c", "d", "e", "f"}));
+    }
+
+    HOST_TEST(SerialInput, LongLinesAreDroppedToTheirTerminator){
+        std::unique_ptr<SerialInput> input(new SerialInput(115200));
+        Host::serialInput(std::string(RocketOS_CFG_SerialRxBufferSize + 10, 'x'));
+        CHECK(input->update() == error_t::ERROR);
+        //the rest of the long line arrives later, the line after it is kept
+        Host::serialInput(std::string(300, 'y') + "\nok\n");
+        input->update();
+        std::vector<std::string> lines;
+        takeLines(*input, lines);
+        CHECK(lines == std::vector<std::string>{"ok"});
+        CHECK(input->getOverflows() == 1);
+    }
+
+    //HIL traffic arriving in USB packet sized pieces while the loop keeps polling, update() must not wait for the rest of a line
+    HOST_TEST(SerialInput, UpdateNeverWaitsUnderHILTraffic){
+        std::vector<std::string> expected;
+        std::string stream = traffic(20000, expected);
+        std::unique_ptr<SerialInput> input(new SerialInput(115200));
+        std::vector<std::string> lines;
+        double worst_s = 0, total_s = 0;
+        uint32_t calls = 0, clockMoved = 0;
+        for(size_t position = 0; position < stream.size(); position += 64){
+            Host::serialInput(stream.substr(position, 64));
+            uint32_t before = Host::clock.now_us();
+            double call_s = HostTest::time_s([&input](){ input->update(); });
+            if(Host::clock.now_us() != before) clockMoved++;
+            worst_s = std::fmax(worst_s, call_s);
+            total_s += call_s;
+            calls++;
+            takeLines(*input, lines);
+        }
+        HOST_REPORT("%zu bytes in 64 byte pieces: update() %.2f us mean, %.2f us worst (host)", stream.size(), total_s / calls * 1e6, worst_s * 1e6);
+        CHECK(clockMoved == 0);
+        CHECK(lines == expected);
+    }
+}
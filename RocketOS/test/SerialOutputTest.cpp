@@ -0,0 +1,107 @@
+#include "HostTest.h"
+#include "ApplicationRig.h"
+#include "RocketOSSerial.h"
+#include <array>
+#include <set>
+#include <sstream>
+#include <string>
+
+namespace{
+    using RocketOS::OutputLane;
+    using RocketOS::SerialOutput;
+    using RocketOS::error_t;
+    using RocketOS::uint_t;
+
+    //a HIL lane and a console lane of their own, in the application's priority order
+    struct Lanes{
+        std::array<char, 64> hilBuffer;
+        std::array<char, 128> consoleBuffer;
+        OutputLane hil;
+        OutputLane console;
+        SerialOutput<2> output;
+
+        Lanes() : hil("hil", hilBuffer.data(), hilBuffer.size()), console("console", consoleBuffer.data(), consoleBuffer.size()), output({&hil, &console}) {}
+
+        void frame(const std::string& frame){
+            hil.writeFrame(frame.data(), frame.size());
+        }
+
+        //gives the port the given number of bytes of space and lets the output fill it
+        void drain(int bytes){
+            Host::setSerialWriteSpace(bytes);
+            output.update();
+        }
+    };
+
+    HOST_TEST(SerialOutput, HILFramesGoAheadOfShellText){
+        Lanes lanes;
+        lanes.console.print("shell text\n");
+        lanes.frame("HIL,1\n");
+        lanes.drain(100);
+        CHECK(Host::takeSerialOutput() == "HIL,1\nshell text\n");
+    }
+
+    HOST_TEST(SerialOutput, LinesAreNotInterleavedOrCutShort){
+        Lanes lanes;
+        lanes.console.print("a console line\n");
+        //the port takes five bytes at a time, the console line has started when the frame arrives
+        lanes.drain(5);
+        lanes.frame("HIL,2\n");
+        lanes.console.print("partial");
+        for(uint_t i=0; i<10; i++) lanes.drain(5);
+        //the open console line finishes first, the unterminated text waits for its newline
+        CHECK(Host::takeSerialOutput() == "a console line\nHIL,2\n");
+        lanes.console.print(" line\n");
+        lanes.drain(100);
+        CHECK(Host::takeSerialOutput() == "partial line\n");
+    }
+
+    HOST_TEST(SerialOutput, SaturationDropsWholeLinesAndNeverBlocks){
+        Lanes lanes;
+        Host::setSerialWriteSpace(0);
+        std::set<std::string> sent;
+        uint_t framesRefused = 0;
+        for(uint_t i=0; i<100; i++){
+            std::string line = "console " + std::to_string(i) + "\n";
+            std::string frame = "HIL," + std::to_string(i) + "\n";
+            lanes.console.print(line.c_str());
+            if(lanes.hil.writeFrame(frame.data(), frame.size()) != error_t::GOOD) framesRefused++;
+            sent.insert(line);
+            sent.insert(frame);
+            //a slow port, every few lines it takes a few bytes
+            lanes.drain(i % 5 == 0 ? 7 : 0);
+        }
+        lanes.drain(100000);
+        //nothing was written past the space the port reported
+        CHECK(Host::getSerialOverruns() == 0);
+        CHECK(lanes.console.getDropped() > 0 && framesRefused > 0 && lanes.hil.getDropped() > 0);
+        CHECK(lanes.console.getBuffered() == 0 && lanes.hil.getBuffered() == 0);
+        //every line that came out is one that went in, whole
+        std::istringstream output(Host::takeSerialOutput());
+        uint_t received = 0, unknown = 0;
+        for(std::string line; std::getline(output, line); received++)
+            if(sent.count(line + "\n") == 0) unknown++;
+        CHECK(unknown == 0 && received > 0 && received < 200);
+        CHECK(lanes.hil.getPeak() <= lanes.hil.getSize() && lanes.console.getPeak() <= lanes.console.getSize());
+    }
+
+    HOST_TEST(SerialOutput, LineLongerThanTheRingSendsWhatFit){
+        Lanes lanes;
+        std::string line(200, 'x');
+        lanes.console.println(line.c_str());
+        lanes.drain(1000);
+        std::string output = Host::takeSerialOutput();
+        CHECK(output == std::string(128, 'x'));
+        CHECK(lanes.console.getDropped() > 0);
+        lanes.console.print("next\n");
+        lanes.drain(1000);
+        CHECK(Host::takeSerialOutput() == "next\n");
+    }
+
+    HOST_TEST(SerialOutput, ShellShowsTheLaneCounters){
+        HostTest::ApplicationRig rig;
+        std::string table = rig.command("serial");
+        CHECK(table.find("dropped") != std::string::npos);
+        CHECK(table.find("hil") != std::string::npos && table.find("console") != std::string::npos);
+    }
+}
@@ -0,0 +1,182 @@
+#pragma once
+/*Arduino core for host builds
+ * Declares the part of the Teensy core the firmware uses, so the RocketOS and Airbrakes sources compile and run on Linux.
+ * Time, pins, timers and the serial port are simulated, see Host.h for how a test drives them.
+*/
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <cstdarg>
+#include <algorithm>
+
+#define PI 3.1415926535897932384626433832795
+#define HALF_PI 1.5707963267948966192313216916398
+#define TWO_PI 6.283185307179586476925286766559
+#define DEG_TO_RAD 0.017453292519943295769236907684886
+#define RAD_TO_DEG 57.295779513082320876798154814105
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define INPUT_PULLDOWN 3
+#define FALLING 2
+#define RISING 3
+#define CHANGE 4
+
+#define DMAMEM
+#define EXTMEM
+#define FASTRUN
+#define FLASHMEM
+#define PROGMEM
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+//the cycle counter runs off the host's steady clock at F_CPU_ACTUAL, so cycle timers measure host execution time
+uint32_t hostCycleCount();
+#define ARM_DWT_CYCCNT (hostCycleCount())
+extern uint32_t F_CPU_ACTUAL;
+
+void __disable_irq();
+void __enable_irq();
+void noInterrupts();
+void interrupts();
+
+// --- time ---
+uint32_t micros();
+uint32_t millis();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void delayNanoseconds(uint32_t ns);
+
+class elapsedMillis{
+private:
+    uint32_t m_start;
+public:
+    elapsedMillis() : m_start(millis()) {}
+    elapsedMillis(uint32_t value) : m_start(millis() - value) {}
+    operator uint32_t() const{ return millis() - m_start; }
+    elapsedMillis& operator=(uint32_t value){ m_start = millis() - value; return *this; }
+};
+
+class elapsedMicros{
+private:
+    uint32_t m_start;
+public:
+    elapsedMicros() : m_start(micros()) {}
+    elapsedMicros(uint32_t value) : m_start(micros() - value) {}
+    operator uint32_t() const{ return micros() - m_start; }
+    elapsedMicros& operator=(uint32_t value){ m_start = micros() - value; return *this; }
+};
+
+// --- pins ---
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t level);
+uint8_t digitalRead(uint8_t pin);
+void digitalWriteFast(uint8_t pin, uint8_t level);
+uint8_t digitalReadFast(uint8_t pin);
+void digitalToggleFast(uint8_t pin);
+void attachInterrupt(uint8_t pin, void (*function)(void), int mode);
+void detachInterrupt(uint8_t pin);
+#define digitalPinToInterrupt(p) (p)
+
+// --- math helpers ---
+//mixed signedness compares like the Teensy core's min and max
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wsign-compare"
+template<class A, class B> constexpr auto min(const A& a, const B& b) -> decltype(a < b ? a : b){ return a < b ? a : b; }
+template<class A, class B> constexpr auto max(const A& a, const B& b) -> decltype(a < b ? b : a){ return a < b ? b : a; }
+#pragma GCC diagnostic pop
+template<class T> T constrain(T x, T low, T high){ return x < low ? low : (x > high ? high : x); }
+inline double pow10(double x){ return pow(10.0, x); }
+inline float pow10f(float x){ return powf(10.0f, x); }
+
+// --- printing ---
+class Print{
+public:
+    virtual ~Print() = default;
+    virtual size_t write(uint8_t) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size);
+    size_t write(const char* string){ return write(reinterpret_cast<const uint8_t*>(string), strlen(string)); }
+    virtual int availableForWrite(){ return 0; }
+    virtual void flush(){}
+
+    size_t print(const char*);
+    size_t print(char);
+    size_t print(int, int = DEC);
+    size_t print(unsigned int, int = DEC);
+    size_t print(long, int = DEC);
+    size_t print(unsigned long, int = DEC);
+    size_t print(long long, int = DEC);
+    size_t print(unsigned long long, int = DEC);
+    size_t print(double, int = 2);
+    size_t println();
+    size_t println(const char*);
+    size_t println(char);
+    size_t println(int, int = DEC);
+    size_t println(unsigned int, int = DEC);
+    size_t println(long, int = DEC);
+    size_t println(unsigned long, int = DEC);
+    size_t println(long long, int = DEC);
+    size_t println(unsigned long long, int = DEC);
+    size_t println(double, int = 2);
+    int printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+};
+
+class Stream : public Print{
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+    void setTimeout(unsigned long){}
+    size_t readBytes(char* buffer, size_t length);
+    size_t readBytesUntil(char terminator, char* buffer, size_t length);
+};
+
+//the USB serial port, input is injected and output captured through Host.h
+class usb_serial_class : public Stream{
+public:
+    void begin(long){}
+    size_t write(uint8_t) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    using Print::write;
+    int availableForWrite() override;
+    int available() override;
+    int read() override;
+    int peek() override;
+    operator bool(){ return true; }
+};
+extern usb_serial_class Serial;
+
+// --- software interrupts ---
+/*EventResponder
+ * attachInterrupt() handlers run like the Teensy software interrupt: right away from the main loop, or once the simulated
+ * interrupt that triggered them returns.
+*/
+class EventResponder;
+typedef EventResponder& EventResponderRef;
+class EventResponder{
+private:
+    void (*m_function)(EventResponderRef);
+    void* m_context;
+    bool m_pending;
+public:
+    EventResponder() : m_function(nullptr), m_context(nullptr), m_pending(false) {}
+    ~EventResponder();
+    void attach(void (*function)(EventResponderRef));
+    void attachInterrupt(void (*function)(EventResponderRef));
+    void attachImmediate(void (*function)(EventResponderRef));
+    void setContext(void* context){ m_context = context; }
+    void* getContext(){ return m_context; }
+    void clearEvent(){ m_pending = false; }
+    void triggerEvent(int = 0, void* = nullptr);
+    //runs the handler if the event is pending, returns true if it ran
+    bool run();
+};
@@ -0,0 +1,28 @@
+#pragma once
+#include <Arduino.h>
+#include <array>
+
+//emulated EEPROM of the Teensy 4.1, erased (0xFF) at startup
+class EEPROMClass{
+private:
+    std::array<uint8_t, 4284> m_memory;
+public:
+    EEPROMClass(){ m_memory.fill(0xFF); }
+    uint8_t read(int address){ return m_memory.at(address); }
+    void write(int address, uint8_t value){ m_memory.at(address) = value; }
+    void update(int address, uint8_t value){ write(address, value); }
+    uint16_t length(){ return m_memory.size(); }
+
+    template<class T>
+    T& get(int address, T& value){
+        memcpy(&value, &m_memory.at(address + sizeof(T) - 1) - (sizeof(T) - 1), sizeof(T));
+        return value;
+    }
+
+    template<class T>
+    const T& put(int address, const T& value){
+        memcpy(&m_memory.at(address + sizeof(T) - 1) - (sizeof(T) - 1), &value, sizeof(T));
+        return value;
+    }
+};
+extern EEPROMClass EEPROM;
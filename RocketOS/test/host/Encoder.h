@@ -0,0 +1,13 @@
+#pragma once
+#include <Arduino.h>
+
+//quadrature encoder, the count only changes when the test writes it
+class Encoder{
+private:
+    int32_t m_position;
+public:
+    Encoder(uint8_t, uint8_t) : m_position(0) {}
+    int32_t read(){ return m_position; }
+    void write(int32_t position){ m_position = position; }
+    int32_t readAndReset(){ int32_t position = m_position; m_position = 0; return position; }
+};
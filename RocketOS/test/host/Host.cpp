@@ -0,0 +1,567 @@
+#include "Host.h"
+#include "HostTimer.h"
+#include <IntervalTimer.h>
+#include <TeensyTimerTool.h>
+#include <SPI.h>
+#include <SdFat.h>
+#include <EEPROM.h>
+#include <array>
+#include <chrono>
+#include <deque>
+#include <vector>
+
+uint32_t F_CPU_ACTUAL = 600000000;
+usb_serial_class Serial;
+SPIClass SPI, SPI1, SPI2;
+EEPROMClass EEPROM;
+
+namespace{
+    struct InterruptHandler{
+        void (*function)(void);
+        int mode;
+    };
+
+    struct State{
+        uint32_t depth = 0;
+        bool masked = false;
+        std::vector<Host::Timer*> timers;
+        std::vector<EventResponder*> events;
+        std::array<uint8_t, 64> pins{};
+        std::array<InterruptHandler, 64> handlers{};
+        std::array<std::function<void(uint8_t)>, 64> watchers{};
+        std::array<bool, 64> pendingEdges{};
+        std::vector<std::function<void()>> devices;
+        bool updatingDevices = false;
+        uint32_t idleReads = 0;
+        std::deque<char> serialIn;
+        std::string serialOut;
+        int serialSpace = -1;
+        uint32_t serialOverruns = 0;
+        std::string sdRoot;
+    };
+
+    //constructed on first use, timers and responders register from static constructors
+    State& state(){
+        static State s;
+        return s;
+    }
+
+    void updateDevices(){
+        State& s = state();
+        if(s.updatingDevices) return;
+        s.updatingDevices = true;
+        for(const std::function<void()>& device : s.devices) device();
+        s.updatingDevices = false;
+    }
+
+    //runs the pin and software interrupts that came in while they could not run
+    void runPending(){
+        State& s = state();
+        if(s.depth > 0 || s.masked) return;
+        for(size_t pin=0; pin<s.pendingEdges.size(); pin++){
+            if(!s.pendingEdges[pin]) continue;
+            s.pendingEdges[pin] = false;
+            if(s.handlers[pin].function != nullptr) Host::interrupt(s.handlers[pin].function);
+        }
+        while(s.depth == 0 && !s.masked && !s.events.empty()){
+            EventResponder* event = s.events.front();
+            s.events.erase(s.events.begin());
+            Host::interrupt([event](){ event->run(); });
+        }
+    }
+
+    std::string sdPath(const char* path){
+        return state().sdRoot + "/" + path;
+    }
+}
+
+namespace Host{
+    RocketOS::Scheduler::SimulatedClock clock;
+
+    void advance(uint32_t time_us){
+        State& s = state();
+        uint32_t target = clock.now_us() + time_us;
+        //a delay inside an interrupt or a critical section only moves time, the timers fire late once the main loop runs again
+        if(s.depth > 0 || s.masked){
+            clock.set(target);
+            return;
+        }
+        s.idleReads = 0;
+        while(true){
+            updateDevices();
+            Timer* next = nullptr;
+            for(Timer* timer : s.timers){
+                if(!timer->armed() || static_cast<int32_t>(timer->due_us() - target) > 0) continue;
+                if(next == nullptr || static_cast<int32_t>(timer->due_us() - next->due_us()) < 0) next = timer;
+            }
+            if(next == nullptr) break;
+            if(static_cast<int32_t>(next->due_us() - clock.now_us()) > 0) clock.set(next->due_us());
+            next->fire();
+        }
+        clock.set(target);
+        updateDevices();
+    }
+
+    void interrupt(const std::function<void()>& function){
+        State& s = state();
+        bool masked = s.masked;
+        s.depth++;
+        function();
+        s.depth--;
+        s.masked = masked;
+        runPending();
+    }
+
+    bool inInterrupt(){
+        return state().depth > 0;
+    }
+
+    bool interruptsEnabled(){
+        return !state().masked;
+    }
+
+    void setPin(uint8_t pin, uint8_t level){
+        State& s = state();
+        uint8_t previous = s.pins.at(pin);
+        s.pins.at(pin) = level;
+        const InterruptHandler& handler = s.handlers.at(pin);
+        if(handler.function == nullptr) return;
+        bool rising = previous == LOW && level == HIGH;
+        bool falling = previous == HIGH && level == LOW;
+        if(!((handler.mode == RISING && rising) || (handler.mode == FALLING && falling) || (handler.mode == CHANGE && (rising || falling)))) return;
+        //the edge is latched until the handler can run
+        s.pendingEdges.at(pin) = true;
+        runPending();
+    }
+
+    uint8_t getPin(uint8_t pin){
+        return state().pins.at(pin);
+    }
+
+    void attachDevice(std::function<void()> update){
+        state().devices.push_back(update);
+        update();
+    }
+
+    void watchPin(uint8_t pin, std::function<void(uint8_t)> watcher){
+        state().watchers.at(pin) = watcher;
+    }
+
+    void serialInput(const char* data, size_t length){
+        state().serialIn.insert(state().serialIn.end(), data, data + length);
+    }
+
+    void serialInput(const std::string& data){
+        serialInput(data.data(), data.size());
+    }
+
+    std::string takeSerialOutput(){
+        std::string output;
+        output.swap(state().serialOut);
+        return output;
+    }
+
+    void setSerialWriteSpace(int bytes){
+        state().serialSpace = bytes;
+    }
+
+    uint32_t getSerialOverruns(){
+        return state().serialOverruns;
+    }
+
+    void setSDRoot(const std::string& directory){
+        state().sdRoot = directory;
+    }
+
+    void reset(){
+        State& s = state();
+        for(Timer* timer : s.timers) timer->disarm();
+        s.depth = 0;
+        s.masked = false;
+        s.events.clear();
+        s.pins.fill(LOW);
+        s.handlers.fill(InterruptHandler{nullptr, 0});
+        for(auto& watcher : s.watchers) watcher = nullptr;
+        s.pendingEdges.fill(false);
+        s.devices.clear();
+        s.idleReads = 0;
+        s.serialIn.clear();
+        s.serialOut.clear();
+        s.serialSpace = -1;
+        s.serialOverruns = 0;
+        clock.set(0);
+    }
+
+    // --- timers ---
+    Timer::Timer() : m_due_us(0), m_period_us(0), m_armed(false){
+        state().timers.push_back(this);
+    }
+
+    Timer::~Timer(){
+        std::vector<Timer*>& timers = state().timers;
+        timers.erase(std::remove(timers.begin(), timers.end(), this), timers.end());
+    }
+
+    void Timer::arm(std::function<void()> callback, uint32_t delay_us, uint32_t period_us){
+        m_callback = callback;
+        m_due_us = clock.now_us() + delay_us;
+        m_period_us = period_us;
+        m_armed = true;
+    }
+
+    void Timer::disarm(){
+        m_armed = false;
+    }
+
+    void Timer::fire(){
+        if(m_period_us > 0) m_due_us += m_period_us;
+        else m_armed = false;
+        std::function<void()> callback = m_callback;
+        interrupt(callback);
+    }
+}
+
+// --- core ---
+uint32_t hostCycleCount(){
+    static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    uint64_t elapsed_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    return static_cast<uint32_t>(elapsed_ns * (F_CPU_ACTUAL / 1000000) / 1000);
+}
+
+void __disable_irq(){
+    state().masked = true;
+}
+
+void __enable_irq(){
+    state().masked = false;
+    runPending();
+}
+
+void noInterrupts(){
+    __disable_irq();
+}
+
+void interrupts(){
+    __enable_irq();
+}
+
+namespace{
+    //a read from the main loop lets the devices answer, and lets time pass once the loop is busy waiting
+    uint32_t readClock(){
+        State& s = state();
+        if(s.depth == 0 && !s.masked){
+            updateDevices();
+            if(s.idleReads < 1000) s.idleReads++;
+            else{
+                Host::advance(1);
+                s.idleReads = 1000;
+            }
+        }
+        return Host::clock.now_us();
+    }
+}
+
+uint32_t micros(){
+    return readClock();
+}
+
+uint32_t millis(){
+    return readClock() / 1000;
+}
+
+void delay(uint32_t ms){
+    Host::advance(ms * 1000);
+}
+
+void delayMicroseconds(uint32_t us){
+    Host::advance(us);
+}
+
+void delayNanoseconds(uint32_t){}
+
+void pinMode(uint8_t pin, uint8_t mode){
+    if(mode == INPUT_PULLUP) state().pins.at(pin) = HIGH;
+}
+
+void digitalWrite(uint8_t pin, uint8_t level){
+    State& s = state();
+    s.pins.at(pin) = level;
+    if(s.watchers.at(pin)) s.watchers.at(pin)(level);
+}
+
+uint8_t digitalRead(uint8_t pin){
+    return state().pins.at(pin);
+}
+
+void digitalWriteFast(uint8_t pin, uint8_t level){
+    digitalWrite(pin, level);
+}
+
+uint8_t digitalReadFast(uint8_t pin){
+    return digitalRead(pin);
+}
+
+void digitalToggleFast(uint8_t pin){
+    digitalWrite(pin, !digitalRead(pin));
+}
+
+void attachInterrupt(uint8_t pin, void (*function)(void), int mode){
+    state().handlers.at(pin) = InterruptHandler{function, mode};
+}
+
+void detachInterrupt(uint8_t pin){
+    state().handlers.at(pin) = InterruptHandler{nullptr, 0};
+}
+
+// --- software interrupts ---
+EventResponder::~EventResponder(){
+    std::vector<EventResponder*>& events = state().events;
+    events.erase(std::remove(events.begin(), events.end(), this), events.end());
+}
+
+void EventResponder::attach(void (*function)(EventResponderRef)){
+    m_function = function;
+}
+
+void EventResponder::attachInterrupt(void (*function)(EventResponderRef)){
+    m_function = function;
+}
+
+void EventResponder::attachImmediate(void (*function)(EventResponderRef)){
+    m_function = function;
+}
+
+void EventResponder::triggerEvent(int, void*){
+    if(m_pending) return;
+    m_pending = true;
+    state().events.push_back(this);
+    runPending();
+}
+
+bool EventResponder::run(){
+    if(!m_pending) return false;
+    m_pending = false;
+    if(m_function != nullptr) m_function(*this);
+    return true;
+}
+
+// --- printing ---
+size_t Print::write(const uint8_t* buffer, size_t size){
+    size_t written = 0;
+    while(size--) written += write(*buffer++);
+    return written;
+}
+
+namespace{
+    size_t printNumber(Print& out, unsigned long long value, int base, bool negative){
+        char buffer[72];
+        char* digit = buffer + sizeof(buffer);
+        *--digit = '\0';
+        if(base < 2) base = DEC;
+        do{
+            int remainder = value % base;
+            *--digit = remainder < 10 ? '0' + remainder : 'A' + remainder - 10;
+            value /= base;
+        }while(value > 0);
+        if(negative) *--digit = '-';
+        return out.write(digit);
+    }
+
+    size_t printSigned(Print& out, long long value, int base){
+        if(base == DEC && value < 0) return printNumber(out, -static_cast<unsigned long long>(value), base, true);
+        return printNumber(out, static_cast<unsigned long long>(value), base, false);
+    }
+}
+
+size_t Print::print(const char* string){ return write(string); }
+size_t Print::print(char character){ return write(static_cast<uint8_t>(character)); }
+size_t Print::print(int value, int base){ return printSigned(*this, value, base); }
+size_t Print::print(unsigned int value, int base){ return printNumber(*this, value, base, false); }
+size_t Print::print(long value, int base){ return printSigned(*this, value, base); }
+size_t Print::print(unsigned long value, int base){ return printNumber(*this, value, base, false); }
+size_t Print::print(long long value, int base){ return printSigned(*this, value, base); }
+size_t Print::print(unsigned long long value, int base){ return printNumber(*this, value, base, false); }
+
+size_t Print::print(double value, int digits){
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "%.*f", digits, value);
+    return write(buffer);
+}
+
+size_t Print::println(){ return write("\r\n"); }
+size_t Print::println(const char* string){ return print(string) + println(); }
+size_t Print::println(char character){ return print(character) + println(); }
+size_t Print::println(int value, int base){ return print(value, base) + println(); }
+size_t Print::println(unsigned int value, int base){ return print(value, base) + println(); }
+size_t Print::println(long value, int base){ return print(value, base) + println(); }
+size_t Print::println(unsigned long value, int base){ return print(value, base) + println(); }
+size_t Print::println(long long value, int base){ return print(value, base) + println(); }
+size_t Print::println(unsigned long long value, int base){ return print(value, base) + println(); }
+size_t Print::println(double value, int digits){ return print(value, digits) + println(); }
+
+int Print::printf(const char* format, ...){
+    va_list arguments;
+    va_start(arguments, format);
+    va_list copy;
+    va_copy(copy, arguments);
+    int length = vsnprintf(nullptr, 0, format, copy);
+    va_end(copy);
+    std::string buffer(length > 0 ? length + 1 : 1, '\0');
+    vsnprintf(&buffer[0], buffer.size(), format, arguments);
+    va_end(arguments);
+    if(length > 0) write(reinterpret_cast<const uint8_t*>(buffer.data()), length);
+    return length;
+}
+
+size_t Stream::readBytes(char* buffer, size_t length){
+    size_t count = 0;
+    while(count < length && available() > 0) buffer[count++] = static_cast<char>(read());
+    return count;
+}
+
+size_t Stream::readBytesUntil(char terminator, char* buffer, size_t length){
+    size_t count = 0;
+    while(count < length && available() > 0){
+        char c = static_cast<char>(read());
+        if(c == terminator) break;
+        buffer[count++] = c;
+    }
+    return count;
+}
+
+// --- serial ---
+size_t usb_serial_class::write(uint8_t byte){
+    State& s = state();
+    if(s.serialSpace == 0) s.serialOverruns++;
+    else if(s.serialSpace > 0) s.serialSpace--;
+    s.serialOut.push_back(static_cast<char>(byte));
+    return 1;
+}
+
+size_t usb_serial_class::write(const uint8_t* buffer, size_t size){
+    for(size_t i=0; i<size; i++) write(buffer[i]);
+    return size;
+}
+
+int usb_serial_class::availableForWrite(){
+    return state().serialSpace < 0 ? 1 << 20 : state().serialSpace;
+}
+
+int usb_serial_class::available(){
+    return state().serialIn.size();
+}
+
+int usb_serial_class::read(){
+    State& s = state();
+    if(s.serialIn.empty()) return -1;
+    char c = s.serialIn.front();
+    s.serialIn.pop_front();
+    return static_cast<uint8_t>(c);
+}
+
+int usb_serial_class::peek(){
+    return state().serialIn.empty() ? -1 : static_cast<uint8_t>(state().serialIn.front());
+}
+
+// --- SD card ---
+bool FsFile::open(const char* path, int flags){
+    close();
+    if(state().sdRoot.empty()) return false;
+    std::string file = sdPath(path);
+    if((flags & O_RDWR) == O_RDONLY) m_file = fopen(file.c_str(), "rb");
+    else if(flags & O_TRUNC) m_file = fopen(file.c_str(), "w+b");
+    else if(flags & O_AT_END) m_file = fopen(file.c_str(), (flags & O_CREAT) ? "a+b" : "r+b");
+    else{
+        m_file = fopen(file.c_str(), "r+b");
+        if(m_file == nullptr && (flags & O_CREAT)) m_file = fopen(file.c_str(), "w+b");
+    }
+    return m_file != nullptr;
+}
+
+bool FsFile::close(){
+    if(m_file == nullptr) return false;
+    fclose(m_file);
+    m_file = nullptr;
+    return true;
+}
+
+size_t FsFile::write(uint8_t byte){
+    return write(&byte, 1);
+}
+
+size_t FsFile::write(const uint8_t* buffer, size_t size){
+    return m_file != nullptr ? fwrite(buffer, 1, size, m_file) : 0;
+}
+
+int FsFile::available(){
+    if(m_file == nullptr) return 0;
+    long position = ftell(m_file);
+    return static_cast<int>(size() - position);
+}
+
+int FsFile::read(){
+    if(m_file == nullptr) return -1;
+    int c = fgetc(m_file);
+    return c == EOF ? -1 : c;
+}
+
+int FsFile::peek(){
+    if(m_file == nullptr) return -1;
+    int c = fgetc(m_file);
+    if(c == EOF) return -1;
+    ungetc(c, m_file);
+    return c;
+}
+
+int FsFile::read(void* buffer, size_t length){
+    return m_file != nullptr ? static_cast<int>(fread(buffer, 1, length, m_file)) : -1;
+}
+
+bool FsFile::sync(){
+    return m_file != nullptr && fflush(m_file) == 0;
+}
+
+bool FsFile::seek(uint64_t position){
+    return m_file != nullptr && fseek(m_file, static_cast<long>(position), SEEK_SET) == 0;
+}
+
+uint64_t FsFile::size(){
+    if(m_file == nullptr) return 0;
+    long position = ftell(m_file);
+    fseek(m_file, 0, SEEK_END);
+    long end = ftell(m_file);
+    fseek(m_file, position, SEEK_SET);
+    return static_cast<uint64_t>(end);
+}
+
+bool SdFat::begin(SdioConfig){
+    return !state().sdRoot.empty();
+}
+
+FsFile SdFat::open(const char* path, int flags){
+    FsFile file;
+    file.open(path, flags);
+    return file;
+}
+
+bool SdFat::exists(const char* path){
+    FILE* file = fopen(sdPath(path).c_str(), "rb");
+    if(file == nullptr) return false;
+    fclose(file);
+    return true;
+}
+
+bool SdFat::remove(const char* path){
+    return ::remove(sdPath(path).c_str()) == 0;
+}
+
+// --- timer generators ---
+namespace TeensyTimerTool{
+    void* TMR1(){ return nullptr; }
+    void* TMR2(){ return nullptr; }
+    void* TMR3(){ return nullptr; }
+    void* TMR4(){ return nullptr; }
+    void* GPT1(){ return nullptr; }
+    void* GPT2(){ return nullptr; }
+    void* TCK(){ return nullptr; }
+}
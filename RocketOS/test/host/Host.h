@@ -0,0 +1,53 @@
+#pragma once
+#include <Arduino.h>
+#include "scheduler/RocketOS_SchedulerClock.h"
+#include <functional>
+#include <string>
+
+/*Host simulation
+ * Test side control of the Arduino stand-ins in this directory. Everything runs on one thread:
+ *
+ * Time - micros(), millis() and delay() read and move clock, a RocketOS::Scheduler::SimulatedClock. advance() moves it and fires
+ *        the IntervalTimers and TeensyTimerTool timers that come due on the way, each as an interrupt.
+ * Interrupts - interrupt() runs a function as an interrupt handler. EventResponder software interrupts triggered inside it run
+ *              once it returns, like the lowest priority interrupt on the Teensy. Nothing fires while noInterrupts() is in effect.
+ * Pins - setPin() drives an input and calls the handler attachInterrupt() installed if the edge matches, an edge while
+ *        interrupts are masked fires once they are enabled again. watchPin() reports what the firmware writes to an output, so a
+ *        device model can react to its reset or wake line.
+ * Devices - functions added with attachDevice() update device models and the pins they drive. They run whenever the clock
+ *           moves and whenever the main loop reads it, so a device can answer a driver that waits for it.
+ *           A main loop that keeps reading the clock while it does not move is busy waiting: after 1000 such reads every read
+ *           moves it by a microsecond, so the wait can time out.
+ * Serial - serialInput() queues bytes for Serial to read, takeSerialOutput() returns what was written. setSerialWriteSpace()
+ *          limits availableForWrite() to model a slow host; bytes written past it are counted as overruns.
+ * SD - setSDRoot() picks the host directory that stands in for the card.
+*/
+
+namespace Host{
+    extern RocketOS::Scheduler::SimulatedClock clock;
+
+    //moves the clock forward, firing due timers in order
+    void advance(uint32_t time_us);
+    //runs function as an interrupt handler
+    void interrupt(const std::function<void()>& function);
+    bool inInterrupt();
+    bool interruptsEnabled();
+
+    void attachDevice(std::function<void()> update);
+
+    void setPin(uint8_t pin, uint8_t level);
+    uint8_t getPin(uint8_t pin);
+    void watchPin(uint8_t pin, std::function<void(uint8_t level)> watcher);
+
+    void serialInput(const char* data, size_t length);
+    void serialInput(const std::string& data);
+    std::string takeSerialOutput();
+    //-1 for an unlimited port
+    void setSerialWriteSpace(int bytes);
+    uint32_t getSerialOverruns();
+
+    void setSDRoot(const std::string& directory);
+
+    //returns every simulated peripheral to its power on state and detaches the devices, the clock restarts at zero
+    void reset();
+}
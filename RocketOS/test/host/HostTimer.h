@@ -0,0 +1,33 @@
+#pragma once
+#include <Arduino.h>
+#include <functional>
+
+namespace Host{
+    /*Simulated hardware timer
+     * Base of the IntervalTimer and TeensyTimerTool stand-ins. Armed timers fire as interrupts while Host::advance() moves the
+     * simulated clock past their due time, in the order they are due.
+    */
+    class Timer{
+        friend void reset();
+    private:
+        std::function<void()> m_callback;
+        uint32_t m_due_us;
+        uint32_t m_period_us;
+        bool m_armed;
+    public:
+        Timer();
+        ~Timer();
+        Timer(const Timer&) = delete;
+        Timer& operator=(const Timer&) = delete;
+
+        bool armed() const{ return m_armed; }
+        uint32_t due_us() const{ return m_due_us; }
+        //runs the callback as an interrupt and rearms a periodic timer, called by Host::advance()
+        void fire();
+
+    protected:
+        //the first call comes after delay_us, a non zero period repeats it
+        void arm(std::function<void()> callback, uint32_t delay_us, uint32_t period_us);
+        void disarm();
+    };
+}
@@ -0,0 +1,14 @@
+#pragma once
+#include <Arduino.h>
+#include "HostTimer.h"
+
+class IntervalTimer : private Host::Timer{
+public:
+    bool begin(std::function<void()> callback, unsigned int period_us){ arm(callback, period_us, period_us); return true; }
+    bool begin(std::function<void()> callback, int period_us){ return begin(callback, static_cast<unsigned int>(period_us)); }
+    bool begin(std::function<void()> callback, unsigned long period_us){ return begin(callback, static_cast<unsigned int>(period_us)); }
+    bool begin(std::function<void()> callback, float period_us){ return begin(callback, static_cast<unsigned int>(period_us)); }
+    void end(){ disarm(); }
+    void priority(uint8_t){}
+    using Host::Timer::armed;
+};
@@ -0,0 +1,39 @@
+#pragma once
+#include <Arduino.h>
+
+//the SPI peripherals are not simulated, host builds run the sensor drivers on RocketOS::Utilities::MockSPIBackend
+#define MSBFIRST 1
+#define LSBFIRST 0
+#define SPI_MODE0 0x00
+#define SPI_MODE1 0x04
+#define SPI_MODE2 0x08
+#define SPI_MODE3 0x0C
+
+class SPISettings{
+public:
+    SPISettings() {}
+    SPISettings(uint32_t, uint8_t, uint8_t) {}
+};
+
+class SPIClass{
+public:
+    void begin(){}
+    void end(){}
+    void beginTransaction(SPISettings){}
+    void endTransaction(){}
+    uint8_t transfer(uint8_t){ return 0xFF; }
+    uint16_t transfer16(uint16_t){ return 0xFFFF; }
+    uint32_t transfer32(uint32_t){ return 0xFFFFFFFF; }
+    void transfer(void* buffer, size_t length){ if(buffer != nullptr) memset(buffer, 0xFF, length); }
+    void transfer(const void*, void* rx, size_t length){ if(rx != nullptr) memset(rx, 0xFF, length); }
+    bool transfer(const void*, void* rx, size_t length, EventResponder& event){
+        if(rx != nullptr) memset(rx, 0xFF, length);
+        event.triggerEvent();
+        return true;
+    }
+    void setMISO(uint8_t){}
+    void setMOSI(uint8_t){}
+    void setSCK(uint8_t){}
+    void usingInterrupt(uint8_t){}
+};
+extern SPIClass SPI, SPI1, SPI2;
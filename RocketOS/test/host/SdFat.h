@@ -0,0 +1,62 @@
+#pragma once
+#include <Arduino.h>
+
+/*SD card
+ * Files live in the host directory set with Host::setSDRoot(). Without one every open fails, like a missing card.
+*/
+#define FIFO_SDIO 0
+#define DMA_SDIO 1
+#define O_RDONLY 0x01
+#define O_READ O_RDONLY
+#define O_WRONLY 0x02
+#define O_WRITE O_WRONLY
+#define O_RDWR 0x03
+#define O_CREAT 0x04
+#define O_AT_END 0x08
+#define O_APPEND O_AT_END
+#define O_TRUNC 0x10
+#define FILE_READ O_READ
+#define FILE_WRITE (O_RDWR | O_CREAT | O_AT_END)
+
+class SdioConfig{
+public:
+    SdioConfig(uint8_t = FIFO_SDIO) {}
+};
+
+class FsFile : public Stream{
+private:
+    FILE* m_file;
+public:
+    FsFile() : m_file(nullptr) {}
+    FsFile(FsFile&& other) : m_file(other.m_file){ other.m_file = nullptr; }
+    FsFile& operator=(FsFile&& other){ if(this != &other){ close(); m_file = other.m_file; other.m_file = nullptr; } return *this; }
+    FsFile(const FsFile&) = delete;
+    FsFile& operator=(const FsFile&) = delete;
+    ~FsFile(){ close(); }
+
+    bool open(const char* path, int flags = O_READ);
+    bool close();
+    bool isOpen() const{ return m_file != nullptr; }
+    operator bool() const{ return isOpen(); }
+    size_t write(uint8_t) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    using Print::write;
+    int available() override;
+    int read() override;
+    int peek() override;
+    int read(void* buffer, size_t length);
+    void flush() override{ sync(); }
+    bool sync();
+    bool seek(uint64_t position);
+    uint64_t size();
+};
+typedef FsFile File;
+
+class SdFat{
+public:
+    bool begin(SdioConfig);
+    FsFile open(const char* path, int flags = O_READ);
+    bool exists(const char* path);
+    bool remove(const char* path);
+    void end(){}
+};
@@ -0,0 +1,47 @@
+#pragma once
+#include <Arduino.h>
+#include "HostTimer.h"
+#include "inplace_function.h"
+
+namespace TeensyTimerTool{
+    namespace stdext = ::stdext;
+    using callback_t = stdext::inplace_function<void(void), 16>;
+    enum class errorCode{OK};
+
+    //every generator is the same simulated timer on the host
+    using TimerGenerator = void*();
+    TimerGenerator TMR1, TMR2, TMR3, TMR4, GPT1, GPT2, TCK;
+
+    class OneShotTimer : private Host::Timer{
+    private:
+        callback_t m_callback;
+    public:
+        OneShotTimer(TimerGenerator* = nullptr) {}
+        errorCode begin(callback_t callback){ m_callback = callback; return errorCode::OK; }
+        template<class T>
+        errorCode trigger(T delay_us){
+            arm([this](){ if(m_callback) m_callback(); }, static_cast<uint32_t>(delay_us), 0);
+            return errorCode::OK;
+        }
+        errorCode stop(){ disarm(); return errorCode::OK; }
+        using Host::Timer::armed;
+        using Host::Timer::due_us;
+    };
+
+    class PeriodicTimer : private Host::Timer{
+    private:
+        callback_t m_callback;
+        uint32_t m_period_us = 0;
+    public:
+        PeriodicTimer(TimerGenerator* = nullptr) {}
+        template<class T>
+        errorCode begin(callback_t callback, T period_us, bool start = true){
+            m_callback = callback;
+            m_period_us = static_cast<uint32_t>(period_us);
+            if(start) this->start();
+            return errorCode::OK;
+        }
+        errorCode start(){ arm([this](){ if(m_callback) m_callback(); }, m_period_us, m_period_us); return errorCode::OK; }
+        errorCode stop(){ disarm(); return errorCode::OK; }
+    };
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <functional>
+#include <cstddef>
+#include <type_traits>
+
+/*inplace_function
+ * std::function with the capacity check of the Teensy inplace_function. Captures are checked against the capacity scaled to the
+ * host pointer size, so a capture that only fits a 32 bit target still fails here.
+*/
+namespace stdext{
+    template<class t_signature, std::size_t t_capacity> class inplace_function;
+
+    template<class R, class... A, std::size_t t_capacity>
+    class inplace_function<R(A...), t_capacity>{
+    private:
+        std::function<R(A...)> m_function;
+    public:
+        inplace_function() = default;
+        inplace_function(std::nullptr_t) {}
+        template<class F, class = std::enable_if_t<!std::is_same<std::decay_t<F>, inplace_function>::value>>
+        inplace_function(F&& function) : m_function(std::forward<F>(function)){
+            static_assert(sizeof(std::decay_t<F>) <= t_capacity * sizeof(void*) / 4, "inplace_function capture exceeds its capacity");
+        }
+        R operator()(A... arguments) const{ return m_function(std::forward<A>(arguments)...); }
+        explicit operator bool() const{ return static_cast<bool>(m_function); }
+        friend bool operator==(const inplace_function& function, std::nullptr_t){ return !function.m_function; }
+        friend bool operator!=(const inplace_function& function, std::nullptr_t){ return static_cast<bool>(function.m_function); }
+    };
+}